@@ -39,6 +39,7 @@
 
 #include "animation.h"
 #include "iolib.h"
+#include "player.h"
 #include "unit.h"
 #include "unittype.h"
 
@@ -124,7 +125,7 @@ void COrder_Die::Execute(CUnit &unit) /* override */
 	// Always do that, since types can have different vision properties.
 
 	unit.Remove(nullptr);
-	unit.Type = &corpseType;
+	unit.Player->ChangeUnitType(unit, corpseType);
 	unit.Stats = const_cast<CUnitStats *>(&corpseType.Stats[unit.Player->Index]);
 	UpdateUnitSightRange(unit);
 	unit.Place(unit.tilePos);
@@ -87,9 +87,10 @@ class NearReachableTerrainFinder
 		terrainTraversal.SetSize(Map.Info.MapWidth, Map.Info.MapHeight);
 		terrainTraversal.Init();
 
+		terrainTraversal.SetMaxDistance(range + 1);
 		terrainTraversal.PushPos(startPos);
 
-		NearReachableTerrainFinder nearReachableTerrainFinder(player, range, movemask, resmask);
+		NearReachableTerrainFinder nearReachableTerrainFinder(player, movemask, resmask);
 
 		return terrainTraversal.Run(nearReachableTerrainFinder)
 		         ? std::make_optional(nearReachableTerrainFinder.resPos)
@@ -97,16 +98,14 @@ class NearReachableTerrainFinder
 	}
 
 private:
-	NearReachableTerrainFinder(const CPlayer &player, int maxDist, int movemask, int resmask) :
+	NearReachableTerrainFinder(const CPlayer &player, int movemask, int resmask) :
 		player(player),
-		maxDist(maxDist),
 		movemask(movemask),
 		resmask(resmask)
 	{}
 	VisitResult Visit(TerrainTraversal &terrainTraversal, const Vec2i &pos, const Vec2i &from);
 private:
 	const CPlayer &player;
-	int maxDist;
 	unsigned int movemask;
 	unsigned int resmask;
 	Vec2i resPos{-1, -1};
@@ -123,11 +122,7 @@ VisitResult NearReachableTerrainFinder::Visit(TerrainTraversal &terrainTraversal
 		return VisitResult::Finished;
 	}
 	if (Map.Field(pos)->CheckMask(resmask)) { // reachable
-		if (terrainTraversal.Get(pos) <= maxDist) {
-			return VisitResult::Ok;
-		} else {
-			return VisitResult::DeadEnd;
-		}
+		return VisitResult::Ok;
 	} else { // unreachable
 		return VisitResult::DeadEnd;
 	}
@@ -464,5 +464,27 @@ void COrder_Still::Execute(CUnit &unit) /* override */
 	}
 }
 
+/**
+**  Get the number of next cycles in which the unit only waits in its
+**  still animation and counts down before looking for something to do.
+**
+**  @param unit  Unit which has just executed this order.
+*/
+unsigned int COrder_Still::GetIdleCycles(const CUnit &unit) const /* override */
+{
+	// A stand ground order may be stored and cloned, its count down must stay exact.
+	if (this->Action != UnitAction::Still || this->State != SUB_STILL_STANDBY || this->Sleep == 0
+	    || unit.Waiting || unit.Anim.CurrAnim != &unit.Type->Animations->Still) {
+		return 0;
+	}
+	// The cycle where the wait reaches 0 advances the animation.
+	return std::max(0, std::min<int>(unit.Anim.Wait - 1, this->Sleep));
+}
+
+void COrder_Still::SkipIdleCycles(CUnit &, unsigned int cycles) /* override */
+{
+	Assert(cycles <= this->Sleep);
+	this->Sleep -= cycles;
+}
 
 //@}
@@ -154,9 +154,12 @@ static int TransformUnitIntoType(CUnit &unit, const CUnitType &newtype)
 			unit.Variable[i].Enable = newstats.Variables[i].Enable;
 		}
 	}
+	unit.UpdateIncreasingVariables();
 
-	unit.Type = const_cast<CUnitType *>(&newtype);
+	player.ChangeUnitType(unit, newtype);
 	unit.Stats = const_cast<CUnitStats *>(&unit.Type->Stats[player.Index]);
+	// The movement type and attack may change without removing the unit.
+	Map.UnitChanged(unit);
 
 	if (!newtype.CanCastSpell.empty() && unit.AutoCastSpell.empty()) {
 		unit.AutoCastSpell.resize(SpellTypeTable.size());
@@ -80,8 +80,13 @@
 # include "st_backtrace.h"
 #endif
 
+#include <algorithm>
 #include <array>
+#include <cstddef>
 #include <ctime>
+#include <limits>
+#include <new>
+#include <vector>
 
 /*----------------------------------------------------------------------------
 --  Variables
@@ -124,6 +129,63 @@ COrder::~COrder()
 	Goal.Reset();
 }
 
+/*
+**  Orders are created and destroyed for each command, by the thousands in
+**  big fights. Their memory is recycled by size class instead of going
+**  through the heap each time, the blocks are carved from slabs.
+**  A free block holds the link to the next one, so that delete never
+**  allocates and a refill costs the same whatever the number of slabs.
+*/
+static constexpr size_t OrderBlockAlign = alignof(std::max_align_t);
+static constexpr size_t OrderSizeClasses = 16;
+static constexpr size_t OrdersPerSlab = 64;
+
+struct OrderFreeBlock
+{
+	OrderFreeBlock *Next; /// Next free block of the size class
+};
+
+/// First free block of each size class.
+/// Trivially destroyed, the units may delete their orders at exit.
+static std::array<OrderFreeBlock *, OrderSizeClasses> OrderFreeBlocks{};
+
+static size_t OrderSizeClass(size_t size)
+{
+	return (std::max<size_t>(size, 1) - 1) / OrderBlockAlign;
+}
+
+/* static */ void *COrder::operator new(size_t size)
+{
+	const size_t sizeClass = OrderSizeClass(size);
+
+	if (sizeClass >= OrderSizeClasses) {
+		return ::operator new(size);
+	}
+	OrderFreeBlock *&freeBlocks = OrderFreeBlocks[sizeClass];
+	if (freeBlocks == nullptr) {
+		const size_t blockSize = (sizeClass + 1) * OrderBlockAlign;
+		char *slab = static_cast<char *>(::operator new(blockSize * OrdersPerSlab));
+
+		for (size_t i = OrdersPerSlab; i-- != 0;) {
+			freeBlocks = new (slab + i * blockSize) OrderFreeBlock{freeBlocks};
+		}
+	}
+	OrderFreeBlock *block = freeBlocks;
+	freeBlocks = block->Next;
+	return block;
+}
+
+/* static */ void COrder::operator delete(void *p, size_t size) noexcept
+{
+	const size_t sizeClass = OrderSizeClass(size);
+
+	if (sizeClass >= OrderSizeClasses) {
+		::operator delete(p);
+		return;
+	}
+	OrderFreeBlocks[sizeClass] = new (p) OrderFreeBlock{OrderFreeBlocks[sizeClass]};
+}
+
 void COrder::SetGoal(CUnit *const new_goal)
 {
 	Goal = new_goal;
@@ -398,20 +460,24 @@ static bool HandleBurnAndPoison(CUnit &unit)
 */
 static void HandleBuffsEachSecond(CUnit &unit)
 {
-	// User defined variables
-	for (unsigned int i = 0; i < UnitTypeVar.GetNumberVariable(); i++) {
-		if (i == BLOODLUST_INDEX || i == HASTE_INDEX || i == SLOW_INDEX
-			|| i == INVISIBLE_INDEX || i == UNHOLYARMOR_INDEX || i == POISON_INDEX) {
-			continue;
-		}
-		if (i == HP_INDEX && HandleBurnAndPoison(unit)) {
-			continue;
-		}
-		unsigned char freq = unit.Variable[i].IncreaseFrequency;
-		if (unit.Variable[i].Enable && unit.Variable[i].Increase &&
-				(freq == 0 || freq == 1 || (GameCycle / CYCLES_PER_SECOND % freq) == 0)) {
-			IncreaseVariable(unit, i);
+	static_assert(HP_INDEX == 0);
+	// Burning and poison replace the regeneration of the hit points.
+	const bool hpHandled = UnitTypeVar.GetNumberVariable() && HandleBurnAndPoison(unit);
+
+	// User defined variables, only the ones with an increase.
+	// The list may change while going through it, the next index is searched each time.
+	const std::vector<unsigned int> &variables = unit.IncreasingVariables;
+	for (auto it = variables.begin(); it != variables.end();) {
+		const unsigned int i = *it;
+
+		if (i != HP_INDEX || !hpHandled) {
+			unsigned char freq = unit.Variable[i].IncreaseFrequency;
+			if (unit.Variable[i].Enable && unit.Variable[i].Increase &&
+					(freq == 0 || freq == 1 || (GameCycle / CYCLES_PER_SECOND % freq) == 0)) {
+				IncreaseVariable(unit, i);
+			}
 		}
+		it = std::upper_bound(variables.begin(), variables.end(), i);
 	}
 }
 
@@ -483,10 +549,12 @@ static void HandleUnitAction(CUnit &unit)
 	unit.Orders[0]->Execute(unit);
 }
 
-static void UnitActionsEachSecond(const std::vector<CUnit *> &units)
+static void UnitActionsEachSecond(size_t unitCount)
 {
-	for (CUnit *unitPtr : units) {
-		CUnit &unit = *unitPtr;
+	const std::vector<CUnit *> &units = UnitManager->GetIteratedUnits();
+
+	for (size_t i = 0; i != unitCount; ++i) {
+		CUnit &unit = *units[i];
 
 		if (unit.Destroyed) {
 			continue;
@@ -704,10 +772,109 @@ static void DumpUnitInfo(const CUnit &unit)
 	fflush(nullptr);
 }
 
-static void UnitActionsEachCycle(const std::vector<CUnit *> &units)
+/// Cycle of the running or of the last UnitActions
+static unsigned long UnitActionsCycle = 0;
+/// Number of units whose action is done for UnitActionsCycle
+static size_t UnitActionsDone = 0;
+
+/**
+**  Wake up a sleeping unit: count down what its action skipped.
+**
+**  While it sleeps, the action of a unit is not run. The cycles it skips
+**  are the ones where it would only have counted down its animation wait
+**  and its order, so counting them down now gives the same state.
+**
+**  @param unit       Unit which sleeps.
+**  @param lastCycle  Last cycle for which the unit is done.
+*/
+static void WakeUpUnit(CUnit &unit, unsigned long lastCycle)
+{
+	const unsigned int cycles = std::min(lastCycle, unit.Idle.Until - 1) - unit.Idle.Since;
+
+	unit.Anim.Wait -= cycles;
+	for (auto &order : unit.Orders) {
+		if (order->Idle) {
+			order->SkipIdleCycles(unit, cycles);
+			order->Idle = false;
+		}
+	}
+	unit.Idle = {};
+}
+
+/**
+**  Check if the action of a unit can be skipped this cycle.
+**
+**  A unit sleeps when its order tells it has only to count down for
+**  some cycles. It is woken up before, as soon as something which would
+**  change what its order does happens: a new order, a critical order,
+**  a removal, a change of type, an unbreakable animation or a rotation.
+**
+**  @param unit  Unit whose turn it is.
+**
+**  @return      true if the unit still sleeps.
+*/
+static bool IsUnitAsleep(CUnit &unit)
 {
-	for (auto *unitPtr : units) {
-		CUnit &unit = *unitPtr;
+	if (unit.Idle.Until == 0) {
+		return false;
+	}
+	if (GameCycle < unit.Idle.Until && unit.Orders.size() == 1 && unit.Orders[0]->Idle
+	    && unit.CriticalOrder == nullptr && !unit.Removed && unit.Type == unit.Idle.Type
+	    && !unit.Anim.Unbreakable && unit.Anim.Rotate == 0) {
+		return true;
+	}
+	WakeUpUnit(unit, GameCycle - 1);
+	return false;
+}
+
+/**
+**  Let the unit sleep if its order has nothing to do but count down.
+**
+**  @param unit  Unit whose action has just been run.
+*/
+static void MaybeSleepUnit(CUnit &unit)
+{
+	if (unit.Destroyed || unit.Orders.size() != 1 || unit.CriticalOrder != nullptr || unit.Removed
+	    || unit.Anim.Unbreakable || unit.Anim.Rotate != 0) {
+		return;
+	}
+	COrder &order = *unit.Orders[0];
+	const unsigned int cycles = order.GetIdleCycles(unit);
+
+	if (cycles != 0) {
+		unit.Idle.Since = GameCycle;
+		unit.Idle.Until = GameCycle + cycles + 1;
+		unit.Idle.Type = unit.Type;
+		order.Idle = true;
+	}
+}
+
+/**
+**  Count down what the sleeping units skipped up to the last cycle their
+**  action was run for, and wake them up. It is needed before saving them,
+**  the following cycles give the same results.
+**
+**  A save may come from the triggers, before the actions of the current
+**  cycle, or even from a callback in the middle of them: the units which
+**  are not done yet are only counted down to the previous cycle.
+*/
+void WakeUpIdleUnits()
+{
+	const std::vector<CUnit *> &units = UnitManager->GetIteratedUnits();
+
+	for (size_t i = 0; i != units.size(); ++i) {
+		if (units[i]->Idle.Until != 0) {
+			WakeUpUnit(*units[i], i < UnitActionsDone ? UnitActionsCycle : UnitActionsCycle - 1);
+		}
+	}
+}
+
+static void UnitActionsEachCycle(size_t unitCount)
+{
+	const std::vector<CUnit *> &units = UnitManager->GetIteratedUnits();
+
+	for (size_t i = 0; i != unitCount; UnitActionsDone = ++i) {
+		CUnit &unit = *units[i];
 
 		if (unit.Destroyed) {
 			continue;
@@ -730,10 +897,13 @@ static void UnitActionsEachCycle(const std::vector<CUnit *> &units)
 			continue;
 		}
 
-		try {
-			HandleUnitAction(unit);
-		} catch (AnimationDie_Exception &) {
-			AnimationDie_OnCatch(unit);
+		if (!IsUnitAsleep(unit)) {
+			try {
+				HandleUnitAction(unit);
+			} catch (AnimationDie_Exception &) {
+				AnimationDie_OnCatch(unit);
+			}
+			MaybeSleepUnit(unit);
 		}
 
 		if (EnableUnitDebug) {
@@ -773,16 +943,21 @@ static void UnitActionsEachCycle(const std::vector<CUnit *> &units)
 void UnitActions()
 {
 	const bool isASecondCycle = !(GameCycle % CYCLES_PER_SECOND);
-	// Unit list may be modified during loop... so make a copy
-	std::vector<CUnit *> units(UnitManager->GetUnits());
-	BeginSyncDebugCycle(GameCycle, units.size());
+	// Unit list may be modified during loop, only the units present now are handled
+	UnitManager->BeginIteration();
+	const size_t unitCount = UnitManager->GetIteratedUnits().size();
+	BeginSyncDebugCycle(GameCycle, unitCount);
+	UnitActionsCycle = GameCycle;
+	UnitActionsDone = 0;
 
 	// Check for things that only happen every second
 	if (isASecondCycle) {
-		UnitActionsEachSecond(units);
+		UnitActionsEachSecond(unitCount);
 	}
 	// Do all actions
-	UnitActionsEachCycle(units);
+	UnitActionsEachCycle(unitCount);
+	UnitActionsDone = std::numeric_limits<size_t>::max();
+	UnitManager->EndIteration();
 	EndSyncDebugCycle();
 }
 
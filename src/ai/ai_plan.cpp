@@ -67,7 +67,8 @@ namespace {
 */
 CUnit *EnemyOnMapTile(const CUnit &source, const Vec2i &pos)
 {
-	auto units = Map.Field(pos)->UnitCache;
+	const auto &unitCache = Map.Field(pos)->UnitCache;
+	std::vector<CUnit *> units(unitCache.begin(), unitCache.end());
 	ranges::erase_if(units, [&](const CUnit *unit) {
 		const CUnitType &type = *unit->Type;
 		// unusable unit ?
@@ -101,22 +102,21 @@ class WallFinder
 		terrainTraversal.SetSize(Map.Info.MapWidth, Map.Info.MapHeight);
 		terrainTraversal.Init();
 
+		terrainTraversal.SetMaxDistance(range + 1);
 		terrainTraversal.PushUnitPosAndNeighboor(unit);
 
-		WallFinder wallFinder(unit, range);
+		WallFinder wallFinder(unit);
 
 		return terrainTraversal.Run(wallFinder) ? std::make_optional(wallFinder.resultPos)
 		                                        : std::nullopt;
 	}
 
 private:
-	WallFinder(const CUnit &unit, int maxDist) :
-		maxDist(maxDist),
+	WallFinder(const CUnit &unit) :
 		movemask(unit.Type->MovementMask & ~(MapFieldLandUnit | MapFieldAirUnit | MapFieldSeaUnit))
 	{}
 	VisitResult Visit(TerrainTraversal &terrainTraversal, const Vec2i &pos, const Vec2i &from);
 private:
-	int maxDist;
 	unsigned int movemask;
 	Vec2i resultPos{-1, -1};
 };
@@ -135,11 +135,7 @@ VisitResult WallFinder::Visit(TerrainTraversal &terrainTraversal, const Vec2i &p
 		return VisitResult::Finished;
 	}
 	if (Map.Field(pos)->CheckMask(movemask)) { // reachable
-		if (terrainTraversal.Get(pos) <= maxDist) {
-			return VisitResult::Ok;
-		} else {
-			return VisitResult::DeadEnd;
-		}
+		return VisitResult::Ok;
 	} else { // unreachable
 		return VisitResult::DeadEnd;
 	}
@@ -203,12 +203,16 @@ bool AiEnemyUnitsInDistance(const CPlayer &player,
 						    const CUnitType *type, const Vec2i &pos, unsigned range)
 {
 	const Vec2i offset(range, range);
+	const Vec2i typeSize = type ? Vec2i(type->TileWidth - 1, type->TileHeight - 1) : Vec2i(0, 0);
 
+	// Most of the map has no enemy, the influence map tells it without any scan.
+	if (Map.Influence.GetEnemyPresence(player, pos - offset, pos + typeSize + offset) == 0) {
+		return false;
+	}
 	if (type == nullptr) {
 		std::vector<CUnit *> units = Select<1>(pos - offset, pos + offset, IsAEnemyUnitOf<true>(player));
 		return !units.empty();
 	} else {
-		const Vec2i typeSize(type->TileWidth - 1, type->TileHeight - 1);
 		const IsAEnemyUnitWhichCanCounterAttackOf<true> pred(player, *type);
 
 		std::vector<CUnit *> units = Select<1>(pos - offset, pos + typeSize + offset, pred);
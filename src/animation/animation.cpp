@@ -73,6 +73,8 @@
 #include "unittype.h"
 #include "pathfinder.h"
 
+#include <charconv>
+#include <istream>
 #include <set>
 
 struct LabelsLaterStruct {
@@ -326,7 +328,7 @@ int ParseAnimInt(const CUnit &unit, const std::string_view s)
 		if (dot_pos == std::string_view::npos) {
 			return SyncRand(to_number(cur) + 1);
 		} else {
-			const int min = to_number(cur);
+			const int min = to_number(cur.substr(0, dot_pos));
 			return min + SyncRand(to_number(cur.substr(dot_pos + 1)) - min + 1);
 		}
 	} else if (s[0] == 'l') { //player number
@@ -349,6 +351,190 @@ int ParseAnimInt(const CUnit &unit, const std::string_view s)
 	return to_number(s);
 }
 
+/**
+**  Parse a number of an animation operand.
+**
+**  @return  The number, nothing if the text is not exactly a number.
+*/
+static std::optional<int> ParseAnimNumber(std::string_view s)
+{
+	int res = 0;
+
+	if (s.empty() || !(isdigit(s[0]) || s[0] == '-')) {
+		return std::nullopt;
+	}
+	const auto [ptr, ec] = std::from_chars(s.data(), s.data() + s.size(), res);
+	if (ec != std::errc() || ptr != s.data() + s.size()) {
+		return std::nullopt;
+	}
+	return res;
+}
+
+/**
+**  Analyse an animation operand.
+**
+**  What is not understood here is evaluated by ParseAnimInt, which also
+**  reports the errors, as before.
+*/
+CAnimInt &CAnimInt::operator=(std::string_view s)
+{
+	text = s;
+	name.clear();
+	kind = EKind::Other;
+	component = EComponent::None;
+	ofGoal = false;
+	value = 0;
+	max = 0;
+	index = -1;
+
+	if (s.empty()) {
+		kind = EKind::Number;
+		return *this;
+	}
+	switch (s[0]) {
+		case 'v':
+		case 't': {
+			const auto dot_pos = s.find('.', 2);
+			if (s.size() < 2 || dot_pos == std::string_view::npos) {
+				break;
+			}
+			const std::string_view cur = s.substr(2, dot_pos - 2);
+			const std::string_view next = s.substr(dot_pos + 1);
+			if (cur == "ResourcesHeld" || cur == "ResourceActive" || cur == "_Distance") {
+				break;
+			}
+			kind = EKind::Variable;
+			ofGoal = s[0] == 't';
+			name = cur;
+			component = next == "Value" ? EComponent::Value
+			          : next == "Max" ? EComponent::Max
+			          : next == "Increase" ? EComponent::Increase
+			          : next == "Enable" ? EComponent::Enable
+			          : next == "Percent" ? EComponent::Percent
+			          : EComponent::None;
+			break;
+		}
+		case 'b':
+		case 'g':
+			if (s.size() < 2) {
+				break;
+			}
+			kind = EKind::BoolFlag;
+			ofGoal = s[0] == 'g';
+			name = s.substr(2);
+			break;
+		case 'r': {
+			if (s.size() < 2) {
+				break;
+			}
+			const std::string_view cur = s.substr(2);
+			const auto dot_pos = cur.find('.');
+			const auto min = ParseAnimNumber(dot_pos == std::string_view::npos ? "0" : cur.substr(0, dot_pos));
+			const auto max = ParseAnimNumber(dot_pos == std::string_view::npos ? cur : cur.substr(dot_pos + 1));
+			if (!min || !max) {
+				break;
+			}
+			kind = EKind::Random;
+			this->value = *min;
+			this->max = *max;
+			break;
+		}
+		case 'U': kind = EKind::UnitNumber; break;
+		case 'G': kind = EKind::GoalNumber; break;
+		case 'R': kind = EKind::Rotate; break;
+		case 'W': kind = EKind::RemainingWay; break;
+		default:
+			if (const auto number = ParseAnimNumber(s)) {
+				kind = EKind::Number;
+				value = *number;
+			}
+			break;
+	}
+	return *this;
+}
+
+/**
+**  Evaluate an animation operand, as ParseAnimInt does with its text.
+**
+**  @param unit  Unit of the animation.
+**
+**  @return  The value of the operand.
+*/
+int CAnimInt::Eval(const CUnit &unit) const
+{
+	switch (kind) {
+		case EKind::Other:
+			return ParseAnimInt(unit, text);
+		case EKind::Number:
+			return value;
+		case EKind::Variable: {
+			const CUnit *goal = &unit;
+			if (ofGoal) {
+				if (unit.CurrentOrder()->HasGoal()) {
+					goal = unit.CurrentOrder()->GetGoal();
+				} else if (unit.CurrentOrder()->Action == UnitAction::Build) {
+					goal = static_cast<const COrder_Build *>(unit.CurrentOrder())->GetBuildingUnit();
+				} else {
+					return 0;
+				}
+			}
+			if (index == -1) {
+				index = UnitTypeVar.VariableNameLookup[name];
+				if (index == -1) {
+					return ParseAnimInt(unit, text);
+				}
+			}
+			const CVariable &variable = goal->Variable[index];
+			switch (component) {
+				case EComponent::Value: return variable.Value;
+				case EComponent::Max: return variable.Max;
+				case EComponent::Increase: return variable.Increase;
+				case EComponent::Enable: return variable.Enable;
+				case EComponent::Percent: return variable.Value * 100 / variable.Max;
+				case EComponent::None: return 0;
+			}
+			return 0;
+		}
+		case EKind::BoolFlag: {
+			const CUnit *goal = &unit;
+			if (ofGoal) {
+				if (!unit.CurrentOrder()->HasGoal()) {
+					return 0;
+				}
+				goal = unit.CurrentOrder()->GetGoal();
+			}
+			if (index == -1) {
+				index = UnitTypeVar.BoolFlagNameLookup[name];
+				if (index == -1) {
+					return ParseAnimInt(unit, text);
+				}
+			}
+			return goal->Type->BoolFlag[index].value;
+		}
+		case EKind::Random:
+			return value + SyncRand(max - value + 1);
+		case EKind::UnitNumber:
+			return UnitNumber(unit);
+		case EKind::GoalNumber:
+			return unit.CurrentOrder()->HasGoal() ? UnitNumber(*unit.CurrentOrder()->GetGoal()) : 0;
+		case EKind::Rotate:
+			return unit.Anim.Rotate;
+		case EKind::RemainingWay:
+			return unit.pathFinderData->output.Length + 1 + unit.pathFinderData->output.OverflowLength;
+	}
+	return 0;
+}
+
+std::istream &operator>>(std::istream &is, CAnimInt &value)
+{
+	std::string word;
+
+	if (is >> word) {
+		value = word;
+	}
+	return is;
+}
+
 /**
 **  Show unit animation.
 **
@@ -59,7 +59,7 @@ std::optional<int> CAnimation_ExactFrame::GetStillFrame(const CUnitType &type) /
 int CAnimation_ExactFrame::ParseAnimInt(const CUnit *unit) const
 {
 	if (unit == nullptr) {
-		return to_number(this->frame);
+		return to_number(this->frame.str());
 	} else {
 		return ::ParseAnimInt(*unit, this->frame);
 	}
@@ -64,7 +64,7 @@ std::optional<int> CAnimation_Frame::GetStillFrame(const CUnitType &type) /* ove
 int CAnimation_Frame::ParseAnimInt(const CUnit *unit) const
 {
 	if (unit == nullptr) {
-		return to_number(this->frame);
+		return to_number(this->frame.str());
 	} else {
 		return ::ParseAnimInt(*unit, this->frame);
 	}
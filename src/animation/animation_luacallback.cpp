@@ -50,7 +50,7 @@ void CAnimation_LuaCallback::Action(CUnit &unit, int & /*move*/, int /*scale*/)
 	Assert(cb);
 
 	cb.pushPreamble();
-	for (const std::string &str : cbArgs) {
+	for (const CAnimInt &str : cbArgs) {
 		const int arg = ParseAnimInt(unit, str);
 		cb.pushInteger(arg);
 	}
@@ -74,8 +74,8 @@ void CAnimation_LuaCallback::Init(std::string_view s, lua_State *l) /* override
 	}
 
 	std::istringstream iss{std::string(s.substr(space_pos + 1))};
-	std::copy(std::istream_iterator<std::string>(iss),
-	          std::istream_iterator<std::string>(),
+	std::copy(std::istream_iterator<CAnimInt>(iss),
+	          std::istream_iterator<CAnimInt>(),
 	          std::back_inserter(this->cbArgs));
 }
 
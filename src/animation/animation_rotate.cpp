@@ -59,7 +59,7 @@ void CAnimation_Rotate::Action(CUnit &unit, int & /*move*/, int /*scale*/) const
 	Assert(unit.Anim.CurrAnim);
 	Assert((*unit.Anim.CurrAnim)[unit.Anim.Anim].get() == this);
 
-	if (this->rotateStr == "target") {
+	if (this->rotateStr.str() == "target") {
 		COrder *order = unit.CurrentOrder();
 		CUnit *target;
 		if (order->HasGoal()) {
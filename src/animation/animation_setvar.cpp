@@ -70,13 +70,13 @@ void CAnimation_SetVar::Action(CUnit &unit, int & /*move*/, int /*scale*/) const
 	if (dot_pos == std::string_view::npos) {
 		// Special case for non-CVariable variables
 		if (arg1 == "DamageType") {
-			int death = ExtraDeathIndex(this->valueStr);
+			int death = ExtraDeathIndex(this->valueStr.str());
 			if (death == ANIMATIONS_DEATHTYPES) {
-				ErrorPrint("Incorrect death type: %s\n", this->valueStr.c_str());
+				ErrorPrint("Incorrect death type: %s\n", this->valueStr.str().c_str());
 				Exit(1);
 				return;
 			}
-			goal->Type->DamageType = this->valueStr;
+			goal->Type->DamageType = this->valueStr.str();
 			return;
 		}
 		ErrorPrint("Need also specify the variable '%s' tag\n", arg1.data());
@@ -111,6 +111,7 @@ void CAnimation_SetVar::Action(CUnit &unit, int & /*move*/, int /*scale*/) const
 		value = goal->Variable[index].Increase;
 		modifyValue(this->mod, value, rop);
 		goal->Variable[index].Increase = value;
+		goal->UpdateIncreasingVariables();
 	} else if (next == "Enable") {
 		value = goal->Variable[index].Enable;
 		modifyValue(this->mod, value, rop);
@@ -116,8 +116,8 @@ void CAnimation_Wiggle::Init(std::string_view s, lua_State *) /* override */
 	std::istringstream is{std::string(s)};
 	is >> this->x >> this->y >> this->speed;
 
-	if (this->speed == "absolute") {
-	} else if (this->speed == "heading") {
+	if (this->speed.str() == "absolute") {
+	} else if (this->speed.str() == "heading") {
 		this->isHeading = true;
 	} else {
 		std::string label;
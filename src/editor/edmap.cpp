@@ -40,6 +40,7 @@
 #include "stratagus.h"
 #include "editor.h"
 #include "map.h"
+#include "pathfinder.h"
 #include "tileset.h"
 #include "ui.h"
 #include "player.h"
@@ -176,6 +177,7 @@ void CEditor::SetTile(const Vec2i &pos, tile_index tileIdx)
 
 	mf.setTileIndex(Map.Tileset, tileIdx, 0, mf.getElevation());
 	mf.playerInfo.SeenTile = mf.getGraphicTile();
+	PathfinderTerrainChanged(pos);
 
 	UI.Minimap.UpdateSeenXY(pos);
 	UI.Minimap.UpdateXY(pos);
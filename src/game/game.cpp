@@ -155,6 +155,27 @@ void StartMap(const std::string &filename, bool clean)
 	Gui->setTop(oldTop);
 }
 
+/**
+**  Play a map without video, sound and user interface.
+**
+**  Person players are played by the computer, the results are written
+**  at the end of the game (see GameMainLoop).
+**
+**  @param filename  map filename
+*/
+void RunHeadlessGame(const std::string &filename)
+{
+	InitSettings();
+	NetConnectRunning = 0;
+	InterfaceState = IfaceState::Normal;
+
+	DebugPrint("Creating headless game with map: %s\n", filename.c_str());
+	CleanPlayers();
+	CreateGame(filename, &Map);
+	GameMainLoop(true);
+	CleanGame();
+}
+
 /*----------------------------------------------------------------------------
 --  Map loading/saving
 ----------------------------------------------------------------------------*/
@@ -820,7 +841,18 @@ void CreateGame(const fs::path &filename, CMap *map)
 		if (GameSettings.Presets[i].Type != PlayerTypes::MapDefault) {
 			playertype = GameSettings.Presets[i].Type;
 		}
+		const bool headlessPerson =
+			Parameters::Instance.headless && playertype == PlayerTypes::PlayerPerson;
+		if (headlessPerson) {
+			// Nobody plays a headless game, the AI does.
+			playertype = PlayerTypes::PlayerComputer;
+		}
 		CreatePlayer(playertype);
+		if (headlessPerson && !ThisPlayer) {
+			// The game scripts still see the game as the first person slot:
+			// their victory and defeat triggers test GetThisPlayer().
+			ThisPlayer = &Players[i];
+		}
 		if (GameSettings.Presets[i].Team != SettingsPresetMapDefault) {
 			// why this calculation? Well. The CreatePlayer function assigns some
 			// default team values, starting from up to PlayerMax + some constant (2 at the time
@@ -849,6 +881,10 @@ void CreateGame(const fs::path &filename, CMap *map)
 					Players, [](const CPlayer &p) { return p.Type == PlayerTypes::PlayerNobody; });
 			    it != std::end(Players)) {
 				ThisPlayer = &*it;
+			} else if (Parameters::Instance.headless) {
+				// No slot to watch the game from, triggers testing
+				// GetThisPlayer() see a player without units.
+				ThisPlayer = &Players[PlayerNumNeutral];
 			}
 		} else {
 			// this is bad - we are starting a network game, but ThisPlayer is not assigned!!
@@ -952,36 +988,50 @@ void CreateGame(const fs::path &filename, CMap *map)
 		}
 	}
 
+	const bool headless = Parameters::Instance.headless;
+
 	//
 	// Graphic part
 	//
-	SetPlayersPalette();
-	LoadIcons();
+	if (!headless) {
+		SetPlayersPalette();
+		LoadIcons();
 
-	LoadCursors(PlayerRaces.Name[ThisPlayer->Race]);
+		LoadCursors(PlayerRaces.Name[ThisPlayer->Race]);
+	}
 	UnitUnderCursor = nullptr;
 
 	InitMissileTypes();
 #ifndef DYNAMIC_LOAD
-	LoadMissileSprites();
+	if (!headless) {
+		LoadMissileSprites();
+	}
 #endif
 	InitConstructions();
-	LoadConstructions();
+	if (!headless) {
+		LoadConstructions();
+	}
 	LoadUnitTypes();
-	LoadDecorations();
+	if (!headless) {
+		LoadDecorations();
 
-	InitUserInterface();
-	UI.Load();
+		InitUserInterface();
+		UI.Load();
+	}
 
 	Map.Init();
-	UI.Minimap.Create();
+	if (!headless) {
+		UI.Minimap.Create();
+	}
 	PreprocessMap();
 
 	//
 	// Sound part
 	//
-	LoadUnitSounds();
-	MapUnitSounds();
+	if (!headless) {
+		LoadUnitSounds();
+		MapUnitSounds();
+	}
 	if (SoundEnabled()) {
 		InitSoundClient();
 	}
@@ -1024,7 +1074,9 @@ void CreateGame(const fs::path &filename, CMap *map)
 		UI.SelectedViewport = UI.Viewports;
 	}
 #endif
-	UI.SelectedViewport->Center(Map.TilePosToMapPixelPos_Center(ThisPlayer->StartPos));
+	if (!headless) {
+		UI.SelectedViewport->Center(Map.TilePosToMapPixelPos_Center(ThisPlayer->StartPos));
+	}
 
 	//
 	// Various hacks which must be done after the map is loaded.
@@ -1044,7 +1096,9 @@ void CreateGame(const fs::path &filename, CMap *map)
 	GameResult = GameNoResult;
 
 	CommandLog(nullptr, nullptr, EFlushMode::On, -1, -1, nullptr, nullptr, -1);
-	Video.ClearScreen();
+	if (!headless) {
+		Video.ClearScreen();
+	}
 }
 
 /**
@@ -1081,7 +1135,9 @@ void CleanGame()
 	EndReplayLog();
 	CleanMessages();
 
-	RestoreColorCyclingSurface();
+	if (!Parameters::Instance.headless) {
+		RestoreColorCyclingSurface();
+	}
 	CleanGame_Lua();
 	CleanTriggers();
 	CleanAi();
@@ -45,6 +45,8 @@
 #include "network.h"
 #include "parameters.h"
 #include "player.h"
+#include "replay_keyframe.h"
+#include "replay_log.h"
 #include "script.h"
 #include "settings.h"
 #include "sound.h"
@@ -52,6 +54,7 @@
 #include "unit.h"
 #include "unit_manager.h"
 #include "unittype.h"
+#include "util.h"
 #include "version.h"
 
 #include <ctime>
@@ -59,54 +62,8 @@
 
 extern fs::path ExpandPath(const std::string &path);
 extern void StartMap(const std::string &filename, bool clean);
-
-//----------------------------------------------------------------------------
-// Structures
-//----------------------------------------------------------------------------
-
-/**
-**  LogEntry structure.
-*/
-class LogEntry
-{
-public:
-	LogEntry() = default;
-
-	unsigned long GameCycle = 0;
-	int UnitNumber = 0;
-	std::string UnitIdent;
-	std::string Action;
-	EFlushMode Flush = EFlushMode::Off;
-	Vec2i Pos{0, 0};
-	int DestUnitNumber = 0;
-	std::string Value;
-	int Num = 0;
-	unsigned SyncRandSeed = 0;
-};
-
-/**
-** Full replay structure (definition + logs)
-*/
-class FullReplay
-{
-public:
-	FullReplay() { ReplaySettings.Init(); }
-	std::string Comment1;
-	std::string Comment2;
-	std::string Comment3;
-	std::string Date;
-	std::string Map;
-	std::string MapPath;
-	unsigned MapId = 0;
-
-	int LocalPlayer = 0;
-	std::string PlayerNames[PlayerMax];
-
-	Settings ReplaySettings;
-	int Engine[3]{};
-	int Network[3]{};
-	std::vector<LogEntry> Commands;
-};
+extern void CreateGame(const fs::path &filename, CMap *map);
+extern void CleanGame();
 
 //----------------------------------------------------------------------------
 // Constants
@@ -120,12 +77,14 @@ class FullReplay
 bool CommandLogDisabled;           /// True if command log is off
 EReplayType ReplayGameType;        /// Replay game type
 static bool DisabledLog;           /// Disabled log for replay
-static std::unique_ptr<CFile> LogFile; /// Replay log file
+static std::unique_ptr<CBinaryReplayWriter> LogFile; /// Replay log file
 static fs::path LastLogFileName;   /// Last log file name
 static unsigned long NextLogCycle; /// Next log cycle number
 static bool InitReplay;             /// Initialize replay
 static std::unique_ptr<FullReplay> CurrentReplay;
 static std::optional<std::size_t> ReplayIndex;
+static CReplayKeyframes ReplayKeyframes;              /// Keyframes of the recorded or replayed game
+static std::optional<unsigned long> PendingSeekCycle; /// Cycle of a seek waiting for its keyframe
 
 static void WarnLegacyReplayField(std::string_view field)
 {
@@ -257,40 +216,41 @@ static void PrintLogCommand(const LogEntry &log, CFile &file)
 /**
 **  Output the FullReplay list to file
 **
-**  @param file  The file to output to
+**  @param replay  The replay to output
+**  @param file    The file to output to
 */
-static void SaveFullLog(CFile &file)
+static void SaveFullLog(const FullReplay &replay, CFile &file)
 {
 	file.printf("\n--- -----------------------------------------\n");
 	file.printf("--- MODULE: replay list\n");
 
 	file.printf("\n");
 	file.printf("ReplayLog( {\n");
-	file.printf("  Comment1 = \"%s\",\n", CurrentReplay->Comment1.c_str());
-	file.printf("  Comment2 = \"%s\",\n", CurrentReplay->Comment2.c_str());
-	file.printf("  Date = \"%s\",\n", CurrentReplay->Date.c_str());
-	file.printf("  Map = \"%s\",\n", CurrentReplay->Map.c_str());
-	file.printf("  MapPath = \"%s\",\n", CurrentReplay->MapPath.c_str());
-	file.printf("  MapId = %u,\n", CurrentReplay->MapId);
-	file.printf("  LocalPlayer = %d,\n", CurrentReplay->LocalPlayer);
+	file.printf("  Comment1 = \"%s\",\n", replay.Comment1.c_str());
+	file.printf("  Comment2 = \"%s\",\n", replay.Comment2.c_str());
+	file.printf("  Date = \"%s\",\n", replay.Date.c_str());
+	file.printf("  Map = \"%s\",\n", replay.Map.c_str());
+	file.printf("  MapPath = \"%s\",\n", replay.MapPath.c_str());
+	file.printf("  MapId = %u,\n", replay.MapId);
+	file.printf("  LocalPlayer = %d,\n", replay.LocalPlayer);
 	file.printf("  Players = {\n");
 	for (int i = 0; i < PlayerMax; ++i) {
-		file.printf("\t{ Name = \"%s\", ", CurrentReplay->PlayerNames[i].c_str());
-		CurrentReplay->ReplaySettings.Presets[i].Save([&] (std::string field) {
+		file.printf("\t{ Name = \"%s\", ", replay.PlayerNames[i].c_str());
+		replay.ReplaySettings.Presets[i].Save([&] (std::string field) {
 			file.printf("%s, ", field.c_str());
 		});
 		file.printf("}%s", i != PlayerMax - 1 ? ",\n" : "\n");
 	}
 	file.printf("  },\n");
-	CurrentReplay->ReplaySettings.Save([&] (std::string field) {
+	replay.ReplaySettings.Save([&] (std::string field) {
 		file.printf("  %s,\n", field.c_str());
 	}, false);
 	file.printf("  Engine = { %d, %d, %d },\n",
-				CurrentReplay->Engine[0], CurrentReplay->Engine[1], CurrentReplay->Engine[2]);
+				replay.Engine[0], replay.Engine[1], replay.Engine[2]);
 	file.printf("  Network = { %d, %d, %d }\n",
-				CurrentReplay->Network[0], CurrentReplay->Network[1], CurrentReplay->Network[2]);
+				replay.Network[0], replay.Network[1], replay.Network[2]);
 	file.printf("} )\n");
-	for (const auto &command : CurrentReplay->Commands) {
+	for (const auto &command : replay.Commands) {
 		PrintLogCommand(command, file);
 	}
 }
@@ -298,13 +258,12 @@ static void SaveFullLog(CFile &file)
 /**
 **  Append the LogEntry structure at the end of currentLog, and to LogFile
 **
-**  @param log   Pointer the replay log entry to be added
-**  @param dest  The file to output to
+**  @param log     Pointer the replay log entry to be added
+**  @param writer  The replay writer to output to
 */
-static void AppendLog(LogEntry&& log, CFile &file)
+static void AppendLog(LogEntry&& log, CBinaryReplayWriter &writer)
 {
-	PrintLogCommand(log, file);
-	file.flush();
+	writer.Append(log);
 
 	CurrentReplay->Commands.push_back(std::move(log));
 }
@@ -354,23 +313,18 @@ void CommandLog(const char *action,
 		path /= "log_of_stratagus_" + std::to_string(ThisPlayer->Index) + "_"
 		      + std::to_string((intmax_t) now) + ".log";
 
-		LogFile = std::make_unique<CFile>();
-		if (LogFile->open(path.string().c_str(), CL_OPEN_WRITE) == -1) {
+		if (!CurrentReplay) {
+			CurrentReplay = StartReplay();
+		}
+		LogFile = std::make_unique<CBinaryReplayWriter>();
+		if (!LogFile->Open(path, *CurrentReplay)) {
 			// don't retry for each command
 			CommandLogDisabled = false;
 			LogFile = nullptr;
 			return;
 		}
 		LastLogFileName = path;
-		if (CurrentReplay) {
-			SaveFullLog(*LogFile);
-		}
-	}
-
-	if (!CurrentReplay) {
-		CurrentReplay = StartReplay();
-
-		SaveFullLog(*LogFile);
+		ReplayKeyframes.Open(path, ReplayHeaderDigest(*CurrentReplay));
 	}
 
 	if (!action) {
@@ -600,7 +554,7 @@ bool IsReplayGame()
 */
 void SaveReplayList(CFile &file)
 {
-	SaveFullLog(file);
+	SaveFullLog(*CurrentReplay, file);
 }
 
 /**
@@ -613,7 +567,20 @@ static void LoadReplay(const fs::path &name)
 	CleanReplayLog();
 	ReplayGameType = EReplayType::SinglePlayer;
 	GameCycle = 0;
-	LuaLoadFile(name);
+	if (IsBinaryReplayFile(name)) {
+		CurrentReplay = LoadBinaryReplay(name);
+		if (!CurrentReplay) {
+			ErrorPrint("Can't load the replay '%s'\n", name.u8string().c_str());
+			// FIXME: need to handle errors better
+			Exit(1);
+		}
+		ApplyReplaySettings();
+	} else {
+		LuaLoadFile(name);
+	}
+	if (CurrentReplay) {
+		ReplayKeyframes.Open(name, ReplayHeaderDigest(*CurrentReplay));
+	}
 
 	NextLogCycle = ~0UL;
 	if (!CommandLogDisabled) {
@@ -630,7 +597,7 @@ static void LoadReplay(const fs::path &name)
 void EndReplayLog()
 {
 	if (LogFile) {
-		LogFile->close();
+		LogFile->Close();
 		LogFile = nullptr;
 	}
 	CurrentReplay = nullptr;
@@ -646,6 +613,8 @@ void CleanReplayLog()
 	CurrentReplay = nullptr;
 
 	ReplayIndex = std::nullopt;
+	ReplayKeyframes.Clear();
+	PendingSeekCycle = std::nullopt;
 
 	// if (DisabledLog) {
 	CommandLogDisabled = false;
@@ -850,6 +819,139 @@ void MultiPlayerReplayEachCycle()
 	}
 }
 
+/**
+**  Take a keyframe of the recorded or replayed game, when one is due.
+**
+**  Keyframes are taken at the end of a cycle, every
+**  Preference.ReplayKeyframeMinutes minutes of game time. Network games
+**  don't take them while they are played: every player would wait for
+**  the one writing its keyframe.
+*/
+void ReplayKeyframeEachCycle()
+{
+	if (!CurrentReplay || ReplayKeyframes.GetDirectory().empty() || Preference.ReplayKeyframeMinutes <= 0
+	    || IsNetworkGame() || Parameters::Instance.headless) {
+		return;
+	}
+	if (GameCycle % (CYCLES_PER_SECOND * 60 * Preference.ReplayKeyframeMinutes) != 0
+	    || ReplayKeyframes.Has(GameCycle)) {
+		return;
+	}
+	std::error_code ec;
+	fs::create_directories(ReplayKeyframes.GetDirectory(), ec);
+	if (ec) {
+		ErrorPrint("Can't create '%s': %s\n",
+		           ReplayKeyframes.GetDirectory().u8string().c_str(),
+		           ec.message().c_str());
+		return;
+	}
+	if (SaveGameFile(ReplayKeyframes.GetFile(GameCycle)) == 0) {
+		ReplayKeyframes.Add(GameCycle);
+	}
+}
+
+/**
+**  Seek to a cycle of the replay being played.
+**
+**  Going back, or going forward past a keyframe, stops the game loop
+**  so that it restores the last keyframe before the cycle (see
+**  RestoreReplayKeyframe). The cycles after it are fast forwarded,
+**  without drawing them.
+**
+**  @param cycle  Cycle to seek to.
+**
+**  @return       false if not replaying, or if no keyframe is before the cycle to go back to.
+*/
+bool ReplaySeek(unsigned long cycle)
+{
+	if (!IsReplayGame() || !CurrentReplay) {
+		return false;
+	}
+	const CReplayKeyframes::Keyframe *keyframe = ReplayKeyframes.Find(cycle);
+
+	if (cycle < GameCycle && keyframe == nullptr) {
+		return false;
+	}
+	if (keyframe && (cycle < GameCycle || keyframe->GameCycle > GameCycle)) {
+		PendingSeekCycle = cycle;
+		GameRunning = false;
+	}
+	FastForwardCycle = cycle;
+	GamePaused = false;
+	return true;
+}
+
+/**
+**  Check if a seek waits for the game loop to restore its keyframe.
+*/
+bool IsReplaySeekPending()
+{
+	return PendingSeekCycle.has_value();
+}
+
+/**
+**  Restore the keyframe a seek waits for, out of the game loop.
+**
+**  The whole game is reloaded from the keyframe. The replay itself is
+**  kept: the keyframe only holds its commands up to the keyframe cycle.
+*/
+void RestoreReplayKeyframe()
+{
+	Assert(PendingSeekCycle && CurrentReplay);
+	const unsigned long cycle = *PendingSeekCycle;
+	const CReplayKeyframes::Keyframe keyframe = *ReplayKeyframes.Find(cycle);
+
+	std::unique_ptr<FullReplay> replay = std::move(CurrentReplay);
+	CReplayKeyframes keyframes = std::move(ReplayKeyframes);
+	const EReplayType replayType = ReplayGameType;
+	const int netPlayers = NetPlayers;
+	const bool disabledLog = DisabledLog;
+
+	CleanGame();
+	CleanPlayers();
+	LoadGame(keyframe.File);
+
+	CurrentReplay = std::move(replay);
+	ReplayKeyframes = std::move(keyframes);
+	ReplayGameType = replayType;
+	NetPlayers = netPlayers;
+	CommandLogDisabled = true;
+	DisabledLog = disabledLog;
+	GameObserve = true;
+	CreateGame(keyframe.File, &Map);
+
+	InitReplay = false;
+	ReplayIndex = ReplayResumeIndex(CurrentReplay->Commands, ReplayGameType, GameCycle);
+	NextLogCycle = ReplayIndex ? CurrentReplay->Commands[*ReplayIndex].GameCycle : ~0UL;
+	FastForwardCycle = cycle;
+	PendingSeekCycle = std::nullopt;
+}
+
+/**
+**  Index of the first command of a replay to run after a keyframe.
+**
+**  Multiplayer replays run the commands of a cycle once it is counted,
+**  single player ones before: a keyframe taken at the end of a cycle
+**  has run the commands of this cycle in the former only.
+**
+**  @param commands  Commands of the replay, sorted by cycle.
+**  @param type      Type of the replay.
+**  @param cycle     Cycle at the end of which the keyframe was taken.
+**
+**  @return          Index of the next command, none if all of them were run.
+*/
+std::optional<std::size_t> ReplayResumeIndex(const std::vector<LogEntry> &commands,
+                                             EReplayType type, unsigned long cycle)
+{
+	const auto next = type == EReplayType::MultiPlayer
+		? ranges::upper_bound(commands.begin(), commands.end(), cycle, std::less<>{}, &LogEntry::GameCycle)
+		: ranges::lower_bound(commands.begin(), commands.end(), cycle, std::less<>{}, &LogEntry::GameCycle);
+	if (next == commands.end()) {
+		return std::nullopt;
+	}
+	return next - commands.begin();
+}
+
 /**
 **  Save the replay
 **
@@ -865,11 +967,58 @@ int SaveReplay(const std::string &filename)
 	}
 	const auto destination = Parameters::Instance.GetUserDirectory() / GameName / "logs" / filename;
 
+	if (LogFile) {
+		LogFile->Flush();
+	}
 	if (!fs::copy_file(LastLogFileName, destination, fs::copy_options::overwrite_existing)) {
 		ErrorPrint("Can't save to '%s'\n", destination.u8string().c_str());
 		return -1;
 	}
+	// The keyframes go with their log, the ones of the overwritten log go away.
+	const fs::path keyframes = CReplayKeyframes::DirectoryOf(destination);
+	std::error_code ec;
+	fs::remove_all(keyframes, ec);
+	if (fs::is_directory(CReplayKeyframes::DirectoryOf(LastLogFileName), ec)) {
+		fs::copy(CReplayKeyframes::DirectoryOf(LastLogFileName), keyframes, fs::copy_options::recursive, ec);
+		if (ec) {
+			ErrorPrint("Can't save the keyframes to '%s': %s\n",
+			           keyframes.u8string().c_str(),
+			           ec.message().c_str());
+		}
+	}
+
+	return 0;
+}
 
+/**
+**  Export a binary replay as a text replay, which is a Lua script
+**
+**  @param filename      Name of the binary replay
+**  @param textFilename  Name of the file to export to
+**
+**  @return              0 for success, -1 for failure
+*/
+int ExportReplay(const std::string &filename, const std::string &textFilename)
+{
+	if (filename.find_first_of("\\/") != std::string::npos
+	    || textFilename.find_first_of("\\/") != std::string::npos) {
+		ErrorPrint("\\ or / not allowed in ExportReplay filenames\n");
+		return -1;
+	}
+	const auto logs = Parameters::Instance.GetUserDirectory() / GameName / "logs";
+
+	const std::unique_ptr<FullReplay> replay = LoadBinaryReplay(logs / filename);
+	if (!replay) {
+		ErrorPrint("'%s' isn't a binary replay\n", filename.c_str());
+		return -1;
+	}
+	CFile file;
+	if (file.open((logs / textFilename).string().c_str(), CL_OPEN_WRITE) == -1) {
+		ErrorPrint("Can't save to '%s'\n", textFilename.c_str());
+		return -1;
+	}
+	SaveFullLog(*replay, file);
+	file.close();
 	return 0;
 }
 
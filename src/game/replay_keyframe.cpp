@@ -0,0 +1,191 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+/**@name replay_keyframe.cpp - Replay keyframes. */
+//
+//      (c) Copyright 2026 by the Stratagus Developers
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+//@{
+
+//@{
+
+//----------------------------------------------------------------------------
+// Includes
+//----------------------------------------------------------------------------
+
+#include "stratagus.h"
+
+#include "replay_keyframe.h"
+
+#include "util.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <string>
+#include <system_error>
+
+//----------------------------------------------------------------------------
+// Constants
+//----------------------------------------------------------------------------
+
+static constexpr std::string_view KeyframePrefix = "keyframe_";
+static constexpr std::string_view KeyframeSuffix = ".sav";
+
+//----------------------------------------------------------------------------
+// Functions
+//----------------------------------------------------------------------------
+
+/**
+**  Use the keyframe directory of a replay log, and find the keyframes
+**  already written in it for this log.
+**
+**  The keyframes of another log, which was written at the same place
+**  before, are removed.
+**
+**  @param logFile    Replay log file.
+**  @param logDigest  Header digest of the replay log.
+*/
+void CReplayKeyframes::Open(const fs::path &logFile, uint32_t logDigest)
+{
+	Clear();
+	Directory = DirectoryOf(logFile);
+	LogDigest = logDigest;
+
+	std::vector<fs::path> staleFiles;
+	std::error_code ec;
+	for (auto it = fs::directory_iterator{Directory, ec}; !ec && it != fs::directory_iterator{};
+	     it.increment(ec)) {
+		if (const auto keyframe = ParseFile(it->path())) {
+			if (keyframe->first == LogDigest) {
+				Keyframes.push_back({keyframe->second, GetFile(keyframe->second)});
+			} else {
+				staleFiles.push_back(it->path());
+			}
+		}
+	}
+	for (const fs::path &file : staleFiles) {
+		fs::remove(file, ec);
+	}
+	ranges::sort(Keyframes, std::less<>{}, &Keyframe::GameCycle);
+	Keyframes.erase(std::unique(Keyframes.begin(),
+	                            Keyframes.end(),
+	                            [](const Keyframe &lhs, const Keyframe &rhs) {
+		                            return lhs.GameCycle == rhs.GameCycle;
+	                            }),
+	                Keyframes.end());
+}
+
+/**
+**  Forget the keyframes. Their files are kept for the next replay.
+*/
+void CReplayKeyframes::Clear()
+{
+	Directory.clear();
+	LogDigest = 0;
+	Keyframes.clear();
+}
+
+/**
+**  File of the keyframe of a cycle.
+**
+**  The savegame writer may append a compression extension to it,
+**  the savegame loader finds it back.
+*/
+fs::path CReplayKeyframes::GetFile(unsigned long cycle) const
+{
+	char digest[16];
+	snprintf(digest, sizeof(digest), "%08x_", LogDigest);
+	return Directory
+	     / (std::string(KeyframePrefix) + digest + std::to_string(cycle) + std::string(KeyframeSuffix));
+}
+
+/**
+**  Keyframe directory of a replay log: "<log>.keyframes" next to it.
+*/
+fs::path CReplayKeyframes::DirectoryOf(const fs::path &logFile)
+{
+	return fs::path(logFile).replace_extension(".keyframes");
+}
+
+bool CReplayKeyframes::Has(unsigned long cycle) const
+{
+	const auto it = ranges::lower_bound(Keyframes.begin(), Keyframes.end(), cycle, std::less<>{}, &Keyframe::GameCycle);
+	return it != Keyframes.end() && it->GameCycle == cycle;
+}
+
+/**
+**  Record the keyframe of a cycle, once its file is written.
+*/
+void CReplayKeyframes::Add(unsigned long cycle)
+{
+	const auto it = ranges::lower_bound(Keyframes.begin(), Keyframes.end(), cycle, std::less<>{}, &Keyframe::GameCycle);
+	if (it != Keyframes.end() && it->GameCycle == cycle) {
+		return;
+	}
+	Keyframes.insert(it, {cycle, GetFile(cycle)});
+}
+
+/**
+**  Last keyframe taken at or before a cycle.
+**
+**  @return  The keyframe, or null if all of them are after the cycle.
+*/
+const CReplayKeyframes::Keyframe *CReplayKeyframes::Find(unsigned long cycle) const
+{
+	const auto it = ranges::upper_bound(Keyframes.begin(), Keyframes.end(), cycle, std::less<>{}, &Keyframe::GameCycle);
+	return it == Keyframes.begin() ? nullptr : &*std::prev(it);
+}
+
+/**
+**  Log digest and cycle of a keyframe file, as named by GetFile.
+**
+**  @return  The header digest of its log and its cycle, or none if the file isn't a keyframe.
+*/
+std::optional<std::pair<uint32_t, unsigned long>> CReplayKeyframes::ParseFile(const fs::path &file)
+{
+	std::string name = file.filename().string();
+
+	if (name.size() > 3 && name.compare(name.size() - 3, 3, ".gz") == 0) {
+		name.resize(name.size() - 3);
+	}
+	if (!starts_with(name, KeyframePrefix) || name.size() <= KeyframePrefix.size() + KeyframeSuffix.size()
+	    || name.compare(name.size() - KeyframeSuffix.size(), KeyframeSuffix.size(), KeyframeSuffix) != 0) {
+		return std::nullopt;
+	}
+	const std::string stem =
+		name.substr(KeyframePrefix.size(), name.size() - KeyframePrefix.size() - KeyframeSuffix.size());
+	if (stem.size() < 10 || stem.size() > 18 || stem[8] != '_') {
+		return std::nullopt;
+	}
+	const std::string digest = stem.substr(0, 8);
+	const std::string digits = stem.substr(9);
+	if (!ranges::all_of(digest, [](unsigned char c) { return std::isxdigit(c) != 0; })
+	    || !ranges::all_of(digits, [](unsigned char c) { return std::isdigit(c) != 0; })) {
+		return std::nullopt;
+	}
+	return std::pair{static_cast<uint32_t>(std::stoul(digest, nullptr, 16)), std::stoul(digits)};
+}
+
+//@}
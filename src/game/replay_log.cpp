@@ -0,0 +1,648 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+/**@name replay_log.cpp - Binary replay format. */
+//
+//      (c) Copyright 2026 by the Stratagus Developers
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+//@{
+
+//@{
+
+//----------------------------------------------------------------------------
+// Includes
+//----------------------------------------------------------------------------
+
+#include "stratagus.h"
+
+#include "replay_log.h"
+
+#include "sync_digest.h"
+
+#ifdef USE_ZLIB
+#include <zlib.h>
+#endif
+
+#include <algorithm>
+#include <iterator>
+#include <optional>
+
+//----------------------------------------------------------------------------
+// Constants
+//----------------------------------------------------------------------------
+
+/// Commands of a block, which is written once full
+static constexpr std::size_t BlockCommands = 256;
+/// Cycles spanned by a block, which is written once it spans more
+static constexpr unsigned long BlockCycles = CYCLES_PER_SECOND * 60;
+/// Largest chunk accepted when reading
+static constexpr uint64_t MaxChunkSize = 64 * 1024 * 1024;
+
+enum class EChunkCompression : uint8_t {
+	Stored = 0,
+	Zlib = 1
+};
+
+//----------------------------------------------------------------------------
+// Encoding
+//----------------------------------------------------------------------------
+
+static void PutVarint(std::string &out, uint64_t value)
+{
+	while (value >= 0x80) {
+		out += static_cast<char>((value & 0x7F) | 0x80);
+		value >>= 7;
+	}
+	out += static_cast<char>(value);
+}
+
+static void PutSigned(std::string &out, int64_t value)
+{
+	PutVarint(out, (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+}
+
+static void PutString(std::string &out, std::string_view str)
+{
+	PutVarint(out, str.size());
+	out += str;
+}
+
+/**
+**  Make a chunk, compressed when it is worth it.
+*/
+static std::string MakeChunk(EReplayChunk kind, const std::string &raw)
+{
+	std::string chunk(1, static_cast<char>(kind));
+	PutVarint(chunk, raw.size());
+#ifdef USE_ZLIB
+	uLongf size = compressBound(raw.size());
+	std::string compressed(size, '\0');
+	if (compress(reinterpret_cast<Bytef *>(compressed.data()),
+	             &size,
+	             reinterpret_cast<const Bytef *>(raw.data()),
+	             raw.size()) == Z_OK
+	    && size < raw.size()) {
+		PutVarint(chunk, size);
+		chunk += static_cast<char>(EChunkCompression::Zlib);
+		chunk.append(compressed.data(), size);
+		return chunk;
+	}
+#endif
+	PutVarint(chunk, raw.size());
+	chunk += static_cast<char>(EChunkCompression::Stored);
+	chunk += raw;
+	return chunk;
+}
+
+/**
+**  Encode the start of a binary replay: its magic, its version and its header.
+**
+**  The string table and the cycles start over, for a new file.
+*/
+std::string CBinaryReplayEncoder::EncodeHeader(const FullReplay &replay)
+{
+	std::string raw;
+
+	for (const std::string *str : {&replay.Comment1, &replay.Comment2, &replay.Comment3,
+	                               &replay.Date, &replay.Map, &replay.MapPath}) {
+		PutString(raw, *str);
+	}
+	PutVarint(raw, replay.MapId);
+	PutSigned(raw, replay.LocalPlayer);
+	for (int version : replay.Engine) {
+		PutSigned(raw, version);
+	}
+	for (int version : replay.Network) {
+		PutSigned(raw, version);
+	}
+
+	const Settings &settings = replay.ReplaySettings;
+	PutSigned(raw, static_cast<int>(settings.NetGameType));
+	PutSigned(raw, settings.Resources);
+	PutSigned(raw, settings.NumUnits);
+	PutSigned(raw, settings.Opponents);
+	PutSigned(raw, settings.Difficulty);
+	PutSigned(raw, static_cast<int>(settings.GameType));
+	PutSigned(raw, static_cast<int>(settings.FoV));
+	PutSigned(raw, static_cast<int>(settings.RevealMap));
+	PutSigned(raw, static_cast<int>(settings.DefeatReveal));
+	PutVarint(raw, settings.getBitfield());
+	PutVarint(raw, PlayerMax);
+	for (int i = 0; i < PlayerMax; ++i) {
+		const SettingsPresets &preset = settings.Presets[i];
+		PutString(raw, replay.PlayerNames[i]);
+		PutSigned(raw, preset.PlayerColor);
+		PutString(raw, preset.AIScript);
+		PutSigned(raw, preset.Race);
+		PutSigned(raw, preset.Team);
+		PutSigned(raw, static_cast<int>(preset.Type));
+	}
+
+	Strings.clear();
+	LastCycle = 0;
+
+	std::string res(BinaryReplayMagic);
+	res += static_cast<char>(BinaryReplayVersion);
+	return res + MakeChunk(EReplayChunk::Header, raw);
+}
+
+/**
+**  Index of a string in the table, adding it to the new strings of the block.
+*/
+uint32_t CBinaryReplayEncoder::Intern(const std::string &str, std::string &newStrings, uint32_t &newCount)
+{
+	if (str.empty()) {
+		return 0;
+	}
+	const auto [it, inserted] = Strings.try_emplace(str, static_cast<uint32_t>(Strings.size() + 1));
+	if (inserted) {
+		PutString(newStrings, str);
+		++newCount;
+	}
+	return it->second;
+}
+
+/**
+**  Encode a block of commands, which follow the ones encoded before.
+*/
+std::string CBinaryReplayEncoder::EncodeCommands(const LogEntry *begin, const LogEntry *end)
+{
+	std::string newStrings;
+	uint32_t newCount = 0;
+	std::string commands;
+
+	PutVarint(commands, end - begin);
+	for (const LogEntry *log = begin; log != end; ++log) {
+		PutSigned(commands, static_cast<int64_t>(log->GameCycle) - static_cast<int64_t>(LastCycle));
+		LastCycle = log->GameCycle;
+		PutSigned(commands, log->UnitNumber);
+		PutVarint(commands, Intern(log->UnitIdent, newStrings, newCount));
+		PutVarint(commands, Intern(log->Action, newStrings, newCount));
+		commands += static_cast<char>(log->Flush);
+		PutSigned(commands, log->Pos.x);
+		PutSigned(commands, log->Pos.y);
+		PutSigned(commands, log->DestUnitNumber);
+		PutVarint(commands, Intern(log->Value, newStrings, newCount));
+		PutSigned(commands, log->Num);
+		PutVarint(commands, log->SyncRandSeed);
+	}
+
+	std::string raw;
+	PutVarint(raw, newCount);
+	raw += newStrings;
+	raw += commands;
+	return MakeChunk(EReplayChunk::Commands, raw);
+}
+
+//----------------------------------------------------------------------------
+// Decoding
+//----------------------------------------------------------------------------
+
+namespace
+{
+
+/// Read the values of a binary replay, failing at the first invalid one
+class CReplayReader
+{
+public:
+	explicit CReplayReader(std::string_view data) : Data(data) {}
+
+	bool AtEnd() const { return Pos == Data.size(); }
+	bool HasFailed() const { return Failed; }
+	void Fail() { Failed = true; }
+
+	uint8_t Byte()
+	{
+		if (Pos == Data.size()) {
+			Failed = true;
+			return 0;
+		}
+		return static_cast<uint8_t>(Data[Pos++]);
+	}
+
+	uint64_t Varint()
+	{
+		uint64_t value = 0;
+		for (int shift = 0; shift < 64; shift += 7) {
+			const uint8_t byte = Byte();
+			value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+			if (!(byte & 0x80)) {
+				return value;
+			}
+		}
+		Failed = true;
+		return 0;
+	}
+
+	int64_t Signed()
+	{
+		const uint64_t value = Varint();
+		return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+	}
+
+	std::string_view Bytes(uint64_t size)
+	{
+		if (size > Data.size() - Pos) {
+			Failed = true;
+			Pos = Data.size();
+			return {};
+		}
+		const std::string_view res = Data.substr(Pos, size);
+		Pos += size;
+		return res;
+	}
+
+	std::string String() { return std::string(Bytes(Varint())); }
+
+private:
+	std::string_view Data;
+	std::size_t Pos = 0;
+	bool Failed = false;
+};
+
+} // namespace
+
+/**
+**  Read the next chunk and uncompress it.
+**
+**  @return  The kind and the data of the chunk, none if it is truncated or invalid.
+*/
+static std::optional<std::pair<EReplayChunk, std::string>> ReadChunk(CReplayReader &reader)
+{
+	const auto kind = static_cast<EReplayChunk>(reader.Byte());
+	const uint64_t rawSize = reader.Varint();
+	const uint64_t storedSize = reader.Varint();
+	const auto compression = static_cast<EChunkCompression>(reader.Byte());
+	const std::string_view stored = reader.Bytes(storedSize);
+
+	if (reader.HasFailed() || rawSize > MaxChunkSize) {
+		return std::nullopt;
+	}
+	switch (compression) {
+		case EChunkCompression::Stored:
+			if (storedSize != rawSize) {
+				return std::nullopt;
+			}
+			return std::pair{kind, std::string(stored)};
+#ifdef USE_ZLIB
+		case EChunkCompression::Zlib: {
+			std::string raw(rawSize, '\0');
+			uLongf size = rawSize;
+			if (uncompress(reinterpret_cast<Bytef *>(raw.data()),
+			               &size,
+			               reinterpret_cast<const Bytef *>(stored.data()),
+			               stored.size()) != Z_OK
+			    || size != rawSize) {
+				return std::nullopt;
+			}
+			return std::pair{kind, std::move(raw)};
+		}
+#endif
+		default:
+			return std::nullopt;
+	}
+}
+
+static void DecodeHeader(CReplayReader &reader, FullReplay &replay)
+{
+	for (std::string *str : {&replay.Comment1, &replay.Comment2, &replay.Comment3,
+	                         &replay.Date, &replay.Map, &replay.MapPath}) {
+		*str = reader.String();
+	}
+	replay.MapId = reader.Varint();
+	replay.LocalPlayer = reader.Signed();
+	for (int &version : replay.Engine) {
+		version = reader.Signed();
+	}
+	for (int &version : replay.Network) {
+		version = reader.Signed();
+	}
+
+	Settings &settings = replay.ReplaySettings;
+	settings.NetGameType = static_cast<NetGameTypes>(reader.Signed());
+	settings.Resources = reader.Signed();
+	settings.NumUnits = reader.Signed();
+	settings.Opponents = reader.Signed();
+	settings.Difficulty = reader.Signed();
+	settings.GameType = static_cast<GameTypes>(reader.Signed());
+	settings.FoV = static_cast<FieldOfViewTypes>(reader.Signed());
+	settings.RevealMap = static_cast<MapRevealModes>(reader.Signed());
+	settings.DefeatReveal = static_cast<RevealTypes>(reader.Signed());
+	settings.setBitfield(reader.Varint());
+	const uint64_t players = reader.Varint();
+	for (uint64_t i = 0; i < players && !reader.HasFailed(); ++i) {
+		std::string name = reader.String();
+		SettingsPresets preset;
+		preset.PlayerColor = reader.Signed();
+		preset.AIScript = reader.String();
+		preset.Race = reader.Signed();
+		preset.Team = reader.Signed();
+		preset.Type = static_cast<PlayerTypes>(reader.Signed());
+		if (i < PlayerMax) {
+			replay.PlayerNames[i] = std::move(name);
+			settings.Presets[i] = std::move(preset);
+		}
+	}
+}
+
+static void DecodeCommands(CReplayReader &reader,
+                           std::vector<std::string> &strings,
+                           unsigned long &cycle,
+                           std::vector<LogEntry> &commands)
+{
+	const auto stringAt = [&](uint64_t index) -> const std::string & {
+		if (index >= strings.size()) {
+			reader.Fail();
+			return strings[0];
+		}
+		return strings[index];
+	};
+
+	for (uint64_t count = reader.Varint(); count != 0 && !reader.HasFailed(); --count) {
+		strings.push_back(reader.String());
+	}
+	for (uint64_t count = reader.Varint(); count != 0 && !reader.HasFailed(); --count) {
+		LogEntry log;
+		cycle += reader.Signed();
+		log.GameCycle = cycle;
+		log.UnitNumber = reader.Signed();
+		log.UnitIdent = stringAt(reader.Varint());
+		log.Action = stringAt(reader.Varint());
+		log.Flush = reader.Byte() ? EFlushMode::On : EFlushMode::Off;
+		log.Pos.x = reader.Signed();
+		log.Pos.y = reader.Signed();
+		log.DestUnitNumber = reader.Signed();
+		log.Value = stringAt(reader.Varint());
+		log.Num = reader.Signed();
+		log.SyncRandSeed = reader.Varint();
+		commands.push_back(std::move(log));
+	}
+}
+
+/**
+**  Check if data starts as a binary replay.
+*/
+bool IsBinaryReplay(std::string_view data)
+{
+	return data.substr(0, BinaryReplayMagic.size()) == BinaryReplayMagic;
+}
+
+/**
+**  Decode a binary replay.
+**
+**  A replay whose last chunk is truncated, as when the game crashed,
+**  is decoded up to it.
+**
+**  @return  The replay, or null if it is invalid.
+*/
+std::unique_ptr<FullReplay> DecodeBinaryReplay(std::string_view data)
+{
+	if (!IsBinaryReplay(data) || data.size() == BinaryReplayMagic.size()) {
+		return nullptr;
+	}
+	const int version = static_cast<uint8_t>(data[BinaryReplayMagic.size()]);
+	if (version != BinaryReplayVersion) {
+		ErrorPrint("Unsupported binary replay version %d\n", version);
+		return nullptr;
+	}
+
+	CReplayReader reader(data.substr(BinaryReplayMagic.size() + 1));
+	auto replay = std::make_unique<FullReplay>();
+	std::vector<std::string> strings(1);
+	unsigned long cycle = 0;
+	bool hasHeader = false;
+
+	while (!reader.AtEnd()) {
+		auto chunk = ReadChunk(reader);
+		if (!chunk) {
+			if (!hasHeader) {
+				ErrorPrint("Invalid binary replay header\n");
+				return nullptr;
+			}
+			ErrorPrint("Binary replay is truncated after %d commands\n",
+			           static_cast<int>(replay->Commands.size()));
+			break;
+		}
+		CReplayReader payload(chunk->second);
+		switch (chunk->first) {
+			case EReplayChunk::Header:
+				DecodeHeader(payload, *replay);
+				hasHeader = true;
+				break;
+			case EReplayChunk::Commands:
+				if (!hasHeader) {
+					ErrorPrint("Binary replay commands without header\n");
+					return nullptr;
+				}
+				DecodeCommands(payload, strings, cycle, replay->Commands);
+				break;
+			default: // Chunk of a later format revision
+				break;
+		}
+		if (payload.HasFailed()) {
+			ErrorPrint("Invalid binary replay chunk\n");
+			return nullptr;
+		}
+	}
+	if (!hasHeader) {
+		return nullptr;
+	}
+	return replay;
+}
+
+/**
+**  Check if a file is a binary replay.
+*/
+bool IsBinaryReplayFile(const fs::path &file)
+{
+	std::ifstream in(file, std::ios::binary);
+	std::string magic(BinaryReplayMagic.size(), '\0');
+
+	return in.read(magic.data(), magic.size()) && IsBinaryReplay(magic);
+}
+
+/**
+**  Load a binary replay file.
+**
+**  @return  The replay, or null if the file isn't a valid binary replay.
+*/
+std::unique_ptr<FullReplay> LoadBinaryReplay(const fs::path &file)
+{
+	std::ifstream in(file, std::ios::binary);
+	if (!in) {
+		ErrorPrint("Can't open file '%s'\n", file.u8string().c_str());
+		return nullptr;
+	}
+	const std::string data{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+	return DecodeBinaryReplay(data);
+}
+
+/**
+**  Digest of the header of a replay.
+**
+**  The header holds the date, the map and the players, so the digest
+**  tells a replay from the ones written before at the same place.
+*/
+uint32_t ReplayHeaderDigest(const FullReplay &replay)
+{
+	uint32_t digest = SyncDigestBasis;
+	for (unsigned char c : CBinaryReplayEncoder().EncodeHeader(replay)) {
+		digest = SyncDigestMix(digest, c);
+	}
+	return digest;
+}
+
+//----------------------------------------------------------------------------
+// Writer
+//----------------------------------------------------------------------------
+
+CBinaryReplayWriter::~CBinaryReplayWriter()
+{
+	Close();
+}
+
+/**
+**  Create the replay file, write the replay and the commands it already
+**  has, and start the writer thread.
+**
+**  @return  false if the file can't be created.
+*/
+bool CBinaryReplayWriter::Open(const fs::path &file, const FullReplay &replay)
+{
+	Close();
+	File.open(file, std::ios::binary | std::ios::trunc);
+	if (!File) {
+		return false;
+	}
+	const std::string header = Encoder.EncodeHeader(replay);
+	File.write(header.data(), header.size());
+	for (std::size_t i = 0; i < replay.Commands.size(); i += BlockCommands) {
+		const LogEntry *begin = replay.Commands.data() + i;
+		const std::string chunk =
+			Encoder.EncodeCommands(begin, begin + std::min(BlockCommands, replay.Commands.size() - i));
+		File.write(chunk.data(), chunk.size());
+	}
+	File.flush();
+
+	Closing = false;
+	Thread = std::thread(&CBinaryReplayWriter::Run, this);
+	return true;
+}
+
+/**
+**  Add a command. Its block is handed to the writer thread once full,
+**  or once it spans more than BlockCycles.
+*/
+void CBinaryReplayWriter::Append(const LogEntry &log)
+{
+	if (!Thread.joinable()) {
+		return;
+	}
+	if (!Block.empty() && log.GameCycle >= Block.front().GameCycle + BlockCycles) {
+		QueueBlock();
+	}
+	Block.push_back(log);
+	if (Block.size() >= BlockCommands) {
+		QueueBlock();
+	}
+}
+
+void CBinaryReplayWriter::QueueBlock()
+{
+	{
+		std::lock_guard<std::mutex> lock(Mutex);
+		Queue.push_back(std::move(Block));
+	}
+	Block.clear();
+	Wakeup.notify_one();
+}
+
+/**
+**  Write the commands added so far, and wait until they are.
+*/
+void CBinaryReplayWriter::Flush()
+{
+	if (!Thread.joinable()) {
+		return;
+	}
+	if (!Block.empty()) {
+		QueueBlock();
+	}
+	std::unique_lock<std::mutex> lock(Mutex);
+	Written.wait(lock, [this] { return Queue.empty() && !Busy; });
+}
+
+/**
+**  Write the last commands, stop the writer thread and close the file.
+*/
+void CBinaryReplayWriter::Close()
+{
+	if (!Thread.joinable()) {
+		return;
+	}
+	if (!Block.empty()) {
+		QueueBlock();
+	}
+	{
+		std::lock_guard<std::mutex> lock(Mutex);
+		Closing = true;
+	}
+	Wakeup.notify_one();
+	Thread.join();
+	File.close();
+}
+
+/**
+**  Writer thread: encode and write the queued blocks.
+*/
+void CBinaryReplayWriter::Run()
+{
+	std::unique_lock<std::mutex> lock(Mutex);
+
+	while (true) {
+		Wakeup.wait(lock, [this] { return Closing || !Queue.empty(); });
+		if (Queue.empty()) {
+			return;
+		}
+		const std::vector<LogEntry> block = std::move(Queue.front());
+		Queue.pop_front();
+		Busy = true;
+		lock.unlock();
+
+		const std::string chunk = Encoder.EncodeCommands(block.data(), block.data() + block.size());
+		File.write(chunk.data(), chunk.size());
+		File.flush();
+		if (!File) {
+			ErrorPrint("Can't write the replay log\n");
+		}
+
+		lock.lock();
+		Busy = false;
+		if (Queue.empty()) {
+			Written.notify_all();
+		}
+	}
+}
+
+//@}
@@ -103,13 +103,23 @@ static fs::path GetSaveDir()
 **  @note  Later we want to store in a more compact binary format.
 */
 int SaveGame(const std::string &filename)
+{
+	return SaveGameFile(GetSaveDir() / filename);
+}
+
+/**
+**  Save a game to a file out of the save directory.
+**
+**  @param fullpath  Path of the file, compressed files get an extra extension.
+**  @return  -1 if saving failed, 0 if all OK
+*/
+int SaveGameFile(const fs::path &fullpath)
 {
 	CFile file;
-	fs::path fullpath(GetSaveDir());
+	const std::string filename = fullpath.filename().string();
 
-	fullpath /= filename;
 	if (file.open(fullpath.string().c_str(), CL_WRITE_GZ | CL_OPEN_WRITE) == -1) {
-		ErrorPrint("Can't save to '%s'\n", filename.c_str());
+		ErrorPrint("Can't save to '%s'\n", fullpath.u8string().c_str());
 		return -1;
 	}
 
@@ -158,6 +168,7 @@ int SaveGame(const std::string &filename)
 	SaveUpgrades(file);
 	SavePlayers(file);
 	Map.Save(file);
+	WakeUpIdleUnits();
 	UnitManager->Save(file);
 	SaveUserInterface(file);
 	SaveAi(file);
@@ -0,0 +1,318 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+/**@name sync_digest.cpp - Simulation state digests. */
+//
+//      (c) Copyright 2026 by the Stratagus Developers
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+//@{
+
+//----------------------------------------------------------------------------
+// Includes
+//----------------------------------------------------------------------------
+
+#include "stratagus.h"
+
+#include "sync_digest.h"
+
+#include "actions.h"
+#include "map.h"
+#include "missile.h"
+#include "player.h"
+#include "unit.h"
+#include "unit_manager.h"
+#include "unittype.h"
+#include "upgrade_structs.h"
+#include "util.h"
+
+#include <algorithm>
+
+//----------------------------------------------------------------------------
+// Variables
+//----------------------------------------------------------------------------
+
+/// Number of row bands of the map, one of them is digested by each snapshot
+static constexpr std::size_t SyncMapBandCount = 16;
+
+static std::vector<uint32_t> SyncMapBandDigests; /// Last digest of each band, empty before the first snapshot
+static std::size_t SyncNextMapBand = 0;          /// Band to digest in the next snapshot
+
+//----------------------------------------------------------------------------
+// Functions
+//----------------------------------------------------------------------------
+
+/**
+**  Compute the digest of each field of a unit.
+*/
+static UnitSyncDigests UnitFieldDigests(const CUnit &unit)
+{
+	UnitSyncDigests fields;
+	fields.fill(SyncDigestBasis);
+	auto mix = [&fields](EUnitSyncField field, uint32_t value) {
+		auto &digest = fields[static_cast<std::size_t>(field)];
+		digest = SyncDigestMix(digest, value);
+	};
+
+	mix(EUnitSyncField::Position, unit.tilePos.x);
+	mix(EUnitSyncField::Position, unit.tilePos.y);
+	mix(EUnitSyncField::Position, unit.IX);
+	mix(EUnitSyncField::Position, unit.IY);
+	mix(EUnitSyncField::Position, unit.Direction);
+	mix(EUnitSyncField::Position, unit.Removed);
+
+	mix(EUnitSyncField::HitPoints, unit.Variable[HP_INDEX].Value);
+	mix(EUnitSyncField::HitPoints, unit.Variable[HP_INDEX].Max);
+
+	mix(EUnitSyncField::Orders, unit.Orders.size());
+	for (const auto &order : unit.Orders) {
+		const CUnit *goal = order->GetGoal();
+		const Vec2i goalPos = order->GetGoalPos();
+
+		mix(EUnitSyncField::Orders, static_cast<uint32_t>(order->Action));
+		mix(EUnitSyncField::Orders, goal ? UnitNumber(*goal) : ~0u);
+		mix(EUnitSyncField::Orders, goalPos.x);
+		mix(EUnitSyncField::Orders, goalPos.y);
+	}
+
+	mix(EUnitSyncField::Other, unit.Type->Slot);
+	mix(EUnitSyncField::Other, unit.Player->Index);
+	mix(EUnitSyncField::Other, unit.ResourcesHeld);
+	mix(EUnitSyncField::Other, unit.CurrentResource);
+	mix(EUnitSyncField::Other, unit.Frame);
+	mix(EUnitSyncField::Other, unit.Destroyed);
+	return fields;
+}
+
+/**
+**  Compute the digest of the players.
+*/
+static uint32_t PlayersDigest()
+{
+	uint32_t digest = SyncDigestBasis;
+
+	for (int i = 0; i < NumPlayers; ++i) {
+		const CPlayer &player = Players[i];
+
+		for (int cost = 0; cost < MaxCosts; ++cost) {
+			digest = SyncDigestMix(digest, player.Resources[cost]);
+			digest = SyncDigestMix(digest, player.StoredResources[cost]);
+		}
+		digest = SyncDigestMix(digest, player.Supply);
+		digest = SyncDigestMix(digest, player.Demand);
+		digest = SyncDigestMix(digest, player.Score);
+		for (std::size_t id = 0; id < AllUpgrades.size(); ++id) {
+			digest = SyncDigestMix(digest, player.Allow.Upgrades[id]);
+			digest = SyncDigestMix(digest, player.UpgradeTimers.Upgrades[id]);
+		}
+	}
+	return digest;
+}
+
+/**
+**  Compute the digest of the map fields of a row band.
+*/
+static uint32_t MapBandDigest(std::size_t band)
+{
+	const std::size_t rowBegin = Map.Info.MapHeight * band / SyncMapBandCount;
+	const std::size_t rowEnd = Map.Info.MapHeight * (band + 1) / SyncMapBandCount;
+	const auto begin = Map.Fields.begin() + std::min(Map.Fields.size(), rowBegin * Map.Info.MapWidth);
+	const auto end = Map.Fields.begin() + std::min(Map.Fields.size(), rowEnd * Map.Info.MapWidth);
+	uint32_t digest = SyncDigestBasis;
+
+	for (auto it = begin; it != end; ++it) {
+		const tile_flags flags = it->getFlags();
+
+		digest = SyncDigestMix(digest, static_cast<uint32_t>(flags));
+		digest = SyncDigestMix(digest, static_cast<uint32_t>(flags >> 32));
+		digest = SyncDigestMix(digest, it->Value);
+	}
+	return digest;
+}
+
+/**
+**  Compute the digest of the map fields.
+**
+**  Walking the whole map for each network update is too slow, so only one
+**  band is digested again and the others keep their last digest. All hosts
+**  take the same bands in the same cycles, a map change is seen by the
+**  SyncMapBandCount next snapshots at most.
+*/
+static uint32_t MapDigest()
+{
+	if (SyncMapBandDigests.empty()) {
+		for (std::size_t band = 0; band != SyncMapBandCount; ++band) {
+			SyncMapBandDigests.push_back(MapBandDigest(band));
+		}
+	} else {
+		SyncMapBandDigests[SyncNextMapBand] = MapBandDigest(SyncNextMapBand);
+		SyncNextMapBand = (SyncNextMapBand + 1) % SyncMapBandCount;
+	}
+	uint32_t digest = SyncDigestBasis;
+	for (uint32_t bandDigest : SyncMapBandDigests) {
+		digest = SyncDigestMix(digest, bandDigest);
+	}
+	return digest;
+}
+
+/**
+**  Compute the digests of the current game state.
+**
+**  Must only read state that is the same on all computers of a network game.
+*/
+void CSyncSnapshot::Take()
+{
+	// Order the units by slot without sorting, slots are dense.
+	static std::vector<const CUnit *> unitsBySlot;
+	unitsBySlot.assign(UnitManager->GetUsedSlotCount(), nullptr);
+	for (const CUnit *unit : UnitManager->GetUnits()) {
+		unitsBySlot[UnitNumber(*unit)] = unit;
+	}
+	Units.clear();
+	for (const CUnit *unit : unitsBySlot) {
+		if (unit) {
+			Units.push_back({static_cast<uint16_t>(UnitNumber(*unit)), UnitFieldDigests(*unit)});
+		}
+	}
+
+	uint32_t unitsDigest = SyncDigestBasis;
+	for (const UnitDigests &unit : Units) {
+		unitsDigest = SyncDigestMix(unitsDigest, unit.Slot);
+		for (uint32_t field : unit.Fields) {
+			unitsDigest = SyncDigestMix(unitsDigest, field);
+		}
+	}
+	Digests[static_cast<std::size_t>(ESyncPart::Units)] = unitsDigest;
+	Digests[static_cast<std::size_t>(ESyncPart::Players)] = PlayersDigest();
+	Digests[static_cast<std::size_t>(ESyncPart::Missiles)] = GlobalMissilesSyncDigest();
+	Digests[static_cast<std::size_t>(ESyncPart::Map)] = MapDigest();
+	Digests[static_cast<std::size_t>(ESyncPart::Random)] = SyncRandSeed;
+}
+
+/**
+**  Forget the digests.
+*/
+void CSyncSnapshot::Clear()
+{
+	Digests.fill(0);
+	Units.clear();
+}
+
+/**
+**  Forget the map digests kept between the snapshots, for a new game.
+*/
+void ResetSyncDigests()
+{
+	SyncMapBandDigests.clear();
+	SyncNextMapBand = 0;
+}
+
+/**
+**  Digests used to bisect two snapshots.
+**
+**  For a range of more than one slot, the digests are the ones of the units
+**  of its 4 quarters (see SyncRangeQuarter), 0 for a quarter without units.
+**  For a single slot, they are the field digests of the unit in this slot,
+**  all 0 if there is none.
+**
+**  @param lo  First unit slot of the range.
+**  @param hi  End of the unit slot range.
+**
+**  @return the 4 digests.
+*/
+UnitSyncDigests CSyncSnapshot::RangeDigests(uint32_t lo, uint32_t hi) const
+{
+	static_assert(UnitSyncFieldCount == 4, "Bisection splits ranges in as many parts as unit fields");
+	auto it = ranges::lower_bound(Units.begin(), Units.end(), lo, std::less<>{}, &UnitDigests::Slot);
+	UnitSyncDigests res{};
+
+	if (hi - lo == 1) {
+		if (it != Units.end() && it->Slot == lo) {
+			res = it->Fields;
+		}
+		return res;
+	}
+	for (std::size_t i = 0; i != res.size(); ++i) {
+		const uint32_t end = SyncRangeQuarter(lo, hi, i).second;
+		uint32_t digest = SyncDigestBasis;
+		bool empty = true;
+
+		for (; it != Units.end() && it->Slot < end; ++it) {
+			digest = SyncDigestMix(digest, it->Slot);
+			for (uint32_t field : it->Fields) {
+				digest = SyncDigestMix(digest, field);
+			}
+			empty = false;
+		}
+		res[i] = empty ? 0 : digest;
+	}
+	return res;
+}
+
+/**
+**  Slot range of a quarter of [lo, hi).
+**
+**  Quarters of ranges shorter than 4 slots may be empty.
+*/
+std::pair<uint32_t, uint32_t> SyncRangeQuarter(uint32_t lo, uint32_t hi, std::size_t index)
+{
+	const uint32_t size = hi - lo;
+	return {lo + size * index / 4, lo + size * (index + 1) / 4};
+}
+
+/**
+**  Index of the first different digest, if any.
+*/
+std::optional<std::size_t> FirstSyncDifference(const UnitSyncDigests &lhs, const UnitSyncDigests &rhs)
+{
+	const auto it = std::mismatch(lhs.begin(), lhs.end(), rhs.begin()).first;
+	if (it == lhs.end()) {
+		return std::nullopt;
+	}
+	return it - lhs.begin();
+}
+
+const char *SyncPartName(ESyncPart part)
+{
+	switch (part) {
+		case ESyncPart::Units: return "units";
+		case ESyncPart::Players: return "players";
+		case ESyncPart::Missiles: return "missiles";
+		case ESyncPart::Map: return "map";
+		case ESyncPart::Random: return "random";
+	}
+	return "?";
+}
+
+const char *UnitSyncFieldName(EUnitSyncField field)
+{
+	switch (field) {
+		case EUnitSyncField::Position: return "position";
+		case EUnitSyncField::HitPoints: return "hit points";
+		case EUnitSyncField::Orders: return "orders";
+		case EUnitSyncField::Other: return "type/owner/resources/frame";
+	}
+	return "?";
+}
+
+//@}
@@ -49,6 +49,8 @@ class COrder_Still : public COrder
 	ParseSpecificData(lua_State *l, int &j, std::string_view value, const CUnit &unit) override;
 
 	void Execute(CUnit &unit) override;
+	unsigned int GetIdleCycles(const CUnit &unit) const override;
+	void SkipIdleCycles(CUnit &unit, unsigned int cycles) override;
 	void OnAnimationAttack(CUnit &unit) override;
 	PixelPos Show(const CViewport &vp, const PixelPos &lastScreenPos) const override;
 	void UpdatePathFinderData(PathFinderInput &input) override
@@ -98,8 +98,14 @@ class COrder
 {
 public:
 	explicit COrder(UnitAction action) : Action(action) {}
+	/// A copy is never the order a unit sleeps in
+	COrder(const COrder &rhs) : Goal(rhs.Goal), Action(rhs.Action), Finished(rhs.Finished), Instant(rhs.Instant) {}
 	virtual ~COrder();
 
+	/// Orders come from pools by size, see actions.cpp
+	static void *operator new(size_t size);
+	static void operator delete(void *p, size_t size) noexcept;
+
 	virtual std::unique_ptr<COrder> Clone() const = 0;
 	virtual void Execute(CUnit &unit) = 0;
 	virtual void Cancel(CUnit &unit) {}
@@ -122,6 +128,11 @@ class COrder
 
 	virtual bool OnAiHitUnit(CUnit &unit, CUnit *attacker, int /*damage*/);
 
+	/// Number of next cycles in which Execute would only count down, if nothing else changes
+	virtual unsigned int GetIdleCycles(const CUnit &unit) const { return 0; }
+	/// Count down the cycles skipped while the unit was asleep in this order
+	virtual void SkipIdleCycles(CUnit &unit, unsigned int cycles) {}
+
 	bool ParseGenericData(lua_State *l, int &j, std::string_view value);
 	bool HasGoal() const { return Goal != nullptr; }
 	CUnit *GetGoal() const { return Goal; }
@@ -166,6 +177,7 @@ class COrder
 	const UnitAction Action;   /// global action
 	bool Finished = false; /// true when order is finish
 	bool Instant = false; /// true to ignore TimeCost
+	bool Idle = false;    /// true when the unit sleeps in this order, see CUnit::Idle
 };
 
 using COrderPtr = COrder *;
@@ -207,6 +219,8 @@ extern std::unique_ptr<COrder> CclParseOrder(lua_State *l, CUnit &unit);
 
 /// Handle the actions of all units each game cycle
 extern void UnitActions();
+/// Count down what the sleeping units skipped, so that they can be saved
+extern void WakeUpIdleUnits();
 
 //@}
 
@@ -32,6 +32,7 @@
 
 //@{
 
+#include <iosfwd>
 #include <map>
 #include <optional>
 #include <string>
@@ -71,6 +72,51 @@ enum class SetVar_ModifyTypes {
 SetVar_ModifyTypes toSetVar_ModifyTypes(std::string_view s);
 void modifyValue(SetVar_ModifyTypes mod, int &value, int rop);
 
+/**
+**  Integer operand of an animation, see ParseAnimInt for its syntax.
+**
+**  The text is analysed once when the animation is defined, so that the
+**  numbers, variables, bool flags and the other common operands are not
+**  parsed again at each step of the animation.
+*/
+class CAnimInt
+{
+public:
+	CAnimInt() = default;
+	CAnimInt &operator=(std::string_view s);
+
+	int Eval(const CUnit &unit) const;
+
+	const std::string &str() const { return text; }
+	bool empty() const { return text.empty(); }
+
+private:
+	enum class EKind : unsigned char {
+		Other,        /// Evaluated from the text by ParseAnimInt
+		Number,       /// value
+		Variable,     /// Component of a variable of the unit or of its goal
+		BoolFlag,     /// Bool flag of the type of the unit or of its goal
+		Random,       /// Random number between value and max
+		UnitNumber,   /// Slot of the unit
+		GoalNumber,   /// Slot of the goal of the order
+		Rotate,       /// Pending rotation
+		RemainingWay  /// Length of the path
+	};
+	enum class EComponent : unsigned char {None, Value, Max, Increase, Enable, Percent};
+
+	std::string text;                        /// Operand as written
+	std::string name;                        /// Name of the variable or bool flag
+	EKind kind = EKind::Number;
+	EComponent component = EComponent::None; /// Part of the variable
+	bool ofGoal = false;                     /// Variable or flag of the goal instead of the unit
+	int value = 0;                           /// Number, or minimum of the random number
+	int max = 0;                             /// Maximum of the random number
+	mutable int index = -1;                  /// Index of the variable or flag, found at first use
+};
+
+/// Read one word of an animation
+extern std::istream &operator>>(std::istream &is, CAnimInt &value);
+
 class CAnimation
 {
 public:
@@ -128,6 +174,7 @@ extern int UnitShowAnimation(CUnit &unit, const std::vector<std::unique_ptr<CAni
 
 
 extern int ParseAnimInt(const CUnit &unit, std::string_view parseint);
+inline int ParseAnimInt(const CUnit &unit, const CAnimInt &value) { return value.Eval(unit); }
 
 extern void FindLabelLater(std::size_t *labelIndex, std::string name);
 
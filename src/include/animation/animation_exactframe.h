@@ -45,7 +45,7 @@ class CAnimation_ExactFrame : public CAnimation
 	int ParseAnimInt(const CUnit *unit) const;
 
 private:
-	std::string frame;
+	CAnimInt frame;
 };
 
 //@}
@@ -44,7 +44,7 @@ class CAnimation_Frame : public CAnimation
 
 	int ParseAnimInt(const CUnit *unit) const;
 private:
-	std::string frame;
+	CAnimInt frame;
 };
 
 //@}
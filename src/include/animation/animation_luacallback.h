@@ -48,7 +48,7 @@ class CAnimation_LuaCallback : public CAnimation
 private:
 	mutable LuaCallbackImpl cb;
 	std::string cbName;
-	std::vector<std::string> cbArgs;
+	std::vector<CAnimInt> cbArgs;
 };
 
 //@}
@@ -42,7 +42,7 @@ class CAnimation_RandomGoto : public CAnimation
 	void Init(std::string_view s, lua_State *l) override;
 
 private:
-	std::string randomStr;
+	CAnimInt randomStr;
 	std::size_t gotoLabel = 0;
 };
 
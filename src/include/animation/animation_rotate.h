@@ -42,7 +42,7 @@ class CAnimation_Rotate : public CAnimation
 	void Init(std::string_view s, lua_State *l) override;
 
 private:
-	std::string rotateStr;
+	CAnimInt rotateStr;
 };
 
 extern void UnitRotate(CUnit &unit, int rotate);
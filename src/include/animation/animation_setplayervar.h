@@ -43,10 +43,10 @@ class CAnimation_SetPlayerVar : public CAnimation
 
 private:
 	SetVar_ModifyTypes mod;
-	std::string playerStr;
+	CAnimInt playerStr;
 	std::string varStr;
 	std::string argStr;
-	std::string valueStr;
+	CAnimInt valueStr;
 };
 
 extern int GetPlayerData(int player, std::string_view prop, std::string_view arg);
@@ -44,7 +44,7 @@ class CAnimation_SetVar : public CAnimation
 private:
 	SetVar_ModifyTypes mod;
 	std::string varStr;
-	std::string valueStr;
+	CAnimInt valueStr;
 	std::string unitSlotStr;
 };
 
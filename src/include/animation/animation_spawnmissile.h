@@ -43,12 +43,12 @@ class CAnimation_SpawnMissile : public CAnimation
 
 private:
 	std::string missileTypeStr;
-	std::string startXStr;
-	std::string startYStr;
-	std::string destXStr;
-	std::string destYStr;
+	CAnimInt startXStr;
+	CAnimInt startYStr;
+	CAnimInt destXStr;
+	CAnimInt destYStr;
 	std::string flagsStr;
-	std::string offsetNumStr;
+	CAnimInt offsetNumStr;
 };
 
 //@}
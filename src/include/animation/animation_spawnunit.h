@@ -43,10 +43,10 @@ class CAnimation_SpawnUnit : public CAnimation
 
 private:
 	std::string unitTypeStr;
-	std::string offXStr;
-	std::string offYStr;
-	std::string rangeStr;
-	std::string playerStr;
+	CAnimInt offXStr;
+	CAnimInt offYStr;
+	CAnimInt rangeStr;
+	CAnimInt playerStr;
 	std::string flagsStr;
 };
 
@@ -42,7 +42,7 @@ class CAnimation_Wait : public CAnimation
 	void Init(std::string_view s, lua_State *l) override;
 
 private:
-	std::string wait;
+	CAnimInt wait;
 };
 
 //@}
@@ -42,11 +42,11 @@ class CAnimation_Wiggle : public CAnimation
 	void Init(std::string_view s, lua_State *l) override;
 
 private:
-	std::string x;
-	std::string y;
+	CAnimInt x;
+	CAnimInt y;
 	bool isHeading = false;
 	bool isZDisplacement = false;
-	std::string speed;
+	CAnimInt speed;
 	std::size_t ifNotReached = 0;
 };
 
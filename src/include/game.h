@@ -37,6 +37,7 @@ class CFile;
 
 extern void LoadGame(const fs::path &filename); /// Load saved game
 extern int SaveGame(const std::string &filename); /// Save game
+extern int SaveGameFile(const fs::path &fullpath); /// Save game to a path
 extern void DeleteSaveGame(const std::string &filename); /// Delete save game
 extern bool SaveGameLoading;                 /// Save game is in progress of loading
 
@@ -0,0 +1,109 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+/**@name influence.h - The influence map headerfile. */
+//
+//      (c) Copyright 2026 by the Stratagus Developers
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+#ifndef __INFLUENCE_H__
+#define __INFLUENCE_H__
+
+//@{
+
+#include <vector>
+
+#include "settings.h"
+#include "vec2i.h"
+
+class CPlayer;
+class CUnit;
+
+/*----------------------------------------------------------------------------
+--  Declarations
+----------------------------------------------------------------------------*/
+
+/**
+**  Influence of the players on the map, at a reduced resolution.
+**
+**  The map is split into cells of CellSize x CellSize tiles. For each cell
+**  and each player it holds:
+**    - the threat of the player's units: each unit which can attack adds
+**      its damage x attack range to the cells it can reach from where it
+**      stands.
+**    - the presence of the player: the number of its units on the map
+**      (the same units as in the CMapField::UnitCache, so corpses too)
+**      whose top left tile is in the cell.
+**
+**  It is kept up to date by CMap::Insert, CMap::Remove and
+**  CMap::UnitChanged, so units moving, dying or changing owner are taken
+**  into account when it happens. The upgrades and UpdateStats call
+**  CMap::UnitChanged for the units whose stats they change.
+*/
+class CInfluenceMap
+{
+public:
+	static constexpr int CellShift = 3;
+	static constexpr int CellSize = 1 << CellShift;
+
+	/// Allocate the cells for a map of this size, all of them are empty
+	void Init(int mapWidth, int mapHeight);
+	/// Free the cells
+	void Clear();
+
+	/// Add the influence of a unit placed on the map
+	void AddUnit(CUnit &unit);
+	/// Remove what a unit added
+	void RemoveUnit(CUnit &unit);
+
+	/// Threat of the units of a player on a tile
+	int GetThreat(int player, const Vec2i &pos) const;
+	/// Presence of a player around a tile
+	int GetPresence(int player, const Vec2i &pos) const;
+
+	/// Threat on a tile of the units which are enemies of player
+	int GetEnemyThreat(const CPlayer &player, const Vec2i &pos) const;
+	/// Presence around a tile of player and its allies
+	int GetFriendlyPresence(const CPlayer &player, const Vec2i &pos) const;
+	/// Number of units in the cells overlapping an area which are enemies of player
+	int GetEnemyPresence(const CPlayer &player, const Vec2i &ltPos, const Vec2i &rbPos) const;
+
+private:
+	unsigned int GetCellIndex(const Vec2i &pos) const
+	{
+		return (pos.x >> CellShift) + (pos.y >> CellShift) * cellsX;
+	}
+	void AddThreat(int player, const Vec2i &minPos, const Vec2i &maxPos, int threat);
+
+private:
+	int cellsX = 0;
+	int cellsY = 0;
+	int maxUnitSize = 1;        /// Biggest width or height of the counted units
+	std::vector<int> threats;   /// PlayerMax values for each cell
+	std::vector<int> presences; /// PlayerMax values for each cell
+};
+
+//@}
+
+#endif // !__INFLUENCE_H__
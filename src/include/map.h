@@ -90,7 +90,9 @@
 
 #include "color.h"
 #include "filesystem.h"
+#include "influence.h"
 #include "settings.h"
+#include "unit_index.h"
 #include "vec2i.h"
 
 /*----------------------------------------------------------------------------
@@ -225,6 +227,9 @@ class CMap
 	/// Remove unit from cache
 	void Remove(CUnit &unit);
 
+	/// Update the unit index and the influence after a change of owner, type or stats
+	void UnitChanged(CUnit &unit);
+
 	void Clamp(Vec2i &pos) const;
 
 	//Warning: we expect typical usage as xmin = x - range
@@ -261,6 +266,9 @@ class CMap
 	bool isMapInitialized = false ;
 
 	CMapInfo Info;             /// descriptive information
+
+	CUnitIndex UnitIndex;      /// units of the map by area, owner and movement type
+	CInfluenceMap Influence;   /// threat and presence of the players by area
 };
 
 
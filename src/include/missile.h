@@ -620,6 +620,8 @@ extern MissileType *MissileBurningBuilding(int percent);
 
 /// Save missiles
 extern void SaveMissiles(CFile &file);
+/// Digest of the global missiles state
+extern uint32_t GlobalMissilesSyncDigest();
 
 /// Initialize missile-types
 extern void InitMissileTypes();
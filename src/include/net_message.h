@@ -36,6 +36,7 @@
 #include <vector>
 
 #include "settings.h"
+#include "sync_digest.h"
 
 /*----------------------------------------------------------------------------
 --  Declarations
@@ -377,6 +378,7 @@ enum _message_type_ {
 	MessageSelection,              /// Update a Selection from Team Player
 	MessageQuit,                   /// Quit game
 	MessageResend,                 /// Resend message
+	MessageSyncBisect,             /// Locate a desync (not executed in game cycles)
 
 	MessageChat,                   /// Chat message
 
@@ -486,11 +488,36 @@ class CNetworkCommandSync
 	CNetworkCommandSync() = default;
 	size_t Serialize(unsigned char *buf) const;
 	size_t Deserialize(const unsigned char *buf);
-	static size_t Size() { return 4 + 4; };
+	static size_t Size() { return 4 + 4 + 4 * SyncPartCount; };
 
 public:
 	uint32_t syncSeed = 0;
 	uint32_t syncHash = 0;
+	SyncDigests digests{}; /// Digest of each part of the game state
+};
+
+/**
+**  Network desync bisection message.
+**
+**  Sent back and forth between two hosts which disagree on the units of a
+**  sampled cycle, each answer narrows the slot range to its first differing
+**  quarter until a single unit is left.
+*/
+class CNetworkSyncBisect
+{
+public:
+	CNetworkSyncBisect() = default;
+	size_t Serialize(unsigned char *buf) const;
+	size_t Deserialize(const unsigned char *buf);
+	static size_t Size() { return 4 + 4 + 4 + 4 * UnitSyncFieldCount + 1 + 1; };
+
+public:
+	uint32_t cycle = 0;        /// Game cycle which executed the diverging sync
+	uint32_t lo = 0;           /// First unit slot of the range
+	uint32_t hi = 0;           /// End of the unit slot range
+	UnitSyncDigests digests{}; /// Sender digests of the range (see CSyncSnapshot::RangeDigests)
+	uint8_t player = 0;        /// Player the message is for
+	uint8_t last = 0;          /// Answer to a single slot range, not to be answered
 };
 
 /**
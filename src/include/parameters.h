@@ -32,7 +32,28 @@
 
 #include "filesystem.h"
 
+#include <cstdint>
+#include <optional>
 #include <string>
+#include <string_view>
+
+/**
+**  Description of a headless batch game, read from a JSON file.
+**
+**  All its fields are optional:
+**  {"results": "results.json", "maxCycles": 54000, "seed": 1234}
+*/
+class HeadlessBatch
+{
+public:
+	bool Load(const fs::path &file);
+	bool Parse(std::string_view json, const fs::path &file);
+
+public:
+	fs::path ResultFilename;      /// JSON file receiving the results of the game
+	unsigned long MaxCycles = 0;  /// Cycles after which the game ends as a draw, 0 for no limit
+	std::optional<uint32_t> Seed; /// Seed of the synchronized random numbers
+};
 
 class Parameters
 {
@@ -59,6 +80,8 @@ class Parameters
 	std::string luaScriptArguments;
 	std::string LocalPlayerName;        /// Name of local player
 	bool benchmark = false;             /// If true, run as fast as possible and report fps at the end of a game
+	bool headless = false;              /// If true, play the map without video, sound and user interface
+	HeadlessBatch headlessBatch;        /// Description of the headless game
 private:
 	fs::path userDirectory;          /// Directory containing user settings and data
 public:
@@ -43,6 +43,11 @@ void DrawLastAStar(const class CViewport &vp);
 --  Declarations
 ----------------------------------------------------------------------------*/
 
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <optional>
 #include <queue>
 #include <sys/types.h>
 #include <utility>
@@ -50,6 +55,7 @@ void DrawLastAStar(const class CViewport &vp);
 
 class CUnit;
 class CFile;
+class CFlowField;
 struct lua_State;
 
 /**
@@ -120,11 +126,102 @@ class PathFinderOutput
 	char Path[MAX_PATH_LENGTH];     /// directions of stored path
 };
 
+/// A path search for AStarFindPaths
+struct AStarRequest
+{
+	const CUnit *Unit = nullptr;            /// Unit which moves
+	Vec2i StartPos{0, 0};                   /// Start position of the unit
+	Vec2i GoalPos{0, 0};                    /// Top left of the goal
+	Vec2i GoalSize{0, 0};                   /// Size of the goal
+	int MinRange = 0;                       /// Min range to the goal
+	int MaxRange = 0;                       /// Max range to the goal
+	char *Path = nullptr;                   /// Where to store the path, may be null
+	int PathLength = 0;                     /// Size of Path
+	bool FixedEnemyUnitsUnpassable = false; /// Don't cross fixed enemy units
+	int Result = PF_FAILED;                 /// Path length or PF_* code
+};
+
+/**
+**  Directions of a path, packed by 3 bits in a pool shared by all paths.
+**
+**  The steps are consumed from the front without moving the others.
+*/
+class CPackedPath
+{
+public:
+	CPackedPath() = default;
+	CPackedPath(const CPackedPath &) = delete;
+	CPackedPath &operator=(const CPackedPath &) = delete;
+	~CPackedPath() { Clear(); }
+
+	bool IsEmpty() const { return Begin == End; }
+	int GetLength() const { return End - Begin; }
+	/// Direction of the i-th remaining step
+	int Get(int i) const;
+
+	void Assign(const char *directions, int length);
+	void PopFront(int count);
+	void Clear();
+
+private:
+	int Block = -1;              /// First word in the pool, -1 if none
+	int SizeClass = 0;           /// The block has 1 << SizeClass words
+	int Begin = 0;               /// Index of the next step in the block
+	int End = 0;                 /// Index after the last step in the block
+	unsigned int Generation = 0; /// Generation of the pool which gave the block
+};
+
+/// Counters of an a* search
+struct AStarSearchStats
+{
+	int ExpandedNodes = 0;     /// Nodes taken from the open set
+	int CostCacheHits = 0;     /// Tile costs found in the cache
+	int CostCacheMisses = 0;   /// Tile costs computed
+	bool JumpFallback = false; /// Jump point search let a* decide
+};
+
+/**
+**  Positions where the terrain lets a unit stand, one bit per position.
+**
+**  There is one plane per movement mask and unit size. A bit is set if
+**  no tile of the footprint blocks the movement, units are ignored.
+*/
+class CPassabilityPlane
+{
+public:
+	CPassabilityPlane(uint64_t terrainMask, const Vec2i &unitSize);
+
+	bool Matches(uint64_t terrainMask, const Vec2i &unitSize) const
+	{
+		return this->terrainMask == terrainMask && this->unitSize == unitSize;
+	}
+	/// pos must be on the map
+	bool IsPassable(const Vec2i &pos) const
+	{
+		return (bits[pos.y * wordsPerRow + pos.x / 64] >> (pos.x % 64)) & 1;
+	}
+	void TerrainChanged(const Vec2i &pos, const Vec2i &size);
+
+private:
+	void UpdateTiles(const Vec2i &pos, const Vec2i &size);
+	void UpdateRows(int minY, int maxY);
+
+private:
+	uint64_t terrainMask;
+	Vec2i unitSize;
+	int wordsPerRow;
+	int height;
+	std::vector<uint64_t> tileBits; /// Tiles which don't block the movement
+	std::vector<uint64_t> bits;     /// Positions where the whole footprint doesn't
+};
+
 class PathFinderData
 {
 public:
 	PathFinderInput input;
 	PathFinderOutput output;
+	std::shared_ptr<CFlowField> flowField; /// Flow field followed by the unit, if any
+	CPackedPath storedPath;                /// Steps of the path after the ones in output
 };
 
 
@@ -139,13 +236,34 @@ enum class VisitResult {
 	Cancel
 };
 
+/**
+**  Breadth first traversal of the map, used by the flood fill searches.
+**
+**  The marks and the frontier are kept in a storage which is given back
+**  to a per thread pool when the traversal is destroyed, so the next
+**  traversal of the same thread doesn't allocate anything.
+**  Each mark is stamped with the generation of the traversal which set it,
+**  Init() only starts a new generation instead of clearing the whole map.
+**  Traversals don't share any state, several of them may run at the same
+**  time on different threads.
+*/
 class TerrainTraversal
 {
 public:
 	using dataType = short int;
 public:
+	TerrainTraversal() = default;
+	~TerrainTraversal();
+	TerrainTraversal(const TerrainTraversal &) = delete;
+	TerrainTraversal &operator=(const TerrainTraversal &) = delete;
+
 	void SetSize(unsigned int width, unsigned int height);
 	void Init();
+	/// Don't push positions whose value (Get()) would be greater than maxDistance
+	void SetMaxDistance(int maxDistance)
+	{
+		m_maxDistance = std::min<int>(maxDistance, std::numeric_limits<dataType>::max());
+	}
 
 	void PushPos(const Vec2i &pos);
 	void PushNeighboor(const Vec2i &pos);
@@ -165,23 +283,84 @@ class TerrainTraversal
 	void Set(const Vec2i &pos, dataType value);
 
 	struct PosNode {
+		PosNode() = default;
 		PosNode(const Vec2i &pos, const Vec2i &from) : pos(pos), from(from) {}
 		Vec2i pos;
 		Vec2i from;
 	};
 
+	struct Mark {
+		unsigned int generation; /// Generation of the traversal which set the value
+		dataType value;
+	};
+
+	/// Buffers kept from one traversal to the next one
+	struct Storage {
+		std::vector<Mark> marks;
+		std::vector<PosNode> frontier; /// Ring buffer, its size is a power of 2
+		unsigned int generation = 0;
+		unsigned int extentedWidth = 0;
+		unsigned int height = 0;
+	};
+
+	static std::vector<std::unique_ptr<Storage>> &StoragePool();
+
+	unsigned int GetIndex(const Vec2i &pos) const
+	{
+		return m_extented_width + 1 + pos.y * m_extented_width + pos.x;
+	}
+	void PushNode(const Vec2i &pos, const Vec2i &from);
+	PosNode PopNode();
+	void GrowFrontier();
+
 private:
-	std::vector<dataType> m_values;
-	std::queue<PosNode> m_queue;
+	std::unique_ptr<Storage> m_storage;
 	unsigned int m_extented_width = 0;
 	unsigned int m_height = 0;
+	unsigned int m_generation = 0;
+	size_t m_head = 0;  /// Index in the frontier of the next node to visit
+	size_t m_count = 0; /// Number of nodes in the frontier
+	dataType m_maxDistance = std::numeric_limits<dataType>::max();
 };
 
+inline TerrainTraversal::dataType TerrainTraversal::Get(const Vec2i &pos) const
+{
+	const Mark &mark = m_storage->marks[GetIndex(pos)];
+	return mark.generation == m_generation ? mark.value : 0;
+}
+
+inline void TerrainTraversal::Set(const Vec2i &pos, TerrainTraversal::dataType value)
+{
+	Mark &mark = m_storage->marks[GetIndex(pos)];
+	mark.generation = m_generation;
+	mark.value = value;
+}
+
+inline void TerrainTraversal::PushNode(const Vec2i &pos, const Vec2i &from)
+{
+	std::vector<PosNode> &frontier = m_storage->frontier;
+	if (m_count == frontier.size()) {
+		GrowFrontier();
+	}
+	frontier[(m_head + m_count) & (frontier.size() - 1)] = PosNode(pos, from);
+	++m_count;
+}
+
+inline TerrainTraversal::PosNode TerrainTraversal::PopNode()
+{
+	const std::vector<PosNode> &frontier = m_storage->frontier;
+	const PosNode posNode = frontier[m_head];
+	m_head = (m_head + 1) & (frontier.size() - 1);
+	--m_count;
+	return posNode;
+}
+
 template <typename T>
 bool TerrainTraversal::Run(T &context)
 {
-	for (; m_queue.empty() == false; m_queue.pop()) {
-		const PosNode &posNode = m_queue.front();
+	while (m_count != 0) {
+		// Copy, the frontier may be reallocated by PushNeighboor.
+		const PosNode posNode = PopNode();
 
 		switch (context.Visit(*this, posNode.pos, posNode.from)) {
 			case VisitResult::Finished: return true;
@@ -194,7 +373,6 @@ bool TerrainTraversal::Run(T &context)
 	return false;
 }
 
-
 /*----------------------------------------------------------------------------
 --  Variables
 ----------------------------------------------------------------------------*/
@@ -209,6 +387,12 @@ extern bool AStarKnowUnseenTerrain;
 extern int AStarUnknownTerrainCost;
 /// Maximum number of iterations of A* before giving up.
 extern int AStarMaxSearchIterations;
+/// Whether long paths are first searched on the hierarchical abstraction
+extern bool AStarHierarchical;
+/// Size in tiles of the sectors of the hierarchical abstraction
+extern int AStarHierarchicalSectorSize;
+/// Whether units moving to the same goal share a flow field
+extern bool AStarFlowField;
 
 //
 //  Convert heading into direction.
@@ -233,9 +417,16 @@ extern int UnitReachable(const CUnit &src, const CUnit &dst, int range, bool fro
 /// Return path length to unit 'dst' or error code.
 extern int CalcPathLengthToUnit(const CUnit &src, const CUnit &dst,
 						  const int minrange, const int range);
+/// Return path lengths to each unit of 'dsts' or -1, searched at once
+extern std::vector<int> CalcPathLengthsToUnits(const CUnit &src, const std::vector<CUnit *> &dsts,
+                                               const int minrange, const int range);
 /// Can the unit 'src' reach the place x,y
 extern int PlaceReachable(const CUnit &src, const Vec2i &pos, int w, int h,
 						  int minrange, int maxrange, bool from_outside_container);
+/// Tell the pathfinder that the terrain passability of an area has changed
+extern void PathfinderTerrainChanged(const Vec2i &pos, const Vec2i &size = Vec2i(1, 1));
+/// Can a unit of 'size' with movement 'mask' stand at pos, ignoring other units
+extern bool TerrainFootprintPassable(const Vec2i &pos, unsigned int mask, const Vec2i &size);
 
 //
 // in astar.cpp
@@ -253,6 +444,75 @@ extern int GetAStarUnknownTerrainCost();
 extern void SetAStarFixedEnemyUnitsUnpassable(const bool value);
 extern bool GetAStarFixedEnemyUnitsUnpassable();
 
+extern void SetAStarBucketOpenSet(bool value);
+extern bool GetAStarBucketOpenSet();
+
+extern void SetAStarJumpPointSearch(bool value);
+extern bool GetAStarJumpPointSearch();
+
+/// Counters of the last search done by AStarFindPath
+extern const AStarSearchStats &GetAStarLastSearchStats();
+
+/// Find the paths of many units at once, on worker threads
+extern void AStarFindPaths(std::vector<AStarRequest> &requests);
+
+/// Visit the positions from which a unit is in range of the goal
+extern void AStarVisitGoalArea(const Vec2i &goal, int gw, int gh, const Vec2i &tileSize,
+							   int minrange, int maxrange, std::function<void(unsigned int)> func);
+
+//
+// in hpastar.cpp
+//
+
+/// Init the hierarchical abstraction
+extern void InitHierarchicalPathfinder(int mapWidth, int mapHeight);
+/// Free the hierarchical abstraction
+extern void FreeHierarchicalPathfinder();
+/// Mark the abstraction around a changed area as outdated
+extern void HierarchicalTerrainChanged(const Vec2i &pos, const Vec2i &size);
+/// Find an intermediate goal for a long path
+extern std::optional<Vec2i> HierarchicalFindWaypoint(const Vec2i &startPos, const Vec2i &goalPos, const CUnit &unit);
+
+//
+// in flowfield.cpp
+//
+
+/// Free the flow fields
+extern void FreeFlowFields();
+/// Drop the flow fields which use a changed area
+extern void FlowFieldTerrainChanged(const Vec2i &pos, const Vec2i &size);
+/// Find the first steps of a path using a shared flow field
+extern int FlowFieldFindPath(const PathFinderInput &input, char *path, int pathLen, std::shared_ptr<CFlowField> &flowField);
+
+//
+// in reachability.cpp
+//
+
+/// Free the terrain components
+extern void FreeReachability();
+/// Update the terrain components around a changed area
+extern void ReachabilityTerrainChanged(const Vec2i &pos, const Vec2i &size);
+/// Can the goal area be reached by the unit, considering only the terrain
+extern bool TerrainReachable(const Vec2i &startPos, const Vec2i &goalPos, int gw, int gh, int maxrange, const CUnit &unit);
+
+//
+// in path_store.cpp
+//
+
+/// Free the pool of the packed paths
+extern void FreePathStore();
+
+//
+// in passability.cpp
+//
+
+/// Get the passability bitplane of a movement mask and unit size
+extern const CPassabilityPlane &GetPassabilityPlane(uint64_t mask, const Vec2i &unitSize);
+/// Update the passability bitplanes around a changed area
+extern void PassabilityTerrainChanged(const Vec2i &pos, const Vec2i &size);
+/// Free the passability bitplanes
+extern void FreePassability();
+
 extern void PathfinderCclRegister();
 
 //@}
@@ -136,6 +136,10 @@ class CPlayer
 
 	void AddUnit(CUnit &unit);
 	void RemoveUnit(CUnit &unit);
+	/// Units of this player of a unit-type, in no particular order
+	const std::vector<CUnit *> &GetUnitsOfType(const CUnitType &type) const;
+	/// Change the type of a unit, keeping the units by type up to date
+	void ChangeUnitType(CUnit &unit, const CUnitType &type);
 
 	const std::vector<CUnit *> &GetFreeWorkers() const { return FreeWorkers; }
 	void UpdateFreeWorkers();
@@ -189,6 +193,8 @@ class CPlayer
 	**  Check if the player index is an enemy
 	*/
 	bool IsEnemy(const int index) const { return (Index != index && (Enemy & (1 << index)) != 0); }
+	/// Bit field of the enemy player indexes
+	unsigned int GetEnemyMask() const { return Enemy & ~(1u << Index); }
 
 	/**
 	**  Check if the player index is an enemy
@@ -289,9 +295,14 @@ class CPlayer
 	CAllow Allow;                 /// Allowed for player
 	CUpgradeTimers UpgradeTimers; /// Timer for the upgrades
 
+private:
+	void AddToUnitsByType(CUnit &unit);
+	void RemoveFromUnitsByType(CUnit &unit);
+
 private:
 	CUnitColors UnitColors;            /// Unit colors for new units
 	std::vector<CUnit *> Units;        /// units of this player
+	std::vector<std::vector<CUnit *>> UnitsByType; /// units of this player by unit-type slot
 	std::vector<CUnit *> FreeWorkers;  /// Container for free workers
 	unsigned int Enemy = 0;            /// enemy bit field for this player
 	unsigned int Allied = 0;           /// allied bit field for this player
@@ -35,7 +35,9 @@
 --  Includes
 ----------------------------------------------------------------------------*/
 
+#include <optional>
 #include <string>
+#include <vector>
 
 /*----------------------------------------------------------------------------
 --  Declarations
@@ -49,6 +51,7 @@ enum class EReplayType {
 
 class CFile;
 class CUnit;
+class LogEntry;
 
 enum class EFlushMode;
 
@@ -82,6 +85,17 @@ extern void EndReplayLog();
 extern void CleanReplayLog();
 /// Save the replay list to file
 extern void SaveReplayList(CFile &file);
+/// Take a keyframe of the replay when one is due
+extern void ReplayKeyframeEachCycle();
+/// Seek to a cycle of the replay being played
+extern bool ReplaySeek(unsigned long cycle);
+/// Check if a seek waits for its keyframe to be restored
+extern bool IsReplaySeekPending();
+/// Restore the keyframe a seek waits for
+extern void RestoreReplayKeyframe();
+/// Index of the first command of a replay to run after a keyframe
+extern std::optional<std::size_t> ReplayResumeIndex(const std::vector<LogEntry> &commands,
+                                                    EReplayType type, unsigned long cycle);
 /// Register ccl functions related to network
 extern void ReplayCclRegister();
 
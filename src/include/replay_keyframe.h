@@ -0,0 +1,105 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+/**@name replay_keyframe.h - Replay keyframes header. */
+//
+//      (c) Copyright 2026 by the Stratagus Developers
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+
+
+
+
+#ifndef __REPLAY_KEYFRAME_H__
+#define __REPLAY_KEYFRAME_H__
+
+//@{
+
+/*----------------------------------------------------------------------------
+--  Includes
+----------------------------------------------------------------------------*/
+
+#include "filesystem.h"
+
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+/*----------------------------------------------------------------------------
+--  Declarations
+----------------------------------------------------------------------------*/
+
+/**
+**  Keyframes of a replay.
+**
+**  A keyframe is a compressed savegame of the whole game state taken
+**  at the end of a game cycle. Seeking in a replay restores the last
+**  keyframe before the wanted cycle and only simulates the cycles
+**  after it.
+**
+**  The keyframes of a replay log are kept in the "<log>.keyframes"
+**  directory next to it, so that the ones written while the game is
+**  recorded are found again when it is replayed. Their names hold the
+**  header digest of their log (see ReplayHeaderDigest), so that the
+**  keyframes of an older log written at the same place aren't used.
+*/
+class CReplayKeyframes
+{
+public:
+	struct Keyframe {
+		unsigned long GameCycle = 0; /// Cycle at the end of which it was taken
+		fs::path File;               /// Savegame holding the game state
+	};
+
+	/// Use the keyframe directory of a replay log, and find the keyframes it holds for it
+	void Open(const fs::path &logFile, uint32_t logDigest);
+	/// Forget the keyframes (their files are kept)
+	void Clear();
+
+	/// Directory of the keyframes, empty if none is opened
+	const fs::path &GetDirectory() const { return Directory; }
+	/// File of the keyframe of a cycle
+	fs::path GetFile(unsigned long cycle) const;
+	/// Check if there is a keyframe for a cycle
+	bool Has(unsigned long cycle) const;
+	/// Record the keyframe of a cycle, once its file is written
+	void Add(unsigned long cycle);
+	/// Last keyframe taken at or before a cycle
+	const Keyframe *Find(unsigned long cycle) const;
+
+	const std::vector<Keyframe> &GetKeyframes() const { return Keyframes; }
+
+	/// Log digest and cycle of a keyframe file, none if it is not a keyframe
+	static std::optional<std::pair<uint32_t, unsigned long>> ParseFile(const fs::path &file);
+	/// Keyframe directory of a replay log
+	static fs::path DirectoryOf(const fs::path &logFile);
+
+private:
+	fs::path Directory;              /// Directory of the keyframe files
+	uint32_t LogDigest = 0;          /// Header digest of the replay log
+	std::vector<Keyframe> Keyframes; /// Keyframes sorted by cycle
+};
+
+//@}
+
+#endif // !__REPLAY_KEYFRAME_H__
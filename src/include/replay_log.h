@@ -0,0 +1,200 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+/**@name replay_log.h - Replay log and binary replay format header. */
+//
+//      (c) Copyright 2026 by the Stratagus Developers
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+
+
+
+
+#ifndef __REPLAY_LOG_H__
+#define __REPLAY_LOG_H__
+
+//@{
+
+/*----------------------------------------------------------------------------
+--  Includes
+----------------------------------------------------------------------------*/
+
+#include "commands.h"
+#include "filesystem.h"
+#include "settings.h"
+#include "vec2i.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/*----------------------------------------------------------------------------
+--  Declarations
+----------------------------------------------------------------------------*/
+
+/**
+**  LogEntry structure.
+*/
+class LogEntry
+{
+public:
+	LogEntry() = default;
+
+	unsigned long GameCycle = 0;
+	int UnitNumber = 0;
+	std::string UnitIdent;
+	std::string Action;
+	EFlushMode Flush = EFlushMode::Off;
+	Vec2i Pos{0, 0};
+	int DestUnitNumber = 0;
+	std::string Value;
+	int Num = 0;
+	unsigned SyncRandSeed = 0;
+};
+
+/**
+** Full replay structure (definition + logs)
+*/
+class FullReplay
+{
+public:
+	FullReplay() { ReplaySettings.Init(); }
+	std::string Comment1;
+	std::string Comment2;
+	std::string Comment3;
+	std::string Date;
+	std::string Map;
+	std::string MapPath;
+	unsigned MapId = 0;
+
+	int LocalPlayer = 0;
+	std::string PlayerNames[PlayerMax];
+
+	Settings ReplaySettings;
+	int Engine[3]{};
+	int Network[3]{};
+	std::vector<LogEntry> Commands;
+};
+
+/**
+**  Binary replay format, version 1.
+**
+**  File    := "SRPL" Version:u8 Chunk*
+**  Chunk   := Kind:u8 RawSize:varint StoredSize:varint Compression:u8 Data
+**
+**  The first chunk is the header (the replay without its commands), the
+**  next ones are blocks of commands. Strings are interned: a command
+**  block starts with the strings it adds to the table and its commands
+**  refer to them by index, 0 being the empty string. Cycles are stored
+**  as the difference with the previous command. Numbers are LEB128
+**  varints, zigzag encoded when they can be negative.
+**
+**  A replay is readable up to its last complete chunk, so a game which
+**  crashes only loses the commands of the block being written.
+*/
+constexpr std::string_view BinaryReplayMagic = "SRPL";
+constexpr uint8_t BinaryReplayVersion = 1;
+
+enum class EReplayChunk : uint8_t {
+	Header = 1,  /// Replay description and settings
+	Commands = 2 /// Block of commands
+};
+
+/// Encode a replay as binary chunks, keeping the string table between blocks
+class CBinaryReplayEncoder
+{
+public:
+	/// Magic, version and header chunk of a replay
+	std::string EncodeHeader(const FullReplay &replay);
+	/// Chunk of a block of commands, following the ones already encoded
+	std::string EncodeCommands(const LogEntry *begin, const LogEntry *end);
+
+private:
+	uint32_t Intern(const std::string &str, std::string &newStrings, uint32_t &newCount);
+
+private:
+	std::unordered_map<std::string, uint32_t> Strings; /// Index of the interned strings
+	unsigned long LastCycle = 0;                       /// Cycle of the last encoded command
+};
+
+/**
+**  Write a binary replay incrementally.
+**
+**  Commands are gathered in blocks, which a background thread
+**  compresses and writes, so that the game doesn't wait for them.
+*/
+class CBinaryReplayWriter
+{
+public:
+	CBinaryReplayWriter() = default;
+	~CBinaryReplayWriter();
+	CBinaryReplayWriter(const CBinaryReplayWriter &) = delete;
+	CBinaryReplayWriter &operator=(const CBinaryReplayWriter &) = delete;
+
+	/// Create the file and write the replay, with the commands it already has
+	bool Open(const fs::path &file, const FullReplay &replay);
+	/// Add a command
+	void Append(const LogEntry &log);
+	/// Write the commands added so far, and wait for them
+	void Flush();
+	/// Write the last commands and close the file
+	void Close();
+
+private:
+	void QueueBlock();
+	void Run();
+
+private:
+	std::ofstream File;
+	CBinaryReplayEncoder Encoder;      /// Used by the writer thread once opened
+	std::vector<LogEntry> Block;       /// Commands not queued yet
+	std::deque<std::vector<LogEntry>> Queue; /// Blocks waiting for the writer thread
+	std::mutex Mutex;
+	std::condition_variable Wakeup;    /// Signals the writer thread
+	std::condition_variable Written;   /// Signals that the queue is empty
+	bool Busy = false;                 /// The writer thread writes a block
+	bool Closing = false;
+	std::thread Thread;
+};
+
+/// Check if data starts as a binary replay
+extern bool IsBinaryReplay(std::string_view data);
+/// Decode a binary replay, null if it is invalid
+extern std::unique_ptr<FullReplay> DecodeBinaryReplay(std::string_view data);
+/// Check if a file is a binary replay
+extern bool IsBinaryReplayFile(const fs::path &file);
+/// Load a binary replay file, null if it isn't one or is invalid
+extern std::unique_ptr<FullReplay> LoadBinaryReplay(const fs::path &file);
+/// Digest of the header of a replay, which identifies the replay
+extern uint32_t ReplayHeaderDigest(const FullReplay &replay);
+
+//@}
+
+#endif // !__REPLAY_LOG_H__
@@ -135,7 +135,7 @@ struct SettingsPresets {
 	int8_t Team = 0;          /// Team of player
 	PlayerTypes Type = PlayerTypes::PlayerUnset; /// Type of player (for network games)
 
-	void Save(const std::function <void (std::string)>& f) {
+	void Save(const std::function <void (std::string)>& f) const {
 		f(std::string("PlayerColor = ") + std::to_string(PlayerColor));
 		f(std::string("AIScript = \"") + AIScript + "\"");
 		f(std::string("Race = ") + std::to_string(Race));
@@ -296,7 +296,7 @@ struct Settings {
 			getBitfield() == other.getBitfield();
 	}
 
-	void Save(const std::function <void (std::string)>& f, bool withPlayers = true) {
+	void Save(const std::function <void (std::string)>& f, bool withPlayers = true) const {
 		f(std::string("NetGameType = ") + std::to_string(static_cast<int>(NetGameType)));
 		if (withPlayers) {
 			for (int i = 0; i < PlayerMax; ++i) {
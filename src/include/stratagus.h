@@ -38,6 +38,7 @@
 #else
 #define omp_get_thread_num() 0
 #define omp_get_num_threads() 1
+#define omp_get_max_threads() 1
 #endif
 
 //@{
@@ -205,6 +206,8 @@ extern void Exit(int err);                  /// Exit
 
 extern void UpdateDisplay();            /// Game display update
 extern void GameMainLoop(bool clean);            /// Game main loop
+extern void RunHeadlessGame(const std::string &filename); /// Play a map without video, sound and UI
+extern void CheckHeadlessCycleLimit();   /// End a headless game which has run its maximum of cycles
 extern int stratagusMain(int argc, char **argv); /// main entry
 
 //@}
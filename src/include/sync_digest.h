@@ -0,0 +1,131 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+/**@name sync_digest.h - Simulation state digests header. */
+//
+//      (c) Copyright 2026 by the Stratagus Developers
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+
+
+#ifndef __SYNC_DIGEST_H__
+#define __SYNC_DIGEST_H__
+
+//@{
+
+/*----------------------------------------------------------------------------
+--  Includes
+----------------------------------------------------------------------------*/
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+/*----------------------------------------------------------------------------
+--  Declarations
+----------------------------------------------------------------------------*/
+
+/**
+**  Parts of the simulation state that get their own digest.
+**
+**  The digests are exchanged with the sync messages, so a desync tells
+**  which part of the state diverged and not only that something did.
+*/
+enum class ESyncPart : uint8_t {
+	Units,    /// Position, hit points and orders of every unit
+	Players,  /// Resources, supply and upgrades of every player
+	Missiles, /// Position and state of every global missile
+	Map,      /// Flags and values of every map field
+	Random    /// Synchronized random seed
+};
+constexpr std::size_t SyncPartCount = 5;
+
+/**
+**  Fields of a unit that get their own digest.
+*/
+enum class EUnitSyncField : uint8_t {
+	Position,  /// Tile, pixel offset and direction
+	HitPoints, /// Hit points and their maximum
+	Orders,    /// Actions and goals of the orders
+	Other      /// Type, owner, resources held and animation frame
+};
+constexpr std::size_t UnitSyncFieldCount = 4;
+
+using SyncDigests = std::array<uint32_t, SyncPartCount>;
+using UnitSyncDigests = std::array<uint32_t, UnitSyncFieldCount>;
+
+/// Number of unit slots covered by the unit bisection (slots are 16 bits)
+constexpr uint32_t SyncUnitSlotCount = 0x10000;
+
+/**
+**  Snapshot of the simulation state digests at one game cycle.
+**
+**  The per unit digests are kept so that two snapshots can be
+**  bisected down to the first differing unit and field,
+**  see CSyncSnapshot::RangeDigests.
+*/
+class CSyncSnapshot
+{
+public:
+	struct UnitDigests {
+		uint16_t Slot = 0;       /// Unit slot number
+		UnitSyncDigests Fields{}; /// Digest of each unit field
+	};
+
+	/// Compute the digests of the current game state
+	void Take();
+	/// Forget the digests
+	void Clear();
+
+	/// Digests of the 4 quarters of the unit slots [lo, hi), or the fields of unit lo
+	UnitSyncDigests RangeDigests(uint32_t lo, uint32_t hi) const;
+
+public:
+	SyncDigests Digests{};           /// Digest of each part
+	std::vector<UnitDigests> Units;  /// Per unit digests sorted by slot
+};
+
+/// Mix a value into a digest
+inline uint32_t SyncDigestMix(uint32_t digest, uint32_t value)
+{
+	return (digest ^ value) * 16777619u;
+}
+/// Initial value of a digest
+constexpr uint32_t SyncDigestBasis = 2166136261u;
+
+/// Forget the map digests kept between the snapshots
+extern void ResetSyncDigests();
+/// Name of a part of the state
+extern const char *SyncPartName(ESyncPart part);
+/// Name of a unit field
+extern const char *UnitSyncFieldName(EUnitSyncField field);
+/// Slot range of quarter index of [lo, hi)
+extern std::pair<uint32_t, uint32_t> SyncRangeQuarter(uint32_t lo, uint32_t hi, std::size_t index);
+/// Index of the first different digest
+extern std::optional<std::size_t> FirstSyncDifference(const UnitSyncDigests &lhs,
+                                                      const UnitSyncDigests &rhs);
+
+//@}
+
+#endif // !__SYNC_DIGEST_H__
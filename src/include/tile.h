@@ -121,7 +121,8 @@
 **
 **  CMapField::UnitCache
 **
-**    Contains a vector of all units currently on this field.
+**    Contains all units currently on this field, in the order they
+**    were inserted. See CUnitCache.
 **    Note: currently units are only inserted at the insert point.
 **    This means units of the size of 2x2 fields are inserted at the
 **    top and right most map coordinate.
@@ -135,6 +136,7 @@
 #include "tileset.h"
 #include "vec2i.h"
 
+#include <cstdint>
 #include <vector>
 
 class CFile;
@@ -176,6 +178,66 @@ class CMapFieldPlayerInfo
 	unsigned char RadarJammer[PlayerMax]{}; /// Jamming capabilities.
 };
 
+/**
+**  Units on a map field.
+**
+**  Most fields hold no unit or one or two (a unit on a corpse), so these
+**  are kept inline in the field. More units spill into a block taken from
+**  a pool of blocks of the same capacity, given back when the field is
+**  emptied. The units stay in insertion order.
+*/
+class CUnitCache
+{
+public:
+	using value_type = CUnit *;
+	using iterator = CUnit **;
+	using const_iterator = CUnit *const *;
+
+	CUnitCache() = default;
+	CUnitCache(const CUnitCache &rhs);
+	CUnitCache(CUnitCache &&rhs) noexcept;
+	~CUnitCache() { Release(); }
+
+	CUnitCache &operator=(const CUnitCache &rhs);
+	CUnitCache &operator=(CUnitCache &&rhs) noexcept;
+
+	iterator begin() { return Data(); }
+	iterator end() { return Data() + count; }
+	const_iterator begin() const { return Data(); }
+	const_iterator end() const { return Data() + count; }
+
+	bool empty() const { return count == 0; }
+	size_t size() const { return count; }
+	CUnit *operator[](size_t index) const { return Data()[index]; }
+
+	void push_back(CUnit *unit)
+	{
+		if (count == capacity) {
+			Grow();
+		}
+		Data()[count++] = unit;
+	}
+	/// Remove a unit, keeping the order of the others
+	void Remove(const CUnit *unit);
+	void clear();
+
+private:
+	static constexpr uint32_t InlineCapacity = 2;
+
+	CUnit **Data() { return capacity == InlineCapacity ? inlineUnits : units; }
+	CUnit *const *Data() const { return capacity == InlineCapacity ? inlineUnits : units; }
+	void Grow();
+	void Release();
+
+private:
+	uint32_t count = 0;
+	uint32_t capacity = InlineCapacity;
+	union {
+		CUnit *inlineUnits[InlineCapacity]{}; /// units when they fit in the field
+		CUnit **units;                        /// pooled block of capacity units
+	};
+};
+
 /// Describes a field of the map
 class CMapField
 {
@@ -252,7 +314,7 @@ class CMapField
 
 public:
 	unsigned int Value = 0;         /// HP for walls/Wood Regeneration, value of stored resource for forest or harvestable terrain
-	std::vector<CUnit *> UnitCache; /// A unit on the map field.
+	CUnitCache UnitCache;           /// Units on the map field.
 
 	CMapFieldPlayerInfo playerInfo; /// stuff related to player
 
@@ -144,6 +144,14 @@ class CUnit
 
 	void Init();
 
+	bool HasIndividualUpgrade(int id) const
+	{
+		return static_cast<size_t>(id) < IndividualUpgrades.size() && IndividualUpgrades[id];
+	}
+	void SetIndividualUpgrade(int id, bool has);
+	/// To call after a change of Variable[].Increase
+	void UpdateIncreasingVariables();
+
 	COrder *CurrentOrder() const { return Orders[0].get(); }
 
 	UnitAction CurrentAction() const;
@@ -313,25 +321,15 @@ class CUnit
 		CUnitManagerData() = default;
 
 		int GetUnitId() const { return slot; }
+		/// Place of the unit in the unit list of the manager
+		int GetListIndex() const { return unitSlot; }
 	private:
 		int slot = -1;     /// index in UnitManager::unitSlots
 		int unitSlot = -1; /// index in UnitManager::units
 	};
 public:
-	// @note int is faster than shorts
-	unsigned int     Refs = 0;         /// Reference counter
-	unsigned int     ReleaseCycle = 0; /// When this unit could be recycled
-	CUnitManagerData UnitManagerData;
-	size_t PlayerSlot = 0;  /// index in Player->Units
-
-	std::vector<CUnit *> InsideUnits; /// Units inside.
-	CUnit *Container = nullptr;     /// Pointer to the unit containing it (or 0)
-	int    BoardCount = 0;    /// Number of units transported inside.
-
-	struct {
-		std::vector<CUnit *> AssignedWorkers; /// assigned workers to this resource.
-		int Active = 0; /// how many units are harvesting from the resource.
-	} Resource; /// Resource still
+	// Fields read by most loops over the units come first, so that they share
+	// the same few cache lines. Big and rarely used fields belong at the end.
 
 	Vec2i tilePos{-1, -1}; /// Map position
 
@@ -342,23 +340,12 @@ class CUnit
 	CUnitStats *Stats = nullptr;  /// Current unit stats
 	int CurrentSightRange = 0;    /// Unit's Current Sight Range
 
-	// Pathfinding stuff:
-	std::unique_ptr<PathFinderData> pathFinderData;
-
-	// DISPLAY:
-	int Frame = 0;             /// Image frame: <0 is mirrored
-	int Colors = -1;       /// custom colors
-	bool IndividualUpgrades[UpgradeMax]{}; /// individual upgrades which the unit has
-
 	signed char IX = 0;         /// X image displacement to map position
 	signed char IY = 0;         /// Y image displacement to map position
 	unsigned char Direction = 0; //: 8; /// angle (0-255) unit looking
 	unsigned char CurrentResource = 0;
 	int ResourcesHeld = 0;      /// Resources Held by a unit
 
-	unsigned char DamagedType = 0; /// Index of damage type of unit which damaged this unit
-	unsigned long Attacked = 0;    /// gamecycle unit was last attacked
-	unsigned long Summoned = 0;    /// GameCycle unit was summoned using spells
 	unsigned Blink : 3;          /// Let selection rectangle blink
 	unsigned Moving : 2;         /// The unit is moving
 	unsigned ReCast : 1;         /// Recast again next cycle
@@ -373,7 +360,6 @@ class CUnit
 	unsigned Constructed : 1;    /// Unit is in construction
 	unsigned Active : 1;         /// Unit is active for AI
 	unsigned Boarded : 1;        /// Unit is on board a transporter.
-	unsigned CacheLock : 1;      /// Unit is on lock by unitcache operations.
 
 	unsigned Waiting : 1;        /// Unit is waiting and playing its still animation
 	unsigned MineLow : 1;        /// This mine got a notification about its resources being low
@@ -382,6 +368,45 @@ class CUnit
 
 	unsigned JustMoved : 3;      /// The unit last moved of its own accord this amount of cycles of standing still ago
 
+	std::vector<CVariable> Variable; /// array of User Defined variables.
+	std::vector<unsigned int> IncreasingVariables; /// Indexes of Variable with an Increase, see UpdateIncreasingVariables
+
+	// @note int is faster than shorts
+	unsigned int     Refs = 0;         /// Reference counter
+	unsigned int     ReleaseCycle = 0; /// When this unit could be recycled
+	CUnitManagerData UnitManagerData;
+	size_t PlayerSlot = 0;  /// index in Player->Units
+	size_t PlayerTypeSlot = 0; /// index in Player->GetUnitsOfType(*Type)
+	unsigned int IndexBucket = -1; /// bucket of Map.UnitIndex, -1 if not on the map
+	size_t IndexSlot = 0;          /// index in that bucket
+	struct {
+		int Player = -1;  /// Player counted in Map.Influence, -1 if not counted
+		int Threat = 0;   /// Threat added to the cells of the area
+		Vec2i Pos;        /// Tile counted for the presence
+		Vec2i MinPos;     /// Top left of the threatened area
+		Vec2i MaxPos;     /// Bottom right of the threatened area
+	} Influence;          /// What the unit added to Map.Influence
+
+	std::vector<CUnit *> InsideUnits; /// Units inside.
+	CUnit *Container = nullptr;     /// Pointer to the unit containing it (or 0)
+	int    BoardCount = 0;    /// Number of units transported inside.
+
+	struct {
+		std::vector<CUnit *> AssignedWorkers; /// assigned workers to this resource.
+		int Active = 0; /// how many units are harvesting from the resource.
+	} Resource; /// Resource still
+
+	// Pathfinding stuff:
+	std::unique_ptr<PathFinderData> pathFinderData;
+
+	// DISPLAY:
+	int Frame = 0;             /// Image frame: <0 is mirrored
+	int Colors = -1;       /// custom colors
+
+	unsigned char DamagedType = 0; /// Index of damage type of unit which damaged this unit
+	unsigned long Attacked = 0;    /// gamecycle unit was last attacked
+	unsigned long Summoned = 0;    /// GameCycle unit was summoned using spells
+
 	unsigned TeamSelected = 0;  /// unit is selected by a team member.
 	CPlayer *RescuedFrom = nullptr;        /// The original owner of a rescued unit.
 	/// nullptr if the unit was not rescued.
@@ -401,8 +426,6 @@ class CUnit
 		unsigned    ByPlayer : PlayerMax;   /// Track unit seen by player
 	} Seen;
 
-	std::vector<CVariable> Variable; /// array of User Defined variables.
-
 	unsigned long TTL = 0;  /// time to live
 
 	unsigned int GroupId = 0;       /// unit belongs to this group id
@@ -420,6 +443,12 @@ class CUnit
 		bool Unbreakable = false;        /// Unbreakable
 	} Anim, WaitBackup;
 
+	/// The action of the unit is not run while it would only count down, see UnitActions
+	struct {
+		unsigned long Since = 0;         /// Cycle of the last run of the action
+		unsigned long Until = 0;         /// Cycle of the next run, 0 if the unit is awake
+		const CUnitType *Type = nullptr; /// Type of the unit when it fell asleep
+	} Idle;
 
 	std::vector<std::unique_ptr<COrder>> Orders; /// orders to process
 	std::unique_ptr<COrder> SavedOrder;    /// order to continue after current
@@ -430,6 +459,8 @@ class CUnit
 	std::vector<int> SpellCoolDownTimers; /// how much time unit need to wait before spell will be ready
 
 	CUnit *Goal = nullptr; /// Generic/Teleporter goal pointer
+
+	std::vector<bool> IndividualUpgrades; /// individual upgrades which the unit has, by upgrade ID
 };
 
 /**
@@ -468,6 +499,7 @@ class CPreference
 	int ShowNameDelay = 0;      /// How many cycles need to wait until unit's name popup will appear.
 	int ShowNameTime = 0;       /// How many cycles need to show unit's name popup.
 	int AutosaveMinutes = 5;    /// Autosave the game every X minutes; autosave is disabled if the value is 0
+	int ReplayKeyframeMinutes = 0; /// Keyframe replays every X minutes of game time; off if the value is 0 (default), as keyframes stay as long as their log
 	std::shared_ptr<CGraphic> IconFrameG;
 	std::shared_ptr<CGraphic> PressedIconFrameG;
 
@@ -618,6 +650,10 @@ extern void DestroyAllInside(CUnit &source);
 /// Calculate some value to measure the unit's priority for AI
 extern int ThreatCalculate(const CUnit &unit, const CUnit &dest);
 extern int TargetPriorityCalculate(const CUnit &attacker, const CUnit &dest);
+/// Priority of a target when the path length to it is known
+extern int TargetPriorityCalculate(const CUnit &attacker, const CUnit &dest, int pathLength);
+/// Find the target with the highest priority
+extern CUnit *BestTargetPriority(const CUnit &attacker, const std::vector<CUnit *> &table);
 
 /// Is target within reaction range of this unit?
 extern bool InReactRange(const CUnit &unit, const CUnit &target);
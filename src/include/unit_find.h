@@ -220,15 +220,14 @@ class UnitFinder
 	static CUnit *find(const std::vector<CUnit *> &candidates, int maxDist, CUnit& target);
 
 private:
-	UnitFinder(const CPlayer &player, const std::vector<CUnit *> &units, int maxDist, int movemask) :
-		player(player), units(units), maxDist(maxDist), movemask(movemask) {}
+	UnitFinder(const CPlayer &player, const std::vector<CUnit *> &units, int movemask) :
+		player(player), units(units), movemask(movemask) {}
 	VisitResult Visit(TerrainTraversal &terrainTraversal, const Vec2i &pos, const Vec2i &from);
 private:
 	CUnit *FindUnitAtPos(const Vec2i &pos) const;
 private:
 	const CPlayer &player;
 	const std::vector<CUnit *> &units;
-	int maxDist;
 	int movemask;
 	CUnit *resUnit = nullptr;
 };
@@ -237,6 +236,22 @@ std::vector<CUnit *> Select(const Vec2i &ltPos, const Vec2i &rbPos);
 std::vector<CUnit *> SelectFixed(const Vec2i &ltPos, const Vec2i &rbPos);
 std::vector<CUnit *> SelectAroundUnit(const CUnit &unit, int range);
 
+/**
+**  Check if a tile is the first one of an area, in scan order, covered by a unit.
+**
+**  A unit bigger than a tile is in the UnitCache of each of its tiles,
+**  it is given by the selections only at this tile. No mark is kept on
+**  the unit, so selections may be nested or run by several threads.
+**
+**  @param unit   Unit on the tile.
+**  @param ltPos  Top left of the area.
+**  @param pos    Tile of the area.
+*/
+inline bool IsFirstTileOfUnitInArea(const CUnit &unit, const Vec2i &ltPos, const Vec2i &pos)
+{
+	return pos.x == std::max(ltPos.x, unit.tilePos.x) && pos.y == std::max(ltPos.y, unit.tilePos.y);
+}
+
 template <int selectMax = 0, typename Pred>
 std::vector<CUnit *> SelectFixed(const Vec2i &ltPos, const Vec2i &rbPos, Pred pred)
 {
@@ -252,23 +267,19 @@ std::vector<CUnit *> SelectFixed(const Vec2i &ltPos, const Vec2i &rbPos, Pred pr
 			const CMapField &mf = *Map.Field(posIt);
 
 			for (CUnit *unit : mf.UnitCache) {
-				if ((selectMax == 1 || unit->CacheLock == 0) && pred(unit)) {
+				if ((selectMax == 1 || IsFirstTileOfUnitInArea(*unit, ltPos, posIt)) && pred(unit)) {
 					if constexpr (selectMax == 1) {
 						return {unit};
 					} else {
-						unit->CacheLock = 1;
 						units.push_back(unit);
 						if (--max == 0) {
-							break;
+							return units;
 						}
 					}
 				}
 			}
 		}
 	}
-	for (auto* unit : units) {
-		unit->CacheLock = 0;
-	}
 	return units;
 }
 
@@ -293,6 +304,72 @@ std::vector<CUnit *> SelectAroundUnit(const CUnit &unit, int range, Pred pred)
 	                         MakeAndPredicate(IsNotTheSameUnitAs(unit), pred));
 }
 
+/**
+**  Select the units of some players and movement types in an area.
+**
+**  Only the buckets of Map.UnitIndex matching the bit fields are read,
+**  instead of the UnitCache of every tile of the area.
+**  The units are given in the order of Select(), callers choosing the
+**  first of equally good units (and so the replays) don't depend on the
+**  buckets.
+**
+**  @param ltPos         Top left of the area.
+**  @param rbPos         Bottom right of the area.
+**  @param playerMask    Bit field of the players (1 << player index).
+**  @param movementMask  Bit field of the movement types (CUnitIndex::MovementBit).
+**  @param pred          Filter on the units.
+*/
+template <typename Pred>
+std::vector<CUnit *> SelectOwnedBy(const Vec2i &ltPos, const Vec2i &rbPos,
+                                   unsigned int playerMask, unsigned int movementMask, Pred pred)
+{
+	Vec2i minPos = ltPos;
+	Vec2i maxPos = rbPos;
+	// Index of the first tile of the unit in the area, then rank in its UnitCache.
+	std::vector<std::pair<std::pair<unsigned int, size_t>, CUnit *>> units;
+
+	Map.FixSelectionArea(minPos, maxPos);
+	Map.UnitIndex.ForEach(minPos, maxPos, playerMask, movementMask, [&](CUnit *unit) {
+		if (pred(unit)) {
+			const Vec2i firstPos(std::max(minPos.x, unit->tilePos.x), std::max(minPos.y, unit->tilePos.y));
+			const auto &cache = Map.Field(firstPos)->UnitCache;
+			const size_t rank = std::distance(cache.begin(), ranges::find(cache, unit));
+			units.push_back({{Map.getIndex(firstPos), rank}, unit});
+		}
+	});
+	ranges::sort(units, [](const auto &lhs, const auto &rhs) { return lhs.first < rhs.first; });
+	std::vector<CUnit *> res;
+	res.reserve(units.size());
+	for (const auto &[order, unit] : units) {
+		res.push_back(unit);
+	}
+	return res;
+}
+
+/**
+**  Select the units of the enemies of a player around a unit.
+**
+**  @param unit          Center of the search.
+**  @param range         Distance range to look.
+**  @param player        Player whose enemies are looked for.
+**  @param movementMask  Bit field of the movement types (CUnitIndex::MovementBit).
+**  @param pred          Filter on the units.
+*/
+template <typename Pred>
+std::vector<CUnit *> SelectEnemiesAroundUnit(const CUnit &unit, int range, const CPlayer &player,
+                                             unsigned int movementMask, Pred pred)
+{
+	const Vec2i offset(range, range);
+	const Vec2i typeSize(unit.Type->TileWidth - 1, unit.Type->TileHeight - 1);
+	const unsigned int enemies = player.GetEnemyMask() & ~(1u << PlayerNumNeutral);
+
+	return SelectOwnedBy(unit.tilePos - offset,
+	                     unit.tilePos + typeSize + offset,
+	                     enemies,
+	                     movementMask,
+	                     MakeAndPredicate(IsNotTheSameUnitAs(unit), pred));
+}
+
 template <typename Pred>
 CUnit *FindUnit_IfFixed(const Vec2i &ltPos, const Vec2i &rbPos, Pred pred)
 {
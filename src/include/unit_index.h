@@ -0,0 +1,151 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+/**@name unit_index.h - The spatial unit index headerfile. */
+//
+//      (c) Copyright 2026 by the Stratagus Developers
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+#ifndef __UNIT_INDEX_H__
+#define __UNIT_INDEX_H__
+
+//@{
+
+#include <algorithm>
+#include <vector>
+
+#include "settings.h"
+#include "vec2i.h"
+
+class CUnit;
+
+/*----------------------------------------------------------------------------
+--  Declarations
+----------------------------------------------------------------------------*/
+
+/**
+**  Coarse spatial index of the units on the map.
+**
+**  The map is split into cells of CellSize x CellSize tiles. Each cell has
+**  one bucket per owner and per movement type (land, fly, naval), a unit is
+**  in the bucket of the cell of its top left tile.
+**  It is kept up to date by CMap::Insert and CMap::Remove, so it contains
+**  the same units as the CMapField::UnitCache.
+**
+**  A query gives the players and movement types it wants as bit fields and
+**  only reads the matching buckets of the cells around the area.
+*/
+class CUnitIndex
+{
+public:
+	static constexpr int CellShift = 3;
+	static constexpr int CellSize = 1 << CellShift;
+	static constexpr int MovementTypeCount = 3; /// Number of EMovement values
+
+	/// Bit of an EMovement value in the movement type bit field of the queries
+	static constexpr unsigned int MovementBit(int moveType) { return 1u << moveType; }
+	static constexpr unsigned int AllMovementTypes = (1u << MovementTypeCount) - 1;
+
+	/// Allocate the cells for a map of this size, the index is empty
+	void Init(int mapWidth, int mapHeight);
+	/// Free the cells
+	void Clear();
+
+	/// Add a unit placed on the map
+	void Insert(CUnit &unit);
+	/// Remove a unit from the map
+	void Remove(CUnit &unit);
+	/// Move a unit to its bucket after a change of owner or type
+	void Update(CUnit &unit);
+
+	/**
+	**  Call func for each unit of the given players and movement types
+	**  which overlaps the area. Each unit is given once.
+	**
+	**  @param ltPos         Top left of the area.
+	**  @param rbPos         Bottom right of the area (included).
+	**  @param playerMask    Bit field of the players (1 << player index).
+	**  @param movementMask  Bit field of the movement types (MovementBit).
+	**  @param func          Called with a CUnit *.
+	*/
+	template <typename F>
+	void ForEach(const Vec2i &ltPos, const Vec2i &rbPos,
+	             unsigned int playerMask, unsigned int movementMask, F func) const
+	{
+		if (buckets.empty()) {
+			return;
+		}
+		// Units are filed by their top left tile, a big unit may start in
+		// a cell before the area.
+		const int minCellX = std::max(0, (ltPos.x - maxUnitSize + 1) >> CellShift);
+		const int minCellY = std::max(0, (ltPos.y - maxUnitSize + 1) >> CellShift);
+		const int maxCellX = std::min(cellsX - 1, rbPos.x >> CellShift);
+		const int maxCellY = std::min(cellsY - 1, rbPos.y >> CellShift);
+
+		for (int cellY = minCellY; cellY <= maxCellY; ++cellY) {
+			for (int cellX = minCellX; cellX <= maxCellX; ++cellX) {
+				const unsigned int firstBucket = (cellX + cellY * cellsX) * BucketsPerCell;
+
+				for (unsigned int player = 0; player != PlayerMax; ++player) {
+					if ((playerMask & (1u << player)) == 0) {
+						continue;
+					}
+					for (int moveType = 0; moveType != MovementTypeCount; ++moveType) {
+						if ((movementMask & MovementBit(moveType)) == 0) {
+							continue;
+						}
+						const unsigned int bucket = firstBucket + player * MovementTypeCount + moveType;
+						for (const Entry &entry : buckets[bucket]) {
+							if (entry.minPos.x <= rbPos.x && ltPos.x <= entry.maxPos.x
+							    && entry.minPos.y <= rbPos.y && ltPos.y <= entry.maxPos.y) {
+								func(entry.unit);
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+
+private:
+	static constexpr unsigned int BucketsPerCell = PlayerMax * MovementTypeCount;
+
+	struct Entry {
+		CUnit *unit;
+		Vec2i minPos; /// Top left tile of the unit
+		Vec2i maxPos; /// Bottom right tile of the unit
+	};
+
+	unsigned int GetBucket(const CUnit &unit) const;
+
+private:
+	int cellsX = 0;
+	int cellsY = 0;
+	int maxUnitSize = 1;                     /// Biggest width or height of the indexed units
+	std::vector<std::vector<Entry>> buckets; /// BucketsPerCell buckets for each cell
+};
+
+//@}
+
+#endif // !__UNIT_INDEX_H__
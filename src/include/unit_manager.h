@@ -62,7 +62,14 @@ class CUnitManager
 
 	// Following is for already allocated Unit (no specific order)
 	void Add(CUnit *unit);
-	const std::vector<CUnit *> &GetUnits() const { return units; }
+	/// Units in the game, without the ones released during the iterations
+	const std::vector<CUnit *> &GetUnits() const;
+	/// Units by index during the iterations, the released ones included
+	const std::vector<CUnit *> &GetIteratedUnits() const { return units; }
+
+	/// Units released until EndIteration stay in GetIteratedUnits(), new units are appended to it
+	void BeginIteration();
+	void EndIteration();
 
 	bool empty() const;
 
@@ -73,7 +80,24 @@ class CUnitManager
 	unsigned int GetUsedSlotCount() const;
 
 private:
+	void AddToUnits(CUnit &unit);
+	void RemoveFromUnits(CUnit &unit);
+
+private:
+	/// Change of the unit list, delayed during an iteration
+	struct PendingChange
+	{
+		CUnit *Unit;
+		bool Added;
+	};
+
 	std::vector<CUnit *> units;
+	int iterationDepth = 0;                    /// Number of running iterations
+	size_t unitCountBeforeIteration = 0;       /// Size of units when the iterations began
+	std::vector<PendingChange> pendingChanges; /// Adds and releases during the iterations, in order
+	bool pendingRelease = false;               /// A unit was released during the iterations
+	mutable bool liveUnitsOutdated = false;    /// liveUnits must be computed again
+	mutable std::vector<CUnit *> liveUnits;    /// GetUnits() while released units are in units
 	std::vector<std::unique_ptr<CUnit>> unitSlots;
 	std::list<CUnit *> releasedUnits;
 	CUnit *lastCreated = nullptr;
@@ -49,6 +49,7 @@
 #include <cmath>
 
 extern unsigned SyncRandSeed;           /// Sync random seed value
+extern unsigned SyncRandInitialSeed;    /// Sync random seed value at the start of a game
 extern uint32_t FileChecksums;          /// checksums of all loaded lua files
 
 extern void InitSyncRand();             /// Initialize the syncron rand
@@ -40,6 +40,8 @@
 
 #include "fov.h"
 #include "iolib.h"
+#include "parameters.h"
+#include "pathfinder.h"
 #include "player.h"
 #include "tileset.h"
 #include "unit.h"
@@ -326,6 +328,8 @@ void CMapInfo::Clear()
 void CMap::Create()
 {
 	this->Fields.resize(this->Info.MapWidth * this->Info.MapHeight);
+	this->UnitIndex.Init(this->Info.MapWidth, this->Info.MapHeight);
+	this->Influence.Init(this->Info.MapWidth, this->Info.MapHeight);
 }
 
 /**
@@ -334,7 +338,9 @@ void CMap::Create()
 */
 void CMap::Init()
 {
-	FogOfWar->Init();
+	if (!Parameters::Instance.headless) {
+		FogOfWar->Init();
+	}
 	this->isMapInitialized = true;
 }
 
@@ -344,6 +350,8 @@ void CMap::Init()
 void CMap::Clean(const bool isHardClean /* = false*/)
 {
 	this->Fields.clear();
+	this->UnitIndex.Clear();
+	this->Influence.Clear();
 
 	// Tileset freed by Tileset?
 
@@ -485,6 +493,7 @@ void CMap::FixTile(tile_flags type, int seen, const Vec2i &pos)
 			mf.setGraphicTile(removedtile);
 			mf.resetFlag(flags);
 			mf.Value = 0;
+			PathfinderTerrainChanged(pos);
 			UI.Minimap.UpdateXY(pos);
 		}
 	} else if (seen && this->Tileset.isEquivalentTile(tile, mf.playerInfo.SeenTile)) { //Same Type
@@ -570,6 +579,7 @@ void CMap::ClearWoodTile(const Vec2i &pos)
 				 | MapFieldForest
 				 | MapFieldUnpassable);
 	mf.Value = 0;
+	PathfinderTerrainChanged(pos);
 
 	UI.Minimap.UpdateXY(pos);
 	FixNeighbors(MapFieldForest, 0, pos);
@@ -589,6 +599,7 @@ void CMap::ClearRockTile(const Vec2i &pos)
 	mf.setGraphicTile(this->Tileset.getRemovedRockTile());
 	mf.resetFlag(MapFieldRocks | MapFieldUnpassable);
 	mf.Value = 0;
+	PathfinderTerrainChanged(pos);
 
 	UI.Minimap.UpdateXY(pos);
 	FixNeighbors(MapFieldRocks, 0, pos);
@@ -651,6 +662,7 @@ void CMap::RegenerateForestTile(const Vec2i &pos)
 		mf.playerInfo.SeenTile = mf.getGraphicTile();
 		mf.Value = 100; // TODO: Should be DefaultResourceAmounts[WoodCost] once all games are migrated
 		mf.setFlag(MapFieldForest | MapFieldUnpassable);
+		PathfinderTerrainChanged(pos + offset, Vec2i(1, 2));
 		UI.Minimap.UpdateSeenXY(pos);
 		UI.Minimap.UpdateXY(pos);
 		if (mf.playerInfo.IsTeamVisible(*ThisPlayer)) {
@@ -705,6 +717,8 @@ void CMap::Insert(CUnit &unit)
 		} while (--j && unit.tilePos.x + (j - w) < Info.MapWidth);
 		index += Info.MapWidth;
 	} while (--i && unit.tilePos.y + (i - h) < Info.MapHeight);
+	UnitIndex.Insert(unit);
+	Influence.AddUnit(unit);
 }
 
 /**
@@ -724,11 +738,27 @@ void CMap::Remove(CUnit &unit)
 		CMapField *mf = Field(index);
 		int j = w;
 		do {
-			ranges::erase(mf->UnitCache, &unit);
+			mf->UnitCache.Remove(&unit);
 			++mf;
 		} while (--j && unit.tilePos.x + (j - w) < Info.MapWidth);
 		index += Info.MapWidth;
 	} while (--i && unit.tilePos.y + (i - h) < Info.MapHeight);
+	UnitIndex.Remove(unit);
+	Influence.RemoveUnit(unit);
+}
+
+/**
+**  Update the unit index and the influence of a unit on the map.
+**
+**  @param unit  Unit whose owner, type or stats changed without moving.
+*/
+void CMap::UnitChanged(CUnit &unit)
+{
+	UnitIndex.Update(unit);
+	if (unit.Influence.Player != -1) {
+		Influence.RemoveUnit(unit);
+		Influence.AddUnit(unit);
+	}
 }
 
 void CMap::Clamp(Vec2i &pos) const
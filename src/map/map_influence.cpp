@@ -0,0 +1,249 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+/**@name map_influence.cpp - Threat and presence of the players. */
+//
+//      (c) Copyright 2026 by the Stratagus Developers
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+//@{
+
+/*----------------------------------------------------------------------------
+--  Includes
+----------------------------------------------------------------------------*/
+
+#include "stratagus.h"
+
+#include "influence.h"
+
+#include "actions.h"
+#include "player.h"
+#include "unit.h"
+#include "unittype.h"
+
+/*----------------------------------------------------------------------------
+--  Functions
+----------------------------------------------------------------------------*/
+
+/**
+**  Allocate the cells of the influence map.
+**
+**  @param mapWidth   Width of the map in tiles.
+**  @param mapHeight  Height of the map in tiles.
+*/
+void CInfluenceMap::Init(int mapWidth, int mapHeight)
+{
+	cellsX = (mapWidth + CellSize - 1) >> CellShift;
+	cellsY = (mapHeight + CellSize - 1) >> CellShift;
+	maxUnitSize = 1;
+	threats.assign(cellsX * cellsY * PlayerMax, 0);
+	presences.assign(cellsX * cellsY * PlayerMax, 0);
+}
+
+/**
+**  Free the cells of the influence map.
+*/
+void CInfluenceMap::Clear()
+{
+	cellsX = 0;
+	cellsY = 0;
+	maxUnitSize = 1;
+	threats.clear();
+	presences.clear();
+}
+
+void CInfluenceMap::AddThreat(int player, const Vec2i &minPos, const Vec2i &maxPos, int threat)
+{
+	const int minCellX = std::max(0, minPos.x >> CellShift);
+	const int minCellY = std::max(0, minPos.y >> CellShift);
+	const int maxCellX = std::min(cellsX - 1, maxPos.x >> CellShift);
+	const int maxCellY = std::min(cellsY - 1, maxPos.y >> CellShift);
+
+	for (int cellY = minCellY; cellY <= maxCellY; ++cellY) {
+		for (int cellX = minCellX; cellX <= maxCellX; ++cellX) {
+			threats[(cellX + cellY * cellsX) * PlayerMax + player] += threat;
+		}
+	}
+}
+
+/**
+**  Add the threat and the presence of a unit placed on the map.
+**
+**  @param unit  Unit which is placed.
+*/
+void CInfluenceMap::AddUnit(CUnit &unit)
+{
+	Assert(unit.Influence.Player == -1);
+	if (threats.empty()) {
+		return;
+	}
+	const int player = unit.Player->Index;
+	auto &influence = unit.Influence;
+
+	influence.Player = player;
+	influence.Pos = unit.tilePos;
+	presences[GetCellIndex(unit.tilePos) * PlayerMax + player] += 1;
+	maxUnitSize = std::max<int>({maxUnitSize, unit.Type->TileWidth, unit.Type->TileHeight});
+
+	// Dying units and corpses are present, but no more a threat.
+	influence.Threat = 0;
+	const bool dying = unit.Destroyed || (!unit.Orders.empty() && unit.CurrentAction() == UnitAction::Die);
+	if (unit.Type->CanAttack && unit.Stats && !dying) {
+		const int range = unit.Stats->Variables[ATTACKRANGE_INDEX].Max;
+		const int damage = unit.Stats->Variables[BASICDAMAGE_INDEX].Value
+		                 + unit.Stats->Variables[PIERCINGDAMAGE_INDEX].Value;
+
+		influence.Threat = std::max(0, damage) * std::max(1, range);
+		influence.MinPos = unit.tilePos - Vec2i(range, range);
+		influence.MaxPos = unit.tilePos + Vec2i(unit.Type->TileWidth - 1 + range, unit.Type->TileHeight - 1 + range);
+		AddThreat(player, influence.MinPos, influence.MaxPos, influence.Threat);
+	}
+}
+
+/**
+**  Remove what a unit added to the influence map.
+**
+**  @param unit  Unit which is removed, or whose owner or type changed.
+*/
+void CInfluenceMap::RemoveUnit(CUnit &unit)
+{
+	auto &influence = unit.Influence;
+
+	if (influence.Player == -1) {
+		return;
+	}
+	presences[GetCellIndex(influence.Pos) * PlayerMax + influence.Player] -= 1;
+	if (influence.Threat != 0) {
+		AddThreat(influence.Player, influence.MinPos, influence.MaxPos, -influence.Threat);
+	}
+	influence.Player = -1;
+	influence.Threat = 0;
+}
+
+/**
+**  Get the threat of the units of a player on a tile.
+**
+**  @param player  Index of the player.
+**  @param pos     Tile on the map.
+*/
+int CInfluenceMap::GetThreat(int player, const Vec2i &pos) const
+{
+	return threats.empty() ? 0 : threats[GetCellIndex(pos) * PlayerMax + player];
+}
+
+/**
+**  Get the number of units of a player in the cell of a tile.
+**
+**  @param player  Index of the player.
+**  @param pos     Tile on the map.
+*/
+int CInfluenceMap::GetPresence(int player, const Vec2i &pos) const
+{
+	return presences.empty() ? 0 : presences[GetCellIndex(pos) * PlayerMax + player];
+}
+
+/**
+**  Get the threat on a tile of the units which will attack a player.
+**
+**  @param player  Player who is threatened.
+**  @param pos     Tile on the map.
+*/
+int CInfluenceMap::GetEnemyThreat(const CPlayer &player, const Vec2i &pos) const
+{
+	if (threats.empty()) {
+		return 0;
+	}
+	const int *cell = &threats[GetCellIndex(pos) * PlayerMax];
+	int threat = 0;
+
+	for (int i = 0; i != PlayerMax; ++i) {
+		if (cell[i] != 0 && Players[i].IsEnemy(player)) {
+			threat += cell[i];
+		}
+	}
+	return threat;
+}
+
+/**
+**  Get the number of units of a player and of its allies in the cell of a tile.
+**
+**  @param player  Player whose presence is asked.
+**  @param pos     Tile on the map.
+*/
+int CInfluenceMap::GetFriendlyPresence(const CPlayer &player, const Vec2i &pos) const
+{
+	if (presences.empty()) {
+		return 0;
+	}
+	const int *cell = &presences[GetCellIndex(pos) * PlayerMax];
+	int presence = 0;
+
+	for (int i = 0; i != PlayerMax; ++i) {
+		if (cell[i] != 0 && (i == player.Index || player.IsAllied(i))) {
+			presence += cell[i];
+		}
+	}
+	return presence;
+}
+
+/**
+**  Get the number of units which are enemies of a player in the cells
+**  overlapping an area. It is 0 if no enemy unit stands in the area.
+**
+**  @param player  Player whose enemies are counted.
+**  @param ltPos   Top left of the area.
+**  @param rbPos   Bottom right of the area.
+*/
+int CInfluenceMap::GetEnemyPresence(const CPlayer &player, const Vec2i &ltPos, const Vec2i &rbPos) const
+{
+	if (presences.empty()) {
+		return 0;
+	}
+	// Units are counted in the cell of their top left tile.
+	const int minCellX = std::max(0, (ltPos.x - maxUnitSize + 1) >> CellShift);
+	const int minCellY = std::max(0, (ltPos.y - maxUnitSize + 1) >> CellShift);
+	const int maxCellX = std::min(cellsX - 1, rbPos.x >> CellShift);
+	const int maxCellY = std::min(cellsY - 1, rbPos.y >> CellShift);
+	unsigned int enemies = 0;
+	int presence = 0;
+
+	for (int i = 0; i != PlayerMax; ++i) {
+		if (Players[i].IsEnemy(player)) {
+			enemies |= 1 << i;
+		}
+	}
+	for (int cellY = minCellY; cellY <= maxCellY; ++cellY) {
+		for (int cellX = minCellX; cellX <= maxCellX; ++cellX) {
+			const int *cell = &presences[(cellX + cellY * cellsX) * PlayerMax];
+			for (int i = 0; i != PlayerMax; ++i) {
+				if (enemies & (1 << i)) {
+					presence += cell[i];
+				}
+			}
+		}
+	}
+	return presence;
+}
+
+//@}
@@ -35,6 +35,7 @@
 
 #include "fov.h"
 #include "map.h"
+#include "pathfinder.h"
 #include "player.h"
 #include "stratagus.h"
 #include "tileset.h"
@@ -221,6 +222,7 @@ void CMap::RemoveWall(const Vec2i &pos)
 	MapFixWallTile(pos);
 	mf.resetFlag(MapFieldHuman | MapFieldWall | MapFieldUnpassable | MapFieldOpaque);
 	MapFixWallNeighbors(pos);
+	PathfinderTerrainChanged(pos);
 	UI.Minimap.UpdateXY(pos);
 
 	if (mf.playerInfo.IsTeamVisible(*ThisPlayer)) {
@@ -258,6 +260,7 @@ void CMap::SetWall(const Vec2i &pos, bool humanwall)
 	UI.Minimap.UpdateXY(pos);
 	MapFixWallTile(pos);
 	MapFixWallNeighbors(pos);
+	PathfinderTerrainChanged(pos);
 
 	/// Refresh vision of nearby units in case is walls are set as opaque field
 	if (isOpaque) {
@@ -46,6 +46,140 @@
 #include "unit.h"
 #include "unit_manager.h"
 
+#include <array>
+
+/*----------------------------------------------------------------------------
+--  CUnitCache
+----------------------------------------------------------------------------*/
+
+/**
+**  Blocks of units given back by the caches, by capacity.
+**  The block of capacity 4 << i is in the list i.
+*/
+static std::vector<CUnit **> &UnitCacheFreeBlocks(uint32_t capacity)
+{
+	// Never destroyed, the fields of Map may give their blocks back at exit.
+	static auto *freeBlocks = new std::array<std::vector<CUnit **>, 30>;
+	size_t i = 0;
+
+	while ((4u << i) < capacity) {
+		++i;
+	}
+	return (*freeBlocks)[i];
+}
+
+static CUnit **AcquireUnitCacheBlock(uint32_t capacity)
+{
+	auto &freeBlocks = UnitCacheFreeBlocks(capacity);
+
+	if (freeBlocks.empty()) {
+		return new CUnit *[capacity];
+	}
+	CUnit **block = freeBlocks.back();
+	freeBlocks.pop_back();
+	return block;
+}
+
+CUnitCache::CUnitCache(const CUnitCache &rhs)
+{
+	*this = rhs;
+}
+
+CUnitCache::CUnitCache(CUnitCache &&rhs) noexcept
+{
+	*this = std::move(rhs);
+}
+
+CUnitCache &CUnitCache::operator=(const CUnitCache &rhs)
+{
+	if (this == &rhs) {
+		return *this;
+	}
+	Release();
+	if (rhs.count > InlineCapacity) {
+		units = AcquireUnitCacheBlock(rhs.capacity);
+		capacity = rhs.capacity;
+	}
+	std::copy(rhs.begin(), rhs.end(), Data());
+	count = rhs.count;
+	return *this;
+}
+
+CUnitCache &CUnitCache::operator=(CUnitCache &&rhs) noexcept
+{
+	if (this == &rhs) {
+		return *this;
+	}
+	Release();
+	if (rhs.capacity == InlineCapacity) {
+		std::copy(rhs.begin(), rhs.end(), inlineUnits);
+	} else {
+		units = rhs.units;
+		capacity = rhs.capacity;
+		rhs.capacity = InlineCapacity;
+	}
+	count = rhs.count;
+	rhs.count = 0;
+	return *this;
+}
+
+void CUnitCache::Grow()
+{
+	const uint32_t newCapacity = capacity * 2;
+	CUnit **block = AcquireUnitCacheBlock(newCapacity);
+
+	std::copy(begin(), end(), block);
+	Release();
+	units = block;
+	capacity = newCapacity;
+}
+
+/**
+**  Give the block back to the pool, the cache is inline again.
+**  The units are lost, the count is kept.
+*/
+void CUnitCache::Release()
+{
+	if (capacity != InlineCapacity) {
+		UnitCacheFreeBlocks(capacity).push_back(units);
+		capacity = InlineCapacity;
+	}
+}
+
+/**
+**  Remove a unit from the cache.
+**
+**  @param unit  Unit to remove, nothing is done if it is not in the cache.
+*/
+void CUnitCache::Remove(const CUnit *unit)
+{
+	const iterator it = std::find(begin(), end(), unit);
+
+	if (it == end()) {
+		return;
+	}
+	std::copy(it + 1, end(), it);
+	--count;
+	if (count <= InlineCapacity && capacity != InlineCapacity) {
+		// Back inside the field, the block is free for another one.
+		CUnit **block = units;
+
+		std::copy(block, block + count, inlineUnits);
+		UnitCacheFreeBlocks(capacity).push_back(block);
+		capacity = InlineCapacity;
+	}
+}
+
+void CUnitCache::clear()
+{
+	Release();
+	count = 0;
+}
+
+/*----------------------------------------------------------------------------
+--  CMapField
+----------------------------------------------------------------------------*/
+
 bool CMapField::IsTerrainResourceOnMap(int resource) const
 {
 	switch (resource) {
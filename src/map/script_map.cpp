@@ -41,6 +41,9 @@
 #include "iolib.h"
 #include "netconnect.h"
 #include "network.h"
+#include "parameters.h"
+#include "pathfinder.h"
+#include "player.h"
 #include "script.h"
 #include "tileset.h"
 #include "translate.h"
@@ -92,8 +95,7 @@ static int CclStratagusMap(lua_State *l)
 					CclGetPos(l, &Map.Info.MapWidth, &Map.Info.MapHeight);
 					lua_pop(l, 1);
 
-					Map.Fields.resize(Map.Info.MapWidth * Map.Info.MapHeight);
-					// FIXME: this should be CreateMap or InitMap?
+					Map.Create();
 				} else if (value == "fog-of-war") {
 					Map.NoFogOfWar = false;
 					--k;
@@ -836,9 +838,11 @@ void SetTile(const unsigned int tileIndex, const Vec2i &pos, const int value, co
 					mf.setTileIndex(Map.Tileset, tileIndex, value, uint8_t(elevation), subtile++);
 				}
 			}
+			PathfinderTerrainChanged(pos, Vec2i(multiplier, multiplier));
 		} else {
 			CMapField &mf = *Map.Field(pos);
 			mf.setTileIndex(Map.Tileset, tileIndex, value, uint8_t(elevation));
+			PathfinderTerrainChanged(pos);
 		}
 	}
 }
@@ -917,7 +921,9 @@ static int CclDefineTileset(lua_State *l)
 
 	ShowLoadProgress(_("Tileset '%s'"), Map.Tileset.ImageFile.c_str());
 	Map.TileGraphic = CGraphic::New(Map.Tileset.ImageFile, Map.Tileset.getPixelTileSize().x, Map.Tileset.getPixelTileSize().y);
-	Map.TileGraphic->Load();
+	if (!Parameters::Instance.headless) {
+		Map.TileGraphic->Load();
+	}
 	return 0;
 }
 
@@ -1067,6 +1073,56 @@ static int CclGetTileTerrainHasFlag(lua_State *l)
 	return 1;
 }
 
+/**
+**  Get the player and the tile given to the influence map functions.
+*/
+static std::pair<const CPlayer *, Vec2i> CclGetInfluenceArgs(lua_State *l)
+{
+	LuaCheckArgs(l, 3);
+
+	lua_pushvalue(l, 1);
+	const CPlayer *player = CclGetPlayer(l);
+	lua_pop(l, 1);
+	if (player == nullptr) {
+		LuaError(l, "bad player");
+	}
+	const Vec2i pos(LuaToNumber(l, 2), LuaToNumber(l, 3));
+	if (!Map.Info.IsPointOnMap(pos)) {
+		LuaError(l, "bad position: %d, %d", pos.x, pos.y);
+	}
+	return {player, pos};
+}
+
+/**
+**  Get the threat on a tile of the units which are enemies of a player.
+**
+**  @param l  Lua state.
+**
+**  @return   Sum of damage x attack range of the enemies which reach the area of the tile.
+*/
+static int CclGetEnemyThreat(lua_State *l)
+{
+	const auto [player, pos] = CclGetInfluenceArgs(l);
+
+	lua_pushnumber(l, Map.Influence.GetEnemyThreat(*player, pos));
+	return 1;
+}
+
+/**
+**  Get the number of units of a player and its allies around a tile.
+**
+**  @param l  Lua state.
+**
+**  @return   Number of units in the area of the tile.
+*/
+static int CclGetFriendlyPresence(lua_State *l)
+{
+	const auto [player, pos] = CclGetInfluenceArgs(l);
+
+	lua_pushnumber(l, Map.Influence.GetFriendlyPresence(*player, pos));
+	return 1;
+}
+
 /**
 **  Enable walls enabled for single player games (for debug purposes)
 **
@@ -1227,6 +1283,9 @@ void MapCclRegister()
 	lua_register(Lua, "GetTileTerrainName", CclGetTileTerrainName);
 	lua_register(Lua, "GetTileTerrainHasFlag", CclGetTileTerrainHasFlag);
 
+	lua_register(Lua, "GetEnemyThreat", CclGetEnemyThreat);
+	lua_register(Lua, "GetFriendlyPresence", CclGetFriendlyPresence);
+
 	lua_register(Lua, "SetEnableWallsForSP", CclSetEnableWallsForSP);
 	lua_register(Lua, "GetIsWallsEnabledForSP", CclIsWallsEnabledForSP);
 
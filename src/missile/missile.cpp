@@ -45,6 +45,7 @@
 #include "player.h"
 #include "sound.h"
 #include "spells.h"
+#include "sync_digest.h"
 #include "trigger.h"
 #include "ui.h"
 #include "unit.h"
@@ -1262,6 +1263,28 @@ void SaveMissiles(CFile &file)
 	}
 }
 
+/**
+**  Digest of the state of the global missiles, to detect desyncs.
+**
+**  Local missiles are not the same on all computers and are left out.
+*/
+uint32_t GlobalMissilesSyncDigest()
+{
+	uint32_t digest = SyncDigestBasis;
+
+	for (const auto &missile : GlobalMissiles) {
+		digest = SyncDigestMix(digest, missile->position.x);
+		digest = SyncDigestMix(digest, missile->position.y);
+		digest = SyncDigestMix(digest, missile->destination.x);
+		digest = SyncDigestMix(digest, missile->destination.y);
+		digest = SyncDigestMix(digest, missile->State);
+		digest = SyncDigestMix(digest, missile->Damage);
+		digest = SyncDigestMix(digest, missile->TTL);
+		digest = SyncDigestMix(digest, missile->CurrentStep);
+	}
+	return digest;
+}
+
 /**
 **  Initialize missile type.
 */
@@ -745,6 +745,9 @@ size_t CNetworkCommandSync::Serialize(unsigned char *buf) const
 	unsigned char *p = buf;
 	p += serialize32(p, this->syncSeed);
 	p += serialize32(p, this->syncHash);
+	for (auto digest : this->digests) {
+		p += serialize32(p, digest);
+	}
 	return p - buf;
 }
 
@@ -753,6 +756,41 @@ size_t CNetworkCommandSync::Deserialize(const unsigned char *buf)
 	const unsigned char *p = buf;
 	p += deserialize32(p, &this->syncSeed);
 	p += deserialize32(p, &this->syncHash);
+	for (auto &digest : this->digests) {
+		p += deserialize32(p, &digest);
+	}
+	return p - buf;
+}
+
+//
+// CNetworkSyncBisect
+//
+
+size_t CNetworkSyncBisect::Serialize(unsigned char *buf) const
+{
+	unsigned char *p = buf;
+	p += serialize32(p, this->cycle);
+	p += serialize32(p, this->lo);
+	p += serialize32(p, this->hi);
+	for (auto digest : this->digests) {
+		p += serialize32(p, digest);
+	}
+	p += serialize8(p, this->player);
+	p += serialize8(p, this->last);
+	return p - buf;
+}
+
+size_t CNetworkSyncBisect::Deserialize(const unsigned char *buf)
+{
+	const unsigned char *p = buf;
+	p += deserialize32(p, &this->cycle);
+	p += deserialize32(p, &this->lo);
+	p += deserialize32(p, &this->hi);
+	for (auto &digest : this->digests) {
+		p += deserialize32(p, &digest);
+	}
+	p += deserialize8(p, &this->player);
+	p += deserialize8(p, &this->last);
 	return p - buf;
 }
 
@@ -235,6 +235,7 @@
 #include "player.h"
 #include "replay.h"
 #include "sound.h"
+#include "sync_digest.h"
 #include "translate.h"
 #include "unit.h"
 #include "unit_manager.h"
@@ -303,6 +304,7 @@ static unsigned long NetworkLastCycle[PlayerMax]; /// Last cycle received packet
 static unsigned int NetworkSyncSeeds[256];          /// Network sync seeds.
 static unsigned int NetworkSyncHashs[256];          /// Network sync hashs.
 static unsigned long NetworkSyncCycles[256];        /// Game cycle sampled for sync data.
+static CSyncSnapshot NetworkSyncSnapshots[256];     /// Game state digests sampled for sync data.
 static unsigned long NetworkFirstDesyncGameCycle;   /// First cycle that detected a desync.
 static unsigned long NetworkFirstDesyncSampleCycle; /// First sampled cycle that diverged.
 static bool NetworkGameInSync = true;               /// Last sync command comparison result.
@@ -520,6 +522,10 @@ void NetworkOnStartGame()
 	ranges::fill(NetworkSyncSeeds, 0);
 	ranges::fill(NetworkSyncHashs, 0);
 	ranges::fill(NetworkSyncCycles, 0);
+	for (auto &snapshot : NetworkSyncSnapshots) {
+		snapshot.Clear();
+	}
+	ResetSyncDigests();
 	NetworkFirstDesyncGameCycle = 0;
 	NetworkFirstDesyncSampleCycle = 0;
 	NetworkGameInSync = true;
@@ -801,6 +807,94 @@ static bool IsAValidCommand(const CNetworkPacket &packet, int index, const int p
 	// FIXME: not all values in nc have been validated
 }
 
+/**
+**  Send our digests of a unit slot range of a sampled cycle to a player.
+**
+**  @param player  Player to send the digests to.
+**  @param cycle   Game cycle which executed the diverging sync.
+**  @param lo      First unit slot of the range.
+**  @param hi      End of the unit slot range.
+**  @param last    True if the receiver must not answer.
+*/
+static void NetworkSendSyncBisect(int player, unsigned long cycle, uint32_t lo, uint32_t hi, bool last)
+{
+	CNetworkSyncBisect nsb;
+	nsb.cycle = cycle;
+	nsb.lo = lo;
+	nsb.hi = hi;
+	nsb.digests = NetworkSyncSnapshots[cycle & 0xFF].RangeDigests(lo, hi);
+	nsb.player = player;
+	nsb.last = last;
+
+	CNetworkPacket packet;
+	packet.Header.Cycle = cycle & 0xFF;
+	packet.Header.OrigPlayer = ThisPlayer->Index;
+	packet.Header.Type[0] = MessageSyncBisect;
+	for (int i = 1; i < MaxNetworkCommands; ++i) {
+		packet.Header.Type[i] = MessageNone;
+	}
+	packet.Command[0].resize(nsb.Size());
+	nsb.Serialize(&packet.Command[0][0]);
+	NetworkBroadcast(packet, 1);
+}
+
+/**
+**  Bisect the unit digests of a desync with another player.
+**
+**  Both hosts answer with their digests of the first differing quarter of
+**  the range, so the range shrinks 4 times per message until a single unit
+**  slot is left, whose field digests tell what diverged.
+**  This does not depend on game cycles, so it works while the game is paused.
+**
+**  @param data    Serialized CNetworkSyncBisect.
+**  @param player  Player who sent the digests.
+*/
+static void ParseSyncBisectCommand(const std::vector<unsigned char> &data, int player)
+{
+	if (data.size() != CNetworkSyncBisect::Size()) {
+		DebugPrint("Bad sync bisect message\n");
+		return;
+	}
+	CNetworkSyncBisect nsb;
+	nsb.Deserialize(&data[0]);
+	if (nsb.player != ThisPlayer->Index || nsb.lo >= nsb.hi || nsb.hi > SyncUnitSlotCount) {
+		return;
+	}
+	// The snapshot of a cycle is taken NetworkLag cycles before it, in the same ring slot.
+	const unsigned long lag = CNetworkParameter::Instance.NetworkLag;
+	if (nsb.cycle >= GameCycle + lag || GameCycle + lag >= nsb.cycle + 0x100) {
+		ErrorPrint("Desync bisection with player %d: cycle %u is not kept anymore\n", player, nsb.cycle);
+		return;
+	}
+	const UnitSyncDigests local = NetworkSyncSnapshots[nsb.cycle & 0xFF].RangeDigests(nsb.lo, nsb.hi);
+	const auto diff = FirstSyncDifference(nsb.digests, local);
+
+	if (!diff) {
+		ErrorPrint("Desync bisection with player %d: no difference in unit slots [%u, %u)\n",
+		           player, nsb.lo, nsb.hi);
+		return;
+	}
+	if (nsb.hi - nsb.lo == 1) {
+		const unsigned int slot = nsb.lo;
+		const CUnit *unit = slot < UnitManager->GetUsedSlotCount() ? &UnitManager->GetSlotUnit(slot) : nullptr;
+
+		ErrorPrint("Desync bisection with player %d: first differing unit is slot %u (%s), "
+		           "field %s: %X!=%X\n",
+		           player,
+		           slot,
+		           unit && unit->Type ? unit->Type->Ident.c_str() : "none",
+		           UnitSyncFieldName(static_cast<EUnitSyncField>(*diff)),
+		           nsb.digests[*diff],
+		           local[*diff]);
+		if (!nsb.last) {
+			NetworkSendSyncBisect(player, nsb.cycle, nsb.lo, nsb.hi, true);
+		}
+		return;
+	}
+	const auto [lo, hi] = SyncRangeQuarter(nsb.lo, nsb.hi, *diff);
+	NetworkSendSyncBisect(player, nsb.cycle, lo, hi, false);
+}
+
 static void NetworkParseInGameEvent(const unsigned char *buf, int len, const CHost &host)
 {
 	if (!ThisPlayer) {
@@ -849,6 +943,10 @@ static void NetworkParseInGameEvent(const unsigned char *buf, int len, const CHo
 			ParseResendCommand(packet);
 			return;
 		}
+		if (packet.Header.Type[i] == MessageSyncBisect) {
+			ParseSyncBisectCommand(packet.Command[i], player);
+			return;
+		}
 		// Receive statistic
 		NetworkLastFrame[player] = FrameCounter;
 
@@ -960,8 +1058,9 @@ static void NetworkExecCommand_Sync(const CNetworkCommandQueue &ncq, int player)
 	const unsigned int localSeed = NetworkSyncSeeds[gameNetCycle & 0xFF];
 	const unsigned int localHash = NetworkSyncHashs[gameNetCycle & 0xFF];
 	const unsigned long sampledCycle = NetworkSyncCycles[gameNetCycle & 0xFF];
+	const SyncDigests &localDigests = NetworkSyncSnapshots[gameNetCycle & 0xFF].Digests;
 
-	if (syncSeed != localSeed || syncHash != localHash) {
+	if (syncSeed != localSeed || syncHash != localHash || nc.digests != localDigests) {
 		// if it wasn't already, force enable debug output right now. maybe we get lucky ...
 		EnableDebugPrint = true;
 		EnableUnitDebug = true;
@@ -970,15 +1069,6 @@ static void NetworkExecCommand_Sync(const CNetworkCommandQueue &ncq, int player)
 			SetMessage("%s", _("Network out of sync"));
 			NetworkGameInSync = false;
 			SetGamePaused(true);
-
-			time_t now;
-			time(&now);
-			std::string savefile = "desync_savegame_";
-			savefile += std::to_string(ThisPlayer->Index);
-			savefile += "_";
-			savefile += std::to_string((intmax_t)now);
-			savefile += ".sav";
-			SaveGame(savefile);
 		}
 		if (!NetworkFirstDesyncGameCycle) {
 			NetworkFirstDesyncGameCycle = gameNetCycle;
@@ -994,6 +1084,18 @@ static void NetworkExecCommand_Sync(const CNetworkCommandQueue &ncq, int player)
 			           CNetworkParameter::Instance.NetworkLag,
 			           CNetworkParameter::Instance.gameCyclesPerUpdate);
 			DumpSyncDebugCycleHistory(sampledCycle, syncSeed, localSeed, syncHash, localHash);
+			for (std::size_t i = 0; i != SyncPartCount; ++i) {
+				if (nc.digests[i] != localDigests[i]) {
+					ErrorPrint("Desync in %s: %X!=%X\n",
+					           SyncPartName(static_cast<ESyncPart>(i)),
+					           nc.digests[i],
+					           localDigests[i]);
+				}
+			}
+			if (nc.digests[static_cast<std::size_t>(ESyncPart::Units)]
+			    != localDigests[static_cast<std::size_t>(ESyncPart::Units)]) {
+				NetworkSendSyncBisect(player, gameNetCycle, 0, SyncUnitSlotCount, false);
+			}
 		}
 		ErrorPrint("\nNetwork out of sync seed: %X!=%X , hash: %X!=%X "
 		           "Cycle %lu sampled-after-cycle %lu first-desync-cycle %lu "
@@ -1101,12 +1203,19 @@ static void NetworkSendCommands(unsigned long gameNetCycle)
 	// No command available, send sync.
 	int numcommands = 0;
 	CNetworkCommandQueue(&ncq)[MaxNetworkCommands] = NetworkIn[gameNetCycle & 0xFF][ThisPlayer->Index];
+	CSyncSnapshot &snapshot = NetworkSyncSnapshots[gameNetCycle & 0xFF];
 	ncq[0].Clear();
+	if (IsNetworkGame()) {
+		snapshot.Take();
+	} else {
+		snapshot.Clear();
+	}
 	if (CommandsIn.empty() && MsgCommandsIn.empty()) {
 		CNetworkCommandSync nc;
 		ncq[0].Type = MessageSync;
 		nc.syncHash = SyncHash;
 		nc.syncSeed = SyncRandSeed;
+		nc.digests = snapshot.Digests;
 		ncq[0].Data.resize(nc.Size());
 		nc.Serialize(&ncq[0].Data[0]);
 		ncq[0].Time = gameNetCycle;
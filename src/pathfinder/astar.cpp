@@ -60,6 +60,7 @@
 # include "viewport.h"
 #endif
 
+#include <array>
 #include <cstdio>
 
 /*----------------------------------------------------------------------------
@@ -91,6 +92,99 @@ struct Open {
 	uint32_t Costs; /// complete costs to goal
 };
 
+/**
+**  State of an a* search.
+**
+**  Searches done with different contexts share nothing they modify, so
+**  they can run at the same time on different threads. The map and the
+**  configurable costs must not change while they run.
+**
+**  The Open set is handled by a stored array
+**  the end of the array holds the item with the smallest cost.
+**  Or, if AStarBucketOpenSet is set, by buckets indexed by the cost, each
+**  one a heap with the best tie-break on top: a node found again with a
+**  lower cost is only added again, the outdated entry is skipped when it
+**  reaches the top of its heap.
+*/
+class AStarContext
+{
+public:
+	void Init();
+	void Free();
+
+	int FindPath(const Vec2i &startPos, const Vec2i &goalPos, int gw, int gh,
+				 int tilesizex, int tilesizey, int minrange, int maxrange,
+				 char *path, int pathlen, const CUnit &unit);
+
+	const std::vector<Node> &GetMatrix() const { return Matrix; }
+	const AStarSearchStats &GetStats() const { return Stats; }
+
+public:
+	/// Temporary make fixed enemy units unpassable (needed to compute the real path length for automatic targeting)
+	bool FixedEnemyUnitsUnpassable = false;
+
+private:
+	void Prepare();
+	void CleanUp();
+	void CostMoveToCacheCleanUp();
+	void RemoveMinimum(int pos);
+	int AddNode(const Vec2i &pos, int64_t costs);
+	void ReplaceNode(int pos);
+	int FindNode(int eo) const;
+	bool PopMinimum(Vec2i &pos);
+	int AddBucketNode(const Vec2i &pos, int64_t costs);
+	bool PopBucketMinimum(Vec2i &pos);
+	void BucketsCleanUp();
+	int CostMoveToCallBack(unsigned int index, const CUnit &unit) const;
+	void SetDebugCost(const CMapField &mf, int64_t cost) const;
+	int CostMoveTo(unsigned int index, const CUnit &unit);
+	bool MarkGoal(const Vec2i &goal, int gw, int gh, int tilesizex, int tilesizey,
+				  int minrange, int maxrange, const CUnit &unit);
+	int SavePath(const Vec2i &startPos, const Vec2i &endPos, char *path, int pathLen) const;
+	int FindSimplePath(const Vec2i &startPos, const Vec2i &goal, int gw, int gh,
+					   int minrange, int maxrange, char *path, const CUnit &unit) const;
+	int FindJumpPath(const Vec2i &startPos, const Vec2i &goalPos, int gw, int gh,
+					 int tilesizex, int tilesizey, int minrange, int maxrange,
+					 char *path, int pathlen, const CUnit &unit);
+	bool IsJumpBlocked(const Vec2i &pos, const CUnit &unit);
+	bool HasForcedNeighbour(const Vec2i &pos, int dir, const CUnit &unit);
+	bool Jump(Vec2i &pos, int dir, int &steps, int maxSteps, const CUnit &unit);
+	void FillJumps(const Vec2i &startPos, const Vec2i &endPos);
+
+private:
+	std::vector<Node> Matrix;             /// cost matrix
+	std::vector<Open> OpenSet;            /// The set of Open nodes
+	int OpenSetSize = 0;                  /// The size of the open node set
+	std::vector<int32_t> CostMoveToCache; /// CostMoveTo of each tile (+1), CacheNotSet if unknown
+	int GoalX = 0;
+	int GoalY = 0;
+	AStarSearchStats Stats;               /// Counters of the last search
+	const CPassabilityPlane *Passability = nullptr; /// Terrain of the unit, if it is known
+
+	struct BucketEntry {
+		Vec2i Pos;
+		uint32_t Costs;      /// complete costs to goal
+		uint16_t CostToGoal; /// Estimated cost to goal
+		uint16_t Dist;       /// Manhattan distance to goal
+
+		/// Heap order of a bucket, the best entry is on top
+		static bool IsWorse(const BucketEntry &lhs, const BucketEntry &rhs)
+		{
+			return std::tie(lhs.Costs, lhs.CostToGoal, lhs.Dist) > std::tie(rhs.Costs, rhs.CostToGoal, rhs.Dist);
+		}
+	};
+	bool UseBuckets = false;                       /// Open set in buckets for the current search
+	std::vector<std::vector<BucketEntry>> Buckets; /// Open nodes by costs
+	size_t BucketMin = 0;                          /// Buckets below are empty
+	size_t BucketMax = 0;                          /// Buckets above are empty
+
+	std::vector<uint32_t> JumpParents; /// Jump point from which each jump point was reached
+	Vec2i JumpMapMax;                  /// Positions past it can't be reached
+	int JumpUniformCost = 0;           /// The cost of every tile in a uniform area
+	int JumpCounter = 0;               /// Jump points the search may still add
+	bool JumpNotUniform = false;       /// A tile with another cost was seen, use a*
+};
+
 /// heuristic cost function for a*
 static inline int AStarCosts(const Vec2i &pos, const Vec2i &goalPos)
 {
@@ -114,9 +208,6 @@ const int Heading2Y[9] = { -1, -1, 0, +1, +1, +1, 0, -1, 0 };
 int Heading2O[9];//heading to offset
 const int XY2Heading[3][3] = { {7, 6, 5}, {0, 0, 4}, {1, 2, 3}};
 
-/// cost matrix
-static std::vector<Node> AStarMatrix;
-
 /// a list of close nodes, helps to speed up the matrix cleaning
 #define MAX_CLOSE_SET_RATIO 4
 #define MAX_OPEN_SET_RATIO 8 // 10,16 to small
@@ -127,27 +218,26 @@ int AStarMovingUnitCrossingCost = 5;
 int AStarMaxSearchIterations = 1024 * 5;
 bool AStarKnowUnseenTerrain = false;
 int AStarUnknownTerrainCost = 2;
-/// Used to temporary make enemy units unpassable (needs for correct path length calculating for automatic targeting algorithm)
-static bool AStarFixedEnemyUnitsUnpassable = false;
+/// Use the bucket open set instead of the stored array
+static bool AStarBucketOpenSet = false;
+/// Use jump point search when the area has a uniform cost
+static bool AStarJumpPointSearch = false;
 
 static int AStarMapWidth;
 static int AStarMapHeight;
 
-static int AStarGoalX;
-static int AStarGoalY;
-
-/**
-**  The Open set is handled by a stored array
-**  the end of the array holds the item with the smallest cost.
-*/
-
-/// The set of Open nodes
-static std::vector<Open> OpenSet;
-/// The size of the open node set
-static int OpenSetSize;
-
-static std::vector<int32_t> CostMoveToCache;
 static constexpr int CacheNotSet = -1;
+/// A jump stops after this many moves
+static constexpr int JumpMaxSteps = 32;
+/// Moves of the straight scans done at each step of a diagonal jump
+static constexpr int JumpMaxSideSteps = 4;
+/// Nodes with higher costs all share the last bucket
+static constexpr size_t MaxBuckets = 1 << 16;
+
+/// Context of the searches done by the main thread
+static AStarContext MainAStarContext;
+/// Contexts of the worker threads used by AStarFindPaths
+static std::vector<std::unique_ptr<AStarContext>> WorkerAStarContexts;
 
 /*----------------------------------------------------------------------------
 --  Profile
@@ -202,6 +292,10 @@ inline void ProfileInit()
 
 inline void ProfileBegin(const char *const function)
 {
+	if (omp_get_num_threads() > 1) {
+		// The maps aren't shared with the workers of AStarFindPaths.
+		return;
+	}
 	LARGE_INTEGER counter;
 	if (!QueryPerformanceCounter(&counter)) {
 		return;
@@ -211,6 +305,9 @@ inline void ProfileBegin(const char *const function)
 
 inline void ProfileEnd(const char *const function)
 {
+	if (omp_get_num_threads() > 1) {
+		return;
+	}
 	LARGE_INTEGER counter;
 	if (!QueryPerformanceCounter(&counter)) {
 		return;
@@ -331,20 +428,10 @@ uint32_t Open::GetOffset() const {
 */
 void InitAStar(int mapWidth, int mapHeight)
 {
-	// Should only be called once
-	Assert(AStarMatrix.empty());
-
 	AStarMapWidth = mapWidth;
 	AStarMapHeight = mapHeight;
 
-	AStarMatrix.resize(AStarMapWidth * AStarMapHeight);
-#ifdef DEBUG
-	for (auto& node : AStarMatrix) {
-		node.SetDirection(-1);
-	}
-#endif
-	OpenSet.resize(AStarMapWidth * AStarMapHeight / MAX_OPEN_SET_RATIO);
-	CostMoveToCache.resize(AStarMapWidth * AStarMapHeight, CacheNotSet);
+	MainAStarContext.Init();
 
 	for (int i = 0; i < 9; ++i) {
 		Heading2O[i] = Heading2Y[i] * AStarMapWidth;
@@ -358,22 +445,52 @@ void InitAStar(int mapWidth, int mapHeight)
 */
 void FreeAStar()
 {
-	AStarMatrix.clear();
+	MainAStarContext.Free();
+	WorkerAStarContexts.clear();
+	FreePassability();
+
+	ProfilePrint();
+}
+
+/**
+**  Allocate the data of a context for the current map size.
+*/
+void AStarContext::Init()
+{
+	// Should only be called once
+	Assert(Matrix.empty());
+
+	Matrix.resize(AStarMapWidth * AStarMapHeight);
+#ifdef DEBUG
+	for (auto& node : Matrix) {
+		node.SetDirection(-1);
+	}
+#endif
+	OpenSet.resize(AStarMapWidth * AStarMapHeight / MAX_OPEN_SET_RATIO);
+	CostMoveToCache.resize(AStarMapWidth * AStarMapHeight, CacheNotSet);
+	JumpParents.resize(AStarMapWidth * AStarMapHeight);
+}
+
+/**
+**  Free the data of a context.
+*/
+void AStarContext::Free()
+{
+	Matrix.clear();
 	OpenSet.clear();
 	OpenSetSize = 0;
 	CostMoveToCache.clear();
-
-	ProfilePrint();
+	JumpParents.clear();
 }
 
 /**
 **  Prepare pathfinder.
 */
-static void AStarPrepare()
+void AStarContext::Prepare()
 {
-	ranges::fill(AStarMatrix, Node{});
+	ranges::fill(Matrix, Node{});
 #ifdef DEBUG
-	for (auto& node : AStarMatrix) {
+	for (auto& node : Matrix) {
 		node.SetDirection(-1);
 	}
 #endif
@@ -382,20 +499,29 @@ static void AStarPrepare()
 /**
 **  Clean up A*
 */
-static void CostMoveToCacheCleanUp();
-static void AStarCleanUp()
+void AStarContext::CleanUp()
 {
 	ProfileBegin("AStarCleanUp");
-	AStarPrepare();
+	Prepare();
 	CostMoveToCacheCleanUp();
+	BucketsCleanUp();
 	ProfileEnd("AStarCleanUp");
 }
 
-static void CostMoveToCacheCleanUp()
+void AStarContext::CostMoveToCacheCleanUp()
 {
 	ranges::fill(CostMoveToCache, CacheNotSet);
 }
 
+void AStarContext::BucketsCleanUp()
+{
+	for (size_t i = BucketMin; i <= BucketMax && i < Buckets.size(); ++i) {
+		Buckets[i].clear();
+	}
+	BucketMin = Buckets.size();
+	BucketMax = 0;
+}
+
 /**
 **  Find the best node in the current open node set
 **  Returns the position of this node in the open node set
@@ -406,7 +532,7 @@ static void CostMoveToCacheCleanUp()
 /**
 **  Remove the minimum from the open node set
 */
-static void AStarRemoveMinimum(int pos)
+void AStarContext::RemoveMinimum(int pos)
 {
 	Assert(pos == OpenSetSize - 1);
 
@@ -418,8 +544,11 @@ static void AStarRemoveMinimum(int pos)
 **
 **  @return  0 or PF_FAILED
 */
-static inline int AStarAddNode(const Vec2i &pos, int64_t costs)
+int AStarContext::AddNode(const Vec2i &pos, int64_t costs)
 {
+	if (UseBuckets) {
+		return AddBucketNode(pos, costs);
+	}
 	ProfileBegin("AStarAddNode");
 
 	int32_t bigi = 0, smalli = OpenSetSize;
@@ -437,7 +566,7 @@ static inline int AStarAddNode(const Vec2i &pos, int64_t costs)
 	}
 
 	const int costToGoal = costs;
-	const int dist = std::abs(pos.x - AStarGoalX) + std::abs(pos.y - AStarGoalY);
+	const int dist = std::abs(pos.x - GoalX) + std::abs(pos.y - GoalY);
 
 	// find where we should insert this node.
 	// binary search where to insert the new node
@@ -445,8 +574,8 @@ static inline int AStarAddNode(const Vec2i &pos, int64_t costs)
 		midi = (smalli + bigi) >> 1;
 		open = &OpenSet[midi];
 		midcost = open->GetCosts();
-		midCostToGoal = AStarMatrix[open->GetOffset()].GetCostToGoal();
-		midDist = std::abs(open->pos.x - AStarGoalX) + std::abs(open->pos.y - AStarGoalY);
+		midCostToGoal = Matrix[open->GetOffset()].GetCostToGoal();
+		midDist = std::abs(open->pos.x - GoalX) + std::abs(open->pos.y - GoalY);
 		if (costs > midcost || (costs == midcost
 								&& (costToGoal > midCostToGoal || (costToGoal == midCostToGoal
 																   && dist > midDist)))) {
@@ -485,7 +614,7 @@ static inline int AStarAddNode(const Vec2i &pos, int64_t costs)
 **  Can be further optimized knowing that the new cost MUST BE LOWER
 **  than the old one.
 */
-static void AStarReplaceNode(int pos)
+void AStarContext::ReplaceNode(int pos)
 {
 	ProfileBegin("AStarReplaceNode");
 
@@ -497,7 +626,7 @@ static void AStarReplaceNode(int pos)
 	memmove(&OpenSet[pos], &OpenSet[pos+1], sizeof(Open) * (OpenSetSize-pos));
 
 	// Re-add the node with the new cost
-	AStarAddNode(node.pos, node.GetCosts());
+	AddNode(node.pos, node.GetCosts());
 	ProfileEnd("AStarReplaceNode");
 }
 
@@ -507,7 +636,7 @@ static void AStarReplaceNode(int pos)
 **
 **  @return  -1 if not found and the position of the node in the table if found.
 */
-static int AStarFindNode(int eo)
+int AStarContext::FindNode(int eo) const
 {
 	ProfileBegin("AStarFindNode");
 
@@ -521,10 +650,102 @@ static int AStarFindNode(int eo)
 	return -1;
 }
 
+/**
+**  Remove the best node from the open set.
+**
+**  @return  false if the open set is empty.
+*/
+bool AStarContext::PopMinimum(Vec2i &pos)
+{
+	if (UseBuckets) {
+		return PopBucketMinimum(pos);
+	}
+	if (OpenSetSize <= 0) {
+		return false;
+	}
+	const int shortest = AStarFindMinimum();
+	pos = OpenSet[shortest].pos;
+	RemoveMinimum(shortest);
+	return true;
+}
+
+/**
+**  Add a node to the bucket open set.
+**
+**  @return  0
+*/
+int AStarContext::AddBucketNode(const Vec2i &pos, int64_t costs)
+{
+	ProfileBegin("AStarAddBucketNode");
+	BucketEntry entry;
+	entry.Pos = pos;
+	entry.Costs = std::min<int64_t>(costs, UINT32_MAX);
+	entry.CostToGoal = Matrix[pos.y * AStarMapWidth + pos.x].GetCostToGoal();
+	entry.Dist = std::abs(pos.x - GoalX) + std::abs(pos.y - GoalY);
+
+	const size_t index = std::min<size_t>(entry.Costs, MaxBuckets - 1);
+	if (index >= Buckets.size()) {
+		Buckets.resize(index + 1);
+	}
+	Buckets[index].push_back(entry);
+	std::push_heap(Buckets[index].begin(), Buckets[index].end(), BucketEntry::IsWorse);
+	BucketMin = std::min(BucketMin, index);
+	BucketMax = std::max(BucketMax, index);
+	ProfileEnd("AStarAddBucketNode");
+	return 0;
+}
+
+/**
+**  Remove the best node from the bucket open set.
+**
+**  Ties are broken as in the stored array: lowest estimated cost to goal,
+**  then lowest distance to goal.
+**
+**  @return  false if the open set is empty.
+*/
+bool AStarContext::PopBucketMinimum(Vec2i &pos)
+{
+	ProfileBegin("AStarPopBucketMinimum");
+	for (; BucketMin <= BucketMax; ++BucketMin) {
+		std::vector<BucketEntry> &bucket = Buckets[BucketMin];
+
+		while (!bucket.empty()) {
+			std::pop_heap(bucket.begin(), bucket.end(), BucketEntry::IsWorse);
+			const BucketEntry entry = bucket.back();
+			bucket.pop_back();
+
+			// Skip the entries of nodes found again with a lower cost.
+			const Node &node = Matrix[entry.Pos.y * AStarMapWidth + entry.Pos.x];
+			if (entry.Costs == std::min<int64_t>(int64_t(node.GetCostFromStart()) + node.GetCostToGoal(), UINT32_MAX)) {
+				pos = entry.Pos;
+				ProfileEnd("AStarPopBucketMinimum");
+				return true;
+			}
+		}
+	}
+	ProfileEnd("AStarPopBucketMinimum");
+	return false;
+}
+
 #define GetIndex(x, y) (x) + (y) * AStarMapWidth
 
+/**
+**  Keep the cost of a tile for DrawLastAStar.
+**
+**  Only the searches of the main thread do it, the worker threads of
+**  AStarFindPaths would write the same map fields at the same time.
+*/
+void AStarContext::SetDebugCost(const CMapField &mf, int64_t cost) const
+{
+#ifdef DEBUG
+	if (this == &MainAStarContext) {
+		const_cast<CMapField &>(mf).lastAStarCost = cost;
+	}
+#endif
+}
+
 /* build-in costmoveto code */
-static int CostMoveToCallBack_Default(unsigned int index, const CUnit &unit)
+int AStarContext::CostMoveToCallBack(unsigned int index, const CUnit &unit) const
 {
 #ifdef DEBUG
 	{
@@ -534,6 +755,10 @@ static int CostMoveToCallBack_Default(unsigned int index, const CUnit &unit)
 		Assert(Map.Info.IsPointOnMap(pos));
 	}
 #endif
+	if (Passability && !Passability->IsPassable(Vec2i(index % AStarMapWidth, index / AStarMapWidth))) {
+		// we can't cross fixed units and other unpassable things
+		return -1;
+	}
 	int cost = 0;
 	const int mask = unit.Type->MovementMask;
 	const CUnitTypeFinder unit_finder(unit.Type->MoveType);
@@ -549,9 +774,7 @@ static int CostMoveToCallBack_Default(unsigned int index, const CUnit &unit)
 			if (flag && (AStarKnowUnseenTerrain || mf->playerInfo.IsExplored(*unit.Player))) {
 				if (flag & ~(MapFieldLandUnit | MapFieldAirUnit | MapFieldSeaUnit)) {
 					// we can't cross fixed units and other unpassable things
-#ifdef DEBUG
-					const_cast<CMapField *>(mf)->lastAStarCost = -1;
-#endif
+					SetDebugCost(*mf, -1);
 					return -1;
 				}
 				auto it = ranges::find_if(mf->UnitCache, unit_finder);
@@ -559,9 +782,7 @@ static int CostMoveToCallBack_Default(unsigned int index, const CUnit &unit)
 				if (!goal) {
 					// Shouldn't happen, mask says there is something on this tile
 					Assert(0);
-#ifdef DEBUG
-					const_cast<CMapField *>(mf)->lastAStarCost = -1;
-#endif
+					SetDebugCost(*mf, -1);
 					return -1;
 				}
 				if (goal->Moving)  {
@@ -570,10 +791,8 @@ static int CostMoveToCallBack_Default(unsigned int index, const CUnit &unit)
 				} else {
 					// for non moving unit Always Fail unless goal is unit, or unit can attack the target
 					if (&unit != goal) {
-						if (GetAStarFixedEnemyUnitsUnpassable() == true) {
-#ifdef DEBUG
-							const_cast<CMapField *>(mf)->lastAStarCost = -1;
-#endif
+						if (FixedEnemyUnitsUnpassable == true) {
+							SetDebugCost(*mf, -1);
 							return -1;
 						}
 						if (goal->Player->IsEnemy(unit) && unit.IsAggressive() && CanTarget(*unit.Type, *goal->Type)
@@ -581,9 +800,7 @@ static int CostMoveToCallBack_Default(unsigned int index, const CUnit &unit)
 								cost += 2 * AStarMovingUnitCrossingCost;
 						} else {
 						// FIXME: Need support for moving a fixed unit to add cost
-#ifdef DEBUG
-							const_cast<CMapField *>(mf)->lastAStarCost = -1;
-#endif
+							SetDebugCost(*mf, -1);
 							return -1;
 						}
 						//cost += AStarFixedUnitCrossingCost;
@@ -597,9 +814,7 @@ static int CostMoveToCallBack_Default(unsigned int index, const CUnit &unit)
 			}
 			// Add tile movement cost
 			cost += mf->getMoveCost();
-#ifdef DEBUG
-			const_cast<CMapField *>(mf)->lastAStarCost = cost;
-#endif
+			SetDebugCost(*mf, cost);
 			++mf;
 		} while (--i);
 		index += AStarMapWidth;
@@ -619,43 +834,25 @@ static int CostMoveToCallBack_Default(unsigned int index, const CUnit &unit)
 **                0 -> no induced cost, except move
 **               >0 -> costly tile
 */
-static inline int CostMoveTo(unsigned int index, const CUnit &unit)
+int AStarContext::CostMoveTo(unsigned int index, const CUnit &unit)
 {
 	int32_t *c = &CostMoveToCache[index];
 	if (*c != CacheNotSet) {
+		++Stats.CostCacheHits;
 		// for performance reasons, CostMoveToCache uses -1 to
 		// indicate it is unset, but the algorithm is simpler
 		// if the range of costs is [-1, INT_MAX]. so we always
 		// store everything +1
 		return *c - 1;
 	}
-	*c = CostMoveToCallBack_Default(index, unit) + 1;
+	++Stats.CostCacheMisses;
+	*c = CostMoveToCallBack(index, unit) + 1;
 #ifdef DEBUG
 	Assert(*c >= 0);
 #endif
 	return *c - 1;
 }
 
-class AStarGoalMarker
-{
-public:
-	AStarGoalMarker(const CUnit &unit) : unit(unit) {}
-
-	void operator()(int offset)
-	{
-		if (CostMoveTo(offset, unit) >= 0) {
-			AStarMatrix[offset].SetInGoal();
-			goal_reachable = true;
-		}
-	}
-
-	bool isGoalReachable() const { return goal_reachable; }
-
-private:
-	const CUnit &unit;
-	bool goal_reachable = false;
-};
-
 
 template <typename T>
 class MinMaxRangeVisitor
@@ -814,7 +1011,7 @@ class MinMaxRangeVisitor
 /**
 **  MarkAStarGoal
 */
-static bool AStarMarkGoal(const Vec2i &goal,
+bool AStarContext::MarkGoal(const Vec2i &goal,
                           int gw,
                           int gh,
                           int tilesizex,
@@ -832,7 +1029,7 @@ static bool AStarMarkGoal(const Vec2i &goal,
 		}
 		unsigned int offset = GetIndex(goal.x, goal.y);
 		if (CostMoveTo(offset, unit) >= 0) {
-			AStarMatrix[offset].SetInGoal();
+			Matrix[offset].SetInGoal();
 			ProfileEnd("AStarMarkGoal");
 			return true;
 		} else {
@@ -844,8 +1041,14 @@ static bool AStarMarkGoal(const Vec2i &goal,
 	gw = std::max(gw, 1);
 	gh = std::max(gh, 1);
 
-	AStarGoalMarker aStarGoalMarker(unit);
-	MinMaxRangeVisitor<AStarGoalMarker> visitor(aStarGoalMarker);
+	bool goalReachable = false;
+	auto goalMarker = [&](int offset) {
+		if (CostMoveTo(offset, unit) >= 0) {
+			Matrix[offset].SetInGoal();
+			goalReachable = true;
+		}
+	};
+	MinMaxRangeVisitor<decltype(goalMarker)> visitor(goalMarker);
 
 	const Vec2i goalBottomRigth(goal.x + gw - 1, goal.y + gh - 1);
 	visitor.SetGoal(goal, goalBottomRigth);
@@ -858,7 +1061,36 @@ static bool AStarMarkGoal(const Vec2i &goal,
 	visitor.Visit();
 
 	ProfileEnd("AStarMarkGoal");
-	return aStarGoalMarker.isGoalReachable();
+	return goalReachable;
+}
+
+/**
+**  Call func with the map index of every position from which a unit is in
+**  range of the goal, the same positions AStarMarkGoal checks.
+**
+**  @param goal      Top left of the goal.
+**  @param gw        Width of the goal.
+**  @param gh        Height of the goal.
+**  @param tileSize  Size of the unit.
+**  @param minrange  Min range to the goal.
+**  @param maxrange  Max range to the goal.
+**  @param func      Called with each map index.
+*/
+void AStarVisitGoalArea(const Vec2i &goal, int gw, int gh, const Vec2i &tileSize,
+						int minrange, int maxrange, std::function<void(unsigned int)> func)
+{
+	if (minrange == 0 && maxrange == 0 && gw == 0 && gh == 0) {
+		if (goal.x + tileSize.x <= Map.Info.MapWidth && goal.y + tileSize.y <= Map.Info.MapHeight) {
+			func(Map.getIndex(goal));
+		}
+		return;
+	}
+	MinMaxRangeVisitor<std::function<void(unsigned int)>> visitor(func);
+
+	visitor.SetGoal(goal, Vec2i(goal.x + std::max(gw, 1) - 1, goal.y + std::max(gh, 1) - 1));
+	visitor.SetRange(minrange, maxrange);
+	visitor.SetUnitSize(tileSize);
+	visitor.Visit();
 }
 
 /**
@@ -866,7 +1098,7 @@ static bool AStarMarkGoal(const Vec2i &goal,
 **
 **  @return  The length of the path
 */
-static int AStarSavePath(const Vec2i &startPos, const Vec2i &endPos, char *path, int pathLen)
+int AStarContext::SavePath(const Vec2i &startPos, const Vec2i &endPos, char *path, int pathLen) const
 {
 	ProfileBegin("AStarSavePath");
 
@@ -879,7 +1111,7 @@ static int AStarSavePath(const Vec2i &startPos, const Vec2i &endPos, char *path,
 	Vec2i curr = endPos;
 	int currO = curr.y * AStarMapWidth;
 	while (curr != startPos) {
-		direction = AStarMatrix[currO + curr.x].GetDirection();
+		direction = Matrix[currO + curr.x].GetDirection();
 #ifdef DEBUG
 		Assert(direction >= 0 && direction < 8);
 #endif
@@ -896,7 +1128,7 @@ static int AStarSavePath(const Vec2i &startPos, const Vec2i &endPos, char *path,
 		curr = endPos;
 		currO = curr.y * AStarMapWidth;
 		while (curr != startPos) {
-			direction = AStarMatrix[currO + curr.x].GetDirection();
+			direction = Matrix[currO + curr.x].GetDirection();
 #ifdef DEBUG
 			Assert(direction >= 0 && direction < 8);
 #endif
@@ -918,9 +1150,8 @@ static int AStarSavePath(const Vec2i &startPos, const Vec2i &endPos, char *path,
 **  Optimization to find a simple path
 **  Check if we're at the goal or if it's 1 tile away
 */
-static int AStarFindSimplePath(const Vec2i &startPos, const Vec2i &goal, int gw, int gh,
-							   int, int, int minrange, int maxrange,
-							   char *path, const CUnit &unit)
+int AStarContext::FindSimplePath(const Vec2i &startPos, const Vec2i &goal, int gw, int gh,
+								 int minrange, int maxrange, char *path, const CUnit &unit) const
 {
 	ProfileBegin("AStarFindSimplePath");
 	// At exact destination point already
@@ -946,7 +1177,8 @@ static int AStarFindSimplePath(const Vec2i &startPos, const Vec2i &goal, int gw,
 
 	if (std::abs(diff.x) <= 1 && std::abs(diff.y) <= 1) {
 		// Move to adjacent cell
-		if (CostMoveTo(GetIndex(goal.x, goal.y), unit) == -1) {
+		// (the cache is only cleaned for the full search, don't use it)
+		if (CostMoveToCallBack(GetIndex(goal.x, goal.y), unit) == -1) {
 			ProfileEnd("AStarFindSimplePath");
 			return PF_UNREACHABLE;
 		}
@@ -964,15 +1196,15 @@ static int AStarFindSimplePath(const Vec2i &startPos, const Vec2i &goal, int gw,
 
 #ifdef DEBUG
 extern bool DumpNextAStar;
-void AStarDumpStats();
+void AStarDumpStats(const std::vector<Node> &matrix);
 #endif
 
 /**
-**  Find path.
+**  Find path on the tile grid.
 */
-int AStarFindPath(const Vec2i &startPos, const Vec2i &goalPosIn, int gw, int gh,
-				  int tilesizex, int tilesizey, int minrange, int maxrange,
-				  char *path, int pathlen, const CUnit &unit)
+int AStarContext::FindPath(const Vec2i &startPos, const Vec2i &goalPosIn, int gw, int gh,
+						   int tilesizex, int tilesizey, int minrange, int maxrange,
+						   char *path, int pathlen, const CUnit &unit)
 {
 	Assert(Map.Info.IsPointOnMap(startPos));
 
@@ -995,23 +1227,38 @@ int AStarFindPath(const Vec2i &startPos, const Vec2i &goalPosIn, int gw, int gh,
 	const int maxMapX = AStarMapWidth + 1 - tilesizex;
 	const int maxMapY = AStarMapHeight + 1 - tilesizey;
 
-	AStarGoalX = goalPos.x;
-	AStarGoalY = goalPos.y;
+	GoalX = goalPos.x;
+	GoalY = goalPos.y;
+	Stats = AStarSearchStats{};
+	// Without the whole terrain, the tiles must be checked one by one.
+	Passability = AStarKnowUnseenTerrain ? &GetPassabilityPlane(unit.Type->MovementMask, Vec2i(tilesizex, tilesizey)) : nullptr;
 
 	//  Check for simple cases first
-	int ret = AStarFindSimplePath(startPos, goalPos, gw, gh, tilesizex, tilesizey,
-								  minrange, maxrange, path, unit);
+	int ret = FindSimplePath(startPos, goalPos, gw, gh, minrange, maxrange, path, unit);
 	if (ret != PF_FAILED) {
 		ProfileEnd("AStarFindPath");
 		return ret;
 	}
 
-	//  Initialize
-	AStarCleanUp();
+	if (AStarJumpPointSearch) {
+		ret = FindJumpPath(startPos, goalPos, gw, gh, tilesizex, tilesizey, minrange, maxrange,
+						   path, pathlen, unit);
+		if (ret != PF_FAILED) {
+			ProfileEnd("AStarFindPath");
+			return ret;
+		}
+		Stats.JumpFallback = true;
+		// The costs of the tiles are still right for this search.
+		Prepare();
+		BucketsCleanUp();
+	} else {
+		CleanUp();
+	}
 
 	OpenSetSize = 0;
+	UseBuckets = AStarBucketOpenSet;
 
-	if (!AStarMarkGoal(goalPos, gw, gh, tilesizex, tilesizey, minrange, maxrange, unit)) {
+	if (!MarkGoal(goalPos, gw, gh, tilesizex, tilesizey, minrange, maxrange, unit)) {
 		// goal is not reachable
 		ret = PF_UNREACHABLE;
 		ProfileEnd("AStarFindPath");
@@ -1021,19 +1268,19 @@ int AStarFindPath(const Vec2i &startPos, const Vec2i &goalPosIn, int gw, int gh,
 	int eo = startPos.y * AStarMapWidth + startPos.x;
 	// it is quite important to start from 1 rather than 0, because we use
 	// 0 as a way to represent nodes that we have not visited yet.
-	AStarMatrix[eo].SetCostFromStart(1);
+	Matrix[eo].SetCostFromStart(1);
 	// 8 to say we are came from nowhere.
-	AStarMatrix[eo].SetDirection(8);
+	Matrix[eo].SetDirection(8);
 
 	// place start point in open, it that failed, try another pathfinder
 	int costToGoal = AStarCosts(startPos, goalPos);
-	AStarMatrix[eo].SetCostToGoal(costToGoal);
-	if (AStarAddNode(startPos, 1 + costToGoal) == PF_FAILED) {
+	Matrix[eo].SetCostToGoal(costToGoal);
+	if (AddNode(startPos, 1 + costToGoal) == PF_FAILED) {
 		ret = PF_FAILED;
 		ProfileEnd("AStarFindPath");
 		return ret;
 	}
-	if (AStarMatrix[eo].IsInGoal()) {
+	if (Matrix[eo].IsInGoal()) {
 		ret = PF_REACHED;
 		ProfileEnd("AStarFindPath");
 		return ret;
@@ -1047,18 +1294,22 @@ int AStarFindPath(const Vec2i &startPos, const Vec2i &goalPosIn, int gw, int gh,
 		// Find the best node of from the open set
 #ifdef DEBUG
 		if (DumpNextAStar) {
-			AStarDumpStats();
+			AStarDumpStats(Matrix);
 		}
 #endif
-		const int shortest = AStarFindMinimum();
-		const int x = OpenSet[shortest].pos.x;
-		const int y = OpenSet[shortest].pos.y;
-		const int o = OpenSet[shortest].GetOffset();
-
-		AStarRemoveMinimum(shortest);
+		Vec2i current;
+		if (!PopMinimum(current)) { // no new nodes generated
+			ret = PF_UNREACHABLE;
+			ProfileEnd("AStarFindPath");
+			return ret;
+		}
+		++Stats.ExpandedNodes;
+		const int x = current.x;
+		const int y = current.y;
+		const int o = y * AStarMapWidth + x;
 
 		// If we have reached the goal, then exit.
-		if (AStarMatrix[o].IsInGoal()) {
+		if (Matrix[o].IsInGoal()) {
 			endPos.x = x;
 			endPos.y = y;
 			break;
@@ -1079,10 +1330,10 @@ int AStarFindPath(const Vec2i &startPos, const Vec2i &goalPosIn, int gw, int gh,
 
 		// Node that this node was generated from.
 #ifdef DEBUG
-		Assert(AStarMatrix[o].GetDirection() >= 0 && (AStarMatrix[o].GetDirection() < 8 || (x == startPos.x && y == startPos.y)));
+		Assert(Matrix[o].GetDirection() >= 0 && (Matrix[o].GetDirection() < 8 || (x == startPos.x && y == startPos.y)));
 #endif
-		const int px = x - Heading2X[(int)AStarMatrix[o].GetDirection()];
-		const int py = y - Heading2Y[(int)AStarMatrix[o].GetDirection()];
+		const int px = x - Heading2X[(int)Matrix[o].GetDirection()];
+		const int py = y - Heading2Y[(int)Matrix[o].GetDirection()];
 
 		for (int i = 0; i < 8; ++i) {
 			endPos.x = x + Heading2X[i];
@@ -1120,55 +1371,51 @@ int AStarFindPath(const Vec2i &startPos, const Vec2i &goalPosIn, int gw, int gh,
 
 			// Add a cost for walking to make paths more realistic for the user.
 			new_cost++;
-			new_cost += AStarMatrix[o].GetCostFromStart();
-			if (AStarMatrix[eo].GetCostFromStart() == 0) {
+			new_cost += Matrix[o].GetCostFromStart();
+			if (Matrix[eo].GetCostFromStart() == 0) {
 				--counter;
 				// we are sure the current node has not been already visited
-				AStarMatrix[eo].SetCostFromStart(new_cost);
-				AStarMatrix[eo].SetDirection(i);
+				Matrix[eo].SetCostFromStart(new_cost);
+				Matrix[eo].SetDirection(i);
 				costToGoal = AStarCosts(endPos, goalPos);
-				AStarMatrix[eo].SetCostToGoal(costToGoal);
-				if (AStarAddNode(endPos, new_cost + costToGoal) == PF_FAILED) {
+				Matrix[eo].SetCostToGoal(costToGoal);
+				if (AddNode(endPos, new_cost + costToGoal) == PF_FAILED) {
 					ret = PF_FAILED;
 					ProfileEnd("AStarFindPath");
 					return ret;
 				}
-			} else if (new_cost < AStarMatrix[eo].GetCostFromStart()) {
+			} else if (new_cost < Matrix[eo].GetCostFromStart()) {
 				--counter;
 				// Already visited node, but we have here a better path
 				// I know, it's redundant (but simpler like this)
-				AStarMatrix[eo].SetCostFromStart(new_cost);
-				AStarMatrix[eo].SetDirection(i);
+				Matrix[eo].SetCostFromStart(new_cost);
+				Matrix[eo].SetDirection(i);
 				// this point might be already in the OpenSet
-				const int j = AStarFindNode(eo);
+				// (the bucket open set just skips the outdated entry)
+				const int j = UseBuckets ? -1 : FindNode(eo);
 				if (j == -1) {
 					costToGoal = AStarCosts(endPos, goalPos);
-					AStarMatrix[eo].SetCostToGoal(costToGoal);
-					if (AStarAddNode(endPos, new_cost + costToGoal) == PF_FAILED) {
+					Matrix[eo].SetCostToGoal(costToGoal);
+					if (AddNode(endPos, new_cost + costToGoal) == PF_FAILED) {
 						ret = PF_FAILED;
 						ProfileEnd("AStarFindPath");
 						return ret;
 					}
 				} else {
 					costToGoal = AStarCosts(endPos, goalPos);
-					AStarMatrix[eo].SetCostToGoal(costToGoal);
-					AStarReplaceNode(j);
+					Matrix[eo].SetCostToGoal(costToGoal);
+					ReplaceNode(j);
 				}
 				// we don't have to add this point to the close set
 			}
 		}
-		if (OpenSetSize <= 0) { // no new nodes generated
-			ret = PF_UNREACHABLE;
-			ProfileEnd("AStarFindPath");
-			return ret;
-		}
 	}
 
 #ifdef DEBUG
 	DumpNextAStar = false;
 #endif
 	AstarDebugPrint("AStar counter %d/%d\n", counter, AStarMaxSearchIterations);
-	const int path_length = AStarSavePath(startPos, endPos, path, pathlen);
+	const int path_length = SavePath(startPos, endPos, path, pathlen);
 
 	ret = path_length;
 
@@ -1176,14 +1423,362 @@ int AStarFindPath(const Vec2i &startPos, const Vec2i &goalPosIn, int gw, int gh,
 	return ret;
 }
 
-void AStarDumpStats()
+/// Offset of one move in a direction
+static Vec2i HeadingOffset(int dir)
+{
+	return Vec2i(Heading2X[dir], Heading2Y[dir]);
+}
+
+/**
+**  Check if a jump can't go through a position.
+**
+**  A passable position with another cost than the uniform one marks the
+**  area as not uniform.
+*/
+bool AStarContext::IsJumpBlocked(const Vec2i &pos, const CUnit &unit)
+{
+	if (pos.x < 0 || pos.x >= JumpMapMax.x || pos.y < 0 || pos.y >= JumpMapMax.y) {
+		return true;
+	}
+	const int cost = CostMoveTo(GetIndex(pos.x, pos.y), unit);
+	if (cost == -1) {
+		return true;
+	}
+	if (cost != JumpUniformCost) {
+		JumpNotUniform = true;
+	}
+	return false;
+}
+
+/**
+**  Check if an obstacle next to pos makes a path going in direction dir
+**  turn there.
+*/
+bool AStarContext::HasForcedNeighbour(const Vec2i &pos, int dir, const CUnit &unit)
+{
+	if (dir % 2 == 0) {
+		// straight move: a blocked side can only be passed from here.
+		for (const int side : {(dir + 2) % 8, (dir + 6) % 8}) {
+			const Vec2i sidePos = pos + HeadingOffset(side);
+			if (IsJumpBlocked(sidePos, unit) && !IsJumpBlocked(sidePos + HeadingOffset(dir), unit)) {
+				return true;
+			}
+		}
+		return false;
+	}
+	// diagonal move: a blocked side behind can only be passed from here.
+	const int straight[2] = {dir - 1, (dir + 1) % 8};
+	for (int i = 0; i < 2; ++i) {
+		const Vec2i behindPos = pos - HeadingOffset(straight[i]);
+		if (IsJumpBlocked(behindPos, unit) && !IsJumpBlocked(behindPos + HeadingOffset(straight[1 - i]), unit)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+**  Move in a direction until a position where the path may turn.
+**
+**  A jump stops after maxSteps moves, the end is then used as a jump
+**  point. A diagonal jump scans the straight lines of each of its steps
+**  for JumpMaxSideSteps moves only, else it would cost the square of its
+**  length. When they find nothing in this distance, the diagonal stops
+**  and the straight lines are scanned by the next jumps.
+**
+**  @param pos       Start of the jump, the found jump point on success.
+**  @param dir       Direction of the jump.
+**  @param steps     Number of moves done by the jump.
+**  @param maxSteps  Number of moves after which the jump stops.
+**  @param unit      Unit which moves.
+**
+**  @return          true if a jump point was found.
+*/
+bool AStarContext::Jump(Vec2i &pos, int dir, int &steps, int maxSteps, const CUnit &unit)
+{
+	const Vec2i offset = HeadingOffset(dir);
+
+	while (true) {
+		pos += offset;
+		++steps;
+		if (IsJumpBlocked(pos, unit) || JumpNotUniform) {
+			return false;
+		}
+		if (Matrix[GetIndex(pos.x, pos.y)].IsInGoal() || steps == maxSteps) {
+			return true;
+		}
+		if (HasForcedNeighbour(pos, dir, unit)) {
+			return !JumpNotUniform;
+		}
+		if (dir % 2 == 1) {
+			// a diagonal jump stops where one of its straight parts finds something.
+			for (const int straight : {dir - 1, (dir + 1) % 8}) {
+				Vec2i straightPos = pos;
+				int straightSteps = 0;
+				if (Jump(straightPos, straight, straightSteps, JumpMaxSideSteps, unit)) {
+					return true;
+				}
+				if (JumpNotUniform) {
+					return false;
+				}
+			}
+		}
+	}
+}
+
+/**
+**  Give the tiles between the jump points of the path the direction of
+**  their jump, so SavePath can follow the path tile by tile.
+*/
+void AStarContext::FillJumps(const Vec2i &startPos, const Vec2i &endPos)
+{
+	Vec2i pos = endPos;
+
+	while (pos != startPos) {
+		const unsigned int index = GetIndex(pos.x, pos.y);
+		const int dir = Matrix[index].GetDirection();
+		const Vec2i parentPos(JumpParents[index] % AStarMapWidth, JumpParents[index] / AStarMapWidth);
+
+		for (pos -= HeadingOffset(dir); pos != parentPos; pos -= HeadingOffset(dir)) {
+			Matrix[GetIndex(pos.x, pos.y)].SetDirection(dir);
+		}
+	}
+}
+
+/**
+**  Find path with jump point search.
+**
+**  When all tiles cost the same, a best path only needs to turn next to
+**  obstacles. Only these positions are put in the open set, the straight
+**  lines between them are just scanned.
+**
+**  The greedy heuristic of a* would make the search commit to the first
+**  jump points it finds, so an admissible one is used: the number of moves
+**  left to the goal area, all costing the same.
+**
+**  @return  PF_FAILED if plain a* must decide: a tile with another cost
+**           was found, no jump point is left or the budget is spent.
+**           Else the same as FindPath.
+*/
+int AStarContext::FindJumpPath(const Vec2i &startPos, const Vec2i &goalPos, int gw, int gh,
+							   int tilesizex, int tilesizey, int minrange, int maxrange,
+							   char *path, int pathlen, const CUnit &unit)
+{
+	ProfileBegin("AStarFindJumpPath");
+
+	CleanUp();
+
+	OpenSetSize = 0;
+	UseBuckets = AStarBucketOpenSet;
+	JumpMapMax = Vec2i(AStarMapWidth + 1 - tilesizex, AStarMapHeight + 1 - tilesizey);
+	// Same cost as a* gives to a move: the whole footprint of the unit.
+	const unsigned int startIndex = GetIndex(startPos.x, startPos.y);
+	JumpUniformCost = CostMoveTo(startIndex, unit);
+	if (JumpUniformCost == -1) {
+		ProfileEnd("AStarFindJumpPath");
+		return PF_FAILED;
+	}
+	JumpCounter = AStarMaxSearchIterations;
+	JumpNotUniform = false;
+	const int moveCost = 1 + JumpUniformCost;
+	const Vec2i goalEnd(goalPos.x + std::max(gw, 1) - 1, goalPos.y + std::max(gh, 1) - 1);
+	const auto jumpCosts = [&](const Vec2i &pos) {
+		const int dx = std::max({0, goalPos.x - (pos.x + tilesizex - 1), pos.x - goalEnd.x});
+		const int dy = std::max({0, goalPos.y - (pos.y + tilesizey - 1), pos.y - goalEnd.y});
+		return std::max(0, std::max(dx, dy) - maxrange) * moveCost;
+	};
+
+	if (!MarkGoal(goalPos, gw, gh, tilesizex, tilesizey, minrange, maxrange, unit)) {
+		// goal is not reachable
+		ProfileEnd("AStarFindJumpPath");
+		return PF_UNREACHABLE;
+	}
+
+	Matrix[startIndex].SetCostFromStart(1);
+	Matrix[startIndex].SetDirection(8);
+	Matrix[startIndex].SetCostToGoal(jumpCosts(startPos));
+	if (Matrix[startIndex].IsInGoal()) {
+		ProfileEnd("AStarFindJumpPath");
+		return PF_REACHED;
+	}
+	if (AddNode(startPos, 1 + jumpCosts(startPos)) == PF_FAILED) {
+		ProfileEnd("AStarFindJumpPath");
+		return PF_FAILED;
+	}
+	Vec2i endPos;
+
+	//  Begin search
+	while (true) {
+		// A jump point may have been missed, or the search is too long:
+		// a* tells whether the goal is reachable.
+		Vec2i current;
+		if (!PopMinimum(current) || JumpCounter <= 0) {
+			ProfileEnd("AStarFindJumpPath");
+			return PF_FAILED;
+		}
+		++Stats.ExpandedNodes;
+		const unsigned int o = GetIndex(current.x, current.y);
+
+		if (Matrix[o].IsInGoal()) {
+			endPos = current;
+			break;
+		}
+
+		// Only keep the directions a best path may take after this node.
+		const int from = Matrix[o].GetDirection();
+		std::array<int, 8> dirs;
+		int dirCount = 0;
+		if (from == 8) {
+			for (int dir = 0; dir != 8; ++dir) {
+				dirs[dirCount++] = dir;
+			}
+		} else if (from % 2 == 0) {
+			dirs[dirCount++] = from;
+			if (IsJumpBlocked(current + HeadingOffset((from + 2) % 8), unit)) {
+				dirs[dirCount++] = (from + 1) % 8;
+			}
+			if (IsJumpBlocked(current + HeadingOffset((from + 6) % 8), unit)) {
+				dirs[dirCount++] = (from + 7) % 8;
+			}
+		} else {
+			dirs[dirCount++] = from;
+			dirs[dirCount++] = from - 1;
+			dirs[dirCount++] = (from + 1) % 8;
+			if (IsJumpBlocked(current - HeadingOffset((from + 1) % 8), unit)) {
+				dirs[dirCount++] = (from + 6) % 8;
+			}
+			if (IsJumpBlocked(current - HeadingOffset(from - 1), unit)) {
+				dirs[dirCount++] = (from + 2) % 8;
+			}
+		}
+
+		for (int i = 0; i != dirCount; ++i) {
+			const int dir = dirs[i];
+			Vec2i jumpPos = current;
+			int steps = 0;
+			const bool found = Jump(jumpPos, dir, steps, JumpMaxSteps, unit);
+			if (JumpNotUniform) {
+				ProfileEnd("AStarFindJumpPath");
+				return PF_FAILED;
+			}
+			if (!found) {
+				continue;
+			}
+			const unsigned int eo = GetIndex(jumpPos.x, jumpPos.y);
+			const int newCost = Matrix[o].GetCostFromStart() + steps * moveCost;
+			const bool visited = Matrix[eo].GetCostFromStart() != 0;
+			if (visited && newCost >= Matrix[eo].GetCostFromStart()) {
+				continue;
+			}
+			--JumpCounter;
+			Matrix[eo].SetCostFromStart(newCost);
+			Matrix[eo].SetDirection(dir);
+			JumpParents[eo] = o;
+			const int costToGoal = jumpCosts(jumpPos);
+			Matrix[eo].SetCostToGoal(costToGoal);
+			// this point might be already in the OpenSet
+			const int j = (visited && !UseBuckets) ? FindNode(eo) : -1;
+			if (j != -1) {
+				ReplaceNode(j);
+			} else if (AddNode(jumpPos, newCost + costToGoal) == PF_FAILED) {
+				ProfileEnd("AStarFindJumpPath");
+				return PF_FAILED;
+			}
+		}
+	}
+
+	FillJumps(startPos, endPos);
+	const int pathLength = SavePath(startPos, endPos, path, pathlen);
+
+	ProfileEnd("AStarFindJumpPath");
+	return pathLength;
+}
+
+/**
+**  Find path.
+**
+**  Far goals are first searched on the hierarchical abstraction, and a*
+**  only computes the path to the next waypoint. As the unit asks for a new
+**  path once the stored one is consumed, it still reaches the real goal.
+*/
+int AStarFindPath(const Vec2i &startPos, const Vec2i &goalPos, int gw, int gh,
+				  int tilesizex, int tilesizey, int minrange, int maxrange,
+				  char *path, int pathlen, const CUnit &unit)
+{
+	// The abstraction knows the whole terrain, don't leak unexplored parts.
+	// Only real moves need it, reachability checks want the full path.
+	if (AStarHierarchical && AStarKnowUnseenTerrain && path != nullptr) {
+		const int distance = std::max(std::abs(goalPos.x - startPos.x), std::abs(goalPos.y - startPos.y));
+
+		if (distance > 2 * AStarHierarchicalSectorSize + maxrange) {
+			ProfileBegin("AStarFindWaypoint");
+			const std::optional<Vec2i> waypoint = HierarchicalFindWaypoint(startPos, goalPos, unit);
+			ProfileEnd("AStarFindWaypoint");
+
+			if (waypoint) {
+				const int ret = MainAStarContext.FindPath(startPos, *waypoint, 0, 0, tilesizex, tilesizey,
+														  0, 0, path, pathlen, unit);
+				if (ret > 0) {
+					return ret;
+				}
+				// Blocked by units, try the usual way.
+			}
+		}
+	}
+	return MainAStarContext.FindPath(startPos, goalPos, gw, gh, tilesizex, tilesizey,
+									 minrange, maxrange, path, pathlen, unit);
+}
+
+/**
+**  Find the paths of many units at once, using all the worker threads.
+**
+**  Each search has its own context and only reads the game state, so the
+**  result of a request doesn't depend on the thread which computed it nor
+**  on the other requests. The hierarchical abstraction is not used.
+**
+**  @param requests  Searches to do, their Result is filled.
+*/
+void AStarFindPaths(std::vector<AStarRequest> &requests)
+{
+	if (requests.empty()) {
+		return;
+	}
+	const int threadCount = std::min<int>(omp_get_max_threads(), requests.size());
+	while (WorkerAStarContexts.size() < static_cast<size_t>(threadCount)) {
+		WorkerAStarContexts.push_back(std::make_unique<AStarContext>());
+		WorkerAStarContexts.back()->Init();
+	}
+	// The threads can't create the bitplanes.
+	if (AStarKnowUnseenTerrain) {
+		for (const AStarRequest &request : requests) {
+			const CUnitType &type = *request.Unit->Type;
+			GetPassabilityPlane(type.MovementMask, Vec2i(type.TileWidth, type.TileHeight));
+		}
+	}
+
+	#pragma omp parallel for schedule(dynamic) num_threads(threadCount)
+	for (int i = 0; i < static_cast<int>(requests.size()); ++i) {
+		AStarRequest &request = requests[i];
+		AStarContext &context = *WorkerAStarContexts[omp_get_thread_num()];
+		const CUnitType &type = *request.Unit->Type;
+
+		context.FixedEnemyUnitsUnpassable = request.FixedEnemyUnitsUnpassable;
+		request.Result = context.FindPath(request.StartPos, request.GoalPos,
+										  request.GoalSize.x, request.GoalSize.y,
+										  type.TileWidth, type.TileHeight,
+										  request.MinRange, request.MaxRange,
+										  request.Path, request.PathLength, *request.Unit);
+	}
+}
+
+void AStarDumpStats(const std::vector<Node> &matrix)
 {
 	int32_t maxCostFromHome = 0;
 	int32_t minCostFromHome = INT_MAX;
 	int32_t maxCostToGoal = 0;
 	int32_t minCostToGoal = INT_MAX;
 
-	for (const Node &m : AStarMatrix) {
+	for (const Node &m : matrix) {
 		
 		maxCostFromHome = std::max(maxCostFromHome, m.GetCostFromStart());
 		maxCostToGoal = std::max(maxCostToGoal, m.GetCostToGoal());
@@ -1196,7 +1791,7 @@ void AStarDumpStats()
 	if (minCostFromHome) minCostFromHome--;
 
 	int i = 0;
-	for (const Node &m : AStarMatrix) {
+	for (const Node &m : matrix) {
 		int r = 0;
 		int g = 0;
 		if (m.GetCostFromStart() && maxCostFromHome - minCostFromHome) {
@@ -1253,7 +1848,7 @@ void DrawLastAStar(const CViewport& vp)
 #if defined(DEBUG_ASTAR)
 	for (auto y = vp.MapPos.y; y != vp.MapPos.y + vp.MapHeight; ++y) {
 		for (auto x = vp.MapPos.x; x != vp.MapPos.x + vp.MapWidth; ++x) {
-			const auto &node = AStarMatrix[GetIndex(x, y)];
+			const auto &node = MainAStarContext.GetMatrix()[GetIndex(x, y)];
 			const auto direction = node.GetDirection();
 			if (direction == 255) {
 				continue;
@@ -1317,11 +1912,36 @@ int GetAStarUnknownTerrainCost()
 
 void SetAStarFixedEnemyUnitsUnpassable(const bool value)
 {
-	AStarFixedEnemyUnitsUnpassable = value;
+	MainAStarContext.FixedEnemyUnitsUnpassable = value;
 }
 
 bool GetAStarFixedEnemyUnitsUnpassable()
 {
-	return AStarFixedEnemyUnitsUnpassable;
+	return MainAStarContext.FixedEnemyUnitsUnpassable;
+}
+
+// AStarBucketOpenSet
+void SetAStarBucketOpenSet(bool value)
+{
+	AStarBucketOpenSet = value;
+}
+bool GetAStarBucketOpenSet()
+{
+	return AStarBucketOpenSet;
+}
+
+const AStarSearchStats &GetAStarLastSearchStats()
+{
+	return MainAStarContext.GetStats();
+}
+
+// AStarJumpPointSearch
+void SetAStarJumpPointSearch(bool value)
+{
+	AStarJumpPointSearch = value;
+}
+bool GetAStarJumpPointSearch()
+{
+	return AStarJumpPointSearch;
 }
 //@}
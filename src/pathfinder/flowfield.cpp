@@ -0,0 +1,456 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+/**@name flowfield.cpp - Shared flow fields for group moves. */
+//
+//      (c) Copyright 2026 by the Stratagus Developers
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+//@{
+
+/*----------------------------------------------------------------------------
+--  Includes
+----------------------------------------------------------------------------*/
+
+#include "stratagus.h"
+
+#include "pathfinder.h"
+
+#include "map.h"
+#include "settings.h"
+#include "unit.h"
+#include "unittype.h"
+
+#include <climits>
+#include <list>
+
+/*----------------------------------------------------------------------------
+--  Declarations
+----------------------------------------------------------------------------*/
+
+/**
+**  A flow field is a reverse Dijkstra from every position in range of a
+**  goal: each position gets the cost to reach the goal, and a unit finds
+**  its next step by going to the cheapest neighbour.
+**
+**  The search is only run as far as needed: each unit asking for a path
+**  continues it until its own position is settled. Many units moving to
+**  the same goal so cost about one search to the farthest of them.
+**
+**  Only the terrain is considered, blocking units are handled by the
+**  usual wait and a* fallback of NextPathElement.
+*/
+
+namespace
+{
+
+struct FlowFieldKey
+{
+	bool operator==(const FlowFieldKey &rhs) const
+	{
+		return goalPos == rhs.goalPos && goalSize == rhs.goalSize && unitSize == rhs.unitSize
+			&& minRange == rhs.minRange && maxRange == rhs.maxRange && terrainMask == rhs.terrainMask;
+	}
+
+	Vec2i goalPos{0, 0};
+	Vec2i goalSize{0, 0};
+	Vec2i unitSize{0, 0};
+	int minRange = 0;
+	int maxRange = 0;
+	tile_flags terrainMask = 0;
+};
+
+struct FlowFieldDemand
+{
+	FlowFieldKey Key;
+	std::vector<int> Units;      /// Slots of the units which asked
+	unsigned long LastCycle = 0; /// Cycle of the last request
+};
+
+struct FlowFieldNode
+{
+	unsigned int generation = 0; /// Generation of the field which set the values
+	int cost;                    /// Cost to the goal
+	bool settled;                /// Cost is final
+};
+
+/// Map sized buffer kept from one field to the next one
+struct FlowFieldStorage
+{
+	std::vector<FlowFieldNode> nodes;
+	unsigned int generation = 0;
+};
+
+} // namespace
+
+class CFlowField
+{
+public:
+	explicit CFlowField(const FlowFieldKey &key);
+	~CFlowField();
+	CFlowField(const CFlowField &) = delete;
+	CFlowField &operator=(const CFlowField &) = delete;
+
+	const FlowFieldKey &GetKey() const { return key; }
+	bool IsValid() const { return valid; }
+
+	void TerrainChanged(const Vec2i &pos, const Vec2i &size);
+	int FindPath(const Vec2i &startPos, char *path, int pathLen);
+
+private:
+	int GetCost(unsigned int index) const
+	{
+		const FlowFieldNode &node = storage->nodes[index];
+		return node.generation == generation ? node.cost : INT_MAX;
+	}
+	bool IsSettled(unsigned int index) const
+	{
+		const FlowFieldNode &node = storage->nodes[index];
+		return node.generation == generation && node.settled;
+	}
+	void SetCost(unsigned int index, int cost);
+	bool IsPassable(const Vec2i &pos) const;
+	int StepCost(const Vec2i &pos) const;
+	bool Settle(unsigned int index);
+
+private:
+	FlowFieldKey key;
+	int width;                         /// Number of possible columns for the unit
+	int height;                        /// Number of possible rows for the unit
+	bool valid = true;                 /// False once a used position got blocked
+	std::unique_ptr<FlowFieldStorage> storage; /// Costs, only the nodes of generation are set
+	unsigned int generation = 0;       /// Generation of the field in storage
+	std::priority_queue<std::pair<int, unsigned int>,
+	                    std::vector<std::pair<int, unsigned int>>,
+	                    std::greater<>> open;
+};
+
+/*----------------------------------------------------------------------------
+--  Variables
+----------------------------------------------------------------------------*/
+
+/// see pathfinder.h
+bool AStarFlowField = false;
+
+/// Number of units which must ask for the same goal before a field is built
+static constexpr size_t FlowFieldMinUnits = 8;
+/// Maximum number of fields kept in cache
+static constexpr size_t FlowFieldCacheSize = 8;
+
+/// Cached fields, the most recently used first
+static std::list<std::shared_ptr<CFlowField>> FlowFields;
+/// All fields still in use, cached or not
+static std::vector<std::weak_ptr<CFlowField>> LiveFlowFields;
+/// Recent path requests without field
+static std::vector<FlowFieldDemand> FlowFieldDemands;
+/// Buffers of the destroyed fields
+static std::vector<std::unique_ptr<FlowFieldStorage>> FlowFieldStoragePool;
+
+/*----------------------------------------------------------------------------
+--  Functions
+----------------------------------------------------------------------------*/
+
+CFlowField::CFlowField(const FlowFieldKey &key) :
+	key(key),
+	width(std::max(0, Map.Info.MapWidth + 1 - key.unitSize.x)),
+	height(std::max(0, Map.Info.MapHeight + 1 - key.unitSize.y))
+{
+	if (FlowFieldStoragePool.empty()) {
+		storage = std::make_unique<FlowFieldStorage>();
+	} else {
+		storage = std::move(FlowFieldStoragePool.back());
+		FlowFieldStoragePool.pop_back();
+	}
+	const size_t size = Map.Info.MapWidth * Map.Info.MapHeight;
+	if (storage->nodes.size() != size) {
+		storage->nodes.assign(size, FlowFieldNode());
+		storage->generation = 0;
+	}
+	// Only start a new generation, nodes of the previous fields are unset.
+	if (++storage->generation == 0) {
+		// Stamps wrapped around, old nodes could look like new ones.
+		ranges::fill(storage->nodes, FlowFieldNode());
+		storage->generation = 1;
+	}
+	generation = storage->generation;
+
+	AStarVisitGoalArea(key.goalPos, key.goalSize.x, key.goalSize.y, key.unitSize,
+					   key.minRange, key.maxRange, [this](unsigned int index) {
+		const Vec2i goal(index % Map.Info.MapWidth, index / Map.Info.MapWidth);
+		if (IsPassable(goal) && GetCost(index) != 0) {
+			SetCost(index, 0);
+			open.push({0, index});
+		}
+	});
+}
+
+CFlowField::~CFlowField()
+{
+	FlowFieldStoragePool.push_back(std::move(storage));
+}
+
+void CFlowField::SetCost(unsigned int index, int cost)
+{
+	FlowFieldNode &node = storage->nodes[index];
+	if (node.generation != generation) {
+		node.generation = generation;
+		node.settled = false;
+	}
+	node.cost = cost;
+}
+
+bool CFlowField::IsPassable(const Vec2i &pos) const
+{
+	return TerrainFootprintPassable(pos, key.terrainMask, key.unitSize);
+}
+
+/**
+**  Cost for a unit to step onto pos, as computed by a*: one for the move
+**  and the mean cost of the tiles under the unit.
+**  The fields are only used when the whole terrain is known, unexplored
+**  tiles have no extra cost.
+*/
+int CFlowField::StepCost(const Vec2i &pos) const
+{
+	int cost = 0;
+	for (int y = 0; y < key.unitSize.y; ++y) {
+		const CMapField *mf = Map.Field(pos.x, pos.y + y);
+		for (int x = 0; x < key.unitSize.x; ++x, ++mf) {
+			cost += mf->getMoveCost();
+		}
+	}
+	return 1 + cost / (key.unitSize.x * key.unitSize.y);
+}
+
+/**
+**  Continue the search until the position at index has its final cost.
+**
+**  @return  true if the position can reach the goal.
+*/
+bool CFlowField::Settle(unsigned int index)
+{
+	while (!IsSettled(index) && !open.empty()) {
+		const auto [cost, current] = open.top();
+		open.pop();
+		if (IsSettled(current)) {
+			continue;
+		}
+		storage->nodes[current].settled = true;
+
+		const Vec2i pos(current % Map.Info.MapWidth, current / Map.Info.MapWidth);
+		// The unit moves from the neighbour onto pos.
+		const int newCost = cost + StepCost(pos);
+		for (int i = 0; i < 8; ++i) {
+			const Vec2i next(pos.x + Heading2X[i], pos.y + Heading2Y[i]);
+			if (next.x < 0 || next.y < 0 || next.x >= width || next.y >= height) {
+				continue;
+			}
+			const unsigned int nextIndex = Map.getIndex(next);
+			if (newCost < GetCost(nextIndex) && IsPassable(next)) {
+				SetCost(nextIndex, newCost);
+				open.push({newCost, nextIndex});
+			}
+		}
+	}
+	return IsSettled(index);
+}
+
+/**
+**  Fill path with the first steps to the goal.
+**
+**  @param startPos  Position of the unit.
+**  @param path      Where to store the directions, the first step last.
+**  @param pathLen   Size of path.
+**
+**  @return  Path length (more than pathLen if the goal is farther),
+**           PF_REACHED if already in goal, PF_FAILED if the field can't tell.
+*/
+int CFlowField::FindPath(const Vec2i &startPos, char *path, int pathLen)
+{
+	if (startPos.x >= width || startPos.y >= height) {
+		return PF_FAILED;
+	}
+	unsigned int index = Map.getIndex(startPos);
+	if (!Settle(index)) {
+		return PF_FAILED;
+	}
+	if (GetCost(index) == 0) {
+		return PF_REACHED;
+	}
+	std::vector<char> steps;
+	Vec2i pos = startPos;
+	while (GetCost(index) != 0 && int(steps.size()) != pathLen) {
+		int bestHeading = -1;
+		int bestCost = GetCost(index);
+		for (int i = 0; i < 8; ++i) {
+			const Vec2i next(pos.x + Heading2X[i], pos.y + Heading2Y[i]);
+			if (next.x < 0 || next.y < 0 || next.x >= width || next.y >= height) {
+				continue;
+			}
+			const int cost = GetCost(Map.getIndex(next));
+			if (cost < bestCost) {
+				bestCost = cost;
+				bestHeading = i;
+			}
+		}
+		Assert(bestHeading != -1);
+		steps.push_back(bestHeading);
+		pos.x += Heading2X[bestHeading];
+		pos.y += Heading2Y[bestHeading];
+		index = Map.getIndex(pos);
+	}
+	for (size_t i = 0; i != steps.size(); ++i) {
+		path[steps.size() - 1 - i] = steps[i];
+	}
+	return GetCost(index) == 0 ? steps.size() : steps.size() + 1;
+}
+
+/**
+**  Invalidate the field if a position it may use got blocked.
+*/
+void CFlowField::TerrainChanged(const Vec2i &pos, const Vec2i &size)
+{
+	const Vec2i minPos(std::max(0, pos.x - key.unitSize.x + 1), std::max(0, pos.y - key.unitSize.y + 1));
+	const Vec2i maxPos(std::min(width - 1, pos.x + size.x - 1), std::min(height - 1, pos.y + size.y - 1));
+
+	for (Vec2i it = minPos; it.y <= maxPos.y; ++it.y) {
+		for (it.x = minPos.x; it.x <= maxPos.x; ++it.x) {
+			if (GetCost(Map.getIndex(it)) != INT_MAX && !IsPassable(it)) {
+				valid = false;
+				return;
+			}
+		}
+	}
+}
+
+/**
+**  Get the field for key, if enough different units asked for it recently.
+**
+**  A unit asking again, as when it waits for a blocking unit, doesn't count.
+*/
+static std::shared_ptr<CFlowField> GetFlowField(const FlowFieldKey &key, const CUnit &unit)
+{
+	auto it = ranges::find_if(FlowFields, [&](const auto &field) { return field->GetKey() == key; });
+	if (it != FlowFields.end()) {
+		FlowFields.splice(FlowFields.begin(), FlowFields, it);
+		return FlowFields.front();
+	}
+	// Forget old requests.
+	const unsigned long minCycle = GameCycle > CYCLES_PER_SECOND ? GameCycle - CYCLES_PER_SECOND : 0;
+	ranges::erase_if(FlowFieldDemands, [&](const FlowFieldDemand &demand) { return demand.LastCycle < minCycle; });
+
+	auto demand = ranges::find_if(FlowFieldDemands, [&](const FlowFieldDemand &demand) { return demand.Key == key; });
+	if (demand == FlowFieldDemands.end()) {
+		FlowFieldDemands.push_back({key, {}, GameCycle});
+		demand = std::prev(FlowFieldDemands.end());
+	}
+	demand->LastCycle = GameCycle;
+	if (!ranges::contains(demand->Units, UnitNumber(unit))) {
+		demand->Units.push_back(UnitNumber(unit));
+	}
+	if (demand->Units.size() < FlowFieldMinUnits) {
+		return nullptr;
+	}
+	FlowFieldDemands.erase(demand);
+
+	FlowFields.push_front(std::make_shared<CFlowField>(key));
+	// Forget the fields nobody follows anymore.
+	ranges::erase_if(LiveFlowFields, [](const std::weak_ptr<CFlowField> &field) { return field.expired(); });
+	LiveFlowFields.push_back(FlowFields.front());
+	if (FlowFields.size() > FlowFieldCacheSize) {
+		// Units still following it keep it alive.
+		FlowFields.pop_back();
+	}
+	return FlowFields.front();
+}
+
+/**
+**  Find the first steps of a path using a shared flow field.
+**
+**  @param input      Path request of the unit.
+**  @param path       Where to store the directions, the first step last.
+**  @param pathLen    Size of path.
+**  @param flowField  Field used by the unit, updated.
+**
+**  @return  Path length, PF_REACHED, or PF_FAILED if a* must be used.
+*/
+int FlowFieldFindPath(const PathFinderInput &input, char *path, int pathLen, std::shared_ptr<CFlowField> &flowField)
+{
+	// The field knows the whole terrain, don't leak unexplored parts.
+	if (!AStarFlowField || !AStarKnowUnseenTerrain) {
+		flowField.reset();
+		return PF_FAILED;
+	}
+	const CUnit &unit = *input.GetUnit();
+	FlowFieldKey key;
+	key.goalPos = input.GetGoalPos();
+	key.goalSize = input.GetGoalSize();
+	key.unitSize = input.GetUnitSize();
+	key.minRange = input.GetMinRange();
+	key.maxRange = input.GetMaxRange();
+	key.terrainMask = unit.Type->MovementMask & ~(MapFieldLandUnit | MapFieldAirUnit | MapFieldSeaUnit);
+
+	if (!flowField || !flowField->IsValid() || !(flowField->GetKey() == key)) {
+		flowField = GetFlowField(key, unit);
+		if (!flowField) {
+			return PF_FAILED;
+		}
+	}
+	const int ret = flowField->FindPath(input.GetUnitPos(), path, pathLen);
+	if (ret == PF_FAILED) {
+		flowField.reset();
+	}
+	return ret;
+}
+
+/**
+**  Tell the flow fields that the terrain of an area has changed.
+**
+**  @param pos   Top left tile of the area.
+**  @param size  Size of the area in tiles.
+*/
+void FlowFieldTerrainChanged(const Vec2i &pos, const Vec2i &size)
+{
+	ranges::erase_if(LiveFlowFields, [&](const std::weak_ptr<CFlowField> &weakField) {
+		const auto field = weakField.lock();
+		if (field) {
+			field->TerrainChanged(pos, size);
+		}
+		return !field || !field->IsValid();
+	});
+	FlowFields.remove_if([](const auto &field) { return !field->IsValid(); });
+}
+
+/**
+**  Free the flow fields.
+*/
+void FreeFlowFields()
+{
+	FlowFields.clear();
+	LiveFlowFields.clear();
+	FlowFieldDemands.clear();
+	FlowFieldStoragePool.clear();
+}
+
+//@}
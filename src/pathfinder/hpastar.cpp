@@ -0,0 +1,588 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+/**@name hpastar.cpp - Hierarchical abstraction for the a* path finder. */
+//
+//      (c) Copyright 2026 by the Stratagus Developers
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+//@{
+
+/*----------------------------------------------------------------------------
+--  Includes
+----------------------------------------------------------------------------*/
+
+#include "stratagus.h"
+
+#include "pathfinder.h"
+
+#include "map.h"
+#include "unit.h"
+#include "unittype.h"
+
+#include <climits>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+
+/*----------------------------------------------------------------------------
+--  Declarations
+----------------------------------------------------------------------------*/
+
+/**
+**  The map is cut into square sectors of AStarHierarchicalSectorSize tiles.
+**  Along each border between two sectors, every run of tiles which are
+**  passable on both sides gives an entrance (two for long runs).
+**  Entrances are the nodes of the abstract graph: inside a sector they are
+**  linked with their real travel cost, across a border with a single step.
+**
+**  Only the terrain is considered (units are ignored), so there is one
+**  graph per movement mask and unit size. A terrain change only marks the
+**  sectors around it as dirty, they are rebuilt the next time they are used.
+*/
+
+namespace
+{
+
+/// Runs of entrance tiles at least this long get an entrance at each end
+constexpr int LongEntranceLength = 6;
+
+struct HpaEdge
+{
+	uint16_t Target = 0; /// Index of the target node in the sector
+	uint16_t Cost = 0;   /// Cost to reach the target node
+};
+
+struct HpaNode
+{
+	unsigned int Index = 0;     /// Map index of the entrance tile
+	std::vector<HpaEdge> Edges; /// Links to the other entrances of the sector
+};
+
+struct HpaSector
+{
+	bool Dirty = true;          /// Entrances must be recomputed before use
+	std::vector<HpaNode> Nodes; /// Entrances, sorted by map index
+};
+
+class CHierarchicalGraph
+{
+public:
+	CHierarchicalGraph(unsigned int mask, const Vec2i &unitSize, int sectorSize);
+
+	bool Matches(unsigned int mask, const Vec2i &unitSize) const
+	{
+		return this->mask == mask && this->unitSize == unitSize;
+	}
+	int GetSectorSize() const { return sectorSize; }
+
+	void MarkDirty(const Vec2i &minPos, const Vec2i &maxPos);
+	std::optional<Vec2i> FindWaypoint(const Vec2i &startPos, const Vec2i &goalPos);
+
+private:
+	bool IsPassable(const Vec2i &pos) const;
+	int StepCost(const Vec2i &pos) const;
+
+	int SectorIndex(const Vec2i &pos) const { return (pos.y / sectorSize) * sectorsX + pos.x / sectorSize; }
+	Vec2i SectorMin(int sectorIndex) const;
+	Vec2i SectorMax(int sectorIndex) const;
+
+	HpaSector &Refresh(int sectorIndex);
+	const HpaNode *FindNode(const HpaSector &sector, unsigned int index) const;
+	void AddBorderEntrances(const Vec2i &first, const Vec2i &step, const Vec2i &outside,
+	                        int length, std::vector<Vec2i> &entrances) const;
+	void SectorCosts(int sectorIndex, const Vec2i &origin, bool reverse, std::vector<int> &costs) const;
+
+private:
+	unsigned int mask;
+	Vec2i unitSize;
+	int sectorSize;
+	int sectorsX;
+	int sectorsY;
+	std::vector<HpaSector> sectors;
+};
+
+} // namespace
+
+/*----------------------------------------------------------------------------
+--  Variables
+----------------------------------------------------------------------------*/
+
+/// see pathfinder.h
+bool AStarHierarchical = false;
+int AStarHierarchicalSectorSize = 16;
+
+static int HpaMapWidth = 0;
+static int HpaMapHeight = 0;
+
+/// One graph per movement mask and unit size, created on first use
+static std::vector<std::unique_ptr<CHierarchicalGraph>> HpaGraphs;
+
+/*----------------------------------------------------------------------------
+--  Methods
+----------------------------------------------------------------------------*/
+
+CHierarchicalGraph::CHierarchicalGraph(unsigned int mask, const Vec2i &unitSize, int sectorSize) :
+	mask(mask),
+	unitSize(unitSize),
+	sectorSize(sectorSize),
+	sectorsX((HpaMapWidth + sectorSize - 1) / sectorSize),
+	sectorsY((HpaMapHeight + sectorSize - 1) / sectorSize),
+	sectors(sectorsX * sectorsY)
+{
+}
+
+/**
+**  Check if the unit footprint fits on the terrain at pos.
+*/
+bool CHierarchicalGraph::IsPassable(const Vec2i &pos) const
+{
+	if (pos.x < 0 || pos.y < 0
+	    || pos.x + unitSize.x > HpaMapWidth || pos.y + unitSize.y > HpaMapHeight) {
+		return false;
+	}
+	return TerrainFootprintPassable(pos, mask, unitSize);
+}
+
+/**
+**  Cost to enter pos, same scale as the a* step cost without units.
+*/
+int CHierarchicalGraph::StepCost(const Vec2i &pos) const
+{
+	int cost = 0;
+	for (int y = 0; y < unitSize.y; ++y) {
+		const CMapField *mf = Map.Field(pos.x, pos.y + y);
+		for (int x = 0; x < unitSize.x; ++x, ++mf) {
+			cost += mf->getMoveCost();
+		}
+	}
+	return 1 + cost / (unitSize.x * unitSize.y);
+}
+
+Vec2i CHierarchicalGraph::SectorMin(int sectorIndex) const
+{
+	return Vec2i((sectorIndex % sectorsX) * sectorSize, (sectorIndex / sectorsX) * sectorSize);
+}
+
+Vec2i CHierarchicalGraph::SectorMax(int sectorIndex) const
+{
+	const Vec2i minPos = SectorMin(sectorIndex);
+	return Vec2i(std::min(minPos.x + sectorSize, HpaMapWidth) - 1,
+	             std::min(minPos.y + sectorSize, HpaMapHeight) - 1);
+}
+
+/**
+**  Mark the sectors whose entrances may depend on the tiles in [minPos, maxPos].
+*/
+void CHierarchicalGraph::MarkDirty(const Vec2i &minPos, const Vec2i &maxPos)
+{
+	// The footprint at pos covers the tiles up to pos + unitSize - 1,
+	// and the entrances of a sector look one tile outside of it.
+	const int minX = std::max(0, minPos.x - unitSize.x) / sectorSize;
+	const int minY = std::max(0, minPos.y - unitSize.y) / sectorSize;
+	const int maxX = std::min(HpaMapWidth - 1, maxPos.x + 1) / sectorSize;
+	const int maxY = std::min(HpaMapHeight - 1, maxPos.y + 1) / sectorSize;
+
+	for (int y = minY; y <= maxY; ++y) {
+		for (int x = minX; x <= maxX; ++x) {
+			sectors[y * sectorsX + x].Dirty = true;
+		}
+	}
+}
+
+/**
+**  Add the entrances of one border of a sector.
+**
+**  @param first     First tile of the border, inside the sector.
+**  @param step      Offset between two tiles of the border.
+**  @param outside   Offset from a border tile to its neighbour in the next sector.
+**  @param length    Number of tiles of the border.
+**  @param entrances Where to add the entrance tiles.
+**
+**  @note Both sectors of a border find the same runs, so their entrances
+**        always face each other.
+*/
+void CHierarchicalGraph::AddBorderEntrances(const Vec2i &first, const Vec2i &step, const Vec2i &outside,
+                                            int length, std::vector<Vec2i> &entrances) const
+{
+	int runStart = -1;
+	for (int i = 0; i <= length; ++i) {
+		const Vec2i pos = first + step * i;
+		if (i < length && IsPassable(pos) && IsPassable(pos + outside)) {
+			if (runStart < 0) {
+				runStart = i;
+			}
+			continue;
+		}
+		if (runStart < 0) {
+			continue;
+		}
+		const int runEnd = i - 1;
+		if (runEnd - runStart + 1 >= LongEntranceLength) {
+			entrances.push_back(first + step * runStart);
+			entrances.push_back(first + step * runEnd);
+		} else {
+			entrances.push_back(first + step * ((runStart + runEnd) / 2));
+		}
+		runStart = -1;
+	}
+}
+
+/**
+**  Compute the travel costs inside a sector.
+**
+**  @param sectorIndex  Sector to search.
+**  @param origin       Tile the search starts from.
+**  @param reverse      If set, compute the cost to reach origin instead of
+**                      the cost to come from it.
+**  @param costs        Cost for each tile of the sector, INT_MAX if unreachable.
+*/
+void CHierarchicalGraph::SectorCosts(int sectorIndex, const Vec2i &origin, bool reverse, std::vector<int> &costs) const
+{
+	const Vec2i minPos = SectorMin(sectorIndex);
+	const Vec2i maxPos = SectorMax(sectorIndex);
+	const int width = maxPos.x - minPos.x + 1;
+	const int height = maxPos.y - minPos.y + 1;
+
+	costs.assign(width * height, INT_MAX);
+
+	using Entry = std::pair<int, int>; // cost, local index
+	std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+	const int originLocal = (origin.y - minPos.y) * width + origin.x - minPos.x;
+	costs[originLocal] = 0;
+	open.emplace(0, originLocal);
+
+	while (!open.empty()) {
+		const auto [cost, local] = open.top();
+		open.pop();
+		if (cost != costs[local]) {
+			continue;
+		}
+		const Vec2i pos(minPos.x + local % width, minPos.y + local / width);
+		// The origin may be unpassable (a building as goal), leaving it is free.
+		const int leaveCost = reverse && IsPassable(pos) ? StepCost(pos) : 0;
+
+		for (int i = 0; i < 8; ++i) {
+			const Vec2i next(pos.x + Heading2X[i], pos.y + Heading2Y[i]);
+			if (next.x < minPos.x || next.x > maxPos.x || next.y < minPos.y || next.y > maxPos.y
+			    || !IsPassable(next)) {
+				continue;
+			}
+			const int nextCost = cost + (reverse ? leaveCost : StepCost(next));
+			const int nextLocal = (next.y - minPos.y) * width + next.x - minPos.x;
+			if (nextCost < costs[nextLocal]) {
+				costs[nextLocal] = nextCost;
+				open.emplace(nextCost, nextLocal);
+			}
+		}
+	}
+}
+
+/**
+**  Rebuild the entrances of a sector if needed.
+*/
+HpaSector &CHierarchicalGraph::Refresh(int sectorIndex)
+{
+	HpaSector &sector = sectors[sectorIndex];
+	if (!sector.Dirty) {
+		return sector;
+	}
+	const Vec2i minPos = SectorMin(sectorIndex);
+	const Vec2i maxPos = SectorMax(sectorIndex);
+	const int width = maxPos.x - minPos.x + 1;
+	const int height = maxPos.y - minPos.y + 1;
+
+	std::vector<Vec2i> entrances;
+	if (minPos.y > 0) {
+		AddBorderEntrances(minPos, Vec2i(1, 0), Vec2i(0, -1), width, entrances);
+	}
+	if (maxPos.y + 1 < HpaMapHeight) {
+		AddBorderEntrances(Vec2i(minPos.x, maxPos.y), Vec2i(1, 0), Vec2i(0, 1), width, entrances);
+	}
+	if (minPos.x > 0) {
+		AddBorderEntrances(minPos, Vec2i(0, 1), Vec2i(-1, 0), height, entrances);
+	}
+	if (maxPos.x + 1 < HpaMapWidth) {
+		AddBorderEntrances(Vec2i(maxPos.x, minPos.y), Vec2i(0, 1), Vec2i(1, 0), height, entrances);
+	}
+
+	sector.Nodes.clear();
+	for (const Vec2i &pos : entrances) {
+		HpaNode node;
+		node.Index = Map.getIndex(pos);
+		sector.Nodes.push_back(std::move(node));
+	}
+	ranges::sort(sector.Nodes, std::less<>{}, &HpaNode::Index);
+	sector.Nodes.erase(std::unique(sector.Nodes.begin(), sector.Nodes.end(),
+	                               [](const HpaNode &lhs, const HpaNode &rhs) { return lhs.Index == rhs.Index; }),
+	                   sector.Nodes.end());
+
+	std::vector<int> costs;
+	for (HpaNode &node : sector.Nodes) {
+		const Vec2i pos(node.Index % Map.Info.MapWidth, node.Index / Map.Info.MapWidth);
+		SectorCosts(sectorIndex, pos, false, costs);
+		for (size_t i = 0; i != sector.Nodes.size(); ++i) {
+			const HpaNode &target = sector.Nodes[i];
+			if (&target == &node) {
+				continue;
+			}
+			const int local = (target.Index / Map.Info.MapWidth - minPos.y) * width
+			                  + target.Index % Map.Info.MapWidth - minPos.x;
+			if (costs[local] != INT_MAX) {
+				node.Edges.push_back({uint16_t(i), uint16_t(std::min(costs[local], UINT16_MAX))});
+			}
+		}
+	}
+	sector.Dirty = false;
+	return sector;
+}
+
+const HpaNode *CHierarchicalGraph::FindNode(const HpaSector &sector, unsigned int index) const
+{
+	auto it = ranges::lower_bound(sector.Nodes.begin(), sector.Nodes.end(), index, std::less<>{}, &HpaNode::Index);
+	return it != sector.Nodes.end() && it->Index == index ? &*it : nullptr;
+}
+
+/**
+**  Search the abstract graph from startPos to goalPos.
+**
+**  @return  The farthest entrance of the abstract path which is still close
+**           to startPos, or nothing if the terrain gives no path.
+*/
+std::optional<Vec2i> CHierarchicalGraph::FindWaypoint(const Vec2i &startPos, const Vec2i &goalPos)
+{
+	const int startSector = SectorIndex(startPos);
+	const int goalSector = SectorIndex(goalPos);
+	if (startSector == goalSector || !IsPassable(startPos)) {
+		return std::nullopt;
+	}
+	const int mapWidth = Map.Info.MapWidth;
+	const auto toPos = [mapWidth](unsigned int index) {
+		return Vec2i(index % mapWidth, index / mapWidth);
+	};
+
+	// Temporary links from the start to the entrances of its sector...
+	std::vector<int> costs;
+	std::vector<std::pair<unsigned int, int>> startLinks;
+	{
+		const HpaSector &sector = Refresh(startSector);
+		const Vec2i minPos = SectorMin(startSector);
+		const int width = SectorMax(startSector).x - minPos.x + 1;
+		SectorCosts(startSector, startPos, false, costs);
+		for (const HpaNode &node : sector.Nodes) {
+			const Vec2i pos = toPos(node.Index);
+			const int cost = costs[(pos.y - minPos.y) * width + pos.x - minPos.x];
+			if (cost != INT_MAX) {
+				startLinks.emplace_back(node.Index, cost);
+			}
+		}
+	}
+	// ... and from the entrances of the goal sector to the goal.
+	std::unordered_map<unsigned int, int> goalLinks;
+	{
+		const HpaSector &sector = Refresh(goalSector);
+		const Vec2i minPos = SectorMin(goalSector);
+		const int width = SectorMax(goalSector).x - minPos.x + 1;
+		SectorCosts(goalSector, goalPos, true, costs);
+		for (const HpaNode &node : sector.Nodes) {
+			const Vec2i pos = toPos(node.Index);
+			const int cost = costs[(pos.y - minPos.y) * width + pos.x - minPos.x];
+			if (cost != INT_MAX) {
+				goalLinks.emplace(node.Index, cost);
+			}
+		}
+	}
+	if (startLinks.empty() || goalLinks.empty()) {
+		return std::nullopt;
+	}
+
+	struct Visit
+	{
+		int Cost = INT_MAX;
+		unsigned int Parent = 0;
+		bool Closed = false;
+	};
+	constexpr unsigned int GoalIndex = UINT_MAX;
+	const unsigned int startIndex = Map.getIndex(startPos);
+	const auto estimate = [&](unsigned int index) {
+		if (index == GoalIndex) {
+			return 0;
+		}
+		const Vec2i pos = toPos(index);
+		return 2 * std::max(std::abs(pos.x - goalPos.x), std::abs(pos.y - goalPos.y));
+	};
+
+	using OpenEntry = std::tuple<int, int, unsigned int>; // estimated total cost, cost, index
+	std::priority_queue<OpenEntry, std::vector<OpenEntry>, std::greater<OpenEntry>> open;
+	std::unordered_map<unsigned int, Visit> visits;
+
+	visits[startIndex].Cost = 0;
+	open.emplace(estimate(startIndex), 0, startIndex);
+
+	bool found = false;
+	while (!open.empty()) {
+		const auto [total, cost, index] = open.top();
+		open.pop();
+		if (index == GoalIndex) {
+			found = true;
+			break;
+		}
+		Visit &visit = visits[index];
+		if (visit.Closed || cost != visit.Cost) {
+			continue;
+		}
+		visit.Closed = true;
+
+		const auto relax = [&](unsigned int nextIndex, int stepCost) {
+			Visit &next = visits[nextIndex];
+			if (next.Closed || cost + stepCost >= next.Cost) {
+				return;
+			}
+			next.Cost = cost + stepCost;
+			next.Parent = index;
+			open.emplace(next.Cost + estimate(nextIndex), next.Cost, nextIndex);
+		};
+
+		if (index == startIndex) {
+			for (const auto &[nextIndex, stepCost] : startLinks) {
+				relax(nextIndex, stepCost);
+			}
+		}
+		const Vec2i pos = toPos(index);
+		const int sectorIndex = SectorIndex(pos);
+		const HpaSector &sector = Refresh(sectorIndex);
+		if (const HpaNode *node = FindNode(sector, index)) {
+			for (const HpaEdge &edge : node->Edges) {
+				relax(sector.Nodes[edge.Target].Index, edge.Cost);
+			}
+			// Cross to the facing entrance of the neighbour sectors (N, E, S, W).
+			for (int i = 0; i < 8; i += 2) {
+				const Vec2i next(pos.x + Heading2X[i], pos.y + Heading2Y[i]);
+				if (!Map.Info.IsPointOnMap(next) || SectorIndex(next) == sectorIndex) {
+					continue;
+				}
+				const unsigned int nextIndex = Map.getIndex(next);
+				if (FindNode(Refresh(SectorIndex(next)), nextIndex)) {
+					relax(nextIndex, StepCost(next));
+				}
+			}
+		}
+		if (sectorIndex == goalSector) {
+			if (auto it = goalLinks.find(index); it != goalLinks.end()) {
+				relax(GoalIndex, it->second);
+			}
+		}
+	}
+	if (!found) {
+		return std::nullopt;
+	}
+
+	std::vector<unsigned int> path;
+	for (unsigned int index = visits[GoalIndex].Parent; index != startIndex; index = visits[index].Parent) {
+		path.push_back(index);
+	}
+	if (path.empty()) {
+		return std::nullopt;
+	}
+	// Only refine the beginning of the path: the unit will ask again later.
+	const int refineDistance = 2 * sectorSize;
+	Vec2i waypoint = toPos(path.back());
+	for (auto it = path.rbegin() + 1; it != path.rend(); ++it) {
+		const Vec2i pos = toPos(*it);
+		if (std::max(std::abs(pos.x - startPos.x), std::abs(pos.y - startPos.y)) > refineDistance) {
+			break;
+		}
+		waypoint = pos;
+	}
+	return waypoint;
+}
+
+/*----------------------------------------------------------------------------
+--  Functions
+----------------------------------------------------------------------------*/
+
+/**
+**  Init the hierarchical pathfinder, graphs are built on demand.
+*/
+void InitHierarchicalPathfinder(int mapWidth, int mapHeight)
+{
+	HpaGraphs.clear();
+	HpaMapWidth = mapWidth;
+	HpaMapHeight = mapHeight;
+}
+
+/**
+**  Free the hierarchical pathfinder.
+*/
+void FreeHierarchicalPathfinder()
+{
+	HpaGraphs.clear();
+	HpaMapWidth = 0;
+	HpaMapHeight = 0;
+}
+
+/**
+**  Mark the abstract graphs around a changed area as dirty.
+**
+**  @param pos   Top left tile of the area.
+**  @param size  Size of the area.
+*/
+void HierarchicalTerrainChanged(const Vec2i &pos, const Vec2i &size)
+{
+	const Vec2i maxPos(pos.x + size.x - 1, pos.y + size.y - 1);
+	for (auto &graph : HpaGraphs) {
+		graph->MarkDirty(pos, maxPos);
+	}
+}
+
+/**
+**  Find an intermediate goal for a long path using the abstract graph.
+**
+**  @param startPos  Start position of the unit.
+**  @param goalPos   Final goal.
+**  @param unit      Unit which moves.
+**
+**  @return  Position to give to a* instead of goalPos, nothing if the
+**           abstraction can't help (and plain a* should be used).
+*/
+std::optional<Vec2i> HierarchicalFindWaypoint(const Vec2i &startPos, const Vec2i &goalPos, const CUnit &unit)
+{
+	if (HpaMapWidth == 0 || AStarHierarchicalSectorSize <= 0) {
+		return std::nullopt;
+	}
+	const unsigned int mask = unit.Type->MovementMask;
+	const Vec2i unitSize(unit.Type->TileWidth, unit.Type->TileHeight);
+
+	if (!HpaGraphs.empty() && HpaGraphs.front()->GetSectorSize() != AStarHierarchicalSectorSize) {
+		HpaGraphs.clear();
+	}
+	auto it = ranges::find_if(HpaGraphs, [&](const auto &graph) { return graph->Matches(mask, unitSize); });
+	if (it == HpaGraphs.end()) {
+		HpaGraphs.push_back(std::make_unique<CHierarchicalGraph>(mask, unitSize, AStarHierarchicalSectorSize));
+		it = std::prev(HpaGraphs.end());
+	}
+	return (*it)->FindWaypoint(startPos, goalPos);
+}
+
+//@}
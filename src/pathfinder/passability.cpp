@@ -0,0 +1,167 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+/**@name passability.cpp - Bitplanes of the terrain passability. */
+//
+//      (c) Copyright 2026 by the Stratagus Developers
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+//@{
+
+/*----------------------------------------------------------------------------
+--  Includes
+----------------------------------------------------------------------------*/
+
+#include "stratagus.h"
+
+#include "pathfinder.h"
+
+#include "map.h"
+
+/*----------------------------------------------------------------------------
+--  Variables
+----------------------------------------------------------------------------*/
+
+/// One bitplane per terrain mask and unit size, created on first use
+static std::vector<std::unique_ptr<CPassabilityPlane>> PassabilityPlanes;
+
+/*----------------------------------------------------------------------------
+--  Functions
+----------------------------------------------------------------------------*/
+
+CPassabilityPlane::CPassabilityPlane(uint64_t terrainMask, const Vec2i &unitSize) :
+	terrainMask(terrainMask),
+	unitSize(unitSize),
+	wordsPerRow((Map.Info.MapWidth + 63) / 64),
+	height(Map.Info.MapHeight)
+{
+	Assert(0 < unitSize.x && unitSize.x < 64 && 0 < unitSize.y);
+	tileBits.resize(wordsPerRow * height);
+	bits.resize(wordsPerRow * height);
+	UpdateTiles(Vec2i(0, 0), Vec2i(Map.Info.MapWidth, Map.Info.MapHeight));
+	UpdateRows(0, height - 1);
+}
+
+/**
+**  Read the terrain of the tiles of an area.
+*/
+void CPassabilityPlane::UpdateTiles(const Vec2i &pos, const Vec2i &size)
+{
+	for (int y = pos.y; y != pos.y + size.y; ++y) {
+		const CMapField *mf = Map.Field(pos.x, y);
+		for (int x = pos.x; x != pos.x + size.x; ++x, ++mf) {
+			uint64_t &word = tileBits[y * wordsPerRow + x / 64];
+			const uint64_t bit = uint64_t(1) << (x % 64);
+			if (mf->Flags & terrainMask) {
+				word &= ~bit;
+			} else {
+				word |= bit;
+			}
+		}
+	}
+}
+
+/**
+**  Compute the footprint bits of rows from the tile bits.
+**
+**  The footprint of x is passable if the tiles x to x + width - 1 of the
+**  height rows starting at y are, so the words of these rows are shifted
+**  and and-ed together. Tiles outside of the map are not passable.
+*/
+void CPassabilityPlane::UpdateRows(int minY, int maxY)
+{
+	minY = std::max(0, minY);
+	maxY = std::min(height - 1, maxY);
+	for (int y = minY; y <= maxY; ++y) {
+		for (int i = 0; i != wordsPerRow; ++i) {
+			uint64_t word = y + unitSize.y <= height ? ~uint64_t(0) : 0;
+			for (int row = y; row != std::min(height, y + unitSize.y); ++row) {
+				const uint64_t *rowBits = &tileBits[row * wordsPerRow];
+				const uint64_t next = i + 1 < wordsPerRow ? rowBits[i + 1] : 0;
+				word &= rowBits[i];
+				for (int shift = 1; shift < unitSize.x; ++shift) {
+					word &= (rowBits[i] >> shift) | (next << (64 - shift));
+				}
+			}
+			bits[y * wordsPerRow + i] = word;
+		}
+	}
+}
+
+/**
+**  Update the bits of the positions whose footprint overlaps the area.
+**
+**  @param pos   Top left tile of the changed area.
+**  @param size  Size of the changed area.
+*/
+void CPassabilityPlane::TerrainChanged(const Vec2i &pos, const Vec2i &size)
+{
+	const Vec2i minPos(std::max<int>(0, pos.x), std::max<int>(0, pos.y));
+	const Vec2i maxPos(std::min<int>(Map.Info.MapWidth, pos.x + size.x), std::min<int>(height, pos.y + size.y));
+	if (minPos.x >= maxPos.x || minPos.y >= maxPos.y) {
+		return;
+	}
+	UpdateTiles(minPos, maxPos - minPos);
+	UpdateRows(minPos.y - unitSize.y + 1, maxPos.y - 1);
+}
+
+/**
+**  Get the bitplane of a movement mask and unit size.
+**
+**  Creates it if needed, so the first call for a mask and size must not be
+**  done while other threads use the planes.
+*/
+const CPassabilityPlane &GetPassabilityPlane(uint64_t mask, const Vec2i &unitSize)
+{
+	const uint64_t terrainMask = mask & ~(MapFieldLandUnit | MapFieldAirUnit | MapFieldSeaUnit);
+	auto it = ranges::find_if(PassabilityPlanes, [&](const auto &plane) { return plane->Matches(terrainMask, unitSize); });
+	if (it == PassabilityPlanes.end()) {
+		PassabilityPlanes.push_back(std::make_unique<CPassabilityPlane>(terrainMask, unitSize));
+		it = std::prev(PassabilityPlanes.end());
+	}
+	return **it;
+}
+
+/**
+**  Tell the passability bitplanes that the terrain of an area has changed.
+**
+**  @param pos   Top left tile of the area.
+**  @param size  Size of the area in tiles.
+*/
+void PassabilityTerrainChanged(const Vec2i &pos, const Vec2i &size)
+{
+	for (auto &plane : PassabilityPlanes) {
+		plane->TerrainChanged(pos, size);
+	}
+}
+
+/**
+**  Free the passability bitplanes.
+*/
+void FreePassability()
+{
+	PassabilityPlanes.clear();
+}
+
+//@}
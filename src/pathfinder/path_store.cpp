@@ -0,0 +1,151 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+/**@name path_store.cpp - Pool of the packed paths. */
+//
+//      (c) Copyright 2026 by the Stratagus Developers
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+//@{
+
+/*----------------------------------------------------------------------------
+--  Includes
+----------------------------------------------------------------------------*/
+
+#include "stratagus.h"
+
+#include "pathfinder.h"
+
+/*----------------------------------------------------------------------------
+--  Variables
+----------------------------------------------------------------------------*/
+
+/// Number of directions packed in a word of the pool
+static constexpr int DirectionsPerWord = 10;
+
+/// Words of all the packed paths
+static std::vector<uint32_t> PathPool;
+/// Free blocks of the pool, by size class
+static std::vector<std::vector<int>> FreePathBlocks;
+/// Changed each time the pool is freed, blocks of older pools are forgotten
+static unsigned int PathPoolGeneration = 0;
+
+/*----------------------------------------------------------------------------
+--  Functions
+----------------------------------------------------------------------------*/
+
+/**
+**  Get a block of 1 << sizeClass words, reusing a freed one if possible.
+*/
+static int AllocatePathBlock(int sizeClass)
+{
+	if (sizeClass < int(FreePathBlocks.size()) && !FreePathBlocks[sizeClass].empty()) {
+		const int block = FreePathBlocks[sizeClass].back();
+		FreePathBlocks[sizeClass].pop_back();
+		return block;
+	}
+	const int block = PathPool.size();
+	PathPool.resize(PathPool.size() + (size_t(1) << sizeClass));
+	return block;
+}
+
+int CPackedPath::Get(int i) const
+{
+	Assert(0 <= i && i < GetLength());
+	Assert(Generation == PathPoolGeneration);
+	const int index = Begin + i;
+	return (PathPool[Block + index / DirectionsPerWord] >> (3 * (index % DirectionsPerWord))) & 7;
+}
+
+/**
+**  Replace the path.
+**
+**  @param directions  Directions of the steps, the first step first.
+**  @param length      Number of steps.
+*/
+void CPackedPath::Assign(const char *directions, int length)
+{
+	Clear();
+	if (length <= 0) {
+		return;
+	}
+	const int words = (length + DirectionsPerWord - 1) / DirectionsPerWord;
+	while ((1 << SizeClass) < words) {
+		++SizeClass;
+	}
+	Block = AllocatePathBlock(SizeClass);
+	Generation = PathPoolGeneration;
+	std::fill_n(PathPool.begin() + Block, words, 0);
+	for (int i = 0; i != length; ++i) {
+		Assert(0 <= directions[i] && directions[i] < 8);
+		PathPool[Block + i / DirectionsPerWord] |= uint32_t(directions[i]) << (3 * (i % DirectionsPerWord));
+	}
+	Begin = 0;
+	End = length;
+}
+
+/**
+**  Remove the first steps of the path.
+*/
+void CPackedPath::PopFront(int count)
+{
+	Assert(0 <= count && count <= GetLength());
+	Begin += count;
+	if (IsEmpty()) {
+		Clear();
+	}
+}
+
+/**
+**  Give the block back to the pool.
+*/
+void CPackedPath::Clear()
+{
+	if (Block != -1 && Generation == PathPoolGeneration) {
+		if (SizeClass >= int(FreePathBlocks.size())) {
+			FreePathBlocks.resize(SizeClass + 1);
+		}
+		FreePathBlocks[SizeClass].push_back(Block);
+	}
+	Block = -1;
+	SizeClass = 0;
+	Begin = 0;
+	End = 0;
+}
+
+/**
+**  Free the pool of the packed paths.
+**
+**  Paths still alive, like the ones of the units kept for the next game,
+**  only forget their block.
+*/
+void FreePathStore()
+{
+	PathPool.clear();
+	PathPool.shrink_to_fit();
+	FreePathBlocks.clear();
+	++PathPoolGeneration;
+}
+
+//@}
@@ -61,32 +61,102 @@ extern int AStarFindPath(const Vec2i &startPos, const Vec2i &goalPos, int gw, in
 --  Variables
 ----------------------------------------------------------------------------*/
 
+/// Where a* stores the complete paths, sized for the longest one
+static std::vector<char> PathBuffer;
+
+/// Steps of a blocked path which are searched again
+static constexpr int PathRepairDistance = 8;
+
+/**
+**  Pool of the storages which aren't used by a traversal, one per thread.
+*/
+std::vector<std::unique_ptr<TerrainTraversal::Storage>> &TerrainTraversal::StoragePool()
+{
+	static thread_local std::vector<std::unique_ptr<Storage>> pool;
+	return pool;
+}
+
+TerrainTraversal::~TerrainTraversal()
+{
+	if (m_storage) {
+		StoragePool().push_back(std::move(m_storage));
+	}
+}
+
 void TerrainTraversal::SetSize(unsigned int width, unsigned int height)
 {
-	m_values.resize((width + 2) * (height + 2));
+	if (!m_storage) {
+		auto &pool = StoragePool();
+		if (pool.empty()) {
+			m_storage = std::make_unique<Storage>();
+		} else {
+			m_storage = std::move(pool.back());
+			pool.pop_back();
+		}
+	}
+	Storage &storage = *m_storage;
+	if (storage.extentedWidth != width + 2 || storage.height != height) {
+		storage.marks.assign((width + 2) * (height + 2), Mark{0, 0});
+		storage.generation = 0;
+		storage.extentedWidth = width + 2;
+		storage.height = height;
+	}
+	if (storage.frontier.empty()) {
+		// Enough for the usual fronts, GrowFrontier handles the others.
+		size_t size = 64;
+		while (size < 4 * (width + height)) {
+			size <<= 1;
+		}
+		storage.frontier.resize(size);
+	}
 	m_extented_width = width + 2;
 	m_height = height;
 }
 
 void TerrainTraversal::Init()
 {
-	const unsigned int height = m_height;
-	const unsigned int width = m_extented_width - 2;
-	const unsigned int width_ext = m_extented_width;
+	Storage &storage = *m_storage;
 
-	memset(&m_values[0], '\xFF', width_ext * sizeof(dataType));
-	for (unsigned i = 1; i < 1 + height; ++i) {
-		m_values[i * width_ext] = -1;
-		memset(&m_values[i * width_ext + 1], '\0', width * sizeof(dataType));
-		m_values[i * width_ext + width + 1] = -1;
+	if (++storage.generation == 0) {
+		// Stamps wrapped around, old marks could look like new ones.
+		std::fill(storage.marks.begin(), storage.marks.end(), Mark{0, 0});
+		storage.generation = 1;
+	}
+	m_generation = storage.generation;
+	m_head = 0;
+	m_count = 0;
+
+	// Only the border has to be set, other positions are unvisited
+	// as long as they have an older stamp.
+	const int width = m_extented_width - 2;
+	const int height = m_height;
+	for (int x = -1; x != width + 1; ++x) {
+		Set(Vec2i(x, -1), -1);
+		Set(Vec2i(x, height), -1);
+	}
+	for (int y = 0; y != height; ++y) {
+		Set(Vec2i(-1, y), -1);
+		Set(Vec2i(width, y), -1);
 	}
-	memset(&m_values[(height + 1) * width_ext], '\xFF', width_ext * sizeof(dataType));
+}
+
+/**
+**  Double the size of the frontier, keeping the order of its nodes.
+*/
+void TerrainTraversal::GrowFrontier()
+{
+	std::vector<PosNode> &frontier = m_storage->frontier;
+	const size_t oldSize = frontier.size();
+
+	std::rotate(frontier.begin(), frontier.begin() + m_head, frontier.end());
+	frontier.resize(2 * oldSize);
+	m_head = 0;
 }
 
 void TerrainTraversal::PushPos(const Vec2i &pos)
 {
-	if (IsVisited(pos) == false) {
-		m_queue.push(PosNode(pos, pos));
+	if (IsVisited(pos) == false && m_maxDistance >= 1) {
+		PushNode(pos, pos);
 		Set(pos, 1);
 	}
 }
@@ -96,13 +166,17 @@ void TerrainTraversal::PushNeighboor(const Vec2i &pos)
 	const Vec2i offsets[] = {Vec2i(0, -1), Vec2i(-1, 0), Vec2i(1, 0), Vec2i(0, 1),
 							 Vec2i(-1, -1), Vec2i(1, -1), Vec2i(-1, 1), Vec2i(1, 1)
 							};
+	const int value = Get(pos) + 1;
 
+	if (value > m_maxDistance) {
+		return;
+	}
 	for (int i = 0; i != 8; ++i) {
 		const Vec2i newPos = pos + offsets[i];
 
 		if (IsVisited(newPos) == false) {
-			m_queue.push(PosNode(newPos, pos));
-			Set(newPos, Get(pos) + 1);
+			PushNode(newPos, pos);
+			Set(newPos, value);
 		}
 	}
 }
@@ -137,16 +211,6 @@ bool TerrainTraversal::IsInvalid(const Vec2i &pos) const
 	return Get(pos) != -1;
 }
 
-TerrainTraversal::dataType TerrainTraversal::Get(const Vec2i &pos) const
-{
-	return m_values[m_extented_width + 1 + pos.y * m_extented_width + pos.x];
-}
-
-void TerrainTraversal::Set(const Vec2i &pos, TerrainTraversal::dataType value)
-{
-	m_values[m_extented_width + 1 + pos.y * m_extented_width + pos.x] = value;
-}
-
 /*----------------------------------------------------------------------------
 --  Functions
 ----------------------------------------------------------------------------*/
@@ -157,6 +221,7 @@ void TerrainTraversal::Set(const Vec2i &pos, TerrainTraversal::dataType value)
 void InitPathfinder()
 {
 	InitAStar(Map.Info.MapWidth, Map.Info.MapHeight);
+	InitHierarchicalPathfinder(Map.Info.MapWidth, Map.Info.MapHeight);
 }
 
 /**
@@ -164,7 +229,43 @@ void InitPathfinder()
 */
 void FreePathfinder()
 {
+	FreeFlowFields();
+	FreeReachability();
+	FreeHierarchicalPathfinder();
 	FreeAStar();
+	FreePathStore();
+	PathBuffer.clear();
+}
+
+/**
+**  Tell the pathfinder that the terrain passability of an area has changed.
+**
+**  Called for map tile changes (walls, forest, rocks) and for units which
+**  block the terrain like buildings. Moving units are not reported.
+**
+**  @param pos   Top left tile of the area.
+**  @param size  Size of the area in tiles.
+*/
+void PathfinderTerrainChanged(const Vec2i &pos, const Vec2i &size)
+{
+	PassabilityTerrainChanged(pos, size);
+	HierarchicalTerrainChanged(pos, size);
+	ReachabilityTerrainChanged(pos, size);
+	FlowFieldTerrainChanged(pos, size);
+}
+
+/**
+**  Check if the terrain lets a unit stand at pos, ignoring the units on it.
+**
+**  @param pos   Top left tile of the unit.
+**  @param mask  Movement mask of the unit.
+**  @param size  Size of the unit in tiles.
+**
+**  @return      true if no tile of the footprint blocks the movement.
+*/
+bool TerrainFootprintPassable(const Vec2i &pos, unsigned int mask, const Vec2i &size)
+{
+	return GetPassabilityPlane(mask, size).IsPassable(pos);
 }
 
 /*----------------------------------------------------------------------------
@@ -191,9 +292,13 @@ int PlaceReachable(const CUnit &src, const Vec2i &goalPos, int w, int h, int min
 	int srcTW = src.Type->TileWidth;
 	int srcTH = src.Type->TileHeight;
 	if (!from_outside_container || !src.Container) {
-		i = AStarFindPath(srcTilePos, goalPos, w, h,
-						  srcTW, srcTH,
-						  minrange, range, nullptr, 0, src);
+		if (!TerrainReachable(srcTilePos, goalPos, w, h, range, src)) {
+			i = PF_UNREACHABLE;
+		} else {
+			i = AStarFindPath(srcTilePos, goalPos, w, h,
+							  srcTW, srcTH,
+							  minrange, range, nullptr, 0, src);
+		}
 	} else {
 		const CUnit *first_container = GetFirstContainer(src);
 
@@ -217,6 +322,9 @@ int PlaceReachable(const CUnit &src, const Vec2i &goalPos, int w, int h, int min
 					//ignore tiles to which the unit cannot be dropped from its container
 					continue;
 				}
+				if (!TerrainReachable(tile_pos, goalPos, w, h, range, src)) {
+					continue;
+				}
 
 				i = AStarFindPath(tile_pos, goalPos, w, h,
 					srcTW, srcTH,
@@ -284,6 +392,9 @@ int UnitReachable(const CUnit &src, const CUnit &dst, int range, bool from_outsi
 
 int CalcPathLengthToUnit(const CUnit &src, const CUnit &dst, const int minrange, const int range)
 {
+	if (!TerrainReachable(src.tilePos, dst.tilePos, dst.Type->TileWidth, dst.Type->TileHeight, range, src)) {
+		return -1;
+	}
 	SetAStarFixedEnemyUnitsUnpassable(true); /// change Path Finder setting to don't count tiles with enemy units as passable
 	int length = AStarFindPath(src.tilePos, dst.tilePos,
 							   dst.Type->TileWidth, dst.Type->TileHeight,
@@ -302,6 +413,60 @@ int CalcPathLengthToUnit(const CUnit &src, const CUnit &dst, const int minrange,
 	return length;
 }
 
+/**
+**  Calc the path lengths for the unit 'src' to reach each unit of 'dsts'.
+**
+**  The searches run at once on the worker threads, the lengths are the
+**  ones CalcPathLengthToUnit gives for each unit.
+**
+**  @param src       Unit for the paths.
+**  @param dsts      Units to be reached.
+**  @param minrange  min range to the tiles
+**  @param range     Range to the tiles.
+**
+**  @return          path length to each unit of dsts or -1
+*/
+std::vector<int> CalcPathLengthsToUnits(const CUnit &src, const std::vector<CUnit *> &dsts,
+                                        const int minrange, const int range)
+{
+	std::vector<int> lengths(dsts.size(), -1);
+	std::vector<AStarRequest> requests;
+	std::vector<size_t> requestIndexes;
+
+	for (size_t i = 0; i != dsts.size(); ++i) {
+		const CUnit &dst = *dsts[i];
+		if (!TerrainReachable(src.tilePos, dst.tilePos, dst.Type->TileWidth, dst.Type->TileHeight, range, src)) {
+			continue;
+		}
+		AStarRequest &request = requests.emplace_back();
+		request.Unit = &src;
+		request.StartPos = src.tilePos;
+		request.GoalPos = dst.tilePos;
+		request.GoalSize = Vec2i(dst.Type->TileWidth, dst.Type->TileHeight);
+		request.MinRange = minrange;
+		request.MaxRange = range;
+		/// don't count tiles with enemy units as passable
+		request.FixedEnemyUnitsUnpassable = true;
+		requestIndexes.push_back(i);
+	}
+	AStarFindPaths(requests);
+	for (size_t i = 0; i != requests.size(); ++i) {
+		switch (requests[i].Result) {
+			case PF_FAILED:
+			case PF_UNREACHABLE:
+			case PF_WAIT:
+				break;
+			case PF_REACHED:
+				lengths[requestIndexes[i]] = 0;
+				break;
+			default:
+				lengths[requestIndexes[i]] = requests[i].Result;
+				break;
+		}
+	}
+	return lengths;
+}
+
 /*----------------------------------------------------------------------------
 --  REAL PATH-FINDER
 ----------------------------------------------------------------------------*/
@@ -371,51 +536,161 @@ PathFinderOutput::PathFinderOutput()
 	memset(this, 0, sizeof(*this));
 }
 
+/**
+**  Keep a path found by a*: the first steps go to the output and the
+**  other ones to the stored path.
+**
+**  @param data    Path data of the unit.
+**  @param path    Directions of the steps, the first step last.
+**  @param length  Number of steps.
+*/
+static void KeepPath(PathFinderData &data, const char *path, int length)
+{
+	PathFinderOutput &output = data.output;
+	const int outputLength = std::min<int>(length, PathFinderOutput::MAX_PATH_LENGTH);
+
+	std::copy_n(path + length - outputLength, outputLength, output.Path);
+	std::vector<char> rest(std::make_reverse_iterator(path + length - outputLength),
+						   std::make_reverse_iterator(path));
+	data.storedPath.Assign(rest.data(), rest.size());
+	output.Length = outputLength;
+	output.OverflowLength = std::min<int>(rest.size(), PathFinderOutput::MAX_OVERFLOW);
+}
+
+/**
+**  Move the next stored steps to the output.
+*/
+static void RefillPath(PathFinderData &data)
+{
+	PathFinderOutput &output = data.output;
+	CPackedPath &storedPath = data.storedPath;
+	const int length = std::min<int>(storedPath.GetLength(), PathFinderOutput::MAX_PATH_LENGTH);
+
+	for (int i = 0; i != length; ++i) {
+		output.Path[length - 1 - i] = storedPath.Get(i);
+	}
+	storedPath.PopFront(length);
+	output.Length = length;
+	output.OverflowLength = std::min<int>(storedPath.GetLength(), PathFinderOutput::MAX_OVERFLOW);
+}
+
 /**
 **  Find new path.
 **
 **  The destination could be a unit or a field.
 **  Range gives how far we must reach the goal.
 **
+**  The whole a* path is kept, so it is only searched again when the
+**  goal changes or the path is blocked.
+**
 **  @note  The destination could become negative coordinates!
 **
-**  @param unit  Path for this unit.
+**  @param data          Path data of the unit.
+**  @param useFlowField  Whether a shared flow field may be used. Fields
+**                       ignore units, so not when units are in the way.
 **
 **  @return      >0 remaining path length, 0 wait for path, -1
 **               reached goal, -2 can't reach the goal.
 */
-static int NewPath(PathFinderInput &input, PathFinderOutput &output)
+static int NewPath(PathFinderData &data, bool useFlowField)
 {
-	char *path = output.Path;
-	int i = AStarFindPath(input.GetUnitPos(),
+	PathFinderInput &input = data.input;
+	PathFinderOutput &output = data.output;
+	int i = PF_FAILED;
+	data.storedPath.Clear();
+	if (useFlowField) {
+		i = FlowFieldFindPath(input, output.Path, PathFinderOutput::MAX_PATH_LENGTH, data.flowField);
+	} else {
+		data.flowField.reset();
+	}
+	if (i == PF_FAILED) {
+		// A path never goes twice through a tile.
+		PathBuffer.resize(std::max<size_t>(PathBuffer.size(), Map.Info.MapWidth * Map.Info.MapHeight));
+		i = AStarFindPath(input.GetUnitPos(),
 						  input.GetGoalPos(),
 						  input.GetGoalSize().x, input.GetGoalSize().y,
 						  input.GetUnitSize().x, input.GetUnitSize().y,
 						  input.GetMinRange(), input.GetMaxRange(),
-						  path, PathFinderOutput::MAX_PATH_LENGTH,
+						  PathBuffer.data(), PathBuffer.size(),
 						  *input.GetUnit());
+		if (i > 0) {
+			KeepPath(data, PathBuffer.data(), std::min<int>(i, PathBuffer.size()));
+		}
+	}
 	input.PathRecalculated();
 	if (i == PF_FAILED) {
 		i = PF_UNREACHABLE;
 	}
 
-	// Update path if it was requested. Otherwise we may only want
-	// to know if there exists a path.
-	if (path != nullptr) {
-		if (i >= 0) {
-			output.Length = std::min<int>(i, PathFinderOutput::MAX_PATH_LENGTH);
-			output.OverflowLength = std::min<int>(i - output.Length, PathFinderOutput::MAX_OVERFLOW);
-			if (output.Length == 0) {
-				++output.Length;
-			}
-		} else {
-			output.Length = 0;
-			output.OverflowLength = 0;
+	if (i >= 0) {
+		output.Length = std::min<int>(i, PathFinderOutput::MAX_PATH_LENGTH);
+		output.OverflowLength = std::min<int>(i - output.Length, PathFinderOutput::MAX_OVERFLOW);
+		if (output.Length == 0) {
+			++output.Length;
 		}
+	} else {
+		output.Length = 0;
+		output.OverflowLength = 0;
 	}
 	return i;
 }
 
+/**
+**  Go around what blocks the next steps of the kept path.
+**
+**  A path is searched to the position reached PathRepairDistance steps
+**  later, the kept path is followed again from there.
+**
+**  @param data  Path data of the unit.
+**
+**  @return      Remaining path length, or PF_FAILED if a new path must be
+**               searched to the goal.
+*/
+static int RepairPath(PathFinderData &data)
+{
+	PathFinderInput &input = data.input;
+	PathFinderOutput &output = data.output;
+	const int remaining = output.Length + data.storedPath.GetLength();
+
+	if (input.IsRecalculateNeeded() || remaining <= PathRepairDistance) {
+		return PF_FAILED;
+	}
+	// The remaining steps, the next one first.
+	std::vector<char> steps(output.Path, output.Path + output.Length);
+	std::reverse(steps.begin(), steps.end());
+	for (int i = 0; i != data.storedPath.GetLength(); ++i) {
+		steps.push_back(data.storedPath.Get(i));
+	}
+	Vec2i joinPos = input.GetUnitPos();
+	for (int i = 0; i != PathRepairDistance; ++i) {
+		joinPos.x += Heading2X[(int)steps[i]];
+		joinPos.y += Heading2Y[(int)steps[i]];
+	}
+
+	char repair[PathFinderOutput::MAX_PATH_LENGTH];
+	const int length = AStarFindPath(input.GetUnitPos(), joinPos, 0, 0,
+									 input.GetUnitSize().x, input.GetUnitSize().y, 0, 0,
+									 repair, std::size(repair), *input.GetUnit());
+	if (length <= 0 || length > int(std::size(repair))) {
+		return PF_FAILED;
+	}
+	// a* returns the best path found so far when it looked too long.
+	Vec2i pos = input.GetUnitPos();
+	for (int i = length - 1; i >= 0; --i) {
+		pos.x += Heading2X[(int)repair[i]];
+		pos.y += Heading2Y[(int)repair[i]];
+	}
+	if (pos != joinPos) {
+		return PF_FAILED;
+	}
+
+	// The new path, the first step last.
+	std::vector<char> path(steps.rbegin(), steps.rend() - PathRepairDistance);
+	path.insert(path.end(), repair, repair + length);
+	KeepPath(data, path.data(), path.size());
+	return path.size();
+}
+
 /**
 **  Returns the next element of a path.
 **
@@ -436,7 +711,7 @@ std::pair<int, Vec2i> NextPathElement(CUnit &unit)
 
 	// Goal has moved, need to recalculate path or no cached path
 	if (output.Length <= 0 || input.IsRecalculateNeeded()) {
-		const int result = NewPath(input, output);
+		const int result = NewPath(*unit.pathFinderData, true);
 
 		if (result == PF_UNREACHABLE) {
 			output.OverflowLength = output.Length = 0;
@@ -447,6 +722,9 @@ std::pair<int, Vec2i> NextPathElement(CUnit &unit)
 		}
 	} else {
 		output.Length--;
+		if (output.Length == 0 && !unit.pathFinderData->storedPath.IsEmpty()) {
+			RefillPath(*unit.pathFinderData);
+		}
 	}
 
 	Vec2i dir(Heading2X[(int) output.Path[output.Length - 1]],
@@ -465,7 +743,11 @@ std::pair<int, Vec2i> NextPathElement(CUnit &unit)
 		}
 		if (output.Fast == 0 && result != 0) {
 			AstarDebugPrint("WAIT expired\n");
-			result = NewPath(input, output);
+			// Go around the units in the way, a flow field doesn't know them.
+			result = RepairPath(*unit.pathFinderData);
+			if (result == PF_FAILED) {
+				result = NewPath(*unit.pathFinderData, false);
+			}
 			if (result > 0) {
 				dir.x = Heading2X[(int)output.Path[output.Length - 1]];
 				dir.y = Heading2Y[(int)output.Path[output.Length - 1]];
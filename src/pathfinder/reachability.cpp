@@ -0,0 +1,445 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+/**@name reachability.cpp - Connected components of the terrain. */
+//
+//      (c) Copyright 2026 by the Stratagus Developers
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+//@{
+
+/*----------------------------------------------------------------------------
+--  Includes
+----------------------------------------------------------------------------*/
+
+#include "stratagus.h"
+
+#include "pathfinder.h"
+
+#include "map.h"
+#include "unit.h"
+#include "unittype.h"
+
+#include <memory>
+#include <unordered_map>
+
+/*----------------------------------------------------------------------------
+--  Declarations
+----------------------------------------------------------------------------*/
+
+/**
+**  Every position where a unit can stand (terrain only, units are ignored)
+**  gets the label of its 8-connected component, 0 means blocked.
+**  There is one label grid per movement mask and unit size.
+**
+**  When tiles become passable the new positions are labelled and their
+**  components merged with a union-find, so the grid stays exact.
+**  When tiles become blocked a component may split: the blocked positions
+**  are kept, and on the next lookup only the components around them are
+**  flooded again, each part getting a new label.
+**
+**  The components of a goal area are cached until the terrain changes,
+**  units going to the same goal only look at their own position.
+*/
+
+namespace
+{
+
+class CReachabilityMap
+{
+public:
+	CReachabilityMap(tile_flags terrainMask, const Vec2i &unitSize);
+
+	bool Matches(tile_flags terrainMask, const Vec2i &unitSize) const
+	{
+		return this->terrainMask == terrainMask && this->unitSize == unitSize;
+	}
+
+	void TerrainChanged(const Vec2i &pos, const Vec2i &size);
+	bool CanReach(const Vec2i &startPos, const Vec2i &goalMin, const Vec2i &goalMax);
+
+private:
+	bool IsPassable(const Vec2i &pos) const;
+	bool IsOnGrid(const Vec2i &pos) const { return 0 <= pos.x && 0 <= pos.y && pos.x < width && pos.y < height; }
+	unsigned int GetIndex(const Vec2i &pos) const { return pos.x + pos.y * width; }
+	unsigned int FindRoot(unsigned int label);
+	void Merge(unsigned int label1, unsigned int label2);
+	void Relabel();
+	void Flood(const Vec2i &startPos, unsigned int oldRoot);
+	void SplitComponents();
+	const std::vector<unsigned int> &GetGoalRoots(const Vec2i &minPos, const Vec2i &maxPos);
+
+private:
+	tile_flags terrainMask;
+	Vec2i unitSize;
+	int width;                         /// Number of possible columns for the unit
+	int height;                        /// Number of possible rows for the unit
+	bool outdated = true;              /// Labels must be computed from scratch
+	std::vector<unsigned int> labels;  /// Label of each position, 0 if blocked
+	std::vector<unsigned int> parents; /// Union-find over the labels
+	std::vector<Vec2i> blocked;        /// Positions blocked since the last lookup
+	std::vector<Vec2i> stack;          /// Positions to flood
+	/// Roots of the components of each goal area, by packed bounds
+	std::unordered_map<uint64_t, std::vector<unsigned int>> goalRoots;
+};
+
+} // namespace
+
+/*----------------------------------------------------------------------------
+--  Variables
+----------------------------------------------------------------------------*/
+
+/// One label grid per movement mask and unit size, created on first use
+static std::vector<std::unique_ptr<CReachabilityMap>> ReachabilityMaps;
+
+/// Number of goal areas cached by a grid before the cache is emptied
+static constexpr size_t ReachabilityMaxGoals = 1024;
+
+static const Vec2i NeighbourOffsets[] = {Vec2i(0, -1), Vec2i(-1, 0), Vec2i(1, 0), Vec2i(0, 1),
+                                         Vec2i(-1, -1), Vec2i(1, -1), Vec2i(-1, 1), Vec2i(1, 1)};
+
+/*----------------------------------------------------------------------------
+--  Functions
+----------------------------------------------------------------------------*/
+
+CReachabilityMap::CReachabilityMap(tile_flags terrainMask, const Vec2i &unitSize) :
+	terrainMask(terrainMask),
+	unitSize(unitSize),
+	width(std::max(0, Map.Info.MapWidth + 1 - unitSize.x)),
+	height(std::max(0, Map.Info.MapHeight + 1 - unitSize.y))
+{
+}
+
+bool CReachabilityMap::IsPassable(const Vec2i &pos) const
+{
+	return TerrainFootprintPassable(pos, terrainMask, unitSize);
+}
+
+unsigned int CReachabilityMap::FindRoot(unsigned int label)
+{
+	while (parents[label] != label) {
+		parents[label] = parents[parents[label]];
+		label = parents[label];
+	}
+	return label;
+}
+
+void CReachabilityMap::Merge(unsigned int label1, unsigned int label2)
+{
+	label1 = FindRoot(label1);
+	label2 = FindRoot(label2);
+	// keep the smallest root so the result doesn't depend on the merge order.
+	if (label1 < label2) {
+		parents[label2] = label1;
+	} else if (label2 < label1) {
+		parents[label1] = label2;
+	}
+}
+
+/**
+**  Flood fill every component from scratch.
+*/
+void CReachabilityMap::Relabel()
+{
+	labels.assign(width * height, 0);
+	parents.assign(1, 0);
+	blocked.clear();
+	goalRoots.clear();
+
+	for (Vec2i pos(0, 0); pos.y != height; ++pos.y) {
+		for (pos.x = 0; pos.x != width; ++pos.x) {
+			if (labels[GetIndex(pos)] != 0 || !IsPassable(pos)) {
+				continue;
+			}
+			const unsigned int label = parents.size();
+			parents.push_back(label);
+			labels[GetIndex(pos)] = label;
+			stack.push_back(pos);
+			while (!stack.empty()) {
+				const Vec2i current = stack.back();
+				stack.pop_back();
+				for (const Vec2i &offset : NeighbourOffsets) {
+					const Vec2i next = current + offset;
+					if (!IsOnGrid(next)) {
+						continue;
+					}
+					unsigned int &nextLabel = labels[GetIndex(next)];
+					if (nextLabel == 0 && IsPassable(next)) {
+						nextLabel = label;
+						stack.push_back(next);
+					}
+				}
+			}
+		}
+	}
+	outdated = false;
+}
+
+/**
+**  Give a new label to the part of the component oldRoot connected to startPos.
+*/
+void CReachabilityMap::Flood(const Vec2i &startPos, unsigned int oldRoot)
+{
+	const unsigned int label = parents.size();
+	parents.push_back(label);
+	labels[GetIndex(startPos)] = label;
+	stack.push_back(startPos);
+	while (!stack.empty()) {
+		const Vec2i current = stack.back();
+		stack.pop_back();
+		for (const Vec2i &offset : NeighbourOffsets) {
+			const Vec2i next = current + offset;
+			if (!IsOnGrid(next)) {
+				continue;
+			}
+			unsigned int &nextLabel = labels[GetIndex(next)];
+			if (nextLabel != 0 && nextLabel < label && FindRoot(nextLabel) == oldRoot) {
+				nextLabel = label;
+				stack.push_back(next);
+			}
+		}
+	}
+}
+
+/**
+**  Split the components which lost positions since the last lookup.
+**
+**  Each part of a split component touches a blocked position, so flooding
+**  from the neighbours of the blocked positions relabels every part.
+*/
+void CReachabilityMap::SplitComponents()
+{
+	// The labels given here are new, their positions are done.
+	const unsigned int firstNewLabel = parents.size();
+	for (const Vec2i &blockedPos : blocked) {
+		for (const Vec2i &offset : NeighbourOffsets) {
+			const Vec2i next = blockedPos + offset;
+			if (!IsOnGrid(next)) {
+				continue;
+			}
+			const unsigned int label = labels[GetIndex(next)];
+			if (label != 0 && label < firstNewLabel) {
+				Flood(next, FindRoot(label));
+			}
+		}
+	}
+	blocked.clear();
+	goalRoots.clear();
+	// Labels are never reused, start again before they take too much memory.
+	if (parents.size() > labels.size()) {
+		outdated = true;
+	}
+}
+
+/**
+**  Update the labels of the positions whose footprint overlaps the area.
+**
+**  @param pos   Top left tile of the changed area.
+**  @param size  Size of the changed area.
+*/
+void CReachabilityMap::TerrainChanged(const Vec2i &pos, const Vec2i &size)
+{
+	if (outdated) {
+		return;
+	}
+	const Vec2i minPos(std::max(0, pos.x - unitSize.x + 1), std::max(0, pos.y - unitSize.y + 1));
+	const Vec2i maxPos(std::min(width - 1, pos.x + size.x - 1), std::min(height - 1, pos.y + size.y - 1));
+
+	// First label the new positions, so that they can be merged with each other.
+	std::vector<Vec2i> added;
+	for (Vec2i it = minPos; it.y <= maxPos.y; ++it.y) {
+		for (it.x = minPos.x; it.x <= maxPos.x; ++it.x) {
+			unsigned int &label = labels[GetIndex(it)];
+			const bool passable = IsPassable(it);
+
+			if (label == 0 && passable) {
+				label = parents.size();
+				parents.push_back(label);
+				added.push_back(it);
+			} else if (label != 0 && !passable) {
+				// The component may be split, it is checked on the next lookup.
+				label = 0;
+				blocked.push_back(it);
+			}
+		}
+	}
+	for (const Vec2i &addedPos : added) {
+		const unsigned int label = labels[GetIndex(addedPos)];
+		for (const Vec2i &offset : NeighbourOffsets) {
+			const Vec2i next = addedPos + offset;
+			if (!IsOnGrid(next)) {
+				continue;
+			}
+			if (labels[GetIndex(next)] != 0) {
+				Merge(label, labels[GetIndex(next)]);
+			}
+		}
+	}
+	if (!added.empty()) {
+		goalRoots.clear();
+	}
+}
+
+/**
+**  Get the roots of the components which have a position in the area.
+**
+**  @param minPos  Top left of the area, on the grid.
+**  @param maxPos  Bottom right of the area, on the grid.
+**
+**  @return        Sorted roots, valid until the terrain changes.
+*/
+const std::vector<unsigned int> &CReachabilityMap::GetGoalRoots(const Vec2i &minPos, const Vec2i &maxPos)
+{
+	const uint64_t key = uint64_t(uint16_t(minPos.x)) | uint64_t(uint16_t(minPos.y)) << 16
+	                     | uint64_t(uint16_t(maxPos.x)) << 32 | uint64_t(uint16_t(maxPos.y)) << 48;
+	auto it = goalRoots.find(key);
+	if (it != goalRoots.end()) {
+		return it->second;
+	}
+	if (goalRoots.size() >= ReachabilityMaxGoals) {
+		goalRoots.clear();
+	}
+	std::vector<unsigned int> roots;
+	for (Vec2i pos = minPos; pos.y <= maxPos.y; ++pos.y) {
+		for (pos.x = minPos.x; pos.x <= maxPos.x; ++pos.x) {
+			const unsigned int label = labels[GetIndex(pos)];
+			if (label != 0) {
+				roots.push_back(FindRoot(label));
+			}
+		}
+	}
+	ranges::sort(roots);
+	roots.erase(std::unique(roots.begin(), roots.end()), roots.end());
+	return goalRoots.emplace(key, std::move(roots)).first->second;
+}
+
+/**
+**  Check if a position of the goal area shares a component with the start.
+**
+**  @param startPos  Start position of the unit.
+**  @param goalMin   Top left of the positions which may reach the goal.
+**  @param goalMax   Bottom right of the positions which may reach the goal.
+**
+**  @return          false only if the goal can't be reached.
+*/
+bool CReachabilityMap::CanReach(const Vec2i &startPos, const Vec2i &goalMin, const Vec2i &goalMax)
+{
+	if (!blocked.empty()) {
+		SplitComponents();
+	}
+	if (outdated) {
+		Relabel();
+	}
+	if (startPos.x >= width || startPos.y >= height) {
+		return true;
+	}
+	// A unit may stand on a blocked position (e.g. just dropped out of a
+	// building), it can leave it to any passable neighbour.
+	std::vector<unsigned int> startRoots;
+	if (labels[GetIndex(startPos)] != 0) {
+		startRoots.push_back(FindRoot(labels[GetIndex(startPos)]));
+	} else {
+		for (const Vec2i &offset : NeighbourOffsets) {
+			const Vec2i next = startPos + offset;
+			if (!IsOnGrid(next)) {
+				continue;
+			}
+			if (labels[GetIndex(next)] != 0) {
+				startRoots.push_back(FindRoot(labels[GetIndex(next)]));
+			}
+		}
+	}
+	const Vec2i minPos(std::max<int>(0, goalMin.x), std::max<int>(0, goalMin.y));
+	const Vec2i maxPos(std::min<int>(width - 1, goalMax.x), std::min<int>(height - 1, goalMax.y));
+	if (minPos.x > maxPos.x || minPos.y > maxPos.y) {
+		return false;
+	}
+	const std::vector<unsigned int> &roots = GetGoalRoots(minPos, maxPos);
+	return ranges::any_of(startRoots, [&](unsigned int root) { return std::binary_search(roots.begin(), roots.end(), root); });
+}
+
+/**
+**  Tell the reachability index that the terrain of an area has changed.
+**
+**  @param pos   Top left tile of the area.
+**  @param size  Size of the area in tiles.
+*/
+void ReachabilityTerrainChanged(const Vec2i &pos, const Vec2i &size)
+{
+	for (auto &reachabilityMap : ReachabilityMaps) {
+		reachabilityMap->TerrainChanged(pos, size);
+	}
+}
+
+/**
+**  Free the reachability index.
+*/
+void FreeReachability()
+{
+	ReachabilityMaps.clear();
+}
+
+/**
+**  Check if the goal is in the same terrain component as the unit.
+**
+**  The goal area is the same as the one given to a*, but the check is
+**  done on its bounding box, so it may answer true for an unreachable goal
+**  and a* must still be used. It never answers false for a reachable one.
+**
+**  @param startPos  Start position of the unit.
+**  @param goalPos   Top left of the goal.
+**  @param gw        Width of the goal.
+**  @param gh        Height of the goal.
+**  @param maxrange  Max range to the goal.
+**  @param unit      Unit which moves.
+**
+**  @return          false if the goal can't be reached whatever units do.
+*/
+bool TerrainReachable(const Vec2i &startPos, const Vec2i &goalPos, int gw, int gh, int maxrange, const CUnit &unit)
+{
+	// Unexplored tiles are considered passable by a*.
+	if (!AStarKnowUnseenTerrain) {
+		return true;
+	}
+	const tile_flags terrainMask = unit.Type->MovementMask & ~(MapFieldLandUnit | MapFieldAirUnit | MapFieldSeaUnit);
+	if (terrainMask == 0) {
+		return true;
+	}
+	const Vec2i unitSize(unit.Type->TileWidth, unit.Type->TileHeight);
+	const Vec2i goalMin(goalPos.x - maxrange - unitSize.x + 1, goalPos.y - maxrange - unitSize.y + 1);
+	const Vec2i goalMax(goalPos.x + std::max(gw, 1) - 1 + maxrange, goalPos.y + std::max(gh, 1) - 1 + maxrange);
+
+	if (goalMin.x <= startPos.x && startPos.x <= goalMax.x
+		&& goalMin.y <= startPos.y && startPos.y <= goalMax.y) {
+		return true;
+	}
+	auto it = ranges::find_if(ReachabilityMaps, [&](const auto &reachabilityMap) { return reachabilityMap->Matches(terrainMask, unitSize); });
+	if (it == ReachabilityMaps.end()) {
+		ReachabilityMaps.push_back(std::make_unique<CReachabilityMap>(terrainMask, unitSize));
+		it = std::prev(ReachabilityMaps.end());
+	}
+	return (*it)->CanReach(startPos, goalMin, goalMax);
+}
+
+//@}
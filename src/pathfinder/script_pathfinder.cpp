@@ -97,6 +97,30 @@ static int CclAStar(lua_State *l)
 			} else {
 				AStarMaxSearchIterations = i;
 			}
+		} else if (value == "hierarchical") {
+			AStarHierarchical = true;
+		} else if (value == "no-hierarchical") {
+			AStarHierarchical = false;
+		} else if (value == "hierarchical-sector-size") {
+			++j;
+			i = LuaToNumber(l, j + 1);
+			if (i < 4 || i > 64) {
+				LuaError(l, "Hierarchical sector size must be between 4 and 64\n");
+			} else {
+				AStarHierarchicalSectorSize = i;
+			}
+		} else if (value == "flow-field") {
+			AStarFlowField = true;
+		} else if (value == "no-flow-field") {
+			AStarFlowField = false;
+		} else if (value == "bucket-open-set") {
+			SetAStarBucketOpenSet(true);
+		} else if (value == "sorted-open-set") {
+			SetAStarBucketOpenSet(false);
+		} else if (value == "jump-point-search") {
+			SetAStarJumpPointSearch(true);
+		} else if (value == "no-jump-point-search") {
+			SetAStarJumpPointSearch(false);
 		} else {
 			LuaError(l, "Unsupported tag: %s", value.data());
 		}
@@ -154,6 +154,10 @@ int Spell_AdjustVariable::Cast(CUnit &caster,
 
 		clamp(&unit->Variable[i].Value, 0, unit->Variable[i].Max);
 	}
+	caster.UpdateIncreasingVariables();
+	if (target) {
+		target->UpdateIncreasingVariables();
+	}
 	return 1;
 }
 
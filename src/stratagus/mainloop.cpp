@@ -53,6 +53,12 @@
 #include "unit.h"
 #include "video.h"
 #include "parameters.h"
+#include "player.h"
+#include "settings.h"
+
+#include <array>
+#include <chrono>
+#include <fstream>
 
 #ifdef HAVE_COZ_PROFILER
 # include <coz.h>
@@ -83,6 +89,15 @@ int MouseScrollState = ScrollNone;
 EventCallback GameCallbacks;   /// Game callbacks
 EventCallback EditorCallbacks; /// Editor callbacks
 
+/// Phases of a game cycle timed in headless mode
+enum class EGamePhase { Commands, Triggers, Units, Missiles, Players, EachSecond, Count };
+
+static constexpr std::array<const char *, static_cast<size_t>(EGamePhase::Count)> GamePhaseNames = {
+	"commands", "triggers", "units", "missiles", "players", "each-second"};
+
+/// Time spent in each phase of the game cycles
+static std::array<std::chrono::steady_clock::duration, static_cast<size_t>(EGamePhase::Count)> GamePhaseTimes;
+
 //----------------------------------------------------------------------------
 // Functions
 //----------------------------------------------------------------------------
@@ -249,6 +264,21 @@ static void InitGameCallbacks()
 	GameCallbacks.NetworkEvent = NetworkEvent;
 }
 
+/**
+**  Run a phase of a game cycle, timing it in headless mode.
+*/
+template <typename F>
+static void RunGamePhase(EGamePhase phase, F &&f)
+{
+	if (!Parameters::Instance.headless) {
+		f();
+		return;
+	}
+	const auto start = std::chrono::steady_clock::now();
+	f();
+	GamePhaseTimes[static_cast<size_t>(phase)] += std::chrono::steady_clock::now() - start;
+}
+
 static void GameLogicLoop()
 {
 	// Can't find a better place.
@@ -259,15 +289,19 @@ static void GameLogicLoop()
 	// Game logic part
 	//
 	if (!GamePaused && NetworkInSync && SkipGameCycle < 1) {
-		SinglePlayerReplayEachCycle();
-		++GameCycle;
-		MultiPlayerReplayEachCycle();
-		NetworkCommands(); // Get network commands
-		TriggersEachCycle();// handle triggers
-		UnitActions();      // handle units
-		MissileActions();   // handle missiles
-		PlayersEachCycle(); // handle players
-		UpdateTimer();      // update game timer
+		RunGamePhase(EGamePhase::Commands, [] {
+			SinglePlayerReplayEachCycle();
+			++GameCycle;
+			MultiPlayerReplayEachCycle();
+			NetworkCommands(); // Get network commands
+		});
+		RunGamePhase(EGamePhase::Triggers, TriggersEachCycle); // handle triggers
+		RunGamePhase(EGamePhase::Units, UnitActions);          // handle units
+		RunGamePhase(EGamePhase::Missiles, MissileActions);    // handle missiles
+		RunGamePhase(EGamePhase::Players, [] {
+			PlayersEachCycle(); // handle players
+			UpdateTimer();      // update game timer
+		});
 
 
 		//
@@ -280,46 +314,53 @@ static void GameLogicLoop()
 		// Check game goals.
 		// Check rescue of units.
 		//
-		switch (GameCycle % CYCLES_PER_SECOND) {
-			case 0: // At cycle 0, start all ai players...
-				if (GameCycle == 0) {
-					for (int player = 0; player < NumPlayers; ++player) {
+		RunGamePhase(EGamePhase::EachSecond, [] {
+			switch (GameCycle % CYCLES_PER_SECOND) {
+				case 0: // At cycle 0, start all ai players...
+					if (GameCycle == 0) {
+						for (int player = 0; player < NumPlayers; ++player) {
+							PlayersEachSecond(player);
+						}
+					}
+					break;
+				case 1:
+					break;
+				case 2:
+					break;
+				case 3: // minimap update
+					UI.Minimap.UpdateCache = true;
+					break;
+				case 4:
+					break;
+				case 5: // forest grow
+					Map.RegenerateForest();
+					break;
+				case 6: // overtaking units
+					RescueUnits();
+					break;
+				default: {
+					// FIXME: assume that NumPlayers < (CYCLES_PER_SECOND - 7)
+					int player = (GameCycle % CYCLES_PER_SECOND) - 7;
+					Assert(player >= 0);
+					if (player < NumPlayers) {
 						PlayersEachSecond(player);
 					}
 				}
-				break;
-			case 1:
-				break;
-			case 2:
-				break;
-			case 3: // minimap update
-				UI.Minimap.UpdateCache = true;
-				break;
-			case 4:
-				break;
-			case 5: // forest grow
-				Map.RegenerateForest();
-				break;
-			case 6: // overtaking units
-				RescueUnits();
-				break;
-			default: {
-				// FIXME: assume that NumPlayers < (CYCLES_PER_SECOND - 7)
-				int player = (GameCycle % CYCLES_PER_SECOND) - 7;
-				Assert(player >= 0);
-				if (player < NumPlayers) {
-					PlayersEachSecond(player);
-				}
 			}
-		}
+		});
 
-		if (Preference.AutosaveMinutes != 0 && !IsNetworkGame() && !IsReplayGame() && GameCycle > 0 && (GameCycle % (CYCLES_PER_SECOND * 60 * Preference.AutosaveMinutes)) == 0) { // autosave every X minutes (default is 5), if the option is enabled
+		if (Preference.AutosaveMinutes != 0 && !IsNetworkGame() && !IsReplayGame() && !Parameters::Instance.headless && GameCycle > 0 && (GameCycle % (CYCLES_PER_SECOND * 60 * Preference.AutosaveMinutes)) == 0) { // autosave every X minutes (default is 5), if the option is enabled
 		//Wyrmgus end
 			UI.StatusLine.Set(_("Autosave"));
 			SaveGame("autosave.sav");
 		}
+		ReplayKeyframeEachCycle();
 	}
 
+	if (Parameters::Instance.headless) {
+		// Nothing to show nor to wait for.
+		return;
+	}
 	UpdateMessages();     // update messages
 	ParticleManager.update(); // handle particles
 
@@ -372,11 +413,141 @@ static void DisplayLoop()
 static void SingleGameLoop()
 {
 	while (GameRunning) {
-		DisplayLoop();
+		// Fast forwarding only shows its progress from time to time
+		if (FastForwardCycle <= GameCycle || !(GameCycle & CallPeriod::cEvery256th)) {
+			DisplayLoop();
+		}
+		GameLogicLoop();
+	}
+}
+
+/**
+**  End a headless game as a draw once it has run its maximum of cycles.
+*/
+void CheckHeadlessCycleLimit()
+{
+	const unsigned long maxCycles = Parameters::Instance.headlessBatch.MaxCycles;
+
+	if (maxCycles != 0 && GameCycle >= maxCycles && GameRunning) {
+		StopGame(GameDraw);
+	}
+}
+
+static void HeadlessGameLoop()
+{
+	while (GameRunning) {
 		GameLogicLoop();
+		CheckHeadlessCycleLimit();
 	}
 }
 
+/**
+**  Quote a string for JSON.
+*/
+static std::string JsonString(std::string_view str)
+{
+	std::string res = "\"";
+	for (char c : str) {
+		switch (c) {
+			case '"': res += "\\\""; break;
+			case '\\': res += "\\\\"; break;
+			case '\n': res += "\\n"; break;
+			default:
+				if (static_cast<unsigned char>(c) < 0x20) {
+					char buf[8];
+					snprintf(buf, sizeof(buf), "\\u%04x", c);
+					res += buf;
+				} else {
+					res += c;
+				}
+		}
+	}
+	return res + '"';
+}
+
+static const char *GameResultName(GameResults result)
+{
+	switch (result) {
+		case GameNoResult: return "none";
+		case GameVictory: return "victory";
+		case GameDefeat: return "defeat";
+		case GameDraw: return "draw";
+		case GameQuitToMenu: return "quit";
+		case GameRestart: return "restart";
+		case GameExit: return "exit";
+	}
+	return "none";
+}
+
+/**
+**  Write the results and the phase timings of a headless game as JSON.
+**
+**  @param elapsed  Wall time of the game.
+*/
+static void WriteHeadlessResults(std::chrono::steady_clock::duration elapsed)
+{
+	const auto toMs = [](std::chrono::steady_clock::duration d) {
+		return std::chrono::duration<double, std::milli>(d).count();
+	};
+	const fs::path &filename = Parameters::Instance.headlessBatch.ResultFilename;
+	std::ofstream out(filename);
+	if (!out) {
+		ErrorPrint("Can't write the headless results to '%s'\n", filename.u8string().c_str());
+		return;
+	}
+	const double seconds = toMs(elapsed) / 1000.;
+
+	out << "{\n";
+	out << "  \"map\": " << JsonString(Map.Info.Filename) << ",\n";
+	out << "  \"result\": " << JsonString(GameResultName(GameResult)) << ",\n";
+	out << "  \"thisPlayer\": " << (ThisPlayer ? ThisPlayer->Index : -1) << ",\n";
+	out << "  \"seed\": " << SyncRandInitialSeed << ",\n";
+	out << "  \"cycles\": " << GameCycle << ",\n";
+	out << "  \"seconds\": " << seconds << ",\n";
+	out << "  \"cyclesPerSecond\": " << (seconds > 0 ? GameCycle / seconds : 0.) << ",\n";
+	out << "  \"players\": [";
+	const char *separator = "\n";
+	for (int i = 0; i < NumPlayers; ++i) {
+		const CPlayer &player = Players[i];
+		if (player.Type != PlayerTypes::PlayerComputer && player.Type != PlayerTypes::PlayerPerson) {
+			continue;
+		}
+		out << separator << "    {";
+		out << "\"index\": " << player.Index;
+		out << ", \"name\": " << JsonString(player.Name);
+		out << ", \"type\": " << JsonString(PlayerTypeNames[static_cast<int>(player.Type)]);
+		out << ", \"ai\": " << JsonString(player.AiName);
+		out << ", \"race\": " << JsonString(PlayerRaces.Name[player.Race]);
+		out << ", \"team\": " << player.Team;
+		out << ", \"alive\": " << (player.GetUnitCount() > 0 ? "true" : "false");
+		out << ", \"score\": " << player.Score;
+		out << ", \"units\": " << player.TotalUnits;
+		out << ", \"buildings\": " << player.TotalBuildings;
+		out << ", \"kills\": " << player.TotalKills;
+		out << ", \"razings\": " << player.TotalRazings;
+		out << ", \"resources\": {";
+		const char *resourceSeparator = "";
+		for (int res = 0; res < MaxCosts; ++res) {
+			if (DefaultResourceNames[res].empty()) {
+				continue;
+			}
+			out << resourceSeparator << JsonString(DefaultResourceNames[res]) << ": " << player.TotalResources[res];
+			resourceSeparator = ", ";
+		}
+		out << "}}";
+		separator = ",\n";
+	}
+	out << "\n  ],\n";
+	out << "  \"timings\": {";
+	separator = "\n";
+	for (size_t i = 0; i != GamePhaseTimes.size(); ++i) {
+		out << separator << "    " << JsonString(GamePhaseNames[i]) << ": " << toMs(GamePhaseTimes[i]);
+		separator = ",\n";
+	}
+	out << "\n  }\n";
+	out << "}\n";
+}
+
 /**
 **  Game main loop.
 **
@@ -408,10 +579,28 @@ void GameMainLoop(bool clean)
 	CclCommand("if (GameStarting ~= nil) then GameStarting() end");
 
 	long ticks = SDL_GetTicks();
+	const auto start = std::chrono::steady_clock::now();
+	GamePhaseTimes.fill({});
 
 	MultiPlayerReplayEachCycle();
+	ReplayKeyframeEachCycle();
 
-	SingleGameLoop();
+	while (true) {
+		if (Parameters::Instance.headless) {
+			HeadlessGameLoop();
+		} else {
+			SingleGameLoop();
+		}
+		if (GameResult != GameNoResult || !IsReplaySeekPending()) {
+			break;
+		}
+		// Seeking back in a replay reloads the game from a keyframe.
+		CParticleManager::exit();
+		RestoreReplayKeyframe();
+		CParticleManager::init();
+		GameCursor = UI.Point.Cursor;
+		GameRunning = true;
+	}
 
 	//
 	// Game over
@@ -428,6 +617,10 @@ void GameMainLoop(bool clean)
 	NetworkQuitGame();
 	EndReplayLog();
 
+	if (Parameters::Instance.headless) {
+		WriteHeadlessResults(std::chrono::steady_clock::now() - start);
+	}
+
 	if (Parameters::Instance.benchmark) {
 		ticks = SDL_GetTicks() - ticks;
 		double fps = FrameCounter * 1000.0 / ticks;
@@ -34,7 +34,10 @@
 #include "filesystem.h"
 #include "parameters.h"
 
+#include <cctype>
 #include <cstdlib>
+#include <fstream>
+#include <iterator>
 
 #ifdef USE_WIN32
 #include <shlobj.h>
@@ -110,5 +113,181 @@ void Parameters::SetLocalPlayerNameFromEnv()
 	LocalPlayerName = GetLocalPlayerNameFromEnv();
 }
 
+namespace
+{
+
+/**
+**  Reader of the flat JSON objects describing the batch games.
+*/
+class JsonReader
+{
+public:
+	explicit JsonReader(std::string_view json) : Json(json) {}
+
+	bool AtEnd()
+	{
+		SkipSpaces();
+		return Pos == Json.size();
+	}
+
+	/// Read a character if it is the next one
+	bool Accept(char c)
+	{
+		SkipSpaces();
+		if (Pos < Json.size() && Json[Pos] == c) {
+			++Pos;
+			return true;
+		}
+		return false;
+	}
+
+	std::optional<std::string> String()
+	{
+		if (!Accept('"')) {
+			return std::nullopt;
+		}
+		std::string res;
+		while (Pos < Json.size() && Json[Pos] != '"') {
+			char c = Json[Pos++];
+			if (static_cast<unsigned char>(c) < 0x20) {
+				return std::nullopt;
+			}
+			if (c == '\\') {
+				if (Pos == Json.size()) {
+					return std::nullopt;
+				}
+				switch (Json[Pos++]) {
+					case '"': c = '"'; break;
+					case '\\': c = '\\'; break;
+					case '/': c = '/'; break;
+					case 'n': c = '\n'; break;
+					case 't': c = '\t'; break;
+					default: return std::nullopt;
+				}
+			}
+			res += c;
+		}
+		if (!Accept('"')) {
+			return std::nullopt;
+		}
+		return res;
+	}
+
+	/// Read an integer, without fraction nor exponent
+	std::optional<long long> Integer()
+	{
+		SkipSpaces();
+		const size_t begin = Pos;
+		if (Pos < Json.size() && Json[Pos] == '-') {
+			++Pos;
+		}
+		while (Pos < Json.size() && std::isdigit(static_cast<unsigned char>(Json[Pos]))) {
+			++Pos;
+		}
+		const std::string_view digits = Json.substr(begin, Pos - begin);
+		if (digits.empty() || digits == "-" || digits.size() > 18) {
+			return std::nullopt;
+		}
+		return std::stoll(std::string(digits));
+	}
+
+private:
+	void SkipSpaces()
+	{
+		while (Pos < Json.size() && std::isspace(static_cast<unsigned char>(Json[Pos]))) {
+			++Pos;
+		}
+	}
+
+private:
+	std::string_view Json;
+	size_t Pos = 0;
+};
+
+} // namespace
+
+static bool InvalidHeadlessBatch(const fs::path &file, std::string_view reason)
+{
+	ErrorPrint("Invalid headless batch '%s': %s\n", file.u8string().c_str(), std::string(reason).c_str());
+	return false;
+}
+
+/**
+**  Read the description of a headless batch game from a file.
+**
+**  @return  false, once told why, if it can't be read or is invalid.
+*/
+bool HeadlessBatch::Load(const fs::path &file)
+{
+	std::ifstream in(file);
+	if (!in) {
+		ErrorPrint("Can't open the headless batch '%s'\n", file.u8string().c_str());
+		return false;
+	}
+	const std::string json{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+	return Parse(json, file);
+}
+
+/**
+**  Read the description of a headless batch game.
+**
+**  It is a JSON object whose fields are all optional:
+**  - "results": file receiving the results, relative to the batch file.
+**    The batch file name with a ".results.json" extension by default.
+**  - "maxCycles": game cycles after which the game ends as a draw, 0 for no limit.
+**  - "seed": seed of the synchronized random numbers, from 0 to 4294967295.
+**
+**  @param json  Content of the batch file.
+**  @param file  Batch file.
+**
+**  @return  false, once told why, if the description is invalid.
+*/
+bool HeadlessBatch::Parse(std::string_view json, const fs::path &file)
+{
+	*this = HeadlessBatch();
+	ResultFilename = fs::path(file).replace_extension(".results.json");
+
+	JsonReader reader(json);
+	const auto fail = [&](std::string_view reason) { return InvalidHeadlessBatch(file, reason); };
+	if (!reader.Accept('{')) {
+		return fail("it is not a JSON object");
+	}
+	if (reader.Accept('}')) {
+		return reader.AtEnd() || fail("text after the object");
+	}
+	do {
+		const std::optional<std::string> key = reader.String();
+		if (!key || !reader.Accept(':')) {
+			return fail("a field name is expected");
+		}
+		if (*key == "results") {
+			const std::optional<std::string> results = reader.String();
+			if (!results || results->empty()) {
+				return fail("\"results\" is not a file name");
+			}
+			ResultFilename = fs::path(file).parent_path() / fs::u8path(*results);
+		} else if (*key == "maxCycles") {
+			const std::optional<long long> maxCycles = reader.Integer();
+			if (!maxCycles || *maxCycles < 0) {
+				return fail("\"maxCycles\" is not a number of cycles");
+			}
+			MaxCycles = *maxCycles;
+		} else if (*key == "seed") {
+			const std::optional<long long> seed = reader.Integer();
+			if (!seed || *seed < 0 || *seed > UINT32_MAX) {
+				return fail("\"seed\" is not a 32 bits unsigned number");
+			}
+			Seed = static_cast<uint32_t>(*seed);
+		} else {
+			return fail("unknown field \"" + *key + "\"");
+		}
+	} while (reader.Accept(','));
+
+	if (!reader.Accept('}') || !reader.AtEnd()) {
+		return fail("',' or '}' is expected after a field");
+	}
+	return true;
+}
+
 
 //@}
@@ -815,6 +815,7 @@ void CPlayer::Clear()
 	AiEnabled = false;
 	Ai = nullptr;
 	this->Units.resize(0);
+	this->UnitsByType.clear();
 	this->FreeWorkers.resize(0);
 	NumBuildings = 0;
 	Supply = 0;
@@ -856,6 +857,7 @@ void CPlayer::AddUnit(CUnit &unit)
 	Assert(unit.PlayerSlot == static_cast<size_t>(-1));
 	unit.PlayerSlot = this->Units.size();
 	this->Units.push_back(&unit);
+	AddToUnitsByType(unit);
 	unit.Player = this;
 	Assert(this->Units[unit.PlayerSlot] == &unit);
 }
@@ -873,6 +875,66 @@ void CPlayer::RemoveUnit(CUnit &unit)
 	this->Units.pop_back();
 	unit.PlayerSlot = static_cast<size_t>(-1);
 	Assert(last == &unit || this->Units[last->PlayerSlot] == last);
+	RemoveFromUnitsByType(unit);
+}
+
+void CPlayer::AddToUnitsByType(CUnit &unit)
+{
+	const size_t slot = unit.Type->Slot;
+
+	if (this->UnitsByType.size() <= slot) {
+		this->UnitsByType.resize(slot + 1);
+	}
+	std::vector<CUnit *> &unitsOfType = this->UnitsByType[slot];
+	unit.PlayerTypeSlot = unitsOfType.size();
+	unitsOfType.push_back(&unit);
+}
+
+void CPlayer::RemoveFromUnitsByType(CUnit &unit)
+{
+	std::vector<CUnit *> &unitsOfType = this->UnitsByType[unit.Type->Slot];
+	Assert(unitsOfType[unit.PlayerTypeSlot] == &unit);
+	CUnit *last = unitsOfType.back();
+
+	unitsOfType[unit.PlayerTypeSlot] = last;
+	last->PlayerTypeSlot = unit.PlayerTypeSlot;
+	unitsOfType.pop_back();
+}
+
+/**
+**  Get the units of this player of a unit-type.
+**
+**  @param type  Unit-type of the units.
+**
+**  @return      The units, without the dead ones, in no particular order.
+**
+**  @note Units of a type which vanishes are not registered in the player.
+*/
+const std::vector<CUnit *> &CPlayer::GetUnitsOfType(const CUnitType &type) const
+{
+	static const std::vector<CUnit *> noUnits;
+
+	const size_t slot = type.Slot;
+
+	return slot < this->UnitsByType.size() ? this->UnitsByType[slot] : noUnits;
+}
+
+/**
+**  Change the type of a unit, which may belong to this player.
+**
+**  @param unit  Unit whose type is changed.
+**  @param type  New unit-type.
+*/
+void CPlayer::ChangeUnitType(CUnit &unit, const CUnitType &type)
+{
+	if (unit.PlayerSlot == static_cast<size_t>(-1)) {
+		unit.Type = &type;
+		return;
+	}
+	Assert(unit.Player == this);
+	RemoveFromUnitsByType(unit);
+	unit.Type = &type;
+	AddToUnitsByType(unit);
 }
 
 void CPlayer::UpdateFreeWorkers()
@@ -884,9 +946,12 @@ void CPlayer::UpdateFreeWorkers()
 		// it's safer to re-initialize.
 		std::vector<CUnit*>().swap(FreeWorkers);
 	}
-	for (CUnit *unit : this->GetUnits()) {
-		if (unit->IsAlive() && unit->Type->BoolFlag[HARVESTER_INDEX].value && !unit->Removed) {
-			if (unit->CurrentAction() == UnitAction::Still) {
+	for (const CUnitType *type : getUnitTypes()) {
+		if (!type->BoolFlag[HARVESTER_INDEX].value) {
+			continue;
+		}
+		for (CUnit *unit : GetUnitsOfType(*type)) {
+			if (unit->IsAlive() && !unit->Removed && unit->CurrentAction() == UnitAction::Still) {
 				FreeWorkers.push_back(unit);
 			}
 		}
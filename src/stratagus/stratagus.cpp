@@ -461,6 +461,8 @@ static void Usage()
 		"\t-g\t\tForce software rendering (implies no shaders)\n"
 		"\t-G \"options\"\tGame options (passed to game scripts)\n"
 		"\t-h\t\tHelp shows this page\n"
+		"\t-H batch.json\tHeadless mode. Plays the map without video, sound or UI and writes the results as JSON\n"
+		"\t\t\tThe batch file may give the \"results\" file, \"maxCycles\" and the random \"seed\"\n"
 		"\t-i\t\tEnables unit info dumping into log (for debugging)\n"
 		"\t-I addr\t\tNetwork address to use\n"
 		"\t-l\t\tDisable command log\n"
@@ -559,7 +561,7 @@ void ParseCommandLine(int argc, char **argv, Parameters &parameters)
 	}
 
 	for (;;) {
-		switch (getopt(argc, argv, "abc:d:D:eE:FgG:hiI:lN:oOP:prs:S:u:v:W?-")) {
+		switch (getopt(argc, argv, "abc:d:D:eE:FgG:hH:iI:lN:oOP:prs:S:u:v:W?-")) {
 			case 'a':
 				EnableAssert = true;
 				continue;
@@ -599,6 +601,16 @@ void ParseCommandLine(int argc, char **argv, Parameters &parameters)
 			case 'G':
 				parameters.luaScriptArguments = optarg;
 				continue;
+			case 'H':
+				parameters.headless = true;
+				if (!parameters.headlessBatch.Load(optarg)) {
+					Usage();
+					ExitFatal(-1);
+				}
+				if (parameters.headlessBatch.Seed) {
+					SyncRandInitialSeed = *parameters.headlessBatch.Seed;
+				}
+				continue;
 			case 'i':
 				EnableUnitDebug = true;
 				continue;
@@ -671,6 +683,11 @@ void ParseCommandLine(int argc, char **argv, Parameters &parameters)
 			CliMapName[index] = '/';
 		}
 	}
+	if (parameters.headless && CliMapName.empty()) {
+		ErrorPrint("headless mode needs a map file\n");
+		Usage();
+		ExitFatal(-1);
+	}
 }
 
 #ifdef USE_WIN32
@@ -755,7 +772,7 @@ try {
 
 	// Setup sound card, must be done before loading sounds, so that
 	// SDL_mixer can auto-convert to the target format
-	if (InitSound()) {
+	if (!parameters.headless && InitSound()) {
 		InitMusic();
 	}
 
@@ -766,6 +783,15 @@ try {
 
 	LoadCcl(parameters.luaStartFilename, parameters.luaScriptArguments);
 
+	if (parameters.headless) {
+		// No video, fonts, cursors nor menus: only play the map.
+		ThisPlayer = nullptr;
+		NumPlayers = 0;
+		UnitManager->Init();
+		RunHeadlessGame(CliMapName);
+		return 0;
+	}
+
 	// Setup video display
 	InitVideo();
 
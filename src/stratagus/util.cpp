@@ -64,6 +64,7 @@
 ----------------------------------------------------------------------------*/
 
 uint32_t SyncRandSeed;               /// sync random seed value.
+uint32_t SyncRandInitialSeed = 0x87654321; /// sync random seed value at the start of a game.
 uint32_t FileChecksums = 0;              /// checksums of all loaded lua files
 
 /**
@@ -71,7 +72,7 @@ uint32_t FileChecksums = 0;              /// checksums of all loaded lua files
 */
 void InitSyncRand()
 {
-	SyncRandSeed = 0x87654321;
+	SyncRandSeed = SyncRandInitialSeed;
 	if (EnableDebugPrint) {
 		DebugPrint("GameCycle: %lud, init seed: %x\n", GameCycle, SyncRandSeed);
 		//print_backtrace();
@@ -102,7 +102,7 @@ bool ButtonCheckUpgrade(const CUnit &unit, const ButtonAction &button)
 */
 bool ButtonCheckIndividualUpgrade(const CUnit &unit, const ButtonAction &button)
 {
-	return unit.IndividualUpgrades[UpgradeIdByIdent(button.AllowStr)];
+	return unit.HasIndividualUpgrade(UpgradeIdByIdent(button.AllowStr));
 }
 
 /**
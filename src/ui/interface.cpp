@@ -880,7 +880,9 @@ static void InputKey(int key)
 #else
 			if (starts_with(Input.data(), "ffw ") && ReplayGameType != EReplayType::NoReplay) {
 #endif
-				FastForwardCycle = atoi(&Input[4]);
+				if (!ReplaySeek(atoi(&Input[4]))) {
+					FastForwardCycle = atoi(&Input[4]);
+				}
 			}
 
 			if (Input[0]) {
@@ -526,6 +526,16 @@ static int CclUnit(lua_State *l)
 			lua_pushvalue(l, -1);
 			unit->pathFinderData->output.Load(l);
 			lua_pop(l, 1);
+		} else if (value == "pathfinder-stored-path") {
+			const std::string_view directions = LuaToString(l, 2, j + 1);
+			std::vector<char> path;
+			for (const char c : directions) {
+				if (c < '0' || c > '7') {
+					LuaError(l, "Wrong direction in stored path: %c", c);
+				}
+				path.push_back(c - '0');
+			}
+			unit->pathFinderData->storedPath.Assign(path.data(), path.size());
 		} else if (value == "wait") {
 			unit->Wait = LuaToNumber(l, 2, j + 1);
 		} else if (value == "anim-data") {
@@ -651,6 +661,9 @@ static int CclUnit(lua_State *l)
 				unit->SpellCoolDownTimers[k] = LuaToNumber(l, -1, k + 1);
 			}
 			lua_pop(l, 1);
+		} else if (value == "individual-upgrade") {
+			// The saved variables already have its modifiers.
+			unit->SetIndividualUpgrade(CUpgrade::Get(LuaToString(l, 2, j + 1))->ID, true);
 		} else if (value == "ShadowFly") {
 			WarnLegacySaveField("ShadowFly");
 		} else {
@@ -658,6 +671,7 @@ static int CclUnit(lua_State *l)
 			if (index != -1) { // Valid index
 				lua_rawgeti(l, 2, j + 1);
 				DefineVariableField(l, &unit->Variable[index], -1);
+				unit->UpdateIncreasingVariables();
 				lua_pop(l, 1);
 				continue;
 			}
@@ -1338,7 +1352,7 @@ static int CclGetUnitVariable(lua_State *l)
 		LuaCheckArgs(l, 3);
 		std::string_view upgrade_ident = LuaToString(l, 3);
 		if (CUpgrade::Get(upgrade_ident)) {
-			lua_pushboolean(l, unit->IndividualUpgrades[CUpgrade::Get(upgrade_ident)->ID]);
+			lua_pushboolean(l, unit->HasIndividualUpgrade(CUpgrade::Get(upgrade_ident)->ID));
 		} else {
 			LuaError(l, "Individual upgrade \"%s\" doesn't exist.", upgrade_ident.data());
 		}
@@ -1449,6 +1463,7 @@ static int CclSetUnitVariable(lua_State *l)
 	} else if (name == "RegenerationRate") {
 		value = LuaToNumber(l, 3);
 		unit->Variable[HP_INDEX].Increase = std::min(unit->Variable[HP_INDEX].Max, value);
+		unit->UpdateIncreasingVariables();
 	} else if (name == "RegenerationFrequency") {
 		value = LuaToNumber(l, 3);
 		unit->Variable[HP_INDEX].IncreaseFrequency = value;
@@ -1460,9 +1475,9 @@ static int CclSetUnitVariable(lua_State *l)
 		std::string_view upgrade_ident = LuaToString(l, 3);
 		bool has_upgrade = LuaToBoolean(l, 4);
 		if (CUpgrade::Get(upgrade_ident)) {
-			if (has_upgrade && unit->IndividualUpgrades[CUpgrade::Get(upgrade_ident)->ID] == false) {
+			if (has_upgrade && unit->HasIndividualUpgrade(CUpgrade::Get(upgrade_ident)->ID) == false) {
 				IndividualUpgradeAcquire(*unit, CUpgrade::Get(upgrade_ident));
-			} else if (!has_upgrade && unit->IndividualUpgrades[CUpgrade::Get(upgrade_ident)->ID]) {
+			} else if (!has_upgrade && unit->HasIndividualUpgrade(CUpgrade::Get(upgrade_ident)->ID)) {
 				IndividualUpgradeLost(*unit, CUpgrade::Get(upgrade_ident));
 			}
 		} else {
@@ -1523,6 +1538,7 @@ static int CclSetUnitVariable(lua_State *l)
 				unit->Variable[index].Max = value;
 			} else if (type == "Increase") {
 				unit->Variable[index].Increase = value;
+				unit->UpdateIncreasingVariables();
 			} else if (type == "IncreaseFrequency") {
 				unit->Variable[index].IncreaseFrequency = value;
 				if (unit->Variable[index].IncreaseFrequency != value) {
@@ -50,6 +50,7 @@
 #include "map.h"
 #include "missile.h"
 #include "network.h"
+#include "pathfinder.h"
 #include "player.h"
 #include "script.h"
 #include "settings.h"
@@ -410,7 +411,7 @@ void CUnit::Init()
 
 	Frame = 0;
 	Colors = -1;
-	ranges::fill(IndividualUpgrades, false);
+	IndividualUpgrades.clear();
 	IX = 0;
 	IY = 0;
 	Direction = 0;
@@ -431,7 +432,6 @@ void CUnit::Init()
 	Constructed = 0;
 	Active = 0;
 	Boarded = 0;
-	CacheLock = 0;
 	Waiting = 0;
 	MineLow = 0;
 	ZDisplaced = 0;
@@ -441,6 +441,7 @@ void CUnit::Init()
 	ranges::fill(VisCount, 0);
 	memset(&Seen, 0, sizeof(Seen));
 	Variable.clear();
+	IncreasingVariables.clear();
 	TTL = 0;
 	GroupId = 0;
 	LastGroup = 0;
@@ -449,6 +450,7 @@ void CUnit::Init()
 	UnderAttack = 0;
 	memset(&Anim, 0, sizeof(Anim));
 	memset(&WaitBackup, 0, sizeof(WaitBackup));
+	Idle = {};
 	Orders.clear();
 	SavedOrder = nullptr;
 	NewOrder = nullptr;
@@ -458,6 +460,41 @@ void CUnit::Init()
 	Goal = nullptr;
 }
 
+/**
+**  Give or take an individual upgrade.
+**
+**  @param id   ID of the upgrade.
+**  @param has  True if the unit has the upgrade now.
+*/
+void CUnit::SetIndividualUpgrade(int id, bool has)
+{
+	Assert(id >= 0 && id < UpgradeMax);
+	if (static_cast<size_t>(id) >= IndividualUpgrades.size()) {
+		if (!has) {
+			return;
+		}
+		IndividualUpgrades.resize(id + 1, false);
+	}
+	IndividualUpgrades[id] = has;
+}
+
+/**
+**  Find the variables which change each second.
+**
+**  The spell effects are left out, they count down each cycle.
+*/
+void CUnit::UpdateIncreasingVariables()
+{
+	IncreasingVariables.clear();
+	for (unsigned int i = 0; i != Variable.size(); ++i) {
+		if (Variable[i].Increase == 0 || i == BLOODLUST_INDEX || i == HASTE_INDEX || i == SLOW_INDEX
+		    || i == INVISIBLE_INDEX || i == UNHOLYARMOR_INDEX || i == POISON_INDEX) {
+			continue;
+		}
+		IncreasingVariables.push_back(i);
+	}
+}
+
 /**
 **  Release an unit.
 **
@@ -593,7 +630,8 @@ void CUnit::Init(const CUnitType &type)
 	} else {
 		Variable.clear();
 	}
-	ranges::fill(IndividualUpgrades, false);
+	UpdateIncreasingVariables();
+	IndividualUpgrades.clear();
 
 	// Set a heading for the unit if it Handles Directions
 	// Don't set a building heading, as only 1 construction direction
@@ -714,6 +752,7 @@ void CUnit::AssignToPlayer(CPlayer &player)
 	if (!SaveGameLoading) {
 		if (UnitTypeVar.GetNumberVariable()) {
 			Variable = Stats->Variables;
+			UpdateIncreasingVariables();
 		}
 	}
 }
@@ -964,6 +1003,9 @@ void MarkUnitFieldFlags(const CUnit &unit)
 		} while (--w);
 		index += Map.Info.MapWidth;
 	} while (--h);
+	if (flags & ~(MapFieldLandUnit | MapFieldAirUnit | MapFieldSeaUnit)) {
+		PathfinderTerrainChanged(unit.tilePos, Vec2i(width, unit.Type->TileHeight));
+	}
 }
 
 class _UnmarkUnitFieldFlags
@@ -1014,6 +1056,9 @@ void UnmarkUnitFieldFlags(const CUnit &unit)
 		} while (--w);
 		index += Map.Info.MapWidth;
 	} while (--h);
+	if (unit.Type->FieldFlags & ~(MapFieldLandUnit | MapFieldAirUnit | MapFieldSeaUnit)) {
+		PathfinderTerrainChanged(unit.tilePos, Vec2i(width, unit.Type->TileHeight));
+	}
 }
 
 /**
@@ -1782,6 +1827,7 @@ void CUnit::ChangeOwner(CPlayer &newplayer)
 	MapUnmarkUnitSight(*this);
 	newplayer.AddUnit(*this);
 	Stats = const_cast<CUnitStats *>(&Type->Stats[newplayer.Index]);
+	Map.UnitChanged(*this);
 	UpdateUnitSightRange(*this);
 	MapMarkUnitSight(*this);
 
@@ -2491,25 +2537,80 @@ int ThreatCalculate(const CUnit &unit, const CUnit &dest)
 	return cost;
 }
 
-int TargetPriorityCalculate(const CUnit &attacker, const CUnit &dest)
+/**
+**  Check the conditions of TargetPriorityCalculate which don't need a path.
+*/
+static bool IsPossibleTarget(const CUnit &attacker, const CUnit &dest)
 {
 	const CPlayer &player = *attacker.Player;
-	const CUnitType &type = *attacker.Type;
 	const CUnitType &dtype = *dest.Type;
 
 	if (!player.IsEnemy(dest) // a friend or neutral
 		|| !dest.IsVisibleAsGoal(player)
-		|| !CanTarget(type, dtype)) {
-		return INT_MIN;
+		|| !CanTarget(*attacker.Type, dtype)) {
+		return false;
 	}
 	// Don't attack invulnerable units
-	if (dtype.BoolFlag[INDESTRUCTIBLE_INDEX].value || dest.Variable[UNHOLYARMOR_INDEX].Value) {
+	return !dtype.BoolFlag[INDESTRUCTIBLE_INDEX].value && !dest.Variable[UNHOLYARMOR_INDEX].Value;
+}
+
+int TargetPriorityCalculate(const CUnit &attacker, const CUnit &dest)
+{
+	if (!IsPossibleTarget(attacker, dest)) {
 		return INT_MIN;
 	}
+	const int attackRange = attacker.Stats->Variables[ATTACKRANGE_INDEX].Max;
+	return TargetPriorityCalculate(attacker, dest,
+	                               CalcPathLengthToUnit(attacker, dest, attacker.Type->MinAttackRange, attackRange));
+}
+
+/**
+**  Find the target with the highest priority.
+**
+**  The path lengths to the possible targets are searched at once, on the
+**  worker threads of the pathfinder. The first of the best targets of the
+**  table is taken, as when computing the priorities one by one.
+**
+**  @param attacker  Unit which looks for a target.
+**  @param table     Units to choose from.
+**
+**  @return          The best target, or null if none can be attacked.
+*/
+CUnit *BestTargetPriority(const CUnit &attacker, const std::vector<CUnit *> &table)
+{
+	std::vector<CUnit *> targets;
+	for (CUnit *dest : table) {
+		if (IsPossibleTarget(attacker, *dest)) {
+			targets.push_back(dest);
+		}
+	}
+	const int attackRange = attacker.Stats->Variables[ATTACKRANGE_INDEX].Max;
+	const std::vector<int> pathLengths =
+		CalcPathLengthsToUnits(attacker, targets, attacker.Type->MinAttackRange, attackRange);
+	CUnit *best = nullptr;
+	int bestPriority = INT_MIN;
+
+	for (size_t i = 0; i != targets.size(); ++i) {
+		const int priority = TargetPriorityCalculate(attacker, *targets[i], pathLengths[i]);
+		if (priority > bestPriority) {
+			best = targets[i];
+			bestPriority = priority;
+		}
+	}
+	return best;
+}
+
+int TargetPriorityCalculate(const CUnit &attacker, const CUnit &dest, int pathLength)
+{
+	if (!IsPossibleTarget(attacker, dest)) {
+		return INT_MIN;
+	}
+	const CPlayer &player = *attacker.Player;
+	const CUnitType &type = *attacker.Type;
+	const CUnitType &dtype = *dest.Type;
 
 	const int attackRange 	 = attacker.Stats->Variables[ATTACKRANGE_INDEX].Max;
 	const int minAttackRange = attacker.Type->MinAttackRange;
-	const int pathLength 	 = CalcPathLengthToUnit(attacker, dest, minAttackRange, attackRange);
 	int distance		 	 = attacker.MapDistanceTo(dest);
 
 	const int reactionRange  = (player.Type == PlayerTypes::PlayerPerson) ? type.ReactRangePerson : type.ReactRangeComputer;
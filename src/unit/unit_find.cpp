@@ -81,11 +81,12 @@ std::vector<CUnit *> SelectAroundUnit(const CUnit &unit, int range)
 	terrainTraversal.SetSize(Map.Info.MapWidth, Map.Info.MapHeight);
 	terrainTraversal.Init();
 
+	terrainTraversal.SetMaxDistance(maxDist + 1);
 	terrainTraversal.PushUnitPosAndNeighboor(target);
 
 	const int movemask =
 		type.MovementMask & ~(MapFieldLandUnit | MapFieldAirUnit | MapFieldSeaUnit);
-	UnitFinder unitFinder(player, candidates, maxDist, movemask);
+	UnitFinder unitFinder(player, candidates, movemask);
 	return terrainTraversal.Run(unitFinder) ? unitFinder.resUnit : nullptr;
 }
 
@@ -111,11 +112,7 @@ VisitResult UnitFinder::Visit(TerrainTraversal &terrainTraversal, const Vec2i &p
 		return VisitResult::Finished;
 	}
 	if (CanMoveToMask(pos, movemask)) { // reachable
-		if (terrainTraversal.Get(pos) <= maxDist) {
-			return VisitResult::Ok;
-		} else {
-			return VisitResult::DeadEnd;
-		}
+		return VisitResult::Ok;
 	} else { // unreachable
 		return VisitResult::DeadEnd;
 	}
@@ -128,12 +125,11 @@ class TerrainFinder
 
 public:
 
-	TerrainFinder(const CPlayer &player, int maxDist, int movemask, int resmask) :
-		player(player), maxDist(maxDist), movemask(movemask), resmask(resmask) {}
+	TerrainFinder(const CPlayer &player, int movemask, int resmask) :
+		player(player), movemask(movemask), resmask(resmask) {}
 	VisitResult Visit(TerrainTraversal &terrainTraversal, const Vec2i &pos, const Vec2i &from);
 private:
 	const CPlayer &player;
-	int maxDist;
 	int movemask;
 	int resmask;
 	Vec2i resPos;
@@ -150,11 +146,7 @@ VisitResult TerrainFinder::Visit(TerrainTraversal &terrainTraversal, const Vec2i
 		return VisitResult::Finished;
 	}
 	if (CanMoveToMask(pos, movemask)) { // reachable
-		if (terrainTraversal.Get(pos) <= maxDist) {
-			return VisitResult::Ok;
-		} else {
-			return VisitResult::DeadEnd;
-		}
+		return VisitResult::Ok;
 	} else { // unreachable
 		return VisitResult::DeadEnd;
 	}
@@ -183,9 +175,10 @@ FindTerrainType(int movemask, int resmask, int range, const CPlayer &player, con
 	terrainTraversal.SetSize(Map.Info.MapWidth, Map.Info.MapHeight);
 	terrainTraversal.Init();
 
+	terrainTraversal.SetMaxDistance(range + 1);
 	terrainTraversal.PushPos(startPos);
 
-	TerrainFinder terrainFinder(player, range, movemask & ~(MapFieldLandUnit | MapFieldAirUnit | MapFieldSeaUnit), resmask);
+	TerrainFinder terrainFinder(player, movemask & ~(MapFieldLandUnit | MapFieldAirUnit | MapFieldSeaUnit), resmask);
 
 	return terrainTraversal.Run(terrainFinder) ? std::make_optional(terrainFinder.resPos) : std::nullopt;
 }
@@ -322,21 +315,21 @@ class ResourceUnitFinder
 		terrainTraversal.SetSize(Map.Info.MapWidth, Map.Info.MapHeight);
 		terrainTraversal.Init();
 
+		terrainTraversal.SetMaxDistance(maxRange);
 		terrainTraversal.PushUnitPosAndNeighboor(worker);
 
-		ResourceUnitFinder resourceUnitFinder(unit, deposit, resource, maxRange, check_usage);
+		ResourceUnitFinder resourceUnitFinder(unit, deposit, resource, check_usage);
 
 		terrainTraversal.Run(resourceUnitFinder);
 		return resourceUnitFinder.resultMine;
 	}
 
 private:
-	ResourceUnitFinder(const CUnit &worker, const CUnit *deposit, int resource, int maxRange, bool check_usage) :
+	ResourceUnitFinder(const CUnit &worker, const CUnit *deposit, int resource, bool check_usage) :
 		worker(worker),
 		resinfo(*worker.Type->ResInfo[resource]),
 		deposit(deposit),
 		movemask(worker.Type->MovementMask & ~(MapFieldLandUnit | MapFieldAirUnit | MapFieldSeaUnit)),
-		maxRange(maxRange),
 		check_usage(check_usage),
 		res_finder(resource, 1)
 	{
@@ -368,7 +361,6 @@ class ResourceUnitFinder
 	const ResourceInfo &resinfo;
 	const CUnit *deposit;
 	unsigned int movemask;
-	int maxRange;
 	bool check_usage;
 	CResourceFinder res_finder;
 	ResourceUnitFinder_Cost bestCost;
@@ -419,11 +411,7 @@ VisitResult ResourceUnitFinder::Visit(TerrainTraversal &terrainTraversal, const
 		}
 	}
 	if (CanMoveToMask(pos, movemask)) { // reachable
-		if (terrainTraversal.Get(pos) < maxRange) {
-			return VisitResult::Ok;
-		} else {
-			return VisitResult::DeadEnd;
-		}
+		return VisitResult::Ok;
 	} else { // unreachable
 		return VisitResult::DeadEnd;
 	}
@@ -481,6 +469,8 @@ CUnit *FindDeposit(const CUnit &unit, int range, int resource)
 /**
 **  Find the next idle worker
 **
+**  The workers are taken in the order of the units of the player.
+**
 **  @param player    Player's units to search through
 **  @param last      Previous idle worker selected
 **
@@ -488,22 +478,32 @@ CUnit *FindDeposit(const CUnit &unit, int range, int resource)
 */
 CUnit *FindIdleWorker(const CPlayer &player, const CUnit *last)
 {
+	std::vector<CUnit *> workers;
+	for (const CUnitType *type : getUnitTypes()) {
+		if (!type->BoolFlag[HARVESTER_INDEX].value) {
+			continue;
+		}
+		for (CUnit *unit : player.GetUnitsOfType(*type)) {
+			if (!unit->Removed && unit->CurrentAction() == UnitAction::Still) {
+				workers.push_back(unit);
+			}
+		}
+	}
+	ranges::sort(workers, std::less<>{}, &CUnit::PlayerSlot);
+
+	// The next workers are the ones after last in the units of the player.
+	const bool lastIsOwned = last != nullptr && last->Player == &player
+		&& last->PlayerSlot < static_cast<size_t>(player.GetUnitCount())
+		&& &player.GetUnit(last->PlayerSlot) == last;
 	CUnit *FirstUnitFound = nullptr;
-	int SelectNextUnit = (last == nullptr) ? 1 : 0;
 
-	for (CUnit *unit : player.GetUnits()) {
-		if (unit->Type->BoolFlag[HARVESTER_INDEX].value && !unit->Removed) {
-			if (unit->CurrentAction() == UnitAction::Still) {
-				if (SelectNextUnit && !IsOnlySelected(*unit)) {
-					return unit;
-				}
-				if (FirstUnitFound == nullptr) {
-					FirstUnitFound = unit;
-				}
-			}
+	for (CUnit *unit : workers) {
+		const bool isNext = last == nullptr || (lastIsOwned && unit->PlayerSlot > last->PlayerSlot);
+		if (isNext && !IsOnlySelected(*unit)) {
+			return unit;
 		}
-		if (unit == last) {
-			SelectNextUnit = 1;
+		if (FirstUnitFound == nullptr) {
+			FirstUnitFound = unit;
 		}
 	}
 	if (FirstUnitFound != nullptr && !IsOnlySelected(*FirstUnitFound)) {
@@ -515,6 +515,8 @@ CUnit *FindIdleWorker(const CPlayer &player, const CUnit *last)
 /**
 **  Find all units of type.
 **
+**  The units are in the order of the unit manager.
+**
 **  @param type       type of unit requested
 **  @param everybody  if true, include all units
 **  @return           all units of type
@@ -522,17 +524,34 @@ CUnit *FindIdleWorker(const CPlayer &player, const CUnit *last)
 std::vector<CUnit *> FindUnitsByType(const CUnitType &type, bool everybody)
 {
 	std::vector<CUnit *> units;
-	for (CUnit *unit : UnitManager->GetUnits()) {
-		if (unit->Type == &type && !unit->IsUnusable(everybody)) {
-			units.push_back(unit);
+
+	if (type.BoolFlag[VANISHES_INDEX].value) {
+		// Such units are not kept by their player.
+		for (CUnit *unit : UnitManager->GetUnits()) {
+			if (unit->Type == &type && !unit->IsUnusable(everybody)) {
+				units.push_back(unit);
+			}
 		}
+		return units;
 	}
+	for (const CPlayer &player : Players) {
+		for (CUnit *unit : player.GetUnitsOfType(type)) {
+			if (!unit->IsUnusable(everybody)) {
+				units.push_back(unit);
+			}
+		}
+	}
+	ranges::sort(units, [](const CUnit *lhs, const CUnit *rhs) {
+		return lhs->UnitManagerData.GetListIndex() < rhs->UnitManagerData.GetListIndex();
+	});
 	return units;
 }
 
 /**
 **  Find all units of type.
 **
+**  The units are in the order of the units of the player.
+**
 **  @param player  we're looking for the units of this player
 **  @param type    type of unit requested
 **  @return the units
@@ -555,12 +574,11 @@ std::vector<CUnit *> FindPlayerUnitsByType(const CPlayer &player, const CUnitTyp
 	if (typecount == 0) {
 		return {};
 	}
+	std::vector<CUnit *> units = player.GetUnitsOfType(type);
+	ranges::sort(units, std::less<>{}, &CUnit::PlayerSlot);
 	std::vector<CUnit *> table;
 
-	for (CUnit *unit : player.GetUnits()) {
-		if (unit->Type != &type) {
-			continue;
-		}
+	for (CUnit *unit : units) {
 		if (!unit->IsUnusable()) {
 			table.push_back(unit);
 		}
@@ -681,6 +699,9 @@ class BestTargetFinder
 
 	CUnit *Find(const std::vector<CUnit *> &table) const
 	{
+		if (GameSettings.SimplifiedAutoTargeting) {
+			return BestTargetPriority(*attacker, table);
+		}
 		return Find(table.begin(), table.end());
 	}
 
@@ -689,12 +710,12 @@ class BestTargetFinder
 	CUnit *Find(Iterator begin, Iterator end) const
 	{
 		CUnit *enemy = nullptr;
-		int best_cost = GameSettings.SimplifiedAutoTargeting ? INT_MIN : INT_MAX;
+		int best_cost = INT_MAX;
 
 		for (Iterator it = begin; it != end; ++it) {
-			int cost = GameSettings.SimplifiedAutoTargeting ? TargetPriorityCalculate(*attacker, **it) : ComputeCost(*it);
+			int cost = ComputeCost(*it);
 
-			if (GameSettings.SimplifiedAutoTargeting ? (cost > best_cost) : (cost < best_cost)) {
+			if (cost < best_cost) {
 				enemy = *it;
 				best_cost = cost;
 			}
@@ -810,37 +831,37 @@ class BestRangeTargetFinder
 		{
 		}
 
-		template <typename Container>
-		int Fill(Container &&container)
+		/// Fill good and bad, and tell which units of the table are not targets
+		int Fill(const std::vector<CUnit *> &table, std::vector<bool> &skipped)
 		{
-			for (auto *elem : container) {
-				Compute(*elem);
+			skipped.resize(table.size());
+			for (size_t i = 0; i != table.size(); ++i) {
+				skipped[i] = !Compute(*table[i]);
 			}
 			return enemy_count;
 		}
 	private:
 
-		void Compute(CUnit &dest)
+		/// Mark the cost of dest and return whether it may be the target
+		bool Compute(CUnit &dest)
 		{
 			const CPlayer &player = *attacker->Player;
 
 			if (!dest.IsVisibleAsGoal(player)) {
-				dest.CacheLock = 1;
-				return;
+				return false;
 			}
 
 			const CUnitType &type = *attacker->Type;
 			const CUnitType &dtype = *dest.Type;
 			// won't be a target...
 			if (!CanTarget(type, dtype)) { // can't be attacked.
-				dest.CacheLock = 1;
-				return;
+				return false;
 			}
 			// Don't attack invulnerable units
 			if (dtype.BoolFlag[INDESTRUCTIBLE_INDEX].value || dest.Variable[UNHOLYARMOR_INDEX].Value) {
-				dest.CacheLock = 1;
-				return;
+				return false;
 			}
+			bool isTarget = true;
 
 			//  Calculate the costs to attack the unit.
 			//  Unit with the smallest attack costs will be taken.
@@ -854,7 +875,7 @@ class BestRangeTargetFinder
 									 + attacker->Stats->Variables[PIERCINGDAMAGE_INDEX].Value;
 			}
 			if (!player.IsEnemy(dest)) { // a friend or neutral
-				dest.CacheLock = 1;
+				isTarget = false;
 
 				// Calc a negative cost
 				// The cost is more important when the unit would be killed
@@ -918,11 +939,11 @@ class BestRangeTargetFinder
 					(d <= range && UnitReachable(*attacker, dest, attackrange, false))) {
 					++enemy_count;
 				} else {
-					dest.CacheLock = 1;
+					isTarget = false;
 				}
 				// Attack walls only if we are stuck in them
 				if (dtype.BoolFlag[WALL_INDEX].value && d > 1) {
-					dest.CacheLock = 1;
+					isTarget = false;
 				}
 			}
 
@@ -952,6 +973,7 @@ class BestRangeTargetFinder
 					}
 				}
 			}
+			return isTarget;
 		}
 
 	private:
@@ -965,11 +987,16 @@ class BestRangeTargetFinder
 
 	CUnit *Find(std::vector<CUnit *> &table)
 	{
-		if (!GameSettings.SimplifiedAutoTargeting) {
-			FillBadGood(*attacker, range, &good, &bad, size).Fill(table);
+		if (GameSettings.SimplifiedAutoTargeting) {
+			return BestTargetPriority(*attacker, table);
 		}
-		for (auto* unit : table) {
-			Compute(*unit);
+		std::vector<bool> skipped;
+
+		FillBadGood(*attacker, range, &good, &bad, size).Fill(table, skipped);
+		for (size_t i = 0; i != table.size(); ++i) {
+			if (!skipped[i]) {
+				Compute(*table[i]);
+			}
 		}
 		return best_unit;
 	}
@@ -978,20 +1005,6 @@ class BestRangeTargetFinder
 
 	void Compute(CUnit &dest)
 	{
-		if (dest.CacheLock) {
-			dest.CacheLock = 0;
-			return;
-		}
-
-		if (GameSettings.SimplifiedAutoTargeting) {
-			const int cost = TargetPriorityCalculate(*attacker, dest);
-			if (cost > best_cost) {
-				best_unit = &dest;
-				best_cost = cost;
-			}
-			return;
-		}
-
 		const CUnitType &type = *attacker->Type;
 		const CUnitType &dtype = *dest.Type;
 		int x = attacker->tilePos.x;
@@ -1114,6 +1127,30 @@ bool CheckObstaclesBetweenTiles(const Vec2i &unitPos, const Vec2i &goalPos, unsi
 	return true;
 }
 
+/**
+**  Movement types of the units which may be targeted by a type.
+**
+**  @param type  Type of the attacker.
+**
+**  @return      Bit field of CUnitIndex::MovementBit.
+*/
+static unsigned int TargetableMovementTypes(const CUnitType &type)
+{
+	unsigned int movementMask = 0;
+
+	// Shore buildings are land units which can be targeted from the sea.
+	if ((type.CanTarget & (ECanTargetFlag::Land | ECanTargetFlag::Sea)) != ECanTargetFlag::NulFlag) {
+		movementMask |= CUnitIndex::MovementBit(static_cast<int>(EMovement::Land));
+	}
+	if ((type.CanTarget & ECanTargetFlag::Air) != ECanTargetFlag::NulFlag) {
+		movementMask |= CUnitIndex::MovementBit(static_cast<int>(EMovement::Fly));
+	}
+	if ((type.CanTarget & ECanTargetFlag::Sea) != ECanTargetFlag::NulFlag) {
+		movementMask |= CUnitIndex::MovementBit(static_cast<int>(EMovement::Naval));
+	}
+	return movementMask;
+}
+
 /**
 **  Attack units in distance.
 **
@@ -1152,10 +1189,13 @@ CUnit *AttackUnitsInDistance(const CUnit &unit, int range, CUnitFilter pred)
 	} else {
 		// If unit is removed, use containers x and y
 		const CUnit *firstContainer = unit.Container ? unit.Container : &unit;
+		// Only enemies which can be targeted are candidates, skip the other buckets.
 		std::vector<CUnit *> table =
-			SelectAroundUnit(*firstContainer,
-		                     range,
-		                     MakeAndPredicate(HasNotSamePlayerAs(Players[PlayerNumNeutral]), pred));
+			SelectEnemiesAroundUnit(*firstContainer,
+		                            range,
+		                            *unit.Player,
+		                            TargetableMovementTypes(*unit.Type),
+		                            pred);
 
 		if (range > 25 && table.size() > 9) {
 			ranges::sort(table, CompareUnitDistance(unit));
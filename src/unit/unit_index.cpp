@@ -0,0 +1,136 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+/**@name unit_index.cpp - Spatial index of the units. */
+//
+//      (c) Copyright 2026 by the Stratagus Developers
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+//@{
+
+/*----------------------------------------------------------------------------
+--  Includes
+----------------------------------------------------------------------------*/
+
+#include "stratagus.h"
+
+#include "unit_index.h"
+
+#include "player.h"
+#include "unit.h"
+#include "unittype.h"
+
+/*----------------------------------------------------------------------------
+--  Functions
+----------------------------------------------------------------------------*/
+
+/**
+**  Allocate the cells of the index.
+**
+**  @param mapWidth   Width of the map in tiles.
+**  @param mapHeight  Height of the map in tiles.
+*/
+void CUnitIndex::Init(int mapWidth, int mapHeight)
+{
+	cellsX = (mapWidth + CellSize - 1) >> CellShift;
+	cellsY = (mapHeight + CellSize - 1) >> CellShift;
+	maxUnitSize = 1;
+	buckets.clear();
+	buckets.resize(cellsX * cellsY * BucketsPerCell);
+}
+
+/**
+**  Free the cells of the index.
+*/
+void CUnitIndex::Clear()
+{
+	cellsX = 0;
+	cellsY = 0;
+	maxUnitSize = 1;
+	buckets.clear();
+}
+
+unsigned int CUnitIndex::GetBucket(const CUnit &unit) const
+{
+	const int cellX = std::min(unit.tilePos.x >> CellShift, cellsX - 1);
+	const int cellY = std::min(unit.tilePos.y >> CellShift, cellsY - 1);
+
+	return (cellX + cellY * cellsX) * BucketsPerCell
+	       + unit.Player->Index * MovementTypeCount + static_cast<int>(unit.Type->MoveType);
+}
+
+/**
+**  Add a unit which is placed on the map.
+**
+**  @param unit  Unit to add, at its current position.
+*/
+void CUnitIndex::Insert(CUnit &unit)
+{
+	Assert(unit.IndexBucket == static_cast<unsigned int>(-1));
+	if (buckets.empty()) {
+		return;
+	}
+	const Vec2i size(unit.Type->TileWidth, unit.Type->TileHeight);
+	std::vector<Entry> &bucket = buckets[GetBucket(unit)];
+
+	unit.IndexBucket = GetBucket(unit);
+	unit.IndexSlot = bucket.size();
+	bucket.push_back({&unit, unit.tilePos, unit.tilePos + size - Vec2i(1, 1)});
+	maxUnitSize = std::max({maxUnitSize, int(size.x), int(size.y)});
+}
+
+/**
+**  Remove a unit, whatever its bucket.
+**
+**  @param unit  Unit to remove.
+*/
+void CUnitIndex::Remove(CUnit &unit)
+{
+	if (unit.IndexBucket == static_cast<unsigned int>(-1)) {
+		return;
+	}
+	std::vector<Entry> &bucket = buckets[unit.IndexBucket];
+
+	Assert(bucket[unit.IndexSlot].unit == &unit);
+	bucket[unit.IndexSlot] = bucket.back();
+	bucket[unit.IndexSlot].unit->IndexSlot = unit.IndexSlot;
+	bucket.pop_back();
+	unit.IndexBucket = -1;
+}
+
+/**
+**  Move a unit to the bucket of its current owner and movement type.
+**
+**  @param unit  Unit whose player or type changed without moving.
+*/
+void CUnitIndex::Update(CUnit &unit)
+{
+	if (unit.IndexBucket == static_cast<unsigned int>(-1)) {
+		return;
+	}
+	Remove(unit);
+	Insert(unit);
+}
+
+//@}
@@ -70,6 +70,10 @@ void CUnitManager::Init()
 	}
 	units.clear();
 	releasedUnits.clear();
+	iterationDepth = 0;
+	pendingChanges.clear();
+	pendingRelease = false;
+	liveUnits.clear();
 
 	// Initialize the free unit slots
 	unitSlots.clear();
@@ -111,13 +115,14 @@ void CUnitManager::ReleaseUnit(CUnit &unit)
 		lastCreated = nullptr;
 	}
 	if (unit.UnitManagerData.unitSlot != -1) { // == -1 when loading.
-		Assert(units[unit.UnitManagerData.unitSlot] == &unit);
-
-		CUnit *temp = units.back();
-		temp->UnitManagerData.unitSlot = unit.UnitManagerData.unitSlot;
-		units[unit.UnitManagerData.unitSlot] = temp;
-		unit.UnitManagerData.unitSlot = -1;
-		units.pop_back();
+		if (iterationDepth != 0) {
+			Assert(units[unit.UnitManagerData.unitSlot] == &unit);
+			pendingChanges.push_back({&unit, false});
+			pendingRelease = true;
+			liveUnitsOutdated = true;
+		} else {
+			RemoveFromUnits(unit);
+		}
 	}
 	Assert(unit.PlayerSlot == static_cast<size_t>(-1));
 	if (!unit.Released) {
@@ -151,11 +156,89 @@ CUnit *CUnitManager::lastCreatedUnit()
 	return this->lastCreated;
 }
 
+/**
+**  Get the units in the game.
+**
+**  The units released during an iteration are only removed from
+**  GetIteratedUnits() at its end, they are skipped here.
+*/
+const std::vector<CUnit *> &CUnitManager::GetUnits() const
+{
+	if (!pendingRelease) {
+		return units;
+	}
+	if (liveUnitsOutdated) {
+		liveUnits.clear();
+		ranges::copy_if(units, std::back_inserter(liveUnits), [](const CUnit *unit) { return !unit->Released; });
+		liveUnitsOutdated = false;
+	}
+	return liveUnits;
+}
+
 void CUnitManager::Add(CUnit *unit)
 {
 	lastCreated = unit;
-	unit->UnitManagerData.unitSlot = static_cast<int>(units.size());
-	units.push_back(unit);
+	if (iterationDepth != 0) {
+		pendingChanges.push_back({unit, true});
+		liveUnitsOutdated = true;
+	}
+	AddToUnits(*unit);
+}
+
+void CUnitManager::AddToUnits(CUnit &unit)
+{
+	unit.UnitManagerData.unitSlot = static_cast<int>(units.size());
+	units.push_back(&unit);
+}
+
+void CUnitManager::RemoveFromUnits(CUnit &unit)
+{
+	Assert(units[unit.UnitManagerData.unitSlot] == &unit);
+
+	CUnit *temp = units.back();
+	temp->UnitManagerData.unitSlot = unit.UnitManagerData.unitSlot;
+	units[unit.UnitManagerData.unitSlot] = temp;
+	unit.UnitManagerData.unitSlot = -1;
+	units.pop_back();
+}
+
+/**
+**  Allow to iterate over the units by index while they are created and released.
+**
+**  The first GetIteratedUnits().size() units keep their place until
+**  EndIteration. Released units stay in this list, they are Destroyed.
+**  New units are appended to the list at once.
+*/
+void CUnitManager::BeginIteration()
+{
+	if (iterationDepth++ == 0) {
+		unitCountBeforeIteration = units.size();
+	}
+}
+
+/**
+**  Apply the changes delayed since BeginIteration.
+**
+**  They are replayed in order on the list as it was before the iteration,
+**  so the units end in the same order as without the iteration.
+*/
+void CUnitManager::EndIteration()
+{
+	Assert(iterationDepth > 0);
+	if (--iterationDepth != 0 || pendingChanges.empty()) {
+		return;
+	}
+	units.resize(unitCountBeforeIteration);
+	for (const PendingChange &change : pendingChanges) {
+		if (change.Added) {
+			AddToUnits(*change.Unit);
+		} else {
+			RemoveFromUnits(*change.Unit);
+		}
+	}
+	pendingChanges.clear();
+	pendingRelease = false;
+	liveUnits.clear();
 }
 
 /**
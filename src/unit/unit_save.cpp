@@ -49,6 +49,7 @@
 #include "player.h"
 #include "spells.h"
 #include "unittype.h"
+#include "upgrade_structs.h"
 
 #include <cstdio>
 
@@ -235,6 +236,14 @@ void SaveUnit(const CUnit &unit, CFile &file)
 
 	unit.pathFinderData->input.Save(file);
 	unit.pathFinderData->output.Save(file);
+	if (!unit.pathFinderData->storedPath.IsEmpty()) {
+		const CPackedPath &storedPath = unit.pathFinderData->storedPath;
+		std::string directions;
+		for (int i = 0; i != storedPath.GetLength(); ++i) {
+			directions += char('0' + storedPath.Get(i));
+		}
+		file.printf("\"pathfinder-stored-path\", \"%s\",\n  ", directions.c_str());
+	}
 
 	file.printf("\"wait\", %d, ", unit.Wait);
 	CAnimations::SaveUnitAnim(file, unit);
@@ -333,6 +342,12 @@ void SaveUnit(const CUnit &unit, CFile &file)
 		}
 		file.printf("}");
 	}
+	// The variables already have the modifiers of the upgrades.
+	for (size_t i = 0; i != unit.IndividualUpgrades.size(); ++i) {
+		if (unit.IndividualUpgrades[i]) {
+			file.printf(",\n  \"individual-upgrade\", \"%s\"", AllUpgrades[i]->Ident.c_str());
+		}
+	}
 
 	file.printf("})\n");
 }
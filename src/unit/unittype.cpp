@@ -43,6 +43,7 @@
 #include "luacallback.h"
 #include "map.h"
 #include "missile.h"
+#include "parameters.h"
 #include "player.h"
 #include "script.h"
 #include "sound.h"
@@ -50,6 +51,7 @@
 #include "tileset.h"
 #include "translate.h"
 #include "ui.h"
+#include "unit_manager.h"
 #include "unitsound.h"
 #include "util.h"
 #include "video.h"
@@ -675,6 +677,10 @@ void UpdateStats(int reset)
 	for (CUnitType *type : UnitTypes) {
 		UpdateUnitStats(*type, reset);
 	}
+	// The units of a loaded game are already on the map.
+	for (CUnit *unit : UnitManager->GetUnits()) {
+		Map.UnitChanged(*unit);
+	}
 }
 
 /**
@@ -979,8 +985,15 @@ void LoadUnitTypes()
 #ifndef DYNAMIC_LOAD
 		// Load Sprite
 		if (!type->Sprite) {
-			ShowLoadProgress(_("Unit \"%s\""), type->Name.c_str());
-			LoadUnitTypeSprite(*type);
+			if (Parameters::Instance.headless) {
+				// Only the frame size is used, to place corpses.
+				if (!type->File.empty()) {
+					type->Sprite = CPlayerColorGraphic::New(type->File, type->Width, type->Height);
+				}
+			} else {
+				ShowLoadProgress(_("Unit \"%s\""), type->Name.c_str());
+				LoadUnitTypeSprite(*type);
+			}
 		}
 #endif
 		// FIXME: should i copy the animations of same graphics?
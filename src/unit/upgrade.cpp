@@ -615,6 +615,9 @@ static void ApplyUpgradeModifier(CPlayer &player, const CUpgradeModifier &um)
 							clamp(&unit.Variable[j].Value, 0, unit.Variable[j].Max);
 						}
 					}
+					unit.UpdateIncreasingVariables();
+					// Its threat comes from the stats of its type.
+					Map.UnitChanged(unit);
 				}
 			}
 			if (um.ConvertTo) {
@@ -772,6 +775,9 @@ static void RemoveUpgradeModifier(CPlayer &player, const CUpgradeModifier &um)
 
 						clamp(&unit.Variable[j].Value, 0, unit.Variable[j].Max);
 					}
+					unit.UpdateIncreasingVariables();
+					// Its threat comes from the stats of its type.
+					Map.UnitChanged(unit);
 				}
 			}
 			if (um.ConvertTo) {
@@ -815,6 +821,7 @@ void ApplyIndividualUpgradeModifier(CUnit &unit, const CUpgradeModifier &um)
 			clamp(&unit.Variable[j].Value, 0, unit.Variable[j].Max);
 		}
 	}
+	unit.UpdateIncreasingVariables();
 	if (um.ConvertTo) {
 		CommandTransformIntoType(unit, *um.ConvertTo);
 	}
@@ -847,6 +854,7 @@ static void RemoveIndividualUpgradeModifier(CUnit &unit, const CUpgradeModifier
 			clamp(&unit.Variable[j].Value, 0, unit.Variable[j].Max);
 		}
 	}
+	unit.UpdateIncreasingVariables();
 }
 
 /**
@@ -931,7 +939,7 @@ void IndividualUpgradeAcquire(CUnit &unit, const CUpgrade *upgrade)
 {
 	int id = upgrade->ID;
 	unit.Player->UpgradeTimers.Upgrades[id] = upgrade->Costs[TimeCost];
-	unit.IndividualUpgrades[id] = true;
+	unit.SetIndividualUpgrade(id, true);
 
 	for (int z = 0; z < NumUpgradeModifiers; ++z) {
 		if (UpgradeModifiers[z]->UpgradeId == id) {
@@ -951,7 +959,7 @@ void IndividualUpgradeLost(CUnit &unit, const CUpgrade *upgrade)
 {
 	int id = upgrade->ID;
 	unit.Player->UpgradeTimers.Upgrades[id] = 0;
-	unit.IndividualUpgrades[id] = false;
+	unit.SetIndividualUpgrade(id, false);
 
 	for (int z = 0; z < NumUpgradeModifiers; ++z) {
 		if (UpgradeModifiers[z]->UpgradeId == id) {
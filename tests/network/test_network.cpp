@@ -58,6 +58,18 @@ void FillCustomValue(CNetworkCommandSync *obj)
 {
 	obj->syncSeed = 0x01234567;
 	obj->syncHash = 0x89ABCDEF;
+	for (size_t i = 0; i != SyncPartCount; ++i) {
+		obj->digests[i] = 0x10203040 * (i + 1);
+	}
+}
+void FillCustomValue(CNetworkSyncBisect *obj)
+{
+	obj->cycle = 0x01234567;
+	obj->lo = 0x4000;
+	obj->hi = 0x10000;
+	obj->digests = {0x89ABCDEF, 0x01234567, 0xFEDCBA98, 0x76543210};
+	obj->player = 7;
+	obj->last = 1;
 }
 void FillCustomValue(CNetworkCommandQuit *obj)
 {
@@ -94,6 +106,12 @@ bool Comp(const CNetworkSelection &lhs, const CNetworkSelection &rhs)
 	return lhs.Units == rhs.Units;
 }
 
+bool Comp(const CNetworkSyncBisect &lhs, const CNetworkSyncBisect &rhs)
+{
+	return lhs.cycle == rhs.cycle && lhs.lo == rhs.lo && lhs.hi == rhs.hi
+	    && lhs.digests == rhs.digests && lhs.player == rhs.player && lhs.last == rhs.last;
+}
+
 
 template <typename T>
 bool CheckSerialization()
@@ -126,6 +144,10 @@ TEST_CASE("CNetworkCommandSync")
 {
 	CHECK(CheckSerialization<CNetworkCommandSync>());
 }
+TEST_CASE("CNetworkSyncBisect")
+{
+	CHECK(CheckSerialization<CNetworkSyncBisect>());
+}
 TEST_CASE("CNetworkCommandQuit")
 {
 	CHECK(CheckSerialization<CNetworkCommandQuit>());
@@ -0,0 +1,185 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+/**@name test_actions.cpp - The test file for the sleeping units in actions.cpp. */
+//
+//      (c) Copyright 2026 by the Stratagus Developers
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+
+#include <doctest.h>
+
+#include "stratagus.h"
+
+#include "actions.h"
+#include "animation.h"
+#include "animation/animation_frame.h"
+#include "animation/animation_wait.h"
+#include "iolib.h"
+#include "unit.h"
+#include "unit_manager.h"
+#include "unittype.h"
+
+#include <fstream>
+#include <sstream>
+#include <tuple>
+#include <vector>
+
+namespace
+{
+
+/// What a unit has done, and what a save file would keep of it
+struct UnitState
+{
+	int Frame;
+	int Anim;
+	int Wait;
+	unsigned int IdleCycles;
+	std::string Saved;
+
+	bool operator==(const UnitState &rhs) const
+	{
+		return std::tie(Frame, Anim, Wait, IdleCycles, Saved)
+		    == std::tie(rhs.Frame, rhs.Anim, rhs.Wait, rhs.IdleCycles, rhs.Saved);
+	}
+};
+
+UnitState GetUnitState(const CUnit &unit)
+{
+	const fs::path path = fs::temp_directory_path() / "stratagus_test_actions.lua";
+	{
+		CFile file;
+		file.open(path.string().c_str(), CL_OPEN_WRITE);
+		unit.Orders[0]->Save(file, unit);
+		file.printf(", \"anim-wait\", %d", unit.Anim.Wait);
+		file.close();
+	}
+	std::ostringstream saved;
+	saved << std::ifstream(path).rdbuf();
+	fs::remove(path);
+	return {unit.Frame, unit.Anim.Anim, unit.Anim.Wait, unit.Orders[0]->GetIdleCycles(unit), saved.str()};
+}
+
+struct StillRun
+{
+	std::vector<std::vector<UnitState>> History; /// State of the units after each cycle
+	std::vector<UnitState> Saved;                /// State of the units at the save
+	int SleepingCycles = 0;                      /// Number of cycles skipped by the units
+};
+
+/**
+**  Run the still units for some cycles.
+**
+**  @param cycles     Number of cycles to run.
+**  @param wakeUp     Wake up the units after each cycle, so that they never sleep.
+**  @param saveCycle  Cycle in which the units are saved from a trigger, 0 for none.
+*/
+StillRun RunStillUnits(int cycles, bool wakeUp, unsigned long saveCycle = 0)
+{
+	CAnimations animations;
+	for (const char *wait : {"r.10.40", "3", "r.1.20"}) {
+		animations.Still.push_back(std::make_unique<CAnimation_Frame>());
+		animations.Still.back()->Init("0");
+		animations.Still.push_back(std::make_unique<CAnimation_Wait>());
+		animations.Still.back()->Init(wait);
+	}
+	CUnitType type;
+	type.NumDirections = 8;
+	type.Animations = &animations;
+	type.BoolFlag.resize(UnitTypeVar.GetNumberBoolFlag());
+
+	CUnitManager manager;
+	CUnitManager *const oldManager = UnitManager;
+	UnitManager = &manager;
+	manager.Init();
+	for (int i = 0; i != 3; ++i) {
+		CUnit &unit = *manager.AllocUnit();
+		unit.Type = &type;
+		unit.Removed = 0;
+		unit.Variable.resize(UnitTypeVar.GetNumberVariable());
+		unit.Orders.push_back(COrder::NewActionStill());
+		manager.Add(&unit);
+	}
+
+	InitSyncRand();
+	GameCycle = 0;
+	StillRun run;
+	for (int i = 0; i != cycles; ++i) {
+		++GameCycle;
+		if (GameCycle == saveCycle) {
+			// Triggers run before the units of the cycle.
+			WakeUpIdleUnits();
+			for (const CUnit *unit : manager.GetUnits()) {
+				run.Saved.push_back(GetUnitState(*unit));
+			}
+		}
+		UnitActions();
+		if (wakeUp) {
+			WakeUpIdleUnits();
+		}
+		run.History.emplace_back();
+		for (const CUnit *unit : manager.GetUnits()) {
+			run.SleepingCycles += unit->Idle.Until > GameCycle + 1;
+			run.History.back().push_back(GetUnitState(*unit));
+		}
+	}
+	WakeUpIdleUnits();
+	for (size_t i = 0; i != manager.GetUnits().size(); ++i) {
+		run.History.back()[i] = GetUnitState(*manager.GetUnits()[i]);
+	}
+
+	while (!manager.empty()) {
+		CUnit &unit = *manager.GetUnits().front();
+		unit.Orders.clear();
+		manager.ReleaseUnit(unit);
+	}
+	UnitManager = oldManager;
+	GameCycle = 0;
+	return run;
+}
+
+} // namespace
+
+TEST_CASE("Sleeping units do the same as the awake ones")
+{
+	const int cycles = 200;
+	const StillRun awake = RunStillUnits(cycles, true);
+	CHECK(awake.SleepingCycles == 0);
+
+	SUBCASE("Asleep until the end") {
+		const StillRun asleep = RunStillUnits(cycles, false);
+
+		CHECK(asleep.SleepingCycles > cycles);
+		CHECK(asleep.History.back() == awake.History.back());
+	}
+	SUBCASE("Saved from a trigger") {
+		for (unsigned long saveCycle : {2ul, 17ul, 60ul, 123ul}) {
+			const StillRun asleep = RunStillUnits(cycles, false, saveCycle);
+
+			// The actions of the save cycle are not run yet.
+			CHECK(asleep.Saved == awake.History[saveCycle - 2]);
+			CHECK(asleep.History.back() == awake.History.back());
+		}
+	}
+}
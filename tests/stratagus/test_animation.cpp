@@ -0,0 +1,70 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+/**@name test_animation.cpp - The test file for animation.cpp. */
+//
+//      (c) Copyright 2026 by the Stratagus Developers
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+
+#include <doctest.h>
+
+#include "stratagus.h"
+
+#include "actions.h"
+#include "animation.h"
+#include "unit.h"
+#include "unittype.h"
+#include "util.h"
+
+TEST_CASE("Parsed animation operands give the values of their text")
+{
+	CUnitType type;
+	type.BoolFlag.resize(UnitTypeVar.GetNumberBoolFlag());
+	type.BoolFlag[COWARD_INDEX].value = true;
+
+	CUnit unit;
+	unit.Type = &type;
+	unit.Variable.resize(UnitTypeVar.GetNumberVariable());
+	unit.Variable[HP_INDEX].Value = 30;
+	unit.Variable[HP_INDEX].Max = 40;
+	unit.Variable[HP_INDEX].Increase = 2;
+	unit.Variable[HP_INDEX].Enable = true;
+	unit.Anim.Rotate = -3;
+	unit.Orders.push_back(COrder::NewActionStill());
+
+	for (const char *text : {"", "0", "17", "-5", "v.HitPoints.Value", "v.HitPoints.Max",
+	                         "v.HitPoints.Increase", "v.HitPoints.Enable", "v.HitPoints.Percent",
+	                         "v.HitPoints.Other", "t.HitPoints.Value", "b.Coward", "b.Building",
+	                         "g.Coward", "U", "G", "R", "r.6", "r.3.9"}) {
+		CAnimInt operand;
+		operand = text;
+
+		InitSyncRand();
+		const int expected = ParseAnimInt(unit, std::string_view(text));
+		InitSyncRand();
+		CHECK_MESSAGE(operand.Eval(unit) == expected, text);
+		CHECK(operand.str() == text);
+	}
+}
@@ -0,0 +1,107 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+/**@name test_headless.cpp - The test file for the headless batch games. */
+//
+//      (c) Copyright 2026 by the Stratagus Developers
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+
+#include <doctest.h>
+
+#include "stratagus.h"
+
+#include "interface.h"
+#include "parameters.h"
+#include "results.h"
+
+TEST_CASE("Headless batch files give the results file, the cycle limit and the seed")
+{
+	const fs::path file = fs::path("batches") / "skirmish.json";
+	HeadlessBatch batch;
+
+	CHECK(batch.Parse("{}", file));
+	CHECK(batch.ResultFilename == fs::path("batches") / "skirmish.results.json");
+	CHECK(batch.MaxCycles == 0);
+	CHECK_FALSE(batch.Seed.has_value());
+
+	CHECK(batch.Parse(R"( {
+		"results": "out\/skirmish 1.json",
+		"maxCycles": 54000,
+		"seed": 4294967295
+	} )", file));
+	CHECK(batch.ResultFilename == fs::path("batches") / "out" / "skirmish 1.json");
+	CHECK(batch.MaxCycles == 54000);
+	CHECK(batch.Seed == 4294967295u);
+
+	// A new description forgets the previous one.
+	CHECK(batch.Parse(R"({"seed": 0})", file));
+	CHECK(batch.MaxCycles == 0);
+	CHECK(batch.Seed == 0u);
+
+	for (const char *json : {"", "[]", "{", "{\"seed\": 1", "{\"seed\" 1}", "{\"seed\": 1,}",
+	                         "{\"seed\": 1} 2", "{\"seed\": -1}", "{\"seed\": 4294967296}",
+	                         "{\"seed\": \"1\"}", "{\"seed\": 1.5}", "{\"maxCycles\": -5}",
+	                         "{\"results\": \"\"}", "{\"results\": 3}", "{\"maxcycles\": 100}"}) {
+		CHECK_MESSAGE(!batch.Parse(json, file), json);
+	}
+}
+
+TEST_CASE("Headless games end as a draw at their cycle limit")
+{
+	HeadlessBatch &batch = Parameters::Instance.headlessBatch;
+	GameResult = GameNoResult;
+	GameRunning = true;
+
+	SUBCASE("No limit") {
+		batch.MaxCycles = 0;
+		GameCycle = 1000000;
+		CheckHeadlessCycleLimit();
+		CHECK(GameRunning);
+		CHECK(GameResult == GameNoResult);
+	}
+	SUBCASE("Limit reached") {
+		batch.MaxCycles = 300;
+		GameCycle = 299;
+		CheckHeadlessCycleLimit();
+		CHECK(GameRunning);
+
+		GameCycle = 300;
+		CheckHeadlessCycleLimit();
+		CHECK_FALSE(GameRunning);
+		CHECK(GameResult == GameDraw);
+	}
+	SUBCASE("Game ended by the triggers at the limit") {
+		batch.MaxCycles = 300;
+		GameCycle = 300;
+		StopGame(GameVictory);
+		CheckHeadlessCycleLimit();
+		CHECK(GameResult == GameVictory);
+	}
+	batch = HeadlessBatch();
+	GameCycle = 0;
+	GameResult = GameNoResult;
+	GameRunning = false;
+	GamePaused = false;
+}
@@ -0,0 +1,165 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+/**@name test_influence.cpp - The test file for map_influence.cpp. */
+//
+//      (c) Copyright 2026 by the Stratagus Developers
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+#include <doctest.h>
+
+#include "stratagus.h"
+
+#include "actions.h"
+#include "influence.h"
+#include "map.h"
+#include "player.h"
+#include "unit.h"
+#include "unittype.h"
+#include "upgrade.h"
+#include "upgrade_structs.h"
+
+#include <algorithm>
+
+TEST_CASE("Influence map follows units and diplomacy")
+{
+	CPlayer &player0 = Players[0];
+	CPlayer &player1 = Players[1];
+	player0.Index = 0;
+	player1.Index = 1;
+	player1.SetDiplomacyEnemyWith(player0);
+
+	CUnitType peasant;
+	peasant.TileWidth = 1;
+	peasant.TileHeight = 1;
+	CUnitType archer;
+	archer.TileWidth = 1;
+	archer.TileHeight = 1;
+	archer.CanAttack = true;
+	CUnitStats archerStats;
+	archerStats.Variables.resize(NVARALREADYDEFINED);
+	archerStats.Variables[ATTACKRANGE_INDEX].Max = 4;
+	archerStats.Variables[BASICDAMAGE_INDEX].Value = 3;
+	archerStats.Variables[PIERCINGDAMAGE_INDEX].Value = 6;
+
+	CInfluenceMap influence;
+	influence.Init(64, 40);
+
+	CUnit peasant0;
+	peasant0.Type = &peasant;
+	peasant0.Player = &player0;
+	peasant0.tilePos = Vec2i(20, 20);
+	influence.AddUnit(peasant0);
+
+	CUnit archer1;
+	archer1.Type = &archer;
+	archer1.Stats = &archerStats;
+	archer1.Player = &player1;
+	archer1.tilePos = Vec2i(30, 20);
+	influence.AddUnit(archer1);
+
+	CHECK(influence.GetPresence(0, Vec2i(23, 23)) == 1);
+	CHECK(influence.GetFriendlyPresence(player0, Vec2i(16, 16)) == 1);
+	CHECK(influence.GetThreat(0, Vec2i(20, 20)) == 0);
+	// (3 + 6) damage x 4 range, from tile 26 to 34 horizontally.
+	CHECK(influence.GetThreat(1, Vec2i(24, 20)) == 36);
+	CHECK(influence.GetThreat(1, Vec2i(47, 20)) == 0);
+	CHECK(influence.GetEnemyThreat(player0, Vec2i(24, 20)) == 36);
+	CHECK(influence.GetEnemyThreat(player1, Vec2i(24, 20)) == 0);
+	CHECK(influence.GetEnemyPresence(player0, Vec2i(0, 0), Vec2i(63, 39)) == 1);
+	CHECK(influence.GetEnemyPresence(player0, Vec2i(0, 0), Vec2i(15, 39)) == 0);
+
+	// Removing gives back what was added, even if the stats changed meanwhile.
+	archerStats.Variables[BASICDAMAGE_INDEX].Value = 10;
+	influence.RemoveUnit(archer1);
+	CHECK(archer1.Influence.Player == -1);
+	CHECK(influence.GetThreat(1, Vec2i(24, 20)) == 0);
+	CHECK(influence.GetEnemyPresence(player0, Vec2i(0, 0), Vec2i(63, 39)) == 0);
+
+	influence.RemoveUnit(peasant0);
+	CHECK(influence.GetPresence(0, Vec2i(20, 20)) == 0);
+
+	player1.SetDiplomacyNeutralWith(player0);
+}
+
+TEST_CASE("Influence map follows the upgrades of the units")
+{
+	Map.Info.MapWidth = 64;
+	Map.Info.MapHeight = 40;
+	Map.Create();
+
+	CPlayer &player1 = Players[1];
+	player1.Index = 1;
+	CUnitType &archer = *NewUnitTypeSlot("unit-test-archer").first;
+	archer.TileWidth = 1;
+	archer.TileHeight = 1;
+	archer.CanAttack = true;
+	CUnitStats &stats = archer.Stats[player1.Index];
+	stats.Variables.resize(UnitTypeVar.GetNumberVariable());
+	stats.Variables[ATTACKRANGE_INDEX].Max = 4;
+	stats.Variables[BASICDAMAGE_INDEX].Value = 3;
+	stats.Variables[BASICDAMAGE_INDEX].Max = 10;
+	stats.Variables[PIERCINGDAMAGE_INDEX].Value = 6;
+	stats.Variables[PIERCINGDAMAGE_INDEX].Max = 10;
+
+	CUnit archer1;
+	archer1.Type = &archer;
+	archer1.PlayerSlot = static_cast<size_t>(-1);
+	player1.AddUnit(archer1);
+	archer1.Stats = &stats;
+	archer1.Variable = stats.Variables;
+	archer1.Orders.push_back(COrder::NewActionStill());
+	archer1.tilePos = Vec2i(30, 20);
+	archer1.Offset = Map.getIndex(archer1.tilePos);
+	archer1.Removed = 0;
+	Map.Insert(archer1);
+	CHECK(Map.Influence.GetThreat(1, Vec2i(24, 20)) == 36);
+
+	const CUpgrade &arrows = *CUpgrade::New("upgrade-test-arrows");
+	auto &modifier = UpgradeModifiers[NumUpgradeModifiers++];
+	modifier = std::make_unique<CUpgradeModifier>();
+	modifier->UpgradeId = arrows.ID;
+	modifier->Modifier.Variables.resize(UnitTypeVar.GetNumberVariable());
+	modifier->Modifier.Variables[BASICDAMAGE_INDEX].Value = 1;
+	modifier->ModifyPercent.resize(UnitTypeVar.GetNumberVariable());
+	std::fill(std::begin(modifier->ApplyTo), std::end(modifier->ApplyTo), '?');
+	modifier->ApplyTo[archer.Slot] = 'X';
+
+	// (4 + 6) damage x 4 range, without moving the archer.
+	UpgradeAcquire(player1, &arrows);
+	CHECK(Map.Influence.GetThreat(1, Vec2i(24, 20)) == 40);
+	UpgradeLost(player1, arrows.ID);
+	CHECK(Map.Influence.GetThreat(1, Vec2i(24, 20)) == 36);
+
+	Map.Remove(archer1);
+	CHECK(Map.Influence.GetThreat(1, Vec2i(24, 20)) == 0);
+	player1.RemoveUnit(archer1);
+	archer1.Orders.clear();
+	Map.Fields.clear();
+	Map.UnitIndex.Clear();
+	Map.Influence.Clear();
+	CleanUpgrades();
+	AllUpgrades.clear();
+	CleanUnitTypes();
+}
@@ -0,0 +1,70 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+/**@name test_orders.cpp - The test file for the order pools in actions.cpp. */
+//
+//      (c) Copyright 2026 by the Stratagus Developers
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+
+#include <doctest.h>
+
+#include "stratagus.h"
+
+#include "actions.h"
+#include "map.h"
+
+TEST_CASE("Orders reuse the memory of the deleted ones")
+{
+	Map.Info.MapWidth = 32;
+	Map.Info.MapHeight = 32;
+
+	auto move = COrder::NewActionMove(Vec2i(3, 4));
+	const COrder *address = move.get();
+	auto clone = move->Clone();
+
+	CHECK(clone.get() != address);
+	CHECK(clone->Action == UnitAction::Move);
+	CHECK(clone->GetGoalPos() == Vec2i(3, 4));
+
+	move.reset();
+	auto other = COrder::NewActionMove(Vec2i(5, 6));
+	CHECK(other.get() == address);
+	CHECK(other->GetGoalPos() == Vec2i(5, 6));
+	CHECK(clone->GetGoalPos() == Vec2i(3, 4));
+
+	// Orders of other types live side by side.
+	std::vector<std::unique_ptr<COrder>> orders;
+	for (int i = 0; i != 200; ++i) {
+		orders.push_back(i % 3 == 0 ? COrder::NewActionStill()
+		                 : i % 3 == 1 ? COrder::NewActionPatrol(Vec2i(1, 1), Vec2i(i % 32, 2))
+		                 : COrder::NewActionMove(Vec2i(i % 32, 7)));
+	}
+	for (int i = 0; i != 200; ++i) {
+		if (i % 3 != 0) {
+			CHECK(orders[i]->GetGoalPos() == Vec2i(i % 32, i % 3 == 1 ? 2 : 7));
+		}
+	}
+	orders.clear();
+}
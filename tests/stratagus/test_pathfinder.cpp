@@ -35,8 +35,12 @@
 #include "pathfinder.h"
 #include "stratagus.h"
 #include "unit.h"
+#include "unit_manager.h"
 #include "unittype.h"
 
+#include <array>
+#include <chrono>
+
 namespace doctest
 {
 template <typename T>
@@ -140,8 +144,827 @@ TEST_CASE("PathFinding on clear map 128x128")
 		unit.Orders.clear();
 	}
 
+	SUBCASE("long path (100) is kept")
+	{
+		const short dist = 100;
+		const auto dest = unit.tilePos + Vec2i{0, dist};
+		unit.Orders.push_back(COrder::NewActionMove(dest));
+
+		const auto [d, dir] = NextPathElement(unit);
+		const PathFinderOutput &output = unit.pathFinderData->output;
+		const CPackedPath &storedPath = unit.pathFinderData->storedPath;
+
+		CHECK(d == std::size(output.Path));
+		REQUIRE(output.Length + storedPath.GetLength() == dist);
+		Vec2i pos = FollowedPath(unit.tilePos, output);
+		for (int i = 0; i != storedPath.GetLength(); ++i) {
+			pos.x += Heading2X[storedPath.Get(i)];
+			pos.y += Heading2Y[storedPath.Get(i)];
+		}
+		CHECK(dest == pos);
+
+		unit.Orders.clear();
+	}
+
 	Map.Fields.clear();
 
 	extern void FreeAStar(); // free the a* data structures
 	FreeAStar();
 }
+
+TEST_CASE("Packed paths of a freed pool")
+{
+	const auto makeDirections = [](int length, int first) {
+		std::vector<char> directions(length);
+		for (int i = 0; i != length; ++i) {
+			directions[i] = (first + i) % 8;
+		}
+		return directions;
+	};
+	const auto matches = [](const CPackedPath &path, const std::vector<char> &directions) {
+		if (path.GetLength() != int(directions.size())) {
+			return false;
+		}
+		for (int i = 0; i != path.GetLength(); ++i) {
+			if (path.Get(i) != directions[i]) {
+				return false;
+			}
+		}
+		return true;
+	};
+	const std::vector<char> oldDirections = makeDirections(50, 0);
+	const std::vector<char> directions = makeDirections(50, 3);
+	const std::vector<char> otherDirections = makeDirections(50, 5);
+
+	CPackedPath oldPath;
+	oldPath.Assign(oldDirections.data(), oldDirections.size());
+	REQUIRE(matches(oldPath, oldDirections));
+
+	// A new game, the paths kept by old units must not give their block back.
+	FreePathfinder();
+	CPackedPath path;
+	path.Assign(directions.data(), directions.size());
+	oldPath.Clear();
+	CPackedPath otherPath;
+	otherPath.Assign(otherDirections.data(), otherDirections.size());
+
+	CHECK(matches(path, directions));
+	CHECK(matches(otherPath, otherDirections));
+
+	path.Clear();
+	otherPath.Clear();
+	FreePathfinder();
+}
+
+TEST_CASE("PathFinding open sets on 128x128 map with a wall")
+{
+	CPlayer player;
+	player.Index = 0;
+	CUnitType type;
+	type.TileWidth = 1;
+	type.TileHeight = 1;
+	type.MovementMask = MapFieldUnpassable;
+	type.BoolFlag.resize(UnitTypeVar.GetNumberBoolFlag()); // SOLID_INDEX
+	CUnit unit;
+	unit.Player = &player;
+	unit.Type = &type;
+	unit.tilePos = {10, 64};
+
+	Map.Info.MapWidth = 128;
+	Map.Info.MapHeight = 128;
+
+	Map.Create();
+	// Vertical wall with a gap at the top.
+	for (int y = 8; y != Map.Info.MapHeight; ++y) {
+		Map.Field(64, y)->Flags |= MapFieldUnpassable;
+	}
+
+	extern void InitAStar(int mapWidth, int mapHeight);
+	InitAStar(Map.Info.MapWidth, Map.Info.MapHeight);
+
+	extern int AStarFindPath(const Vec2i &startPos, const Vec2i &goalPos, int gw, int gh,
+							 int tilesizex, int tilesizey, int minrange,
+							 int maxrange, char *path, int pathlen, const CUnit &unit);
+	const int oldMaxSearchIterations = AStarMaxSearchIterations;
+	AStarMaxSearchIterations = 128 * 128;
+	// The player has explored nothing, the wall must be known anyway.
+	AStarKnowUnseenTerrain = true;
+
+	const auto search = [&](const Vec2i &dest) {
+		char path[PathFinderOutput::MAX_PATH_LENGTH];
+		return AStarFindPath(unit.tilePos, dest, 1, 1, 1, 1, 0, 0, path, std::size(path), unit);
+	};
+	const Vec2i dests[] = {{120, 64}, {120, 120}, {70, 2}, {30, 100}};
+	constexpr int repeat = 20;
+
+	for (const bool bucket : {false, true}) {
+		SetAStarBucketOpenSet(bucket);
+		const auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i != repeat; ++i) {
+			for (const Vec2i &dest : dests) {
+				search(dest);
+			}
+		}
+		const auto duration = std::chrono::steady_clock::now() - start;
+		MESSAGE((bucket ? "bucket" : "sorted"), " open set: ",
+		        std::chrono::duration_cast<std::chrono::microseconds>(duration).count() / (repeat * std::size(dests)),
+		        "us per search");
+	}
+
+	for (const Vec2i &dest : dests) {
+		const int distance = std::max(std::abs(dest.x - unit.tilePos.x), std::abs(dest.y - unit.tilePos.y));
+
+		SetAStarBucketOpenSet(false);
+		const int sortedLength = search(dest);
+		SetAStarBucketOpenSet(true);
+		const int bucketLength = search(dest);
+
+		CHECK(sortedLength >= distance);
+		CHECK(bucketLength == sortedLength);
+	}
+	// Going around the wall is longer than the straight line.
+	SetAStarBucketOpenSet(true);
+	CHECK(search(Vec2i(120, 64)) > 110);
+
+	SetAStarBucketOpenSet(false);
+	AStarKnowUnseenTerrain = false;
+	AStarMaxSearchIterations = oldMaxSearchIterations;
+	Map.Fields.clear();
+
+	extern void FreeAStar(); // free the a* data structures
+	FreeAStar();
+}
+
+TEST_CASE("PathFinding jump point search on 128x128 map with obstacles")
+{
+	CPlayer player;
+	player.Index = 0;
+	CUnitType type;
+	type.TileWidth = 1;
+	type.TileHeight = 1;
+	type.MovementMask = MapFieldUnpassable;
+	type.BoolFlag.resize(UnitTypeVar.GetNumberBoolFlag()); // SOLID_INDEX
+	CUnit unit;
+	unit.Player = &player;
+	unit.Type = &type;
+	unit.tilePos = {10, 64};
+
+	Map.Info.MapWidth = 128;
+	Map.Info.MapHeight = 128;
+
+	Map.Create();
+	// Vertical wall with a gap at the top, and some rocks.
+	for (int y = 8; y != Map.Info.MapHeight; ++y) {
+		Map.Field(64, y)->Flags |= MapFieldUnpassable;
+	}
+	for (int i = 0; i != 16; ++i) {
+		Map.Field(30 + i, 40 + 2 * i)->Flags |= MapFieldUnpassable;
+		Map.Field(90, 60 + i)->Flags |= MapFieldUnpassable;
+	}
+
+	extern void InitAStar(int mapWidth, int mapHeight);
+	InitAStar(Map.Info.MapWidth, Map.Info.MapHeight);
+
+	extern int AStarFindPath(const Vec2i &startPos, const Vec2i &goalPos, int gw, int gh,
+							 int tilesizex, int tilesizey, int minrange,
+							 int maxrange, char *path, int pathlen, const CUnit &unit);
+	const int oldMaxSearchIterations = AStarMaxSearchIterations;
+	AStarMaxSearchIterations = 128 * 128;
+	// The player has explored nothing, the obstacles must be known anyway.
+	AStarKnowUnseenTerrain = true;
+
+	const Vec2i dests[] = {{120, 64}, {120, 120}, {70, 2}, {30, 100}, {40, 61}};
+
+	for (const Vec2i &dest : dests) {
+		const int distance = std::max(std::abs(dest.x - unit.tilePos.x), std::abs(dest.y - unit.tilePos.y));
+		char path[512];
+
+		SetAStarJumpPointSearch(false);
+		const int aStarLength = AStarFindPath(unit.tilePos, dest, 1, 1, 1, 1, 0, 0, path, std::size(path), unit);
+		SetAStarJumpPointSearch(true);
+		const int jumpLength = AStarFindPath(unit.tilePos, dest, 1, 1, 1, 1, 0, 0, path, std::size(path), unit);
+
+		CHECK(aStarLength >= distance);
+		CHECK(jumpLength == aStarLength);
+		REQUIRE(jumpLength >= distance);
+		REQUIRE(jumpLength <= static_cast<int>(std::size(path)));
+		// The path is stored from its end.
+		Vec2i pos = unit.tilePos;
+		for (int i = jumpLength - 1; i >= 0; --i) {
+			pos.x += Heading2X[(int)path[i]];
+			pos.y += Heading2Y[(int)path[i]];
+			CHECK((Map.Field(pos)->Flags & MapFieldUnpassable) == 0);
+		}
+		CHECK(pos == dest);
+	}
+
+	// The search uses the cost a* gives to a move, which covers the whole
+	// unit and the unexplored tiles: it doesn't fall back to a*.
+	type.TileWidth = 2;
+	type.TileHeight = 2;
+	AStarKnowUnseenTerrain = false;
+	char path[512];
+	SetAStarJumpPointSearch(false);
+	const int bigAStarLength = AStarFindPath(unit.tilePos, Vec2i(120, 120), 1, 1, 2, 2, 0, 0, path, std::size(path), unit);
+	SetAStarJumpPointSearch(true);
+	const int bigJumpLength = AStarFindPath(unit.tilePos, Vec2i(120, 120), 1, 1, 2, 2, 0, 0, path, std::size(path), unit);
+	CHECK(bigAStarLength >= 109);
+	CHECK(bigJumpLength == bigAStarLength);
+	CHECK_FALSE(GetAStarLastSearchStats().JumpFallback);
+
+	SetAStarJumpPointSearch(false);
+	AStarKnowUnseenTerrain = false;
+	AStarMaxSearchIterations = oldMaxSearchIterations;
+	Map.Fields.clear();
+
+	extern void FreeAStar(); // free the a* data structures
+	FreeAStar();
+}
+
+TEST_CASE("PathFinding batches give the same paths as single searches")
+{
+	CPlayer player;
+	player.Index = 0;
+	CUnitType type;
+	type.TileWidth = 1;
+	type.TileHeight = 1;
+	type.MovementMask = MapFieldUnpassable;
+	type.BoolFlag.resize(UnitTypeVar.GetNumberBoolFlag()); // SOLID_INDEX
+	CUnit unit;
+	unit.Player = &player;
+	unit.Type = &type;
+
+	Map.Info.MapWidth = 128;
+	Map.Info.MapHeight = 128;
+
+	Map.Create();
+	// Vertical wall with a gap at the top, and a closed box.
+	for (int y = 8; y != Map.Info.MapHeight; ++y) {
+		Map.Field(64, y)->Flags |= MapFieldUnpassable;
+	}
+	for (int i = 0; i != 5; ++i) {
+		Map.Field(100 + i, 100)->Flags |= MapFieldUnpassable;
+		Map.Field(100 + i, 104)->Flags |= MapFieldUnpassable;
+		Map.Field(100, 100 + i)->Flags |= MapFieldUnpassable;
+		Map.Field(104, 100 + i)->Flags |= MapFieldUnpassable;
+	}
+
+	extern void InitAStar(int mapWidth, int mapHeight);
+	InitAStar(Map.Info.MapWidth, Map.Info.MapHeight);
+
+	extern int AStarFindPath(const Vec2i &startPos, const Vec2i &goalPos, int gw, int gh,
+							 int tilesizex, int tilesizey, int minrange,
+							 int maxrange, char *path, int pathlen, const CUnit &unit);
+	const int oldMaxSearchIterations = AStarMaxSearchIterations;
+	// Enough to find that the box can't be entered.
+	AStarMaxSearchIterations = 4 * 128 * 128;
+	AStarKnowUnseenTerrain = true;
+
+	const Vec2i starts[] = {{10, 64}, {120, 20}, {70, 120}, {2, 2}};
+	const Vec2i goals[] = {{120, 64}, {20, 120}, {102, 102}, {60, 10}, {2, 2}};
+	std::vector<AStarRequest> requests;
+	std::vector<std::array<char, PathFinderOutput::MAX_PATH_LENGTH>> paths(std::size(starts) * std::size(goals));
+	for (const Vec2i &start : starts) {
+		for (const Vec2i &goal : goals) {
+			AStarRequest &request = requests.emplace_back();
+			request.Unit = &unit;
+			request.StartPos = start;
+			request.GoalPos = goal;
+			request.GoalSize = Vec2i(1, 1);
+			request.MaxRange = requests.size() % 3;
+			request.Path = paths[requests.size() - 1].data();
+			request.PathLength = PathFinderOutput::MAX_PATH_LENGTH;
+		}
+	}
+
+	AStarFindPaths(requests);
+
+	for (const AStarRequest &request : requests) {
+		char path[PathFinderOutput::MAX_PATH_LENGTH];
+		const int length = AStarFindPath(request.StartPos, request.GoalPos, 1, 1, 1, 1,
+										 request.MinRange, request.MaxRange, path, std::size(path), unit);
+
+		CHECK(request.Result == length);
+		const int stored = std::min<int>(length, std::size(path));
+		for (int i = 0; i < stored; ++i) {
+			CHECK(request.Path[i] == path[i]);
+		}
+	}
+	CHECK(requests[2].Result == PF_UNREACHABLE);
+	CHECK(requests.back().Result == PF_REACHED);
+
+	AStarKnowUnseenTerrain = false;
+	AStarMaxSearchIterations = oldMaxSearchIterations;
+	Map.Fields.clear();
+
+	extern void FreeAStar(); // free the a* data structures
+	FreeAStar();
+}
+
+TEST_CASE("Passability bitplanes follow the terrain")
+{
+	Map.Info.MapWidth = 100;
+	Map.Info.MapHeight = 70;
+	Map.Create();
+	for (int i = 0; i != 1000; ++i) {
+		Map.Field((i * 37) % 100, (i * 11) % 70)->Flags |= MapFieldUnpassable;
+	}
+
+	const auto footprintPassable = [](const Vec2i &pos, const Vec2i &size) {
+		if (pos.x + size.x > Map.Info.MapWidth || pos.y + size.y > Map.Info.MapHeight) {
+			return false;
+		}
+		for (int y = 0; y != size.y; ++y) {
+			for (int x = 0; x != size.x; ++x) {
+				if (Map.Field(pos.x + x, pos.y + y)->Flags & MapFieldUnpassable) {
+					return false;
+				}
+			}
+		}
+		return true;
+	};
+	const auto checkPlane = [&](const Vec2i &size) {
+		const CPassabilityPlane &plane = GetPassabilityPlane(MapFieldUnpassable | MapFieldLandUnit, size);
+		for (Vec2i pos(0, 0); pos.y != Map.Info.MapHeight; ++pos.y) {
+			for (pos.x = 0; pos.x != Map.Info.MapWidth; ++pos.x) {
+				if (plane.IsPassable(pos) != footprintPassable(pos, size)) {
+					return false;
+				}
+			}
+		}
+		return true;
+	};
+	const Vec2i sizes[] = {{1, 1}, {2, 2}, {3, 2}, {4, 4}};
+
+	for (const Vec2i &size : sizes) {
+		CHECK(checkPlane(size));
+	}
+	// Open a hole and block a line across a word boundary.
+	for (int y = 30; y != 40; ++y) {
+		for (int x = 60; x != 70; ++x) {
+			Map.Field(x, y)->Flags &= ~MapFieldUnpassable;
+		}
+	}
+	PassabilityTerrainChanged(Vec2i(60, 30), Vec2i(10, 10));
+	for (int x = 50; x != 80; ++x) {
+		Map.Field(x, 50)->Flags |= MapFieldUnpassable;
+	}
+	PassabilityTerrainChanged(Vec2i(50, 50), Vec2i(30, 1));
+	for (const Vec2i &size : sizes) {
+		CHECK(checkPlane(size));
+	}
+
+	FreePassability();
+	Map.Fields.clear();
+}
+
+TEST_CASE("PathFinding follows the terrain changes")
+{
+	CPlayer player;
+	player.Index = 0;
+	CUnitType type;
+	type.TileWidth = 1;
+	type.TileHeight = 1;
+	type.MovementMask = MapFieldUnpassable;
+	type.BoolFlag.resize(UnitTypeVar.GetNumberBoolFlag()); // SOLID_INDEX
+	CUnit unit;
+	unit.Player = &player;
+	unit.Type = &type;
+	unit.tilePos = {10, 32};
+
+	Map.Info.MapWidth = 64;
+	Map.Info.MapHeight = 64;
+	Map.Create();
+	// Wall across the whole map.
+	for (int y = 0; y != Map.Info.MapHeight; ++y) {
+		Map.Field(32, y)->Flags |= MapFieldUnpassable;
+	}
+
+	extern void InitAStar(int mapWidth, int mapHeight);
+	InitAStar(Map.Info.MapWidth, Map.Info.MapHeight);
+
+	extern int AStarFindPath(const Vec2i &startPos, const Vec2i &goalPos, int gw, int gh,
+							 int tilesizex, int tilesizey, int minrange,
+							 int maxrange, char *path, int pathlen, const CUnit &unit);
+	const int oldMaxSearchIterations = AStarMaxSearchIterations;
+	AStarMaxSearchIterations = 64 * 64;
+	AStarKnowUnseenTerrain = true;
+
+	const auto search = [&]() {
+		char path[PathFinderOutput::MAX_PATH_LENGTH];
+		return AStarFindPath(unit.tilePos, Vec2i(50, 32), 1, 1, 1, 1, 0, 0, path, std::size(path), unit);
+	};
+
+	CHECK(search() == PF_UNREACHABLE);
+	// Open a gap, the bitplane built by the first search must see it.
+	Map.Field(32, 32)->Flags &= ~MapFieldUnpassable;
+	PathfinderTerrainChanged(Vec2i(32, 32));
+	CHECK(search() == 40);
+	// And close it again.
+	Map.Field(32, 32)->Flags |= MapFieldUnpassable;
+	PathfinderTerrainChanged(Vec2i(32, 32));
+	CHECK(search() == PF_UNREACHABLE);
+
+	AStarKnowUnseenTerrain = false;
+	AStarMaxSearchIterations = oldMaxSearchIterations;
+	FreePathfinder();
+	Map.Fields.clear();
+}
+
+TEST_CASE("PlaceReachable rejects the goals cut off by the terrain")
+{
+	CPlayer player;
+	player.Index = 0;
+	CUnitType type;
+	type.TileWidth = 1;
+	type.TileHeight = 1;
+	type.MovementMask = MapFieldUnpassable;
+	type.BoolFlag.resize(UnitTypeVar.GetNumberBoolFlag()); // SOLID_INDEX
+	CUnit unit;
+	unit.Player = &player;
+	unit.Type = &type;
+	unit.tilePos = {5, 5};
+
+	Map.Info.MapWidth = 64;
+	Map.Info.MapHeight = 64;
+	Map.Create();
+	// A closed box.
+	for (int i = 0; i != 11; ++i) {
+		Map.Field(30 + i, 30)->Flags |= MapFieldUnpassable;
+		Map.Field(30 + i, 40)->Flags |= MapFieldUnpassable;
+		Map.Field(30, 30 + i)->Flags |= MapFieldUnpassable;
+		Map.Field(40, 30 + i)->Flags |= MapFieldUnpassable;
+	}
+	InitPathfinder();
+
+	extern int AStarFindPath(const Vec2i &startPos, const Vec2i &goalPos, int gw, int gh,
+							 int tilesizex, int tilesizey, int minrange,
+							 int maxrange, char *path, int pathlen, const CUnit &unit);
+	const int oldMaxSearchIterations = AStarMaxSearchIterations;
+	AStarMaxSearchIterations = 4 * 64 * 64;
+	AStarKnowUnseenTerrain = true;
+
+	const Vec2i inside(35, 35);
+	// Same answers as a* for the goals it can tell.
+	const auto aStarReachable = [&](const Vec2i &goal, int range) {
+		const int length = AStarFindPath(unit.tilePos, goal, 1, 1, 1, 1, 0, range, nullptr, 0, unit);
+		return length == PF_UNREACHABLE ? 0 : length == PF_REACHED ? 1 : length;
+	};
+	for (const Vec2i &goal : {Vec2i(60, 60), Vec2i(30, 35), Vec2i(5, 5), inside}) {
+		for (int range : {0, 1, 6}) {
+			CHECK(PlaceReachable(unit, goal, 1, 1, 0, range, false) == aStarReachable(goal, range));
+		}
+	}
+	CHECK(PlaceReachable(unit, inside, 1, 1, 0, 0, false) == 0);
+	CHECK(PlaceReachable(unit, inside, 1, 1, 0, 6, false) > 0);
+
+	SUBCASE("Without a* iterations") {
+		AStarMaxSearchIterations = 64;
+		// a* alone stops early and takes its best effort for a path.
+		CHECK(aStarReachable(inside, 0) > 0);
+		CHECK(PlaceReachable(unit, inside, 1, 1, 0, 0, false) == 0);
+	}
+	SUBCASE("Opening and closing the box") {
+		Map.Field(35, 40)->Flags &= ~MapFieldUnpassable;
+		PathfinderTerrainChanged(Vec2i(35, 40));
+		CHECK(PlaceReachable(unit, inside, 1, 1, 0, 0, false) == aStarReachable(inside, 0));
+		CHECK(PlaceReachable(unit, inside, 1, 1, 0, 0, false) > 0);
+
+		Map.Field(35, 40)->Flags |= MapFieldUnpassable;
+		PathfinderTerrainChanged(Vec2i(35, 40));
+		CHECK(PlaceReachable(unit, inside, 1, 1, 0, 0, false) == 0);
+	}
+	SUBCASE("Splitting and joining the map") {
+		// A wall across the map, with a gap.
+		for (int y = 0; y != 64; ++y) {
+			if (y != 10) {
+				Map.Field(50, y)->Flags |= MapFieldUnpassable;
+				PathfinderTerrainChanged(Vec2i(50, y));
+			}
+		}
+		const Vec2i farSide(60, 5);
+		const auto checkFarSide = [&](bool reachable) {
+			CHECK((PlaceReachable(unit, farSide, 1, 1, 0, 0, false) > 0) == reachable);
+			CHECK(PlaceReachable(unit, farSide, 1, 1, 0, 0, false) == aStarReachable(farSide, 0));
+		};
+		checkFarSide(true);
+		// Blocking a tile which doesn't split anything.
+		Map.Field(20, 20)->Flags |= MapFieldUnpassable;
+		PathfinderTerrainChanged(Vec2i(20, 20));
+		checkFarSide(true);
+		// Closing the gap, then opening another one.
+		Map.Field(50, 10)->Flags |= MapFieldUnpassable;
+		PathfinderTerrainChanged(Vec2i(50, 10));
+		checkFarSide(false);
+		Map.Field(50, 50)->Flags &= ~MapFieldUnpassable;
+		PathfinderTerrainChanged(Vec2i(50, 50));
+		checkFarSide(true);
+		// Several changes between two lookups.
+		Map.Field(50, 50)->Flags |= MapFieldUnpassable;
+		PathfinderTerrainChanged(Vec2i(50, 50));
+		Map.Field(50, 10)->Flags &= ~MapFieldUnpassable;
+		PathfinderTerrainChanged(Vec2i(50, 10));
+		Map.Field(50, 10)->Flags |= MapFieldUnpassable;
+		PathfinderTerrainChanged(Vec2i(50, 10));
+		checkFarSide(false);
+		CHECK(PlaceReachable(unit, inside, 1, 1, 0, 6, false) > 0);
+	}
+
+	AStarKnowUnseenTerrain = false;
+	AStarMaxSearchIterations = oldMaxSearchIterations;
+	FreePathfinder();
+	Map.Fields.clear();
+}
+
+TEST_CASE("PathFinding hierarchical waypoints lead to far goals")
+{
+	CPlayer player;
+	player.Index = 0;
+	CUnitType type;
+	type.TileWidth = 1;
+	type.TileHeight = 1;
+	type.MovementMask = MapFieldUnpassable;
+	type.BoolFlag.resize(UnitTypeVar.GetNumberBoolFlag()); // SOLID_INDEX
+	CUnit unit;
+	unit.Player = &player;
+	unit.Type = &type;
+
+	Map.Info.MapWidth = 128;
+	Map.Info.MapHeight = 128;
+	Map.Create();
+	// Two walls, with their gaps at opposite ends.
+	for (int y = 0; y != Map.Info.MapHeight; ++y) {
+		if (y < 120) {
+			Map.Field(40, y)->Flags |= MapFieldUnpassable;
+		}
+		if (y > 8) {
+			Map.Field(80, y)->Flags |= MapFieldUnpassable;
+		}
+	}
+	InitPathfinder();
+
+	extern int AStarFindPath(const Vec2i &startPos, const Vec2i &goalPos, int gw, int gh,
+							 int tilesizex, int tilesizey, int minrange,
+							 int maxrange, char *path, int pathlen, const CUnit &unit);
+	const int oldMaxSearchIterations = AStarMaxSearchIterations;
+	AStarMaxSearchIterations = 128 * 128;
+	AStarKnowUnseenTerrain = true;
+
+	const Vec2i start(10, 64);
+	const Vec2i goal(120, 64);
+	// Follow the paths given to the unit until it reaches the goal.
+	const auto walk = [&](int &searches) {
+		unit.tilePos = start;
+		int steps = 0;
+		for (searches = 0; searches != 20 && unit.tilePos != goal; ++searches) {
+			char path[512];
+			const int length = AStarFindPath(unit.tilePos, goal, 1, 1, 1, 1, 0, 0, path, std::size(path), unit);
+			REQUIRE(length > 0);
+			REQUIRE(length <= static_cast<int>(std::size(path)));
+			for (int i = length - 1; i >= 0; --i) {
+				unit.tilePos.x += Heading2X[(int)path[i]];
+				unit.tilePos.y += Heading2Y[(int)path[i]];
+				CHECK((Map.Field(unit.tilePos)->Flags & MapFieldUnpassable) == 0);
+			}
+			steps += length;
+		}
+		CHECK(unit.tilePos == goal);
+		return steps;
+	};
+
+	int searches = 0;
+	const int directSteps = walk(searches);
+	CHECK(searches == 1);
+
+	AStarHierarchical = true;
+	SUBCASE("Same goal in several shorter searches") {
+		const int hierarchicalSteps = walk(searches);
+
+		CHECK(searches > 1);
+		CHECK(hierarchicalSteps >= directSteps);
+		CHECK(hierarchicalSteps <= directSteps + directSteps / 10);
+	}
+	SUBCASE("Far goals need no more iterations than the sectors") {
+		AStarMaxSearchIterations = 2 * AStarHierarchicalSectorSize * 4 * AStarHierarchicalSectorSize;
+		AStarHierarchical = false;
+		char path[512];
+		// Plain a* gives up on the way.
+		CHECK(AStarFindPath(start, goal, 1, 1, 1, 1, 0, 0, path, std::size(path), unit) < directSteps);
+		AStarHierarchical = true;
+		walk(searches);
+
+		CHECK(searches > 1);
+	}
+	SUBCASE("Waypoints follow the terrain changes") {
+		walk(searches);
+		// Move the gap of the second wall to the bottom.
+		for (int y = 0; y != Map.Info.MapHeight; ++y) {
+			if (y <= 8) {
+				Map.Field(80, y)->Flags |= MapFieldUnpassable;
+			} else if (y > 120) {
+				Map.Field(80, y)->Flags &= ~MapFieldUnpassable;
+			}
+		}
+		PathfinderTerrainChanged(Vec2i(80, 0), Vec2i(1, Map.Info.MapHeight));
+		AStarHierarchical = false;
+		const int newDirectSteps = walk(searches);
+		AStarHierarchical = true;
+		const int hierarchicalSteps = walk(searches);
+
+		CHECK(newDirectSteps < directSteps);
+		CHECK(hierarchicalSteps >= newDirectSteps);
+		CHECK(hierarchicalSteps <= newDirectSteps + newDirectSteps / 10);
+	}
+
+	AStarHierarchical = false;
+	AStarKnowUnseenTerrain = false;
+	AStarMaxSearchIterations = oldMaxSearchIterations;
+	FreePathfinder();
+	Map.Fields.clear();
+}
+
+TEST_CASE("Flow fields are shared by the units going to the same goal")
+{
+	CPlayer player;
+	player.Index = 0;
+	CUnitType type;
+	type.TileWidth = 1;
+	type.TileHeight = 1;
+	type.MovementMask = MapFieldUnpassable;
+	type.BoolFlag.resize(UnitTypeVar.GetNumberBoolFlag()); // SOLID_INDEX
+
+	Map.Info.MapWidth = 64;
+	Map.Info.MapHeight = 64;
+	Map.Create();
+	extern void InitAStar(int mapWidth, int mapHeight);
+	InitAStar(Map.Info.MapWidth, Map.Info.MapHeight);
+	AStarFlowField = true;
+	AStarKnowUnseenTerrain = true;
+
+	CUnitManager manager;
+	CUnitManager *const oldManager = UnitManager;
+	UnitManager = &manager;
+	manager.Init();
+	std::vector<CUnit *> units;
+	for (int i = 0; i != 9; ++i) {
+		CUnit &unit = *manager.AllocUnit();
+		unit.Player = &player;
+		unit.Type = &type;
+		unit.Removed = 0;
+		unit.tilePos = {10, 10 + 2 * i};
+		unit.Orders.push_back(COrder::NewActionStill());
+		units.push_back(&unit);
+	}
+
+	std::vector<std::shared_ptr<CFlowField>> fields(units.size());
+	const auto search = [&](size_t i) {
+		PathFinderInput input;
+		input.SetUnit(*units[i]);
+		input.SetGoal(Vec2i(50, 32), Vec2i(1, 1));
+		char path[PathFinderOutput::MAX_PATH_LENGTH];
+		return FlowFieldFindPath(input, path, std::size(path), fields[i]);
+	};
+
+	// A unit asking again and again doesn't make a field.
+	for (int i = 0; i != 10; ++i) {
+		CHECK(search(0) == PF_FAILED);
+	}
+	for (size_t i = 1; i != 7; ++i) {
+		CHECK(search(i) == PF_FAILED);
+		CHECK(fields[i] == nullptr);
+	}
+	// The 8th unit gets it, and the next ones share it.
+	CHECK(search(7) > 0);
+	REQUIRE(fields[7] != nullptr);
+	CHECK(search(8) > 0);
+	CHECK(fields[8] == fields[7]);
+	CHECK(search(0) > 0);
+	CHECK(fields[0] == fields[7]);
+
+	SUBCASE("Blocking an unused tile keeps the field") {
+		// Farther from the goal than any unit.
+		Map.Field(0, 63)->Flags |= MapFieldUnpassable;
+		PathfinderTerrainChanged(Vec2i(0, 63));
+		FlowFieldTerrainChanged(Vec2i(0, 63), Vec2i(1, 1));
+
+		const std::shared_ptr<CFlowField> field = fields[0];
+		CHECK(search(0) > 0);
+		CHECK(fields[0] == field);
+	}
+	SUBCASE("Blocking a used tile drops the field") {
+		// On the way of unit 0, which already searched from there.
+		Map.Field(11, 11)->Flags |= MapFieldUnpassable;
+		PathfinderTerrainChanged(Vec2i(11, 11));
+		FlowFieldTerrainChanged(Vec2i(11, 11), Vec2i(1, 1));
+
+		const std::shared_ptr<CFlowField> field = fields[0];
+		// A new field needs the demand again.
+		CHECK(search(0) == PF_FAILED);
+		CHECK(fields[0] == nullptr);
+		CHECK(search(8) == PF_FAILED);
+		for (size_t i = 1; i != 6; ++i) {
+			CHECK(search(i) == PF_FAILED);
+		}
+		CHECK(search(6) > 0);
+		REQUIRE(fields[6] != nullptr);
+		CHECK(fields[6] != field);
+	}
+
+	fields.clear();
+	for (CUnit *unit : units) {
+		unit->Orders.clear();
+		manager.ReleaseUnit(*unit);
+	}
+	UnitManager = oldManager;
+	AStarFlowField = false;
+	AStarKnowUnseenTerrain = false;
+	FreeFlowFields();
+	FreePathfinder();
+	Map.Fields.clear();
+}
+
+namespace
+{
+class VisitCounter
+{
+public:
+	VisitResult Visit(TerrainTraversal &, const Vec2i &, const Vec2i &)
+	{
+		++count;
+		return VisitResult::Ok;
+	}
+
+	int count = 0;
+};
+} // namespace
+
+TEST_CASE("TerrainTraversal with distance limit")
+{
+	TerrainTraversal terrainTraversal;
+	VisitCounter counter;
+
+	terrainTraversal.SetSize(50, 40);
+	terrainTraversal.Init();
+	terrainTraversal.SetMaxDistance(6);
+	terrainTraversal.PushPos(Vec2i(20, 20));
+	CHECK(terrainTraversal.Run(counter) == false);
+	CHECK(counter.count == 11 * 11);
+	CHECK(terrainTraversal.Get(Vec2i(20, 20)) == 1);
+	CHECK(terrainTraversal.Get(Vec2i(25, 17)) == 6);
+	CHECK(terrainTraversal.IsVisited(Vec2i(26, 20)) == false);
+	CHECK(terrainTraversal.Get(Vec2i(-1, 5)) == -1);
+
+	SUBCASE("Init forgets the previous traversal")
+	{
+		terrainTraversal.Init();
+		CHECK(terrainTraversal.IsVisited(Vec2i(20, 20)) == false);
+		CHECK(terrainTraversal.Get(Vec2i(50, 5)) == -1);
+	}
+	SUBCASE("Nested traversals don't share their marks")
+	{
+		TerrainTraversal other;
+		VisitCounter otherCounter;
+
+		other.SetSize(50, 40);
+		other.Init();
+		other.PushPos(Vec2i(0, 0));
+		CHECK(other.Run(otherCounter) == false);
+		CHECK(otherCounter.count == 50 * 40);
+		CHECK(terrainTraversal.IsVisited(Vec2i(40, 30)) == false);
+		CHECK(other.Get(Vec2i(49, 39)) == 50);
+	}
+	SUBCASE("The next traversal reuses the storage without its marks")
+	{
+		{
+			TerrainTraversal previous;
+			VisitCounter previousCounter;
+
+			previous.SetSize(30, 20);
+			previous.Init();
+			previous.PushPos(Vec2i(5, 5));
+			CHECK(previous.Run(previousCounter) == false);
+			CHECK(previous.IsVisited(Vec2i(29, 19)));
+		}
+		TerrainTraversal next;
+
+		next.SetSize(30, 20);
+		next.Init();
+		CHECK(next.IsVisited(Vec2i(5, 5)) == false);
+		CHECK(next.Get(Vec2i(29, 19)) == 0);
+		CHECK(next.Get(Vec2i(30, 19)) == -1);
+	}
+	SUBCASE("Frontier grows past its initial size")
+	{
+		terrainTraversal.SetSize(200, 200);
+		terrainTraversal.Init();
+		terrainTraversal.SetMaxDistance(1000);
+		for (Vec2i pos(0, 0); pos.y != 200; ++pos.y) {
+			for (pos.x = 0; pos.x != 200; ++pos.x) {
+				terrainTraversal.PushPos(pos);
+			}
+		}
+		counter.count = 0;
+		CHECK(terrainTraversal.Run(counter) == false);
+		CHECK(counter.count == 200 * 200);
+	}
+}
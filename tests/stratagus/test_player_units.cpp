@@ -0,0 +1,120 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+/**@name test_player_units.cpp - The test file for the units of player.cpp. */
+//
+//      (c) Copyright 2026 by the Stratagus Developers
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+#include <doctest.h>
+
+#include "stratagus.h"
+
+#include "actions.h"
+#include "player.h"
+#include "unit.h"
+#include "unit_find.h"
+#include "unittype.h"
+
+#include <array>
+#include <iterator>
+
+TEST_CASE("Player keeps its units by unit-type")
+{
+	CPlayer player;
+	player.Index = 0;
+	CUnitType peasant;
+	peasant.Slot = 0;
+	CUnitType footman;
+	footman.Slot = 3;
+
+	CUnit unit1;
+	CUnit unit2;
+	CUnit unit3;
+	for (CUnit *unit : {&unit1, &unit2, &unit3}) {
+		unit->PlayerSlot = static_cast<size_t>(-1);
+	}
+	unit1.Type = &peasant;
+	unit2.Type = &footman;
+	unit3.Type = &peasant;
+	player.AddUnit(unit1);
+	player.AddUnit(unit2);
+	player.AddUnit(unit3);
+
+	CHECK(player.GetUnitsOfType(peasant) == std::vector<CUnit *>{&unit1, &unit3});
+	CHECK(player.GetUnitsOfType(footman) == std::vector<CUnit *>{&unit2});
+
+	player.ChangeUnitType(unit1, footman);
+	CHECK(unit1.Type == &footman);
+	CHECK(player.GetUnitsOfType(peasant) == std::vector<CUnit *>{&unit3});
+	CHECK(player.GetUnitsOfType(footman) == std::vector<CUnit *>{&unit2, &unit1});
+	CHECK(player.GetUnits().size() == 3);
+
+	player.RemoveUnit(unit2);
+	CHECK(player.GetUnitsOfType(footman) == std::vector<CUnit *>{&unit1});
+	player.RemoveUnit(unit1);
+	player.RemoveUnit(unit3);
+	CHECK(player.GetUnitsOfType(peasant).empty());
+	CHECK(player.GetUnitsOfType(footman).empty());
+	CHECK(player.GetUnits().empty());
+}
+
+TEST_CASE("Player units by type come in the order of the player units")
+{
+	CPlayer player;
+	player.Index = 0;
+	CUnitType peasant;
+	peasant.Slot = 0;
+	CUnitType footman;
+	footman.Slot = 3;
+
+	std::array<CUnit, 4> units;
+	for (CUnit &unit : units) {
+		unit.PlayerSlot = static_cast<size_t>(-1);
+		unit.Type = &peasant;
+		unit.Removed = 0;
+		unit.Orders.push_back(COrder::NewActionStill());
+	}
+	units[3].Type = &footman;
+	for (CUnit &unit : units) {
+		player.AddUnit(unit);
+	}
+	// The player units get the footman in the hole, the peasants the last peasant.
+	player.RemoveUnit(units[0]);
+	player.UnitTypesCount[peasant.Slot] = 2;
+	REQUIRE(player.GetUnitsOfType(peasant) == std::vector<CUnit *>{&units[2], &units[1]});
+
+	std::vector<CUnit *> expected;
+	ranges::copy_if(player.GetUnits(), std::back_inserter(expected),
+	                [&](const CUnit *unit) { return unit->Type == &peasant; });
+	CHECK(expected == std::vector<CUnit *>{&units[1], &units[2]});
+	CHECK(FindPlayerUnitsByType(player, peasant) == expected);
+
+	for (CUnit &unit : units) {
+		if (unit.PlayerSlot != static_cast<size_t>(-1)) {
+			player.RemoveUnit(unit);
+		}
+		unit.Orders.clear();
+	}
+}
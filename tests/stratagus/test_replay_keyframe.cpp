@@ -0,0 +1,190 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+/**@name test_replay_keyframe.cpp - The test file for replay_keyframe.cpp. */
+//
+//      (c) Copyright 2026 by the Stratagus Developers
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+
+
+#include <doctest.h>
+
+#include "stratagus.h"
+
+#include "replay.h"
+#include "replay_keyframe.h"
+#include "replay_log.h"
+
+#include <fstream>
+
+namespace
+{
+
+/// Indexes of the commands run by the game loop from the end of a cycle to the end of another one
+std::vector<std::size_t> RunCommands(const std::vector<LogEntry> &commands, EReplayType type,
+                                     std::optional<std::size_t> index, unsigned long cycle, unsigned long endCycle)
+{
+	std::vector<std::size_t> run;
+	const auto runCycle = [&](unsigned long commandCycle) {
+		while (index && *index != commands.size() && commands[*index].GameCycle == commandCycle) {
+			run.push_back((*index)++);
+		}
+	};
+	// Like the start of a game.
+	if (type == EReplayType::MultiPlayer) {
+		runCycle(cycle);
+	}
+	while (cycle != endCycle) {
+		// Same order as GameLogicLoop.
+		if (type == EReplayType::SinglePlayer) {
+			runCycle(cycle);
+		}
+		++cycle;
+		if (type == EReplayType::MultiPlayer) {
+			runCycle(cycle);
+		}
+	}
+	return run;
+}
+
+} // namespace
+
+TEST_CASE("Replay keyframe files give back their log and cycle")
+{
+	using KeyframeName = std::pair<uint32_t, unsigned long>;
+
+	CHECK(CReplayKeyframes::ParseFile("keyframe_0000abcd_0.sav") == KeyframeName{0xabcd, 0});
+	CHECK(CReplayKeyframes::ParseFile("logs/game.keyframes/keyframe_deadbeef_3600.sav")
+	      == KeyframeName{0xdeadbeef, 3600});
+	CHECK(CReplayKeyframes::ParseFile("keyframe_00000001_7200.sav.gz") == KeyframeName{1, 7200});
+
+	CHECK_FALSE(CReplayKeyframes::ParseFile("keyframe_3600.sav"));
+	CHECK_FALSE(CReplayKeyframes::ParseFile("keyframe_deadbeef_.sav"));
+	CHECK_FALSE(CReplayKeyframes::ParseFile("keyframe_deadbeef_12a.sav"));
+	CHECK_FALSE(CReplayKeyframes::ParseFile("keyframe_deadbeeg_12.sav"));
+	CHECK_FALSE(CReplayKeyframes::ParseFile("keyframe_deadbeef_12.log"));
+	CHECK_FALSE(CReplayKeyframes::ParseFile("autosave.sav.gz"));
+}
+
+TEST_CASE("Replay keyframes find the last one before a cycle")
+{
+	CReplayKeyframes keyframes;
+
+	CHECK(keyframes.Find(100) == nullptr);
+	keyframes.Add(3600);
+	keyframes.Add(0);
+	keyframes.Add(1800);
+	keyframes.Add(1800);
+
+	REQUIRE(keyframes.GetKeyframes().size() == 3);
+	CHECK(keyframes.Has(1800));
+	CHECK_FALSE(keyframes.Has(1801));
+
+	REQUIRE(keyframes.Find(0) != nullptr);
+	CHECK(keyframes.Find(0)->GameCycle == 0);
+	CHECK(keyframes.Find(1799)->GameCycle == 0);
+	CHECK(keyframes.Find(1800)->GameCycle == 1800);
+	CHECK(keyframes.Find(100000)->GameCycle == 3600);
+	CHECK(CReplayKeyframes::ParseFile(keyframes.Find(3600)->File)->second == 3600);
+}
+
+TEST_CASE("Replay keyframes are found again next to their log")
+{
+	const fs::path dir = fs::temp_directory_path() / "stratagus_test_replay_keyframe";
+	fs::remove_all(dir);
+	const fs::path log = dir / "log_of_stratagus_0_1.log";
+
+	CReplayKeyframes keyframes;
+	keyframes.Open(log, 0x1234);
+	CHECK(keyframes.GetDirectory() == dir / "log_of_stratagus_0_1.keyframes");
+	CHECK(keyframes.GetKeyframes().empty());
+	CHECK(keyframes.GetFile(1800).filename() == "keyframe_00001234_1800.sav");
+
+	fs::create_directories(keyframes.GetDirectory());
+	for (const char *name : {"keyframe_00001234_3600.sav.gz", "keyframe_00001234_0.sav.gz",
+	                         "keyframe_00001234_1800.sav", "keyframe_00005678_2700.sav.gz", "notes.txt"}) {
+		std::ofstream(keyframes.GetDirectory() / name) << "--";
+	}
+	keyframes.Open(log, 0x1234);
+	REQUIRE(keyframes.GetKeyframes().size() == 3);
+	CHECK(keyframes.GetKeyframes()[0].GameCycle == 0);
+	CHECK(keyframes.GetKeyframes()[1].GameCycle == 1800);
+	CHECK(keyframes.GetKeyframes()[2].GameCycle == 3600);
+
+	// The keyframes of another log at the same place are removed.
+	CHECK_FALSE(fs::exists(keyframes.GetDirectory() / "keyframe_00005678_2700.sav.gz"));
+	CHECK(fs::exists(keyframes.GetDirectory() / "notes.txt"));
+	keyframes.Open(log, 0x5678);
+	CHECK(keyframes.GetKeyframes().empty());
+	CHECK_FALSE(fs::exists(keyframes.GetDirectory() / "keyframe_00001234_0.sav.gz"));
+
+	keyframes.Clear();
+	CHECK(keyframes.GetDirectory().empty());
+	CHECK(keyframes.Find(3600) == nullptr);
+	fs::remove_all(dir);
+}
+
+TEST_CASE("Replay keyframes belong to the header of their log")
+{
+	FullReplay replay;
+	replay.Date = "Sat Oct 17 10:00:00 2026";
+	replay.Map = "Two rivers";
+	const uint32_t digest = ReplayHeaderDigest(replay);
+
+	CHECK(ReplayHeaderDigest(replay) == digest);
+	replay.Commands.emplace_back();
+	CHECK(ReplayHeaderDigest(replay) == digest);
+	// A replayed log finds the keyframes taken while it was recorded.
+	const auto decoded = DecodeBinaryReplay(CBinaryReplayEncoder().EncodeHeader(replay));
+	REQUIRE(decoded != nullptr);
+	CHECK(ReplayHeaderDigest(*decoded) == digest);
+
+	replay.Date = "Sat Oct 17 10:00:01 2026";
+	CHECK(ReplayHeaderDigest(replay) != digest);
+}
+
+TEST_CASE("Replays resume after a keyframe with the commands it hasn't run")
+{
+	std::vector<LogEntry> commands;
+	for (unsigned long cycle : {0, 0, 5, 10, 10, 11, 20}) {
+		commands.emplace_back();
+		commands.back().GameCycle = cycle;
+	}
+	for (EReplayType type : {EReplayType::SinglePlayer, EReplayType::MultiPlayer}) {
+		const std::vector<std::size_t> straight = RunCommands(commands, type, 0, 0, 30);
+		REQUIRE(straight.size() == commands.size());
+
+		for (unsigned long keyframeCycle : {0, 5, 9, 10, 11, 20, 25}) {
+			std::vector<std::size_t> seek = RunCommands(commands, type, 0, 0, keyframeCycle);
+			const std::optional<std::size_t> resumeIndex = ReplayResumeIndex(commands, type, keyframeCycle);
+			const std::vector<std::size_t> resumed = RunCommands(commands, type, resumeIndex, keyframeCycle, 30);
+			seek.insert(seek.end(), resumed.begin(), resumed.end());
+			CHECK(seek == straight);
+		}
+	}
+	CHECK(ReplayResumeIndex(commands, EReplayType::SinglePlayer, 10) == 3u);
+	CHECK(ReplayResumeIndex(commands, EReplayType::MultiPlayer, 10) == 5u);
+	CHECK_FALSE(ReplayResumeIndex(commands, EReplayType::MultiPlayer, 20));
+}
@@ -0,0 +1,187 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+/**@name test_replay_log.cpp - The test file for replay_log.cpp. */
+//
+//      (c) Copyright 2026 by the Stratagus Developers
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+
+
+#include <doctest.h>
+
+#include "stratagus.h"
+
+#include "replay_log.h"
+
+namespace
+{
+
+FullReplay MakeReplay()
+{
+	FullReplay replay;
+	replay.Comment1 = "Generated by a test";
+	replay.Date = "today";
+	replay.Map = "Two rivers";
+	replay.MapPath = "maps/two-rivers.smp";
+	replay.MapId = 0xDEADBEEF;
+	replay.LocalPlayer = 1;
+	replay.PlayerNames[0] = "Ana";
+	replay.PlayerNames[1] = "Bo";
+	replay.Engine[0] = 3;
+	replay.Network[2] = 7;
+	replay.ReplaySettings.Resources = -1;
+	replay.ReplaySettings.Inside = 1;
+	replay.ReplaySettings.Presets[1].AIScript = "ai-passive";
+	replay.ReplaySettings.Presets[1].Team = 2;
+	replay.ReplaySettings.Presets[1].Type = PlayerTypes::PlayerComputer;
+	return replay;
+}
+
+LogEntry MakeCommand(unsigned long cycle, const std::string &action, int unit)
+{
+	LogEntry log;
+	log.GameCycle = cycle;
+	log.UnitNumber = unit;
+	log.UnitIdent = unit == -1 ? "" : "unit-footman";
+	log.Action = action;
+	log.Flush = EFlushMode::On;
+	log.Pos.x = cycle % 64 == 0 ? -1 : 12;
+	log.Pos.y = 300;
+	log.DestUnitNumber = -1;
+	log.Num = -1;
+	log.SyncRandSeed = 0x80000000u + cycle;
+	return log;
+}
+
+void CheckSameCommand(const LogEntry &lhs, const LogEntry &rhs)
+{
+	CHECK(lhs.GameCycle == rhs.GameCycle);
+	CHECK(lhs.UnitNumber == rhs.UnitNumber);
+	CHECK(lhs.UnitIdent == rhs.UnitIdent);
+	CHECK(lhs.Action == rhs.Action);
+	CHECK(lhs.Flush == rhs.Flush);
+	CHECK(lhs.Pos == rhs.Pos);
+	CHECK(lhs.DestUnitNumber == rhs.DestUnitNumber);
+	CHECK(lhs.Value == rhs.Value);
+	CHECK(lhs.Num == rhs.Num);
+	CHECK(lhs.SyncRandSeed == rhs.SyncRandSeed);
+}
+
+} // namespace
+
+TEST_CASE("Binary replays decode what was encoded")
+{
+	FullReplay replay = MakeReplay();
+	for (unsigned long cycle = 0; cycle != 600; cycle += 3) {
+		replay.Commands.push_back(MakeCommand(cycle, cycle % 2 ? "move" : "attack", cycle % 5 ? 42 : -1));
+	}
+	replay.Commands[10].Value = "~<Ana~> gg";
+
+	CBinaryReplayEncoder encoder;
+	std::string data = encoder.EncodeHeader(replay);
+	const LogEntry *commands = replay.Commands.data();
+	data += encoder.EncodeCommands(commands, commands + 150);
+	data += encoder.EncodeCommands(commands + 150, commands + replay.Commands.size());
+	CHECK(IsBinaryReplay(data));
+
+	const auto decoded = DecodeBinaryReplay(data);
+	REQUIRE(decoded != nullptr);
+	CHECK(decoded->Comment1 == replay.Comment1);
+	CHECK(decoded->Date == replay.Date);
+	CHECK(decoded->MapPath == replay.MapPath);
+	CHECK(decoded->MapId == replay.MapId);
+	CHECK(decoded->LocalPlayer == 1);
+	CHECK(decoded->PlayerNames[1] == "Bo");
+	CHECK(decoded->Engine[0] == 3);
+	CHECK(decoded->Network[2] == 7);
+	CHECK(decoded->ReplaySettings == replay.ReplaySettings);
+	REQUIRE(decoded->Commands.size() == replay.Commands.size());
+	for (std::size_t i = 0; i != replay.Commands.size(); ++i) {
+		CheckSameCommand(decoded->Commands[i], replay.Commands[i]);
+	}
+}
+
+TEST_CASE("Binary replays interning makes them compact")
+{
+	FullReplay replay = MakeReplay();
+	for (unsigned long cycle = 0; cycle != 2000; ++cycle) {
+		replay.Commands.push_back(MakeCommand(cycle, "resource-loc", 100));
+	}
+	CBinaryReplayEncoder encoder;
+	const std::string data = encoder.EncodeHeader(replay)
+	                       + encoder.EncodeCommands(replay.Commands.data(),
+	                                                replay.Commands.data() + replay.Commands.size());
+	// The text format takes about 150 bytes per command.
+	CHECK(data.size() < 10 * replay.Commands.size());
+}
+
+TEST_CASE("Truncated binary replays keep their complete blocks")
+{
+	FullReplay replay = MakeReplay();
+	for (unsigned long cycle = 0; cycle != 20; ++cycle) {
+		replay.Commands.push_back(MakeCommand(cycle, "stop", 1));
+	}
+	CBinaryReplayEncoder encoder;
+	const LogEntry *commands = replay.Commands.data();
+	const std::string header = encoder.EncodeHeader(replay);
+	const std::string first = encoder.EncodeCommands(commands, commands + 10);
+	const std::string second = encoder.EncodeCommands(commands + 10, commands + 20);
+
+	const auto decoded = DecodeBinaryReplay(header + first + second.substr(0, second.size() / 2));
+	REQUIRE(decoded != nullptr);
+	CHECK(decoded->Commands.size() == 10);
+
+	CHECK(DecodeBinaryReplay(header.substr(0, header.size() - 1)) == nullptr);
+	CHECK(DecodeBinaryReplay("ReplayLog( {") == nullptr);
+	CHECK_FALSE(IsBinaryReplay("ReplayLog( {"));
+}
+
+TEST_CASE("Binary replay writer streams the commands to the file")
+{
+	const fs::path file = fs::temp_directory_path() / "stratagus_test_replay_log.log";
+	FullReplay replay = MakeReplay();
+	replay.Commands.push_back(MakeCommand(0, "stop", 3));
+
+	CBinaryReplayWriter writer;
+	REQUIRE(writer.Open(file, replay));
+	CHECK(IsBinaryReplayFile(file));
+	for (unsigned long cycle = 1; cycle != 1000; ++cycle) {
+		replay.Commands.push_back(MakeCommand(cycle, "move", 3));
+		writer.Append(replay.Commands.back());
+	}
+	writer.Flush();
+	auto decoded = LoadBinaryReplay(file);
+	REQUIRE(decoded != nullptr);
+	CHECK(decoded->Commands.size() == 1000);
+
+	replay.Commands.push_back(MakeCommand(5000, "quit", -1));
+	writer.Append(replay.Commands.back());
+	writer.Close();
+	decoded = LoadBinaryReplay(file);
+	REQUIRE(decoded != nullptr);
+	REQUIRE(decoded->Commands.size() == replay.Commands.size());
+	CheckSameCommand(decoded->Commands.back(), replay.Commands.back());
+	fs::remove(file);
+}
@@ -0,0 +1,185 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+/**@name test_sync_digest.cpp - The test file for sync_digest.cpp. */
+//
+//      (c) Copyright 2026 by the Stratagus Developers
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+
+#include <doctest.h>
+
+#include "stratagus.h"
+
+#include "sync_digest.h"
+
+#include "actions.h"
+#include "map.h"
+#include "player.h"
+#include "unit.h"
+#include "unit_manager.h"
+#include "unittype.h"
+
+#include <tuple>
+
+namespace
+{
+
+CSyncSnapshot MakeSnapshot(const std::vector<uint16_t> &slots)
+{
+	CSyncSnapshot snapshot;
+	for (uint16_t slot : slots) {
+		snapshot.Units.push_back({slot, {slot + 1u, 2u * slot, 3u * slot, 4u * slot}});
+	}
+	return snapshot;
+}
+
+/// Run the bisection both hosts do over the network, return the slot and field found
+std::optional<std::pair<uint32_t, std::size_t>> Bisect(const CSyncSnapshot &lhs, const CSyncSnapshot &rhs)
+{
+	uint32_t lo = 0;
+	uint32_t hi = SyncUnitSlotCount;
+
+	while (true) {
+		const auto diff = FirstSyncDifference(lhs.RangeDigests(lo, hi), rhs.RangeDigests(lo, hi));
+		if (!diff) {
+			return std::nullopt;
+		}
+		if (hi - lo == 1) {
+			return std::pair{lo, *diff};
+		}
+		std::tie(lo, hi) = SyncRangeQuarter(lo, hi, *diff);
+	}
+}
+
+} // namespace
+
+TEST_CASE("Sync range quarters cover the range")
+{
+	for (auto [lo, hi] : {std::pair<uint32_t, uint32_t>{0, SyncUnitSlotCount}, {10, 13}, {7, 8}}) {
+		uint32_t next = lo;
+		for (std::size_t i = 0; i != 4; ++i) {
+			const auto [begin, end] = SyncRangeQuarter(lo, hi, i);
+			CHECK(begin == next);
+			CHECK(begin <= end);
+			next = end;
+		}
+		CHECK(next == hi);
+	}
+}
+
+TEST_CASE("Sync bisection finds the first differing unit and field")
+{
+	const std::vector<uint16_t> slots{0, 1, 5, 42, 1000, 1234, 40000, 65535};
+	const CSyncSnapshot local = MakeSnapshot(slots);
+	CSyncSnapshot remote = MakeSnapshot(slots);
+
+	CHECK_FALSE(Bisect(local, remote).has_value());
+
+	remote.Units[5].Fields[static_cast<std::size_t>(EUnitSyncField::HitPoints)] ^= 1;
+	remote.Units[7].Fields[static_cast<std::size_t>(EUnitSyncField::Orders)] ^= 1;
+	const auto found = Bisect(local, remote);
+	REQUIRE(found.has_value());
+	CHECK(found->first == 1234);
+	CHECK(found->second == static_cast<std::size_t>(EUnitSyncField::HitPoints));
+}
+
+TEST_CASE("Sync bisection finds a unit missing on one side")
+{
+	const CSyncSnapshot local = MakeSnapshot({3, 17, 300});
+	const CSyncSnapshot remote = MakeSnapshot({3, 300});
+
+	const auto found = Bisect(local, remote);
+	REQUIRE(found.has_value());
+	CHECK(found->first == 17);
+	CHECK(remote.RangeDigests(17, 18) == UnitSyncDigests{});
+}
+
+TEST_CASE("Sync snapshots list the units by slot and see the map changes")
+{
+	CPlayer player;
+	player.Index = 0;
+	CUnitType type;
+	type.BoolFlag.resize(UnitTypeVar.GetNumberBoolFlag());
+
+	CUnitManager manager;
+	CUnitManager *const oldManager = UnitManager;
+	UnitManager = &manager;
+	manager.Init();
+	for (int i = 0; i != 3; ++i) {
+		CUnit &unit = *manager.AllocUnit();
+		unit.Type = &type;
+		unit.Player = &player;
+		unit.Variable.resize(UnitTypeVar.GetNumberVariable());
+		unit.Orders.push_back(COrder::NewActionStill());
+		manager.Add(&unit);
+	}
+	// The last unit takes the place of the released one in the unit list.
+	manager.GetSlotUnit(0).Orders.clear();
+	manager.ReleaseUnit(manager.GetSlotUnit(0));
+
+	Map.Info.MapWidth = 64;
+	Map.Info.MapHeight = 64;
+	Map.Create();
+	ResetSyncDigests();
+
+	CSyncSnapshot snapshot;
+	snapshot.Take();
+	REQUIRE(snapshot.Units.size() == 2);
+	CHECK(snapshot.Units[0].Slot == 1);
+	CHECK(snapshot.Units[1].Slot == 2);
+
+	const auto mapDigest = [&]() { return snapshot.Digests[static_cast<std::size_t>(ESyncPart::Map)]; };
+	const uint32_t before = mapDigest();
+	Map.Field(10, 60)->Value = 1;
+	int takes = 0;
+	while (takes != 16) {
+		snapshot.Take();
+		++takes;
+		if (mapDigest() != before) {
+			break;
+		}
+	}
+	CHECK(mapDigest() != before);
+	// The change is in the last band.
+	CHECK(takes == 16);
+	const uint32_t after = mapDigest();
+
+	// A new game digests the whole map at once.
+	ResetSyncDigests();
+	snapshot.Take();
+	CHECK(mapDigest() == after);
+	Map.Field(10, 60)->Value = 0;
+	ResetSyncDigests();
+	snapshot.Take();
+	CHECK(mapDigest() == before);
+
+	ResetSyncDigests();
+	Map.Fields.clear();
+	for (CUnit *unit : std::vector<CUnit *>(manager.GetUnits())) {
+		unit->Orders.clear();
+		manager.ReleaseUnit(*unit);
+	}
+	UnitManager = oldManager;
+}
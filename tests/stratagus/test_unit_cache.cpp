@@ -0,0 +1,85 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+/**@name test_unit_cache.cpp - The test file for the CUnitCache of mapfield.cpp. */
+//
+//      (c) Copyright 2026 by the Stratagus Developers
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+#include <doctest.h>
+
+#include "stratagus.h"
+
+#include "tile.h"
+
+#include <vector>
+
+namespace
+{
+
+std::vector<CUnit *> ToVector(const CUnitCache &cache)
+{
+	return {cache.begin(), cache.end()};
+}
+
+} // namespace
+
+TEST_CASE("Unit cache keeps the insertion order inline and spilled")
+{
+	std::vector<char> keys(6);
+	std::vector<CUnit *> units;
+	for (char &key : keys) {
+		units.push_back(reinterpret_cast<CUnit *>(&key));
+	}
+	CUnitCache cache;
+	CHECK(cache.empty());
+
+	cache.push_back(units[0]);
+	cache.push_back(units[1]);
+	CHECK(ToVector(cache) == std::vector<CUnit *>{units[0], units[1]});
+
+	for (size_t i = 2; i != units.size(); ++i) {
+		cache.push_back(units[i]);
+	}
+	CHECK(ToVector(cache) == units);
+
+	CUnitCache copy(cache);
+	cache.Remove(units[2]);
+	cache.Remove(units[4]);
+	CHECK(ToVector(cache) == std::vector<CUnit *>{units[0], units[1], units[3], units[5]});
+	CHECK(ToVector(copy) == units);
+
+	cache.Remove(units[0]);
+	cache.Remove(units[5]);
+	CHECK(ToVector(cache) == std::vector<CUnit *>{units[1], units[3]});
+	cache.Remove(units[5]); // not there
+	CHECK(cache.size() == 2);
+	CHECK(cache[1] == units[3]);
+
+	CUnitCache moved(std::move(copy));
+	CHECK(copy.empty());
+	CHECK(ToVector(moved) == units);
+	moved.clear();
+	CHECK(moved.empty());
+}
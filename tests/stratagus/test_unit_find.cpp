@@ -0,0 +1,147 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+/**@name test_unit_find.cpp - The test file for unit_find.cpp. */
+//
+//      (c) Copyright 2026 by the Stratagus Developers
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+#include <doctest.h>
+
+#include "stratagus.h"
+
+#include "map.h"
+#include "player.h"
+#include "unit.h"
+#include "unit_find.h"
+#include "unittype.h"
+
+#include <array>
+
+namespace
+{
+
+void PlaceUnit(CUnit &unit, const CUnitType &type, CPlayer &player, const Vec2i &pos)
+{
+	unit.Type = &type;
+	unit.Player = &player;
+	unit.tilePos = pos;
+	unit.Offset = Map.getIndex(pos);
+	unit.Removed = 0;
+	Map.Insert(unit);
+}
+
+} // namespace
+
+TEST_CASE("Selections give big units once and can be nested")
+{
+	Map.Info.MapWidth = 32;
+	Map.Info.MapHeight = 32;
+	Map.Create();
+
+	CPlayer player;
+	player.Index = 0;
+	CUnitType peasant;
+	peasant.TileWidth = 1;
+	peasant.TileHeight = 1;
+	CUnitType farm;
+	farm.TileWidth = 2;
+	farm.TileHeight = 2;
+
+	CUnit unit1;
+	CUnit unit2;
+	PlaceUnit(unit1, farm, player, Vec2i(4, 4));
+	PlaceUnit(unit2, peasant, player, Vec2i(5, 5));
+
+	CHECK(SelectFixed(Vec2i(0, 0), Vec2i(31, 31)) == std::vector<CUnit *>{&unit1, &unit2});
+	CHECK(SelectFixed(Vec2i(5, 5), Vec2i(6, 6)) == std::vector<CUnit *>{&unit1, &unit2});
+	CHECK(SelectFixed(Vec2i(5, 4), Vec2i(5, 4)) == std::vector<CUnit *>{&unit1});
+
+	int innerCalls = 0;
+	const auto outer = SelectFixed(Vec2i(3, 3), Vec2i(8, 8), [&](const CUnit *) {
+		++innerCalls;
+		return SelectFixed(Vec2i(3, 3), Vec2i(8, 8)).size() == 2;
+	});
+	CHECK(innerCalls == 2);
+	CHECK(outer.size() == 2);
+
+	Map.Remove(unit1);
+	Map.Remove(unit2);
+	Map.Fields.clear();
+	Map.UnitIndex.Clear();
+	Map.Influence.Clear();
+}
+
+TEST_CASE("Selections by owner give the units in tile order")
+{
+	Map.Info.MapWidth = 32;
+	Map.Info.MapHeight = 32;
+	Map.Create();
+
+	CPlayer player0;
+	player0.Index = 0;
+	CPlayer player1;
+	player1.Index = 1;
+	CUnitType peasant;
+	peasant.TileWidth = 1;
+	peasant.TileHeight = 1;
+	peasant.MoveType = EMovement::Land;
+	CUnitType gryphon;
+	gryphon.TileWidth = 1;
+	gryphon.TileHeight = 1;
+	gryphon.MoveType = EMovement::Fly;
+	CUnitType farm;
+	farm.TileWidth = 2;
+	farm.TileHeight = 2;
+	farm.MoveType = EMovement::Land;
+
+	// The buckets are by cell, owner and movement type: their order is not
+	// the order of the tiles.
+	std::array<CUnit, 6> units;
+	PlaceUnit(units[0], peasant, player1, Vec2i(12, 9));
+	PlaceUnit(units[1], gryphon, player0, Vec2i(12, 9));
+	PlaceUnit(units[2], peasant, player0, Vec2i(3, 10));
+	PlaceUnit(units[3], farm, player1, Vec2i(6, 6));
+	PlaceUnit(units[4], gryphon, player1, Vec2i(9, 6));
+	PlaceUnit(units[5], peasant, player0, Vec2i(20, 4));
+
+	const auto all = [](const CUnit *) { return true; };
+	for (const auto &[ltPos, rbPos] : {std::pair(Vec2i(0, 0), Vec2i(31, 31)),
+	                                   std::pair(Vec2i(7, 7), Vec2i(14, 12)),
+	                                   std::pair(Vec2i(2, 4), Vec2i(20, 10))}) {
+		const auto byOwner = SelectOwnedBy(ltPos, rbPos, ~0u, CUnitIndex::AllMovementTypes, all);
+		CHECK(byOwner.size() >= 3);
+		CHECK(byOwner == SelectFixed(ltPos, rbPos));
+	}
+	const auto gryphons = SelectOwnedBy(Vec2i(0, 0), Vec2i(31, 31), ~0u,
+	                                    CUnitIndex::MovementBit(static_cast<int>(EMovement::Fly)), all);
+	CHECK(gryphons == std::vector<CUnit *>{&units[4], &units[1]});
+
+	for (CUnit &unit : units) {
+		Map.Remove(unit);
+	}
+	Map.Fields.clear();
+	Map.UnitIndex.Clear();
+	Map.Influence.Clear();
+}
@@ -0,0 +1,114 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+/**@name test_unit_index.cpp - The test file for unit_index.cpp. */
+//
+//      (c) Copyright 2026 by the Stratagus Developers
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+#include <doctest.h>
+
+#include "stratagus.h"
+
+#include "player.h"
+#include "unit.h"
+#include "unit_index.h"
+#include "unittype.h"
+
+namespace
+{
+
+std::vector<CUnit *> Query(const CUnitIndex &index, const Vec2i &ltPos, const Vec2i &rbPos,
+                           unsigned int playerMask, unsigned int movementMask)
+{
+	std::vector<CUnit *> units;
+	index.ForEach(ltPos, rbPos, playerMask, movementMask, [&](CUnit *unit) { units.push_back(unit); });
+	return units;
+}
+
+void PlaceUnit(CUnitIndex &index, CUnit &unit, CUnitType &type, CPlayer &player, const Vec2i &pos)
+{
+	unit.Type = &type;
+	unit.Player = &player;
+	unit.tilePos = pos;
+	index.Insert(unit);
+}
+
+} // namespace
+
+TEST_CASE("Unit index finds units by area, owner and movement type")
+{
+	CPlayer player0;
+	player0.Index = 0;
+	CPlayer player1;
+	player1.Index = 1;
+	CUnitType footman;
+	footman.TileWidth = 1;
+	footman.TileHeight = 1;
+	footman.MoveType = EMovement::Land;
+	CUnitType dragon;
+	dragon.TileWidth = 2;
+	dragon.TileHeight = 2;
+	dragon.MoveType = EMovement::Fly;
+	CUnitType farm;
+	farm.TileWidth = 4;
+	farm.TileHeight = 4;
+	farm.MoveType = EMovement::Land;
+
+	CUnitIndex index;
+	index.Init(64, 40);
+
+	CUnit unit1;
+	CUnit unit2;
+	CUnit unit3;
+	CUnit unit4;
+	PlaceUnit(index, unit1, footman, player0, Vec2i(10, 10));
+	PlaceUnit(index, unit2, footman, player1, Vec2i(12, 10));
+	PlaceUnit(index, unit3, dragon, player1, Vec2i(11, 12));
+	PlaceUnit(index, unit4, farm, player1, Vec2i(5, 5)); // overlaps (8, 8) from another cell
+
+	const unsigned int all = CUnitIndex::AllMovementTypes;
+	const unsigned int land = CUnitIndex::MovementBit(static_cast<int>(EMovement::Land));
+
+	CHECK(Query(index, Vec2i(8, 8), Vec2i(15, 15), ~0u, all).size() == 4);
+	CHECK(Query(index, Vec2i(8, 8), Vec2i(15, 15), 1u << 1, all).size() == 3);
+	CHECK(Query(index, Vec2i(8, 8), Vec2i(15, 15), 1u << 1, land).size() == 2);
+	CHECK(Query(index, Vec2i(11, 10), Vec2i(11, 10), ~0u, all).empty());
+	CHECK(Query(index, Vec2i(12, 13), Vec2i(12, 13), ~0u, all) == std::vector<CUnit *>{&unit3});
+	CHECK(Query(index, Vec2i(20, 20), Vec2i(63, 39), ~0u, all).empty());
+
+	// A change of owner needs an update to move the unit to its new bucket.
+	unit2.Player = &player0;
+	index.Update(unit2);
+	CHECK(Query(index, Vec2i(8, 8), Vec2i(15, 15), 1u << 0, land).size() == 2);
+
+	index.Remove(unit1);
+	CHECK(unit1.IndexBucket == static_cast<unsigned int>(-1));
+	CHECK(Query(index, Vec2i(8, 8), Vec2i(15, 15), 1u << 0, all) == std::vector<CUnit *>{&unit2});
+
+	index.Remove(unit2);
+	index.Remove(unit3);
+	index.Remove(unit4);
+	CHECK(Query(index, Vec2i(0, 0), Vec2i(63, 39), ~0u, all).empty());
+}
@@ -0,0 +1,105 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+/**@name test_unit_manager.cpp - The test file for unit_manager.cpp. */
+//
+//      (c) Copyright 2026 by the Stratagus Developers
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+
+#include <doctest.h>
+
+#include "stratagus.h"
+
+#include "unit.h"
+#include "unit_manager.h"
+
+#include <vector>
+
+namespace
+{
+struct Step
+{
+	int Unit;
+	bool Added;
+};
+
+/// Alloc 6 units, add the first 4, then run the steps
+std::vector<int> RunSteps(CUnitManager &manager, const std::vector<Step> &steps, bool iterate)
+{
+	std::vector<CUnit *> units;
+	for (int i = 0; i != 6; ++i) {
+		units.push_back(manager.AllocUnit());
+		units.back()->PlayerSlot = static_cast<size_t>(-1);
+	}
+	for (int i = 0; i != 4; ++i) {
+		manager.Add(units[i]);
+	}
+	if (iterate) {
+		manager.BeginIteration();
+	}
+	for (const Step &step : steps) {
+		if (step.Added) {
+			manager.Add(units[step.Unit]);
+		} else {
+			manager.ReleaseUnit(*units[step.Unit]);
+		}
+		if (iterate) {
+			// The units present at the beginning keep their place.
+			for (int i = 0; i != 4; ++i) {
+				CHECK(manager.GetIteratedUnits()[i] == units[i]);
+			}
+			// The other callers don't see the released units.
+			const auto &liveUnits = manager.GetUnits();
+			CHECK(ranges::none_of(liveUnits, [](const CUnit *unit) { return unit->Released; }));
+			CHECK(liveUnits.size() + ranges::count_if(units, [](const CUnit *unit) { return unit->Released; })
+			      == manager.GetIteratedUnits().size());
+		}
+	}
+	if (iterate) {
+		manager.EndIteration();
+	}
+	std::vector<int> result;
+	for (const CUnit *unit : manager.GetUnits()) {
+		result.push_back(static_cast<int>(ranges::find(units, unit) - units.begin()));
+	}
+	// The units know their place in the list.
+	while (!manager.empty()) {
+		manager.ReleaseUnit(*manager.GetUnits().front());
+	}
+	manager.Init();
+	return result;
+}
+} // namespace
+
+TEST_CASE("Unit list changes during an iteration")
+{
+	const std::vector<Step> steps = {
+		{1, false}, {4, true}, {5, true}, {3, false}, {4, false}, {0, false}};
+	CUnitManager manager;
+
+	const std::vector<int> expected = RunSteps(manager, steps, false);
+	CHECK(expected == std::vector<int>{2, 5});
+	CHECK(RunSteps(manager, steps, true) == expected);
+}
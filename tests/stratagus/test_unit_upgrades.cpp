@@ -0,0 +1,192 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+/**@name test_unit_upgrades.cpp - The test file for the upgrades of a unit. */
+//
+//      (c) Copyright 2026 by the Stratagus Developers
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+
+
+#include <doctest.h>
+
+#include "stratagus.h"
+
+#include "actions.h"
+#include "iolib.h"
+#include "map.h"
+#include "player.h"
+#include "unit.h"
+#include "unittype.h"
+#include "upgrade.h"
+#include "upgrade_structs.h"
+
+#include <fstream>
+#include <sstream>
+
+namespace
+{
+
+std::string SavedUnit(const CUnit &unit)
+{
+	const fs::path path = fs::temp_directory_path() / "stratagus_test_unit_upgrades.lua";
+	{
+		CFile file;
+		file.open(path.string().c_str(), CL_OPEN_WRITE);
+		SaveUnit(unit, file);
+		file.close();
+	}
+	std::ostringstream saved;
+	saved << std::ifstream(path).rdbuf();
+	fs::remove(path);
+	return saved.str();
+}
+
+CVariable HitPoints(int increase)
+{
+	CVariable variable;
+	variable.Max = 20;
+	variable.Value = 10;
+	variable.Increase = increase;
+	variable.Enable = true;
+	return variable;
+}
+
+void InitType(CUnitType &type, int slot, int hpIncrease)
+{
+	type.Slot = slot;
+	type.TileWidth = 1;
+	type.TileHeight = 1;
+	type.BoolFlag.resize(UnitTypeVar.GetNumberBoolFlag());
+	type.Stats[0].Variables.resize(UnitTypeVar.GetNumberVariable());
+	type.Stats[0].Variables[HP_INDEX] = HitPoints(hpIncrease);
+}
+
+} // namespace
+
+TEST_CASE("Individual upgrades are set, queried and saved")
+{
+	const CUpgrade &first = *CUpgrade::New("upgrade-test-first");
+	const CUpgrade &middle = *CUpgrade::New("upgrade-test-middle");
+	const CUpgrade &last = *CUpgrade::New("upgrade-test-last");
+
+	CPlayer player;
+	player.Index = 0;
+	CUnitType type;
+	type.Ident = "unit-test";
+	type.BoolFlag.resize(UnitTypeVar.GetNumberBoolFlag());
+	type.DefaultStat.Variables.resize(UnitTypeVar.GetNumberVariable());
+	CUnit unit;
+	unit.Type = &type;
+	unit.Player = &player;
+	unit.Variable = type.DefaultStat.Variables;
+	unit.Orders.push_back(COrder::NewActionStill());
+
+	// Taking an upgrade the unit doesn't have keeps the list empty.
+	unit.SetIndividualUpgrade(last.ID, false);
+	CHECK(unit.IndividualUpgrades.empty());
+	CHECK_FALSE(unit.HasIndividualUpgrade(last.ID));
+
+	unit.SetIndividualUpgrade(middle.ID, true);
+	CHECK(unit.HasIndividualUpgrade(middle.ID));
+	CHECK_FALSE(unit.HasIndividualUpgrade(first.ID));
+	// Past the end of the list.
+	CHECK_FALSE(unit.HasIndividualUpgrade(last.ID));
+
+	unit.SetIndividualUpgrade(last.ID, true);
+	unit.SetIndividualUpgrade(middle.ID, false);
+	CHECK_FALSE(unit.HasIndividualUpgrade(middle.ID));
+	CHECK(unit.HasIndividualUpgrade(last.ID));
+
+	unit.SetIndividualUpgrade(first.ID, true);
+	const std::string saved = SavedUnit(unit);
+	CHECK(saved.find("\"individual-upgrade\", \"upgrade-test-first\"") != std::string::npos);
+	CHECK(saved.find("upgrade-test-middle") == std::string::npos);
+	CHECK(saved.find("\"individual-upgrade\", \"upgrade-test-last\"") != std::string::npos);
+	CHECK(saved.substr(saved.size() - 3) == "})\n");
+
+	unit.Orders.clear();
+	CleanUpgrades();
+	AllUpgrades.clear();
+}
+
+TEST_CASE("Increasing variables follow the upgrades and the type changes")
+{
+	Map.Info.MapWidth = 32;
+	Map.Info.MapHeight = 32;
+	Map.Create();
+
+	CPlayer player;
+	player.Index = 0;
+	CUnitType soldier;
+	InitType(soldier, 0, 0);
+	CUnitType healer;
+	InitType(healer, 1, 1);
+
+	CUnit unit;
+	unit.Type = &soldier;
+	unit.PlayerSlot = static_cast<size_t>(-1);
+	player.AddUnit(unit);
+	unit.Stats = &soldier.Stats[0];
+	unit.Variable = soldier.Stats[0].Variables;
+	unit.tilePos = Vec2i(4, 4);
+	unit.Offset = Map.getIndex(unit.tilePos);
+	unit.Removed = 0;
+	Map.Insert(unit);
+	unit.Orders.push_back(COrder::NewActionStill());
+	unit.UpdateIncreasingVariables();
+	CHECK(unit.IncreasingVariables.empty());
+
+	const CUpgrade &regeneration = *CUpgrade::New("upgrade-test-regeneration");
+	auto &modifier = UpgradeModifiers[NumUpgradeModifiers++];
+	modifier = std::make_unique<CUpgradeModifier>();
+	modifier->UpgradeId = regeneration.ID;
+	modifier->Modifier.Variables.resize(UnitTypeVar.GetNumberVariable());
+	modifier->Modifier.Variables[HP_INDEX].Increase = 2;
+	modifier->ModifyPercent.resize(UnitTypeVar.GetNumberVariable());
+
+	IndividualUpgradeAcquire(unit, &regeneration);
+	CHECK(unit.Variable[HP_INDEX].Increase == 2);
+	CHECK(unit.IncreasingVariables == std::vector<unsigned int>{HP_INDEX});
+	IndividualUpgradeLost(unit, &regeneration);
+	CHECK(unit.Variable[HP_INDEX].Increase == 0);
+	CHECK(unit.IncreasingVariables.empty());
+
+	// The new type regenerates, the old one doesn't.
+	COrder::NewActionTransformInto(healer)->Execute(unit);
+	CHECK(unit.Type == &healer);
+	CHECK(unit.Variable[HP_INDEX].Increase == 1);
+	CHECK(unit.IncreasingVariables == std::vector<unsigned int>{HP_INDEX});
+	COrder::NewActionTransformInto(soldier)->Execute(unit);
+	CHECK(unit.IncreasingVariables.empty());
+
+	Map.Remove(unit);
+	player.RemoveUnit(unit);
+	unit.Orders.clear();
+	Map.Fields.clear();
+	Map.UnitIndex.Clear();
+	Map.Influence.Clear();
+	CleanUpgrades();
+	AllUpgrades.clear();
+}
@@ -0,0 +1,124 @@
+#!/usr/bin/env python3
+"""
+Compare the JSON lines printed by a benchmark with a stored baseline.
+
+    benchcheck.py baseline.json result.json --key map --key mode \\
+        --equal found --max nodes_expanded_mean=0.05 \\
+        --reference mode=sorted --agree found
+
+Records are matched by their --key fields. An --equal field must keep its
+baseline value, a --max field may grow by the given ratio at most. An
+--agree field must have, in the results, the value of the record whose
+--reference key has the given value and whose other keys are the same:
+above, every search mode must find as many paths as the sorted a*. Only
+counters which don't depend on the machine should be checked, the timings
+of shared CI runners vary too much.
+
+The baseline is the output of the benchmark, regenerate it when a change
+is expected:
+
+    ./stratagus_pathbench -q 100 > ../tools/benchmarks/pathbench.json
+"""
+
+from __future__ import annotations
+
+import argparse
+import json
+import sys
+from pathlib import Path
+from typing import Any
+
+
+def load_records(path: Path, keys: list[str]) -> dict[tuple, dict[str, Any]]:
+    records = {}
+    for line in path.read_text().splitlines():
+        line = line.strip()
+        if not line.startswith("{"):
+            continue
+        record = json.loads(line)
+        records[tuple(record.get(key) for key in keys)] = record
+    return records
+
+
+def parse_max(value: str) -> tuple[str, float]:
+    name, _, ratio = value.partition("=")
+    return name, float(ratio) if ratio else 0.0
+
+
+def parse_reference(value: str) -> tuple[str, str]:
+    name, sep, reference = value.partition("=")
+    if not sep:
+        raise argparse.ArgumentTypeError(f"{value}: expected key=value")
+    return name, reference
+
+
+def check_agreement(result: dict[tuple, dict[str, Any]], keys: list[str],
+                    reference: tuple[str, str], fields: list[str]) -> int:
+    position = keys.index(reference[0])
+    failures = 0
+    for key, actual in result.items():
+        if key[position] == reference[1]:
+            continue
+        name = "/".join(str(part) for part in key)
+        expected = result.get(key[:position] + (reference[1],) + key[position + 1:])
+        if expected is None:
+            print(f"FAIL {name}: no {reference[0]}={reference[1]} record to compare with")
+            failures += 1
+            continue
+        for field in fields:
+            if actual.get(field) != expected.get(field):
+                print(f"FAIL {name}: {field} {actual.get(field)} != {expected.get(field)} of {reference[1]}")
+                failures += 1
+    return failures
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description="Check benchmark results against a baseline.")
+    parser.add_argument("baseline", type=Path)
+    parser.add_argument("result", type=Path)
+    parser.add_argument("--key", action="append", default=[], help="field identifying a record")
+    parser.add_argument("--equal", action="append", default=[], help="field which must not change")
+    parser.add_argument("--max", action="append", default=[], type=parse_max,
+                        help="field=ratio, field which may only grow by ratio")
+    parser.add_argument("--reference", type=parse_reference,
+                        help="key=value, record the --agree fields are compared with")
+    parser.add_argument("--agree", action="append", default=[],
+                        help="field which must equal the one of the --reference record")
+    args = parser.parse_args()
+    if args.agree and (args.reference is None or args.reference[0] not in args.key):
+        parser.error("--agree needs a --reference on one of the --key fields")
+
+    baseline = load_records(args.baseline, args.key)
+    result = load_records(args.result, args.key)
+    if not baseline:
+        print(f"{args.baseline}: no baseline record", file=sys.stderr)
+        return 1
+
+    failures = 0
+    for key, expected in baseline.items():
+        name = "/".join(str(part) for part in key)
+        actual = result.get(key)
+        if actual is None:
+            print(f"FAIL {name}: missing from the results")
+            failures += 1
+            continue
+        for field in args.equal:
+            if actual.get(field) != expected.get(field):
+                print(f"FAIL {name}: {field} {actual.get(field)} != {expected.get(field)}")
+                failures += 1
+        for field, ratio in args.max:
+            limit = expected[field] * (1 + ratio)
+            status = "ok  "
+            if actual[field] > limit:
+                status = "FAIL"
+                failures += 1
+            print(f"{status} {name}: {field} {actual[field]} (baseline {expected[field]}, max {limit:g})")
+    for key in result.keys() - baseline.keys():
+        print(f"new  {'/'.join(str(part) for part in key)}: not in the baseline")
+    if args.agree:
+        failures += check_agreement(result, args.key, args.reference, args.agree)
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
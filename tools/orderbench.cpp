@@ -0,0 +1,230 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//   Utility for Stratagus - A free fantasy real time strategy game engine
+//
+/**@name orderbench.cpp - Benchmark of the order allocations. */
+//
+//      (c) Copyright 2026 by the Stratagus Developers
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+/*
+**  Gives commands to an army as an AI attack wave does: units get new move
+**  or patrol orders, some of them queued, some units save their order when
+**  they are hit, finished orders make way for the next one or for a still
+**  order. It is run with the orders of the engine, which come from the
+**  order pools, and with the same orders on the heap, as they were before,
+**  and prints one JSON object for each:
+**
+**    stratagus_orderbench [-u units] [-t cycles] [-s seed]
+*/
+
+#include "stratagus.h"
+
+#include "action/action_move.h"
+#include "action/action_patrol.h"
+#include "action/action_still.h"
+#include "actions.h"
+#include "map.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+static std::atomic<size_t> AllocationCount{0};
+
+void *operator new(size_t size)
+{
+	++AllocationCount;
+	if (void *p = malloc(size ? size : 1)) {
+		return p;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+	free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+	free(p);
+}
+
+void *operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete[](void *p) noexcept
+{
+	free(p);
+}
+
+void operator delete[](void *p, size_t) noexcept
+{
+	free(p);
+}
+
+static constexpr int MapSize = 128;
+
+/// The orders of the engine
+struct PooledOrders
+{
+	using Ptr = std::unique_ptr<COrder>;
+
+	static const char *Name() { return "pool"; }
+	static Ptr Move(const Vec2i &pos) { return COrder::NewActionMove(pos); }
+	static Ptr Patrol(const Vec2i &from, const Vec2i &to) { return COrder::NewActionPatrol(from, to); }
+	static Ptr Still() { return COrder::NewActionStill(); }
+	static Ptr Clone(const COrder &order) { return order.Clone(); }
+};
+
+/// The same orders with one heap allocation each
+struct HeapOrders
+{
+	struct Delete
+	{
+		void operator()(COrder *order) const
+		{
+			order->~COrder();
+			::operator delete(order);
+		}
+	};
+	using Ptr = std::unique_ptr<COrder, Delete>;
+
+	static const char *Name() { return "heap"; }
+	static Ptr Move(const Vec2i &) { return Ptr(::new COrder_Move); }
+	static Ptr Patrol(const Vec2i &, const Vec2i &) { return Ptr(::new COrder_Patrol); }
+	static Ptr Still() { return Ptr(::new COrder_Still(false)); }
+	static Ptr Clone(const COrder &order)
+	{
+		switch (order.Action) {
+			case UnitAction::Move: return Ptr(::new COrder_Move(static_cast<const COrder_Move &>(order)));
+			case UnitAction::Patrol: return Ptr(::new COrder_Patrol(static_cast<const COrder_Patrol &>(order)));
+			default: return Ptr(::new COrder_Still(static_cast<const COrder_Still &>(order)));
+		}
+	}
+};
+
+template <typename Policy>
+struct BenchUnit
+{
+	Vec2i Pos;
+	std::vector<typename Policy::Ptr> Orders;
+	typename Policy::Ptr SavedOrder;
+};
+
+template <typename Policy>
+static void RunBenchmark(int unitCount, int cycles, unsigned int seed)
+{
+	std::mt19937 random(seed);
+	std::vector<BenchUnit<Policy>> units(unitCount);
+
+	for (auto &unit : units) {
+		unit.Pos = Vec2i(random() % MapSize, random() % MapSize);
+		unit.Orders.push_back(Policy::Still());
+	}
+	size_t orderCount = 0;
+	const size_t allocationsBefore = AllocationCount;
+	const auto start = std::chrono::steady_clock::now();
+
+	for (int cycle = 0; cycle != cycles; ++cycle) {
+		for (size_t i = 0; i != units.size(); ++i) {
+			auto &unit = units[i];
+
+			// A wave gets its commands, a quarter of them are queued.
+			if ((i + cycle) % 8 == 0) {
+				const Vec2i goal(random() % MapSize, random() % MapSize);
+				const bool queue = random() % 4 == 0 && unit.Orders.size() < 4;
+
+				if (!queue) {
+					unit.Orders.clear();
+				}
+				if (random() % 3 == 0) {
+					unit.Orders.push_back(Policy::Patrol(unit.Pos, goal));
+				} else {
+					unit.Orders.push_back(Policy::Move(goal));
+				}
+				++orderCount;
+			}
+			// Hit units save their order to react.
+			if (random() % 32 == 0) {
+				unit.SavedOrder = Policy::Clone(*unit.Orders.front());
+				++orderCount;
+			} else if (unit.SavedOrder && random() % 4 == 0) {
+				unit.SavedOrder.reset();
+			}
+			// Some orders are done.
+			if (random() % 16 == 0) {
+				unit.Orders.erase(unit.Orders.begin());
+				if (unit.Orders.empty()) {
+					unit.Orders.push_back(Policy::Still());
+					++orderCount;
+				}
+			}
+		}
+	}
+	const auto duration = std::chrono::steady_clock::now() - start;
+	const size_t allocations = AllocationCount - allocationsBefore;
+
+	units.clear();
+	printf("{\"orders\": \"%s\", \"units\": %d, \"cycles\": %d, \"new_orders\": %d, "
+	       "\"allocations\": %d, \"allocations_per_cycle\": %.1f, \"ms\": %.1f}\n",
+	       Policy::Name(), unitCount, cycles, int(orderCount), int(allocations),
+	       double(allocations) / cycles,
+	       std::chrono::duration<double, std::milli>(duration).count());
+	fflush(stdout);
+}
+
+int main(int argc, char **argv)
+{
+	int unitCount = 2000;
+	int cycles = 1000;
+	unsigned int seed = 42;
+
+	for (int i = 1; i < argc; ++i) {
+		const std::string arg = argv[i];
+		if (arg == "-u" && i + 1 < argc) {
+			unitCount = std::max(1, atoi(argv[++i]));
+		} else if (arg == "-t" && i + 1 < argc) {
+			cycles = std::max(1, atoi(argv[++i]));
+		} else if (arg == "-s" && i + 1 < argc) {
+			seed = strtoul(argv[++i], nullptr, 10);
+		} else {
+			fprintf(stderr, "Usage: %s [-u units] [-t cycles] [-s seed]\n", argv[0]);
+			return 1;
+		}
+	}
+	Map.Info.MapWidth = MapSize;
+	Map.Info.MapHeight = MapSize;
+	RunBenchmark<HeapOrders>(unitCount, cycles, seed);
+	RunBenchmark<PooledOrders>(unitCount, cycles, seed);
+	return 0;
+}
@@ -0,0 +1,418 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//   Utility for Stratagus - A free fantasy real time strategy game engine
+//
+/**@name pathbench.cpp - Benchmark of the a* pathfinder. */
+//
+//      (c) Copyright 2026 by the Stratagus Developers
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+/*
+**  Runs the same random queries with each open set and search mode on
+**  synthetic maps (open field, maze, forest, islands) and on the given
+**  .smp maps, and prints one JSON object per map and mode:
+**
+**    stratagus_pathbench [-q queries] [-s seed] [-d datadir] [map.smp...]
+**
+**  Only the terrain of the .smp maps is loaded, the tilesets are searched
+**  in datadir. Units, players and video are not needed.
+*/
+
+#include "stratagus.h"
+
+#include "game.h"
+#include "map.h"
+#include "pathfinder.h"
+#include "player.h"
+#include "script.h"
+#include "unit.h"
+#include "unit_manager.h"
+#include "unittype.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+extern int AStarFindPath(const Vec2i &startPos, const Vec2i &goalPos, int gw, int gh,
+						 int tilesizex, int tilesizey, int minrange,
+						 int maxrange, char *path, int pathlen, const CUnit &unit);
+
+/// Movement mask of a land unit
+static constexpr tile_flags LandMask = MapFieldLandUnit | MapFieldSeaUnit | MapFieldBuilding
+									   | MapFieldCoastAllowed | MapFieldWaterAllowed | MapFieldUnpassable;
+
+struct Query
+{
+	Vec2i StartPos;
+	Vec2i GoalPos;
+};
+
+struct SearchMode
+{
+	const char *Name;
+	bool BucketOpenSet;
+	bool JumpPointSearch;
+	bool Hierarchical;
+	bool FlowField;
+};
+
+/// Hierarchical searches only give the path to the next waypoint, and flow
+/// fields are only built for crowds.
+static const SearchMode SearchModes[] = {
+	{"sorted", false, false, false, false},
+	{"bucket", true, false, false, false},
+	{"jump-point", false, true, false, false},
+	{"hierarchical", false, false, true, false},
+	{"flow-field", false, false, false, true},
+};
+
+/// Number of consecutive queries going to the same goal
+static constexpr int CrowdSize = 16;
+
+/*----------------------------------------------------------------------------
+--  Maps
+----------------------------------------------------------------------------*/
+
+static void CreateMap(int width, int height)
+{
+	Map.Fields.clear();
+	Map.Info.MapWidth = width;
+	Map.Info.MapHeight = height;
+	Map.Create();
+}
+
+static void Block(const Vec2i &pos, tile_flags flags)
+{
+	Map.Field(pos)->Flags |= flags | MapFieldUnpassable;
+}
+
+static void MakeOpenField(std::mt19937 &)
+{
+	CreateMap(256, 256);
+}
+
+/**
+**  Maze with corridors of one tile, dug by a random depth first walk.
+*/
+static void MakeMaze(std::mt19937 &random)
+{
+	constexpr int size = 255;
+	CreateMap(size, size);
+	for (Vec2i pos(0, 0); pos.y != size; ++pos.y) {
+		for (pos.x = 0; pos.x != size; ++pos.x) {
+			Block(pos, MapFieldRocks);
+		}
+	}
+	const Vec2i offsets[] = {{0, -2}, {2, 0}, {0, 2}, {-2, 0}};
+	std::vector<Vec2i> stack = {Vec2i(1, 1)};
+	Map.Field(1, 1)->Flags = 0;
+	while (!stack.empty()) {
+		const Vec2i pos = stack.back();
+		std::vector<Vec2i> nexts;
+		for (const Vec2i &offset : offsets) {
+			const Vec2i next = pos + offset;
+			if (Map.Info.IsPointOnMap(next) && Map.Field(next)->Flags != 0) {
+				nexts.push_back(next);
+			}
+		}
+		if (nexts.empty()) {
+			stack.pop_back();
+			continue;
+		}
+		const Vec2i next = nexts[random() % nexts.size()];
+		Map.Field((pos.x + next.x) / 2, (pos.y + next.y) / 2)->Flags = 0;
+		Map.Field(next)->Flags = 0;
+		stack.push_back(next);
+	}
+}
+
+/**
+**  Clumps of forest covering about half of the map.
+*/
+static void MakeForest(std::mt19937 &random)
+{
+	constexpr int size = 256;
+	CreateMap(size, size);
+	for (int i = 0; i != 400; ++i) {
+		const Vec2i center(random() % size, random() % size);
+		const int radius = 2 + random() % 8;
+		for (Vec2i pos(center.x - radius, center.y - radius); pos.y <= center.y + radius; ++pos.y) {
+			for (pos.x = center.x - radius; pos.x <= center.x + radius; ++pos.x) {
+				const Vec2i d = pos - center;
+				if (Map.Info.IsPointOnMap(pos) && d.x * d.x + d.y * d.y <= radius * radius) {
+					Block(pos, MapFieldForest);
+				}
+			}
+		}
+	}
+}
+
+/**
+**  Round islands in water, some queries can't be answered.
+*/
+static void MakeIslands(std::mt19937 &random)
+{
+	constexpr int size = 256;
+	CreateMap(size, size);
+	std::vector<Vec2i> centers;
+	for (int i = 0; i != 12; ++i) {
+		centers.emplace_back(20 + random() % (size - 40), 20 + random() % (size - 40));
+	}
+	for (Vec2i pos(0, 0); pos.y != size; ++pos.y) {
+		for (pos.x = 0; pos.x != size; ++pos.x) {
+			const bool land = ranges::any_of(centers, [&](const Vec2i &center) {
+				const Vec2i d = pos - center;
+				return d.x * d.x + d.y * d.y <= 20 * 20;
+			});
+			if (!land) {
+				Map.Field(pos)->Flags |= MapFieldWaterAllowed;
+			}
+		}
+	}
+}
+
+/**
+**  Load the terrain of a .smp map.
+*/
+static bool LoadSmpMap(const std::string &filename)
+{
+	static bool luaReady = false;
+	if (!luaReady) {
+		InitLua();
+		LuaRegisterModules();
+		// Units and players need the game data, only the tiles are wanted.
+		lua_pushcfunction(Lua, [](lua_State *) { return 0; });
+		lua_pushvalue(Lua, -1);
+		lua_setglobal(Lua, "CreateUnit");
+		lua_pushvalue(Lua, -1);
+		lua_setglobal(Lua, "SetResourcesHeld");
+		lua_pushvalue(Lua, -1);
+		lua_setglobal(Lua, "SetPlayerData");
+		lua_setglobal(Lua, "SetAiType");
+		luaReady = true;
+	}
+	Map.Fields.clear();
+	Map.Info.MapWidth = 0;
+	Map.Info.MapHeight = 0;
+	if (!LoadStratagusMapInfo(filename) || Map.Info.MapWidth <= 0 || Map.Info.MapHeight <= 0) {
+		return false;
+	}
+	Map.Create();
+	return LuaLoadFile(Map.Info.Filename, "", false) == 0;
+}
+
+/*----------------------------------------------------------------------------
+--  Benchmark
+----------------------------------------------------------------------------*/
+
+/**
+**  Random queries between passable tiles, grouped by CrowdSize going to
+**  the same goal so that the flow field mode answers the same queries as
+**  the other modes.
+*/
+static std::vector<Query> MakeQueries(int count, std::mt19937 &random)
+{
+	std::vector<Vec2i> passables;
+	for (Vec2i pos(0, 0); pos.y != Map.Info.MapHeight; ++pos.y) {
+		for (pos.x = 0; pos.x != Map.Info.MapWidth; ++pos.x) {
+			if ((Map.Field(pos)->Flags & LandMask) == 0) {
+				passables.push_back(pos);
+			}
+		}
+	}
+	std::vector<Query> queries;
+	if (passables.empty()) {
+		return queries;
+	}
+	for (int i = 0; i != count; ++i) {
+		const Vec2i startPos = passables[random() % passables.size()];
+		const Vec2i goalPos = i % CrowdSize == 0 ? passables[random() % passables.size()]
+		                                         : queries[i - i % CrowdSize].GoalPos;
+		queries.push_back({startPos, goalPos});
+	}
+	return queries;
+}
+
+/// Value below which are ratio of the sorted values
+template <typename T>
+static T Percentile(const std::vector<T> &sorted, double ratio)
+{
+	return sorted[std::min<size_t>(sorted.size() - 1, sorted.size() * ratio)];
+}
+
+static void RunBenchmark(const std::string &mapName, const std::vector<Query> &queries)
+{
+	CPlayer player;
+	player.Index = 0;
+	CUnitType type;
+	type.TileWidth = 1;
+	type.TileHeight = 1;
+	type.MovementMask = LandMask;
+	type.BoolFlag.resize(UnitTypeVar.GetNumberBoolFlag());
+	// Flow fields count the different units asking for them.
+	CUnitManager unitManager;
+	unitManager.Init();
+	std::vector<CUnit *> units;
+	for (int i = 0; i != CrowdSize; ++i) {
+		CUnit &unit = *unitManager.AllocUnit();
+		unit.Player = &player;
+		unit.Type = &type;
+		unit.Removed = 0;
+		unit.Orders.push_back(COrder::NewActionStill());
+		units.push_back(&unit);
+	}
+	std::vector<std::shared_ptr<CFlowField>> flowFields(units.size());
+
+	InitPathfinder();
+	std::vector<char> path(Map.Info.MapWidth * Map.Info.MapHeight);
+
+	for (const SearchMode &mode : SearchModes) {
+		SetAStarBucketOpenSet(mode.BucketOpenSet);
+		SetAStarJumpPointSearch(mode.JumpPointSearch);
+		AStarHierarchical = mode.Hierarchical;
+		AStarFlowField = mode.FlowField;
+
+		std::vector<double> latencies;
+		std::vector<int> expandedNodes;
+		int64_t cacheHits = 0;
+		int64_t cacheLookups = 0;
+		int found = 0;
+		for (size_t i = 0; i != queries.size(); ++i) {
+			const Query &query = queries[i];
+			CUnit &unit = *units[i % units.size()];
+			unit.tilePos = query.StartPos;
+			const auto start = std::chrono::steady_clock::now();
+			int length = PF_FAILED;
+			// Nothing is expanded when the flow field answers.
+			AStarSearchStats stats;
+			if (mode.FlowField) {
+				// Same as NextPathElement: a* when the field can't tell.
+				PathFinderInput input;
+				input.SetUnit(unit);
+				input.SetGoal(query.GoalPos, Vec2i(1, 1));
+				length = FlowFieldFindPath(input, path.data(), PathFinderOutput::MAX_PATH_LENGTH,
+										   flowFields[i % units.size()]);
+				if (length == PF_FAILED) {
+					length = AStarFindPath(query.StartPos, input.GetGoalPos(), 1, 1, 1, 1, 0, 0,
+										   path.data(), path.size(), unit);
+					stats = GetAStarLastSearchStats();
+				}
+			} else {
+				length = AStarFindPath(query.StartPos, query.GoalPos, 1, 1, 1, 1, 0, 0,
+									   path.data(), path.size(), unit);
+				stats = GetAStarLastSearchStats();
+			}
+			const auto duration = std::chrono::steady_clock::now() - start;
+
+			latencies.push_back(std::chrono::duration<double, std::micro>(duration).count());
+			expandedNodes.push_back(stats.ExpandedNodes);
+			cacheHits += stats.CostCacheHits;
+			cacheLookups += stats.CostCacheHits + stats.CostCacheMisses;
+			if (length >= 0 || length == PF_REACHED) {
+				++found;
+			}
+		}
+		if (queries.empty()) {
+			continue;
+		}
+		ranges::sort(latencies);
+		ranges::sort(expandedNodes);
+		int64_t totalExpanded = 0;
+		for (const int nodes : expandedNodes) {
+			totalExpanded += nodes;
+		}
+		printf("{\"map\": \"%s\", \"mode\": \"%s\", \"width\": %d, \"height\": %d, \"queries\": %d, \"found\": %d, "
+			   "\"nodes_expanded_mean\": %.1f, \"nodes_expanded_p99\": %d, \"p50_us\": %.1f, \"p99_us\": %.1f, "
+			   "\"cost_cache_hit_rate\": %.4f}\n",
+			   mapName.c_str(), mode.Name, Map.Info.MapWidth, Map.Info.MapHeight, int(queries.size()), found,
+			   double(totalExpanded) / queries.size(), Percentile(expandedNodes, 0.99),
+			   Percentile(latencies, 0.5), Percentile(latencies, 0.99),
+			   cacheLookups ? double(cacheHits) / cacheLookups : 0.);
+		fflush(stdout);
+	}
+	SetAStarBucketOpenSet(false);
+	SetAStarJumpPointSearch(false);
+	AStarHierarchical = false;
+	AStarFlowField = false;
+	flowFields.clear();
+	FreePathfinder();
+
+	for (CUnit *unit : units) {
+		unit->Orders.clear();
+		unitManager.ReleaseUnit(*unit);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	int queryCount = 200;
+	unsigned int seed = 42;
+	std::vector<std::string> smpMaps;
+
+	StratagusLibPath = ".";
+	for (int i = 1; i < argc; ++i) {
+		const std::string arg = argv[i];
+		if (arg == "-q" && i + 1 < argc) {
+			queryCount = std::max(1, atoi(argv[++i]));
+		} else if (arg == "-s" && i + 1 < argc) {
+			seed = strtoul(argv[++i], nullptr, 10);
+		} else if (arg == "-d" && i + 1 < argc) {
+			StratagusLibPath = argv[++i];
+		} else if (arg.size() > 4 && arg.compare(arg.size() - 4, 4, ".smp") == 0) {
+			smpMaps.push_back(arg);
+		} else {
+			fprintf(stderr, "Usage: %s [-q queries] [-s seed] [-d datadir] [map.smp...]\n", argv[0]);
+			return 1;
+		}
+	}
+	// Unexplored tiles would need a real player.
+	AStarKnowUnseenTerrain = true;
+	AStarMaxSearchIterations = 256 * 256;
+
+	const std::pair<const char *, void (*)(std::mt19937 &)> fixtures[] = {
+		{"open-field", MakeOpenField},
+		{"maze", MakeMaze},
+		{"forest", MakeForest},
+		{"islands", MakeIslands},
+	};
+	for (const auto &[name, make] : fixtures) {
+		std::mt19937 random(seed);
+		make(random);
+		RunBenchmark(name, MakeQueries(queryCount, random));
+	}
+	int ret = 0;
+	for (const std::string &smpMap : smpMaps) {
+		if (!LoadSmpMap(smpMap)) {
+			fprintf(stderr, "Can't load the map %s\n", smpMap.c_str());
+			ret = 1;
+			continue;
+		}
+		std::mt19937 random(seed);
+		RunBenchmark(smpMap, MakeQueries(queryCount, random));
+	}
+	Map.Fields.clear();
+	return ret;
+}
@@ -0,0 +1,226 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//   Utility for Stratagus - A free fantasy real time strategy game engine
+//
+/**@name unitcachebench.cpp - Benchmark of the units on the map fields. */
+//
+//      (c) Copyright 2026 by the Stratagus Developers
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+/*
+**  Moves two armies into each other on an empty map, as CMap::Insert and
+**  CMap::Remove do for each step of a unit, and looks at the units around
+**  some of them, as the unit finders do. Dead units leave a corpse on
+**  their tiles, the oldest corpses rot away. It is run with the CUnitCache
+**  of the map fields and with the std::vector it replaces, and prints one
+**  JSON object for each:
+**
+**    stratagus_unitcachebench [-u units] [-t steps] [-s seed]
+**
+**  Only the heap allocations and the run time are measured.
+*/
+
+#include "stratagus.h"
+
+#include "tile.h"
+#include "util.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+static std::atomic<size_t> AllocationCount{0};
+
+void *operator new(size_t size)
+{
+	++AllocationCount;
+	if (void *p = malloc(size ? size : 1)) {
+		return p;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+	free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+	free(p);
+}
+
+void *operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete[](void *p) noexcept
+{
+	free(p);
+}
+
+void operator delete[](void *p, size_t) noexcept
+{
+	free(p);
+}
+
+static constexpr int MapSize = 256;
+
+struct BenchUnit
+{
+	CUnit *Unit; /// Only used as a key, never dereferenced
+	Vec2i Pos;
+	int Size;
+	Vec2i Goal;
+};
+
+struct VectorCache
+{
+	static const char *Name() { return "std::vector"; }
+	static void Insert(std::vector<CUnit *> &cache, CUnit *unit) { cache.push_back(unit); }
+	static void Remove(std::vector<CUnit *> &cache, CUnit *unit) { ranges::erase(cache, unit); }
+};
+
+struct InlineCache
+{
+	static const char *Name() { return "CUnitCache"; }
+	static void Insert(CUnitCache &cache, CUnit *unit) { cache.push_back(unit); }
+	static void Remove(CUnitCache &cache, CUnit *unit) { cache.Remove(unit); }
+};
+
+template <typename Cache>
+static void ForEachTile(std::vector<Cache> &fields, const BenchUnit &unit, void (*op)(Cache &, CUnit *))
+{
+	for (int y = 0; y != unit.Size; ++y) {
+		for (int x = 0; x != unit.Size; ++x) {
+			op(fields[unit.Pos.x + x + (unit.Pos.y + y) * MapSize], unit.Unit);
+		}
+	}
+}
+
+template <typename Policy, typename Cache>
+static void RunBenchmark(int unitCount, int steps, unsigned int seed)
+{
+	std::mt19937 random(seed);
+	std::vector<char> keys(unitCount + unitCount * steps / 16 + 1);
+	size_t nextKey = 0;
+	std::vector<BenchUnit> units(unitCount);
+
+	const size_t allocationsBefore = AllocationCount;
+	const auto start = std::chrono::steady_clock::now();
+	std::vector<Cache> fields(MapSize * MapSize);
+
+	for (int i = 0; i != unitCount; ++i) {
+		BenchUnit &unit = units[i];
+		const bool west = i % 2 == 0;
+
+		unit.Unit = reinterpret_cast<CUnit *>(&keys[nextKey++]);
+		unit.Size = random() % 5 == 0 ? 2 : 1;
+		unit.Pos.x = west ? random() % 32 : MapSize - 34 + random() % 32;
+		unit.Pos.y = 64 + random() % 128;
+		unit.Goal = Vec2i(MapSize - 3 - unit.Pos.x, unit.Pos.y);
+		ForEachTile(fields, unit, Policy::Insert);
+	}
+	size_t seen = 0;
+	int corpseCount = 0;
+	std::deque<BenchUnit> corpses;
+	for (int step = 0; step != steps; ++step) {
+		for (size_t i = 0; i != units.size(); ++i) {
+			BenchUnit &unit = units[i];
+
+			ForEachTile(fields, unit, Policy::Remove);
+			const Vec2i dir(unit.Goal.x > unit.Pos.x ? 1 : (unit.Goal.x < unit.Pos.x ? -1 : 0),
+			                int(random() % 3) - 1);
+			unit.Pos.x = std::clamp(unit.Pos.x + dir.x, 0, MapSize - unit.Size);
+			unit.Pos.y = std::clamp(unit.Pos.y + dir.y, 0, MapSize - unit.Size);
+			if (unit.Pos.x == unit.Goal.x) {
+				// Go back through the other army.
+				unit.Goal.x = MapSize - 3 - unit.Goal.x;
+			}
+			ForEachTile(fields, unit, Policy::Insert);
+
+			// Some units die in the middle of the fight and leave a corpse.
+			if (random() % 16 == 0 && nextKey < keys.size()) {
+				BenchUnit &corpse = corpses.emplace_back(unit);
+				corpse.Unit = reinterpret_cast<CUnit *>(&keys[nextKey++]);
+				ForEachTile(fields, corpse, Policy::Insert);
+				++corpseCount;
+				if (corpses.size() > units.size() / 2) {
+					ForEachTile(fields, corpses.front(), Policy::Remove);
+					corpses.pop_front();
+				}
+			}
+			// Look around, as the unit finders do.
+			if (i % 8 == 0) {
+				for (int y = std::max(0, unit.Pos.y - 4); y <= std::min(MapSize - 1, unit.Pos.y + 4); ++y) {
+					for (int x = std::max(0, unit.Pos.x - 4); x <= std::min(MapSize - 1, unit.Pos.x + 4); ++x) {
+						for (CUnit *other : fields[x + y * MapSize]) {
+							seen += other != unit.Unit;
+						}
+					}
+				}
+			}
+		}
+	}
+	fields.clear();
+	corpses.clear();
+	const auto duration = std::chrono::steady_clock::now() - start;
+
+	printf("{\"cache\": \"%s\", \"units\": %d, \"steps\": %d, \"corpses\": %d, \"sizeof_field_cache\": %d, "
+	       "\"allocations\": %d, \"ms\": %.1f, \"units_seen\": %d}\n",
+	       Policy::Name(), unitCount, steps, corpseCount, int(sizeof(Cache)),
+	       int(AllocationCount - allocationsBefore),
+	       std::chrono::duration<double, std::milli>(duration).count(), int(seen));
+	fflush(stdout);
+}
+
+int main(int argc, char **argv)
+{
+	int unitCount = 2000;
+	int steps = 500;
+	unsigned int seed = 42;
+
+	for (int i = 1; i < argc; ++i) {
+		const std::string arg = argv[i];
+		if (arg == "-u" && i + 1 < argc) {
+			unitCount = std::max(2, atoi(argv[++i]));
+		} else if (arg == "-t" && i + 1 < argc) {
+			steps = std::max(1, atoi(argv[++i]));
+		} else if (arg == "-s" && i + 1 < argc) {
+			seed = strtoul(argv[++i], nullptr, 10);
+		} else {
+			fprintf(stderr, "Usage: %s [-u units] [-t steps] [-s seed]\n", argv[0]);
+			return 1;
+		}
+	}
+	RunBenchmark<VectorCache, std::vector<CUnit *>>(unitCount, steps, seed);
+	RunBenchmark<InlineCache, CUnitCache>(unitCount, steps, seed);
+	return 0;
+}